@@ -6,17 +6,154 @@
  * - Error handling
  * - Health checks
  * - LED heartbeat
+ *
+ * Work is split into scheduler tasks (common/scheduler.h) instead of
+ * one pass doing everything: each runs at its own rate, or when an
+ * event is posted to it. Short periodic jobs such as the heartbeat and
+ * driver timeouts run on software timers (common/sw_timer.h), ticked
+ * in milliseconds from app_run().
+ *
+ * Liveness: the main loop and the binlog task check in with the
+ * health monitor (common/health.h); the health task kicks the
+ * independent watchdog only while both are on time.
+ *
+ * Lower layers report through the event bus (common/event_bus.h)
+ * instead of being polled: the "events" task is woken by every publish
+ * and dispatches to the subscribers below, e.g. health checks run when
+ * an error is logged rather than on a timer.
+ *
+ * Log records are queued with BINLOGn() (common/binlog.h) and shipped
+ * as binary frames on BINLOG_UART by the lowest-priority task.
  */
 
 #include "app.h"
+#include "console.h"
 #include "../bsp/bsp_init.h"
 #include "../bsp/board_config.h"
+#include "../bsp/bsp_time.h"
+#include "../bsp/bsp_watchdog.h"
 #include "../drivers/gpio_driver.h"
 #include "../drivers/uart_driver.h"
+#include "../drivers/wave_driver.h"
+#include "../common/binlog.h"
+#include "../common/crc.h"
 #include "../common/error.h"
+#include "../common/event_bus.h"
+#include "../common/health.h"
+#include "../common/mem_pool.h"
+#include "../common/profile.h"
+#include "../common/scheduler.h"
+#include "../common/sw_timer.h"
+
+/* Task periods */
+#define APP_HEALTH_PERIOD_US        100000U     /* Watchdog supervision */
+#define APP_BINLOG_PERIOD_US        10000U
+
+/* Liveness deadlines; the watchdog timeout leaves room for the LSI
+ * running fast (0.7x) on top of a withheld supervision period */
+#define APP_LOOP_DEADLINE_US        200000U
+#define APP_BINLOG_DEADLINE_US      100000U
+#define APP_WATCHDOG_TIMEOUT_MS     1000U
+
+/* Timer periods (ms) */
+#define APP_HEARTBEAT_PERIOD_MS     500U
+
+/* Heartbeat LED (board_config.h) */
+#define APP_LED                     GPIO_PIN(LED_PORT, LED_PIN)
 
 static app_state_t app_state = APP_STATE_INIT;
-static uint32_t heartbeat_counter = 0;
+static sw_timer_t heartbeat_timer;
+static uint64_t timer_now_ms;   /* Last tick fed to sw_timer_process() */
+static sched_task_id_t events_task_id;
+static event_subscriber_t error_subscriber;
+static health_id_t loop_check;
+static health_id_t binlog_check;
+
+/* ===== Timers ===== */
+
+static void app_heartbeat_timer(sw_timer_t *timer, void *context)
+{
+    (void)timer; (void)context;
+    PROFILE_BEGIN(heartbeat_toggle);
+    (void)gpio_driver_toggle(APP_LED);
+    PROFILE_END(heartbeat_toggle);
+}
+
+/* ===== Events ===== */
+
+static void app_error_event(const event_topic_t *topic, uint32_t value, void *context)
+{
+    (void)topic; (void)context;
+    if (ERROR_EVENT_SEVERITY(value) == SEVERITY_FATAL) {
+        (void)app_health_check();
+    }
+}
+
+/* Any context: make the dispatching task ready and end the idle */
+static void app_event_notify(void *context)
+{
+    (void)context;
+    (void)sched_post(events_task_id, 1U);
+    bsp_time_wake();
+}
+
+/* ===== Tasks ===== */
+
+static void app_events_task(uint32_t events, void *context)
+{
+    (void)events; (void)context;
+    (void)event_bus_dispatch();
+}
+
+static void app_health_task(uint32_t events, void *context)
+{
+    (void)events; (void)context;
+    (void)app_health_check();
+    (void)health_supervise();
+}
+
+/* Take a frame only if it fits whole, so frames never interleave */
+static bool app_binlog_sink(const uint8_t *frame, uint32_t length, void *context)
+{
+    (void)context;
+    if (uart_driver_tx_free(BINLOG_UART) < length) {
+        return false;
+    }
+    return uart_driver_write(BINLOG_UART, frame, (uint16_t)length, NULL) == ERR_OK;
+}
+
+static void app_binlog_task(uint32_t events, void *context)
+{
+    (void)events; (void)context;
+    health_checkin(binlog_check);
+    (void)binlog_drain(app_binlog_sink, NULL);
+}
+
+static uint32_t app_binlog_clock(void)
+{
+    return (uint32_t)bsp_time_us();
+}
+
+static const sched_task_config_t app_events_config = {
+    .name = "events",
+    .run = app_events_task,
+    .priority = SCHED_PRIORITY_HIGH,
+};
+
+static const sched_task_config_t app_tasks[] = {
+    {
+        .name = "health",
+        .run = app_health_task,
+        .priority = SCHED_PRIORITY_HIGH,
+        .period_us = APP_HEALTH_PERIOD_US,
+    },
+    {
+        .name = "binlog",
+        .run = app_binlog_task,
+        .priority = SCHED_PRIORITY_LOW,
+        .period_us = APP_BINLOG_PERIOD_US,
+    },
+};
 
 error_t app_init(void)
 {
@@ -25,6 +162,17 @@ error_t app_init(void)
     /* Initialize error system first */
     error_init();
 
+    /* Block pools, before anything can borrow from them */
+    err = mem_init();
+    if (err != ERR_OK) {
+        error_log(err, SEVERITY_FATAL, 5);
+        app_state = APP_STATE_ERROR;
+        return err;
+    }
+
+    /* CRC tables for the packet transport */
+    crc_init();
+
     /* Initialize BSP */
     err = bsp_init();
     if (err != ERR_OK) {
@@ -33,8 +181,11 @@ error_t app_init(void)
         return err;
     }
 
-    /* Initialize GPIO driver */
+    /* Initialize GPIO driver and the heartbeat LED */
     err = gpio_driver_init();
+    if (err == ERR_OK) {
+        err = gpio_driver_configure(APP_LED, GPIO_MODE_OUTPUT);
+    }
     if (err != ERR_OK) {
         error_log(err, SEVERITY_FATAL, 1);
         app_state = APP_STATE_ERROR;
@@ -49,7 +200,78 @@ error_t app_init(void)
         return err;
     }
 
+    /* Waveform engine (timer + DMA to GPIO) */
+    err = wave_driver_init();
+    if (err != ERR_OK) {
+        error_log(err, SEVERITY_FATAL, 6);
+        app_state = APP_STATE_ERROR;
+        return err;
+    }
+
+    /* Timestamp log entries from here on */
+    error_set_clock(bsp_time_ms);
+    (void)profile_init();
+
+    /* Binary log; records queue up even if the port fails to open */
+    binlog_init();
+    binlog_set_clock(app_binlog_clock);
+    err = uart_driver_open(BINLOG_UART, BINLOG_BAUD);
+    if (err != ERR_OK) {
+        error_log(err, SEVERITY_WARN, 4);
+    }
+
+    /* Software timers, ticked in ms */
+    timer_now_ms = bsp_time_us() / 1000U;
+    sw_timer_init((uint32_t)timer_now_ms);
+    (void)sw_timer_setup(&heartbeat_timer, app_heartbeat_timer, NULL);
+    (void)sw_timer_start(&heartbeat_timer, APP_HEARTBEAT_PERIOD_MS, APP_HEARTBEAT_PERIOD_MS);
+
+    /* Register tasks */
+    err = sched_init(bsp_time_us);
+    if (err == ERR_OK) {
+        err = sched_add_task(&app_events_config, &events_task_id);
+    }
+    if (err == ERR_OK) {
+        event_bus_init(app_event_notify, NULL);
+        err = event_subscribe(&error_topic, &error_subscriber, app_error_event, NULL);
+    }
+    for (uint32_t i = 0; err == ERR_OK && i < sizeof(app_tasks) / sizeof(app_tasks[0]); i++) {
+        err = sched_add_task(&app_tasks[i], NULL);
+    }
+    if (err == ERR_OK) {
+        err = console_init();
+    }
+    if (err != ERR_OK) {
+        error_log(err, SEVERITY_FATAL, 3);
+        app_state = APP_STATE_ERROR;
+        return err;
+    }
+
+    /* Liveness checks, then the watchdog they gate */
+    health_init(bsp_time_us, bsp_watchdog_kick, bsp_watchdog_caused_reset());
+    err = health_register("loop", APP_LOOP_DEADLINE_US, &loop_check);
+    if (err == ERR_OK) {
+        err = health_register("binlog", APP_BINLOG_DEADLINE_US, &binlog_check);
+    }
+    if (err == ERR_OK) {
+        err = bsp_watchdog_start(APP_WATCHDOG_TIMEOUT_MS);
+    }
+    if (err != ERR_OK) {
+        error_log(err, SEVERITY_FATAL, 7);
+        app_state = APP_STATE_ERROR;
+        return err;
+    }
+    if (bsp_watchdog_caused_reset()) {
+        health_status_t status;
+
+        health_get_status(&status);
+        error_log(ERR_TIMEOUT, SEVERITY_WARN, status.reset_late_mask);
+        BINLOG2("health: watchdog reset %u, late checks 0x%x", status.watchdog_resets,
+                status.reset_late_mask);
+    }
+
     app_state = APP_STATE_RUNNING;
+    BINLOG1("app: running, %u tasks", sizeof(app_tasks) / sizeof(app_tasks[0]));
     return ERR_OK;
 }
 
@@ -69,41 +291,57 @@ error_t app_stop(void)
 
 error_t app_run(void)
 {
+    uint64_t now_us;
+
     if (app_state != APP_STATE_RUNNING) {
         return ERR_NOT_INITIALIZED;
     }
 
-    heartbeat_counter++;
+    /* Report settled input edges, expire due timers, then run every
+     * task that has work */
+    now_us = bsp_time_us();
+    health_checkin(loop_check);
+    gpio_driver_process(now_us);
+    uart_driver_process();
+    timer_now_ms = now_us / 1000U;
+    sw_timer_process((uint32_t)timer_now_ms);
+    (void)sched_run_ready();
 
-    /* Simple heartbeat: toggle LED every 1000 iterations */
-    if (heartbeat_counter % 1000 == 0) {
-        gpio_driver_toggle((gpio_pin_t)LED_PIN);
+    if (app_state != APP_STATE_RUNNING) {
+        return error_get_last();
     }
+    return ERR_OK;
+}
 
-    /* Health check */
-    error_t err = app_health_check();
-    if (err != ERR_OK) {
+error_t app_health_check(void)
+{
+    /* Any fatal error since boot, wherever it was logged from and
+     * whatever was logged after it */
+    if (error_fatal_latched()) {
+        error_t last = error_get_last();
+
+        BINLOG1("health: fatal error, last code %d", last);
         app_state = APP_STATE_ERROR;
-        return err;
+        return last;
     }
 
     return ERR_OK;
 }
 
-error_t app_health_check(void)
+uint64_t app_next_wakeup_us(void)
 {
-    error_t last_err = error_get_last();
-    
-    if (last_err != ERR_OK) {
-        error_severity_t severity = error_get_last_severity();
-        
-        if (severity == SEVERITY_FATAL) {
-            app_state = APP_STATE_ERROR;
-            return last_err;
-        }
+    uint64_t next = sched_next_release_us();
+    uint64_t edge = gpio_driver_next_deadline_us();
+    uint32_t ticks = sw_timer_ticks_to_next();
+
+    if (edge < next) {
+        next = edge;
     }
 
-    return ERR_OK;
+    if (ticks != UINT32_MAX && (timer_now_ms + ticks) * 1000U < next) {
+        next = (timer_now_ms + ticks) * 1000U;
+    }
+    return next;
 }
 
 app_state_t app_get_state(void)
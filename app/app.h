@@ -8,6 +8,7 @@
 #ifndef APP_APP_H
 #define APP_APP_H
 
+#include <stdint.h>
 #include "../common/error.h"
 
 /* Application States */
@@ -23,8 +24,13 @@ error_t app_init(void);
 error_t app_start(void);
 error_t app_stop(void);
 
-/* Main Application Loop */
+/* Main Application Loop
+ * Reports settled GPIO edges, fires due timers and runs every ready
+ * task; the caller then sleeps until app_next_wakeup_us() or until
+ * sched_events_pending().
+ */
 error_t app_run(void);
+uint64_t app_next_wakeup_us(void);
 
 /* Health Check */
 error_t app_health_check(void);
@@ -0,0 +1,191 @@
+/*
+ * console.c - Diagnostic Command Console Implementation
+ */
+
+#include "console.h"
+#include "../bsp/board_config.h"
+#include "../bsp/bsp_clock.h"
+#include "../bsp/bsp_power.h"
+#include "../drivers/uart_driver.h"
+#include "../common/health.h"
+#include "../common/profile.h"
+#include "../common/scheduler.h"
+#include <stdarg.h>
+#include <string.h>
+
+#define CONSOLE_LINE_MAX        64U
+#define CONSOLE_RX_IDLE_MS      5U      /* Quiet time that ends a burst */
+#define CONSOLE_WRITE_WAIT_US   50000U  /* Give up on a full TX queue */
+
+#define CONSOLE_EVENT_RX        (1UL << 0)
+
+static sched_task_id_t console_task_id;
+static char console_line[CONSOLE_LINE_MAX];
+static uint32_t console_line_length = 0;
+
+void console_write(const char *text)
+{
+    (void)uart_driver_printf(CONSOLE_UART, CONSOLE_WRITE_WAIT_US, "%s", text);
+}
+
+static void console_printf(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    (void)uart_driver_vprintf(CONSOLE_UART, CONSOLE_WRITE_WAIT_US, format, args);
+    va_end(args);
+}
+
+static void console_set_clock(clock_profile_t profile)
+{
+    uint32_t switch_us = 0;
+    error_t err = bsp_clock_set_profile(profile, &switch_us);
+
+    if (err == ERR_BUSY) {
+        console_write("busy, retry\r\n");
+        return;
+    }
+    if (err != ERR_OK) {
+        console_write("rejected\r\n");
+        return;
+    }
+    console_printf("ok, %.1lk MHz, switch %lu us\r\n",
+                   (long)(bsp_clock_get_system_clock() / 100000UL), (unsigned long)switch_us);
+}
+
+#ifdef PROFILE_ENABLED
+static void console_profile_write(const char *text, void *context)
+{
+    (void)context;
+    console_write(text);
+}
+#endif
+
+/* One line per check: misses this boot / kept total, worst lateness */
+static void console_health(void)
+{
+    health_status_t status;
+    health_check_stats_t stats;
+    const char *name;
+
+    health_get_status(&status);
+    console_printf("boots %lu, watchdog resets %lu, kicks withheld %lu\r\n",
+                   (unsigned long)status.boots, (unsigned long)status.watchdog_resets,
+                   (unsigned long)status.kicks_withheld);
+    for (health_id_t id = 0; (name = health_get_check_name(id)) != NULL; id++) {
+        (void)health_get_check_stats(id, &stats);
+        console_printf("%s: misses %lu/%lu, worst +%lu us%s\r\n", name,
+                       (unsigned long)stats.misses, (unsigned long)stats.misses_total,
+                       (unsigned long)stats.worst_late_us, stats.late ? ", LATE" : "");
+    }
+}
+
+/* Time per mode since the last reset, then Stop wake-ups */
+static void console_power(void)
+{
+    power_stats_t stats;
+    uint32_t stops;
+
+    bsp_power_get_stats(&stats);
+    stops = stats.entries[POWER_MODE_STOP];
+    console_printf("run %.3llk ms, sleep %.3llk ms, stop %.3llk ms\r\n",
+                   (long long)stats.residency_us[POWER_MODE_RUN],
+                   (long long)stats.residency_us[POWER_MODE_SLEEP],
+                   (long long)stats.residency_us[POWER_MODE_STOP]);
+    console_printf("stops %lu (timer %lu, uart %lu, gpio %lu, other %lu), vetoed %lu\r\n",
+                   (unsigned long)stops, (unsigned long)stats.wakes[POWER_WAKE_TIMER],
+                   (unsigned long)stats.wakes[POWER_WAKE_UART],
+                   (unsigned long)stats.wakes[POWER_WAKE_GPIO],
+                   (unsigned long)stats.wakes[POWER_WAKE_OTHER], (unsigned long)stats.vetoes);
+    /* Average in tenths of a microsecond */
+    console_printf("wake-up last %lu us, avg %.1llk us, max %lu us\r\n",
+                   (unsigned long)stats.wake_latency_last_us,
+                   (long long)((stops != 0U) ? stats.wake_latency_total_us * 10U / stops : 0U),
+                   (unsigned long)stats.wake_latency_max_us);
+}
+
+static void console_execute(const char *line)
+{
+    if (strcmp(line, "prof") == 0) {
+#ifdef PROFILE_ENABLED
+        profile_dump(console_profile_write, NULL);
+#else
+        console_write("profiling disabled (build with PROFILE=1)\r\n");
+#endif
+    } else if (strcmp(line, "prof reset") == 0) {
+        profile_reset();
+        console_write("ok\r\n");
+    } else if (strcmp(line, "health") == 0) {
+        console_health();
+    } else if (strcmp(line, "power") == 0) {
+        console_power();
+    } else if (strcmp(line, "power reset") == 0) {
+        bsp_power_reset_stats();
+        console_write("ok\r\n");
+    } else if (strcmp(line, "clock perf") == 0) {
+        console_set_clock(CLOCK_PROFILE_PERFORMANCE);
+    } else if (strcmp(line, "clock low") == 0) {
+        console_set_clock(CLOCK_PROFILE_LOW_POWER);
+    } else if (line[0] != '\0') {
+        console_write("unknown command\r\n");
+    }
+}
+
+static void console_task(uint32_t events, void *context)
+{
+    uint8_t buffer[32];
+    uint16_t received = 0;
+
+    (void)events; (void)context;
+
+    while (uart_driver_read(CONSOLE_UART, buffer, sizeof(buffer), &received) == ERR_OK &&
+           received > 0U) {
+        for (uint16_t i = 0; i < received; i++) {
+            char c = (char)buffer[i];
+
+            if (c == '\r' || c == '\n') {
+                console_line[console_line_length] = '\0';
+                console_execute(console_line);
+                console_line_length = 0;
+            } else if (console_line_length < CONSOLE_LINE_MAX - 1U) {
+                console_line[console_line_length++] = c;
+            }
+        }
+    }
+}
+
+/* A burst has ended: let the console task handle it */
+static void console_rx_timeout(uart_id_t uart_id, uart_timeout_t timeout, void *context)
+{
+    (void)uart_id; (void)context;
+    if (timeout == UART_TIMEOUT_RX_IDLE) {
+        (void)sched_post(console_task_id, CONSOLE_EVENT_RX);
+    }
+}
+
+error_t console_init(void)
+{
+    static const sched_task_config_t config = {
+        .name = "console",
+        .run = console_task,
+        .priority = SCHED_PRIORITY_LOW,
+    };
+    error_t err;
+
+    err = uart_driver_open(CONSOLE_UART, CONSOLE_BAUD);
+    if (err != ERR_OK) {
+        return err;
+    }
+    err = sched_add_task(&config, &console_task_id);
+    if (err != ERR_OK) {
+        return err;
+    }
+    /* Typing at a stopped board wakes it; the first character is lost */
+    err = uart_driver_set_rx_wake(CONSOLE_UART, true);
+    if (err != ERR_OK) {
+        return err;
+    }
+    return uart_driver_set_timeouts(CONSOLE_UART, CONSOLE_RX_IDLE_MS, 0U,
+                                    console_rx_timeout, NULL);
+}
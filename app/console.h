@@ -0,0 +1,29 @@
+/*
+ * console.h - Diagnostic Command Console
+ *
+ * Line-oriented commands on CONSOLE_UART. Received lines are handled by
+ * a scheduler task woken by the UART RX idle timeout, so the console
+ * costs nothing while the line is quiet.
+ *
+ * Commands:
+ *   prof         dump the profiling table (PROFILE=1 builds)
+ *   prof reset   clear all probes
+ *   health       liveness checks and watchdog history
+ *   power        time per power mode, Stop wake-ups and latency
+ *   power reset  restart the power statistics
+ *   clock perf   switch to the performance clock profile
+ *   clock low    switch to the low-power clock profile
+ */
+
+#ifndef APP_CONSOLE_H
+#define APP_CONSOLE_H
+
+#include "../common/error.h"
+
+/* Open the console UART and register the console task */
+error_t console_init(void);
+
+/* Queue text for output; waits briefly for room, then drops the rest */
+void console_write(const char *text);
+
+#endif /* APP_CONSOLE_H */
@@ -0,0 +1,171 @@
+/*
+ * bench.c - Host Microbenchmark Runner
+ *
+ * Usage: bench [filter]  runs the cases whose name contains filter.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef HAL_STATIC_BINDING
+#define BENCH_BINDING           "static"
+#else
+#define BENCH_BINDING           "dynamic"
+#endif
+
+#ifdef RELEASE
+#define BENCH_OPTIMIZED         true
+#else
+#define BENCH_OPTIMIZED         false
+#endif
+
+typedef struct {
+    uint32_t batch;
+    uint64_t total_ns;
+    uint64_t total_ops;
+    double p50_ns;
+    double p90_ns;
+    double p99_ns;
+} bench_result_t;
+
+volatile uint32_t bench_sink;
+
+static double bench_samples[BENCH_SAMPLES];
+
+uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int bench_compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of the sorted samples */
+static double bench_percentile(uint32_t percent)
+{
+    uint32_t rank = (percent * BENCH_SAMPLES + 99U) / 100U;
+
+    return bench_samples[(rank > 0U) ? rank - 1U : 0U];
+}
+
+static uint64_t bench_time_batch(const bench_case_t *c, uint32_t batch)
+{
+    uint64_t start = bench_now_ns();
+    uint64_t elapsed;
+
+    c->run(batch);
+    elapsed = bench_now_ns() - start;
+    if (c->between != NULL) {
+        c->between();
+    }
+    return elapsed;
+}
+
+/* Double the batch until it lasts BENCH_BATCH_MIN_NS or hits batch_max */
+static uint32_t bench_calibrate(const bench_case_t *c)
+{
+    uint32_t batch = (c->batch_min != 0U) ? c->batch_min : 1U;
+
+    while (batch < c->batch_max && bench_time_batch(c, batch) < BENCH_BATCH_MIN_NS) {
+        batch = (batch * 2U < c->batch_max) ? batch * 2U : c->batch_max;
+    }
+    return batch;
+}
+
+static void bench_run_case(const bench_case_t *c, bench_result_t *result)
+{
+    /* The first batch starts from the same state as the others */
+    if (c->between != NULL) {
+        c->between();
+    }
+    result->batch = bench_calibrate(c);
+    for (uint32_t i = 0; i < BENCH_WARMUP_SAMPLES; i++) {
+        (void)bench_time_batch(c, result->batch);
+    }
+
+    result->total_ns = 0;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        uint64_t ns = bench_time_batch(c, result->batch);
+
+        result->total_ns += ns;
+        bench_samples[i] = (double)ns / (double)result->batch;
+    }
+    result->total_ops = (uint64_t)BENCH_SAMPLES * result->batch;
+
+    qsort(bench_samples, BENCH_SAMPLES, sizeof(bench_samples[0]), bench_compare_double);
+    result->p50_ns = bench_percentile(50U);
+    result->p90_ns = bench_percentile(90U);
+    result->p99_ns = bench_percentile(99U);
+}
+
+static void bench_print_result(const bench_case_t *c, const bench_result_t *result, bool last)
+{
+    double ns_per_op = (double)result->total_ns / (double)result->total_ops;
+    double ops_per_sec = (ns_per_op > 0.0) ? 1e9 / ns_per_op : 0.0;
+
+    printf("    {\"name\": \"%s\", \"ns_per_op\": %.1f, \"ops_per_sec\": %.0f", c->name,
+           ns_per_op, ops_per_sec);
+    if (c->bytes_per_op != 0U) {
+        printf(", \"bytes_per_sec\": %.0f", ops_per_sec * (double)c->bytes_per_op);
+    }
+    if (c->tolerance_pct != 0U) {
+        printf(", \"tolerance\": %.2f", (double)c->tolerance_pct / 100.0);
+    }
+    printf(", \"p50_ns\": %.1f, \"p90_ns\": %.1f, \"p99_ns\": %.1f, \"batch\": %u, \"samples\": %u}%s\n",
+           result->p50_ns, result->p90_ns, result->p99_ns, result->batch, BENCH_SAMPLES,
+           last ? "" : ",");
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = (argc > 1) ? argv[1] : NULL;
+    const bench_case_t *cases;
+    uint32_t count;
+    uint32_t selected = 0;
+    uint32_t printed = 0;
+    bench_result_t result;
+
+    if (!bench_cases_init()) {
+        fprintf(stderr, "bench: firmware initialization failed\n");
+        return EXIT_FAILURE;
+    }
+    cases = bench_cases_get(&count);
+    for (uint32_t i = 0; i < count; i++) {
+        if (filter == NULL || strstr(cases[i].name, filter) != NULL) {
+            selected++;
+        }
+    }
+
+    printf("{\n  \"config\": {\"binding\": \"%s\", \"optimized\": %s},\n",
+           BENCH_BINDING, BENCH_OPTIMIZED ? "true" : "false");
+    if (filter != NULL) {
+        printf("  \"filter\": \"%s\",\n", filter);
+    }
+    printf("  \"benchmarks\": [\n");
+    for (uint32_t i = 0; i < count; i++) {
+        if (filter != NULL && strstr(cases[i].name, filter) == NULL) {
+            continue;
+        }
+        fprintf(stderr, "bench: %s\n", cases[i].name);
+        bench_run_case(&cases[i], &result);
+        printed++;
+        bench_print_result(&cases[i], &result, printed == selected);
+        fflush(stdout);
+    }
+    printf("  ]\n}\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,64 @@
+/*
+ * bench.h - Host Microbenchmark Runner
+ *
+ * Each case times batches of `batch` operations, taking BENCH_SAMPLES
+ * batches after a warm-up. A batch is sized (batch_min to batch_max) so
+ * it lasts at least BENCH_BATCH_MIN_NS, keeping the clock read out of the
+ * result for fast operations; slow ones run one operation per batch,
+ * so their percentiles are per operation.
+ *
+ * Results go to stdout as one JSON document: ns/op (mean), ops/s,
+ * bytes/s where an operation moves data, and p50/p90/p99 of the
+ * per-operation time over the batches, and each case's tolerance.
+ * tools/bench_compare.py checks them against a baseline recorded on the
+ * same machine.
+ *
+ * Host build (BOARD=host) only: cases use the POSIX harness hooks.
+ */
+
+#ifndef BENCH_BENCH_H
+#define BENCH_BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef BENCH_SAMPLES
+#define BENCH_SAMPLES           2000U
+#endif
+
+#define BENCH_WARMUP_SAMPLES    100U
+#define BENCH_BATCH_MIN_NS      20000U
+
+typedef struct {
+    const char *name;
+    void (*run)(uint32_t ops);          /* Timed: ops operations */
+    void (*between)(void);              /* Untimed, before the first batch and after
+                                           each one (may be NULL) */
+    uint32_t bytes_per_op;              /* 0: no byte throughput */
+    uint32_t batch_max;                 /* Largest batch, 1 = per operation */
+    uint32_t batch_min;                 /* Smallest batch, 0 = 1 */
+    uint32_t tolerance_pct;             /* Slowdown of the p50 that make bench
+                                           accepts, 0 = the baseline's default */
+} bench_case_t;
+
+/* Set up the firmware and the simulated peers; false on failure */
+bool bench_cases_init(void);
+
+/* The cases, in run order */
+const bench_case_t *bench_cases_get(uint32_t *count);
+
+/* Monotonic nanoseconds */
+uint64_t bench_now_ns(void);
+
+/* Results the compiler must not drop */
+extern volatile uint32_t bench_sink;
+
+/* Make pending stores happen here: the host's GPIO registers are plain
+ * memory, so without this the compiler merges the stores of a loop that
+ * real MMIO would perform one by one */
+static inline void bench_clobber(void)
+{
+    __asm__ __volatile__("" ::: "memory");
+}
+
+#endif /* BENCH_BENCH_H */
@@ -0,0 +1,637 @@
+/*
+ * bench_cases.c - Host Microbenchmark Cases
+ *
+ * The firmware is brought up with app_init(), so every case runs
+ * against the real driver, HAL and event wiring. The UART peers are
+ * served by one thread: the application's ports are drained (so the
+ * binlog and console never back up), and the benchmark port either
+ * drains or echoes, per case.
+ *
+ * The UART write and read cases time the driver call alone, one per
+ * batch: between batches, untimed, the TX ring is left to drain or the
+ * RX ring is filled from the peer, so a timed call never waits on the
+ * simulated wire.
+ *
+ * Cases that publish events (edge interrupts, error_log()) dispatch
+ * between batches, outside the timing, and keep batches below the event
+ * queue size so nothing is dropped.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include "../app/app.h"
+#include "../bsp/board_config.h"
+#include "../bsp/bsp_time.h"
+#include "../common/cobs.h"
+#include "../common/crc.h"
+#include "../common/error.h"
+#include "../common/event_bus.h"
+#include "../common/mem_pool.h"
+#include "../common/sw_timer.h"
+#include "../drivers/gpio_driver.h"
+#include "../drivers/packet.h"
+#include "../drivers/uart_driver.h"
+#include "../hal/hal_gpio.h"
+#include "../hal/hal_uart_posix.h"
+
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define BENCH_UART              UART_3
+#define BENCH_UART_CHUNK        64U
+#define BENCH_EVENT_BATCH       16U         /* Below EVENT_QUEUE_SIZE */
+#define BENCH_PEER_POLL_MS      1
+
+#define BENCH_OUT_PIN           GPIO_PIN(GPIO_PORT_E, 2)
+#define BENCH_EDGE_PIN          GPIO_PIN(GPIO_PORT_E, 3)
+#define BENCH_PORT              GPIO_PORT_E
+#define BENCH_BUS_PORT          GPIO_PORT_F /* All 16 pins driven as one bus */
+#define BENCH_BUS_PINS          16U
+
+#define BENCH_TIMERS            10000U
+#define BENCH_TIMER_MAX_DELAY   3600000U    /* 1 h in ms ticks */
+
+#define BENCH_CRC_LONG          4096U
+#define BENCH_FRAME_PAYLOAD     PACKET_MAX_PAYLOAD
+
+#define BENCH_MEM_SIZE          100U        /* Class 1 (128-byte blocks) */
+#define BENCH_MEM_BURST         16U
+
+typedef enum {
+    BENCH_PEER_DRAIN = 0,
+    BENCH_PEER_ECHO
+} bench_peer_mode_t;
+
+static _Atomic bench_peer_mode_t peer_mode;
+static uint8_t uart_chunk[BENCH_UART_CHUNK];
+static bool edge_level;
+static sw_timer_t timers[BENCH_TIMERS];
+static uint32_t timer_delays[BENCH_TIMERS];
+static uint8_t crc_data[BENCH_CRC_LONG];
+static uint8_t frame_payload[BENCH_FRAME_PAYLOAD];
+static uint8_t frame_encoded[PACKET_FRAME_MAX];
+static uint32_t frame_encoded_length;
+static uint8_t cobs_encoded[COBS_ENCODED_MAX(BENCH_FRAME_PAYLOAD) + 1U];
+static uint32_t cobs_encoded_length;
+static uint8_t cobs_decoded[BENCH_FRAME_PAYLOAD];
+static packet_decoder_t frame_decoder;
+
+/* ===== Simulated Peers ===== */
+
+static void *bench_peer_thread(void *arg)
+{
+    static const uart_id_t drained[] = { BINLOG_UART, CONSOLE_UART };
+    struct pollfd fds[3];
+    uint8_t buffer[512];
+
+    (void)arg;
+    for (uint32_t i = 0; i < 2U; i++) {
+        fds[i].fd = posix_uart_get_peer_fd(drained[i]);
+        fds[i].events = POLLIN;
+    }
+    fds[2].fd = posix_uart_get_peer_fd(BENCH_UART);
+    fds[2].events = POLLIN;
+
+    for (;;) {
+        if (poll(fds, 3, BENCH_PEER_POLL_MS) <= 0) {
+            continue;
+        }
+        for (uint32_t i = 0; i < 2U; i++) {
+            if ((fds[i].revents & POLLIN) != 0) {
+                (void)read(fds[i].fd, buffer, sizeof(buffer));
+            }
+        }
+        if ((fds[2].revents & POLLIN) != 0) {
+            ssize_t n = read(fds[2].fd, buffer, sizeof(buffer));
+
+            /* Data read after a mode change is served in the new mode */
+            if (n > 0 && atomic_load(&peer_mode) == BENCH_PEER_ECHO) {
+                (void)write(fds[2].fd, buffer, (size_t)n);
+            }
+        }
+    }
+    return NULL;
+}
+
+/* ===== GPIO ===== */
+
+static void bench_gpio_write(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        gpio_write(BENCH_OUT_PIN, (i & 1U) != 0U);
+    }
+}
+
+static void bench_gpio_read(uint32_t ops)
+{
+    uint32_t high = 0;
+
+    for (uint32_t i = 0; i < ops; i++) {
+        high += gpio_read(BENCH_EDGE_PIN) ? 1U : 0U;
+    }
+    bench_sink = high;
+}
+
+static void bench_gpio_toggle(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        gpio_toggle(BENCH_OUT_PIN);
+    }
+}
+
+static void bench_gpio_driver_toggle(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        (void)gpio_driver_toggle(BENCH_OUT_PIN);
+    }
+}
+
+static void bench_gpio_driver_read(uint32_t ops)
+{
+    uint32_t high = 0;
+    bool value = false;
+
+    for (uint32_t i = 0; i < ops; i++) {
+        (void)gpio_driver_read(BENCH_EDGE_PIN, &value);
+        high += value ? 1U : 0U;
+    }
+    bench_sink = high;
+}
+
+static void bench_gpio_driver_port_write(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        (void)gpio_driver_port_write_masked(BENCH_PORT, 0x00F0U, (uint16_t)(i << 4));
+    }
+}
+
+/* The same 16-bit bus update, pin by pin and as one port write; both
+ * cases write the same value sequence, each register write kept */
+static void bench_gpio_bus_per_pin(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        uint16_t value = (uint16_t)(i * 0x9E37U);
+
+        for (uint8_t n = 0; n < BENCH_BUS_PINS; n++) {
+            if ((value & (1U << n)) != 0U) {
+                (void)gpio_driver_set(GPIO_PIN(BENCH_BUS_PORT, n));
+            } else {
+                (void)gpio_driver_clear(GPIO_PIN(BENCH_BUS_PORT, n));
+            }
+            bench_clobber();
+        }
+    }
+}
+
+static void bench_gpio_bus_port_write(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        (void)gpio_driver_port_write_masked(BENCH_BUS_PORT, 0xFFFFU, (uint16_t)(i * 0x9E37U));
+        bench_clobber();
+    }
+}
+
+/* Edge interrupt entry to event published (debounce off) */
+static void bench_gpio_edge_isr(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        edge_level = !edge_level;
+        gpio_hal_edge_isr(BENCH_EDGE_PIN, edge_level, bsp_time_us());
+    }
+}
+
+static void bench_dispatch_events(void)
+{
+    while (event_bus_dispatch() != 0U) {
+    }
+}
+
+/* ===== UART ===== */
+
+static void bench_uart_write_all(void)
+{
+    uint16_t done = 0;
+
+    while (done < BENCH_UART_CHUNK) {
+        uint16_t written = 0;
+
+        (void)uart_driver_write(BENCH_UART, &uart_chunk[done], (uint16_t)(BENCH_UART_CHUNK - done),
+                                &written);
+        done = (uint16_t)(done + written);
+    }
+}
+
+static void bench_uart_read_all(void)
+{
+    uint8_t buffer[BENCH_UART_CHUNK];
+    uint16_t done = 0;
+
+    while (done < BENCH_UART_CHUNK) {
+        uint16_t received = 0;
+
+        (void)uart_driver_read(BENCH_UART, &buffer[done], (uint16_t)(BENCH_UART_CHUNK - done),
+                               &received);
+        done = (uint16_t)(done + received);
+    }
+    bench_sink = buffer[0];
+}
+
+/* Untimed: wait until the TX ring has room for a whole chunk */
+static void bench_uart_drain(void)
+{
+    atomic_store(&peer_mode, BENCH_PEER_DRAIN);
+    while (uart_driver_tx_free(BENCH_UART) < BENCH_UART_CHUNK) {
+        sched_yield();
+    }
+}
+
+/* Untimed: the peer sends what the RX ring lacks of one chunk */
+static void bench_uart_fill(void)
+{
+    uint16_t available = uart_driver_rx_available(BENCH_UART);
+
+    atomic_store(&peer_mode, BENCH_PEER_DRAIN);
+    if (available < BENCH_UART_CHUNK) {
+        (void)write(posix_uart_get_peer_fd(BENCH_UART), uart_chunk,
+                    (size_t)(BENCH_UART_CHUNK - available));
+    }
+    while (uart_driver_rx_available(BENCH_UART) < BENCH_UART_CHUNK) {
+        sched_yield();
+    }
+}
+
+/* One chunk into the empty TX ring */
+static void bench_uart_write(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        bench_uart_write_all();
+    }
+}
+
+/* A diagnostic line, 64 characters, formatted into the empty TX ring */
+static void bench_uart_printf(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        (void)uart_driver_printf(BENCH_UART, UINT32_MAX, "%-16s %10lu %10lu %12.3lk %10lu\r\n",
+                                 "uart_driver_read", (unsigned long)i, 123456UL, -4567890L,
+                                 (unsigned long)(i * 3U));
+    }
+}
+
+static void bench_uart_echo(uint32_t ops)
+{
+    atomic_store(&peer_mode, BENCH_PEER_ECHO);
+    for (uint32_t i = 0; i < ops; i++) {
+        bench_uart_write_all();
+        bench_uart_read_all();
+    }
+}
+
+/* One chunk out of the full RX ring */
+static void bench_uart_read(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        bench_uart_read_all();
+    }
+}
+
+/* ===== Error Log ===== */
+
+static void bench_error_log(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        error_log(ERR_TIMEOUT, SEVERITY_INFO, i);
+    }
+}
+
+static void bench_error_get_last(uint32_t ops)
+{
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < ops; i++) {
+        error_t last = error_get_last();
+
+        sum += (uint32_t)last;
+    }
+    bench_sink = sum;
+}
+
+/* ===== Software Timers ===== */
+
+/* Every batch covers all BENCH_TIMERS timers, with the app's own timers
+ * armed in the same wheel. The stop case leaves them armed for the
+ * start case, which leaves them stopped again. */
+
+static void bench_timer_callback(sw_timer_t *timer, void *context)
+{
+    (void)timer; (void)context;
+}
+
+static void bench_timer_arm_all(void)
+{
+    for (uint32_t i = 0; i < BENCH_TIMERS; i++) {
+        (void)sw_timer_start(&timers[i], timer_delays[i], 0U);
+    }
+}
+
+static void bench_timer_stop_all(void)
+{
+    for (uint32_t i = 0; i < BENCH_TIMERS; i++) {
+        (void)sw_timer_stop(&timers[i]);
+    }
+}
+
+static void bench_timer_start(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        (void)sw_timer_start(&timers[i], timer_delays[i], 0U);
+    }
+}
+
+static void bench_timer_stop(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        (void)sw_timer_stop(&timers[i]);
+    }
+}
+
+/* ===== Framing ===== */
+
+/* CRC kernels per buffer length (bytes/s over the clock rate gives
+ * bytes per cycle), and whole frames of a full-size payload that has a
+ * zero every few bytes, as sensor data does: COBS alone, and the packet
+ * layer (COBS plus CRC-32) in each direction. */
+
+static void bench_crc16_64(uint32_t ops)
+{
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < ops; i++) {
+        sum += crc16_update(0, crc_data, 64U);
+    }
+    bench_sink = sum;
+}
+
+static void bench_crc16_4k(uint32_t ops)
+{
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < ops; i++) {
+        sum += crc16_update(0, crc_data, BENCH_CRC_LONG);
+    }
+    bench_sink = sum;
+}
+
+static void bench_crc32_64(uint32_t ops)
+{
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < ops; i++) {
+        sum += crc32_update(0, crc_data, 64U);
+    }
+    bench_sink = sum;
+}
+
+static void bench_crc32_4k(uint32_t ops)
+{
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < ops; i++) {
+        sum += crc32_update(0, crc_data, BENCH_CRC_LONG);
+    }
+    bench_sink = sum;
+}
+
+static void bench_cobs_encode(uint32_t ops)
+{
+    uint8_t out[sizeof(cobs_encoded)];
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < ops; i++) {
+        cobs_encoder_t enc;
+
+        cobs_encode_begin(&enc, out, sizeof(out));
+        cobs_encode_update(&enc, frame_payload, BENCH_FRAME_PAYLOAD);
+        sum += cobs_encode_end(&enc);
+    }
+    bench_sink = sum;
+}
+
+static void bench_cobs_decode(uint32_t ops)
+{
+    cobs_decoder_t dec;
+    uint32_t sum = 0;
+
+    cobs_decoder_init(&dec, cobs_decoded, sizeof(cobs_decoded));
+    for (uint32_t i = 0; i < ops; i++) {
+        bool complete;
+        cobs_frame_status_t status;
+
+        (void)cobs_decoder_feed(&dec, cobs_encoded, cobs_encoded_length, &complete, &status);
+        sum += dec.length;
+    }
+    bench_sink = sum;
+}
+
+static void bench_packet_encode(uint32_t ops)
+{
+    uint8_t out[PACKET_FRAME_MAX];
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < ops; i++) {
+        sum += packet_encode(PACKET_CRC32, frame_payload, BENCH_FRAME_PAYLOAD, out,
+                             sizeof(out));
+    }
+    bench_sink = sum;
+}
+
+static void bench_frame_received(const uint8_t *payload, uint16_t length, void *context)
+{
+    (void)context;
+    bench_sink = (uint32_t)payload[0] + length;
+}
+
+static void bench_packet_decode(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        packet_decoder_feed(&frame_decoder, frame_encoded, frame_encoded_length);
+    }
+}
+
+/* Inputs, and the encoded frames the decode cases replay */
+static bool bench_frames_init(void)
+{
+    cobs_encoder_t enc;
+
+    for (uint32_t i = 0, seed = 7U; i < BENCH_CRC_LONG; i++) {
+        seed = seed * 1103515245U + 12345U;
+        crc_data[i] = (uint8_t)(seed >> 16);
+    }
+    for (uint32_t i = 0; i < BENCH_FRAME_PAYLOAD; i++) {
+        frame_payload[i] = ((i % 5U) == 0U) ? 0U : (uint8_t)(crc_data[i] | 1U);
+    }
+
+    cobs_encode_begin(&enc, cobs_encoded, sizeof(cobs_encoded));
+    cobs_encode_update(&enc, frame_payload, BENCH_FRAME_PAYLOAD);
+    cobs_encoded_length = cobs_encode_end(&enc);
+
+    frame_encoded_length = packet_encode(PACKET_CRC32, frame_payload, BENCH_FRAME_PAYLOAD,
+                                         frame_encoded, sizeof(frame_encoded));
+    return cobs_encoded_length != 0U && frame_encoded_length != 0U &&
+           packet_decoder_init(&frame_decoder, PACKET_CRC32, bench_frame_received,
+                               NULL) == ERR_OK;
+}
+
+/* ===== Memory ===== */
+
+/* The size classes against the C library heap, for one block and for a
+ * burst of mixed sizes released in a different order than taken. The
+ * pointers go to bench_sink so the compiler cannot pair the malloc()
+ * with its free() and drop both. */
+
+static const uint32_t mem_burst_sizes[BENCH_MEM_BURST] = {
+    24U, 100U, 400U, 8U, 128U, 32U, 60U, 512U, 16U, 90U, 300U, 32U, 120U, 4U, 200U, 64U
+};
+
+static void bench_mem_alloc_free(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        void *block = mem_alloc(BENCH_MEM_SIZE);
+
+        bench_sink = (uint32_t)(uintptr_t)block;
+        (void)mem_free(block);
+    }
+}
+
+static void bench_malloc_free(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        void *block = malloc(BENCH_MEM_SIZE);
+
+        bench_sink = (uint32_t)(uintptr_t)block;
+        free(block);
+    }
+}
+
+static void bench_mem_burst(uint32_t ops)
+{
+    void *blocks[BENCH_MEM_BURST];
+
+    for (uint32_t i = 0; i < ops; i++) {
+        for (uint32_t j = 0; j < BENCH_MEM_BURST; j++) {
+            blocks[j] = mem_alloc(mem_burst_sizes[j]);
+            bench_sink = (uint32_t)(uintptr_t)blocks[j];
+        }
+        for (uint32_t j = 0; j < BENCH_MEM_BURST; j++) {
+            (void)mem_free(blocks[(j * 7U) % BENCH_MEM_BURST]);
+        }
+    }
+}
+
+static void bench_malloc_burst(uint32_t ops)
+{
+    void *blocks[BENCH_MEM_BURST];
+
+    for (uint32_t i = 0; i < ops; i++) {
+        for (uint32_t j = 0; j < BENCH_MEM_BURST; j++) {
+            blocks[j] = malloc(mem_burst_sizes[j]);
+            bench_sink = (uint32_t)(uintptr_t)blocks[j];
+        }
+        for (uint32_t j = 0; j < BENCH_MEM_BURST; j++) {
+            free(blocks[(j * 7U) % BENCH_MEM_BURST]);
+        }
+    }
+}
+
+/* ===== Application ===== */
+
+static void bench_app_run(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        (void)app_run();
+    }
+}
+
+static const bench_case_t bench_cases[] = {
+    { "gpio_write", bench_gpio_write, NULL, 0, 1U << 16, 1U, 0U },
+    { "gpio_read", bench_gpio_read, NULL, 0, 1U << 16, 1U, 0U },
+    { "gpio_toggle", bench_gpio_toggle, NULL, 0, 1U << 16, 1U, 0U },
+    { "gpio_driver_toggle", bench_gpio_driver_toggle, NULL, 0, 1U << 16, 1U, 0U },
+    { "gpio_driver_read", bench_gpio_driver_read, NULL, 0, 1U << 16, 1U, 0U },
+    { "gpio_driver_port_write_masked", bench_gpio_driver_port_write, NULL, 0, 1U << 16, 1U, 0U },
+    { "gpio_bus16_per_pin", bench_gpio_bus_per_pin, NULL, 0, 1U << 12, 1U, 0U },
+    { "gpio_bus16_port_write", bench_gpio_bus_port_write, NULL, 0, 1U << 16, 1U, 0U },
+    { "gpio_edge_isr", bench_gpio_edge_isr, bench_dispatch_events, 0, BENCH_EVENT_BATCH, 1U, 50U },
+    { "uart_driver_write_64", bench_uart_write, bench_uart_drain, BENCH_UART_CHUNK, 1U, 1U, 50U },
+    { "uart_driver_printf_64", bench_uart_printf, bench_uart_drain, BENCH_UART_CHUNK, 1U, 1U, 50U },
+    { "uart_driver_echo_64", bench_uart_echo, NULL, BENCH_UART_CHUNK, 1U, 1U, 50U },
+    { "uart_driver_read_64", bench_uart_read, bench_uart_fill, BENCH_UART_CHUNK, 1U, 1U, 50U },
+    { "error_log", bench_error_log, bench_dispatch_events, 0, BENCH_EVENT_BATCH, 1U, 0U },
+    { "error_get_last", bench_error_get_last, NULL, 0, 1U << 16, 1U, 0U },
+    { "sw_timer_stop_10k", bench_timer_stop, bench_timer_arm_all, 0, BENCH_TIMERS, BENCH_TIMERS, 0U },
+    { "sw_timer_start_10k", bench_timer_start, bench_timer_stop_all, 0, BENCH_TIMERS, BENCH_TIMERS, 0U },
+    { "crc16_64", bench_crc16_64, NULL, 64U, 1U << 16, 1U, 0U },
+    { "crc16_4k", bench_crc16_4k, NULL, BENCH_CRC_LONG, 1U << 10, 1U, 0U },
+    { "crc32_64", bench_crc32_64, NULL, 64U, 1U << 16, 1U, 0U },
+    { "crc32_4k", bench_crc32_4k, NULL, BENCH_CRC_LONG, 1U << 10, 1U, 0U },
+    { "cobs_encode_256", bench_cobs_encode, NULL, BENCH_FRAME_PAYLOAD, 1U << 12, 1U, 0U },
+    { "cobs_decode_256", bench_cobs_decode, NULL, BENCH_FRAME_PAYLOAD, 1U << 12, 1U, 0U },
+    { "packet_encode_256", bench_packet_encode, NULL, BENCH_FRAME_PAYLOAD, 1U << 12, 1U, 0U },
+    { "packet_decode_256", bench_packet_decode, NULL, BENCH_FRAME_PAYLOAD, 1U << 12, 1U, 0U },
+    { "mem_alloc_free", bench_mem_alloc_free, NULL, 0, 1U << 16, 1U, 0U },
+    { "malloc_free", bench_malloc_free, NULL, 0, 1U << 16, 1U, 0U },
+    { "mem_alloc_burst_16", bench_mem_burst, NULL, 0, 1U << 12, 1U, 0U },
+    { "malloc_burst_16", bench_malloc_burst, NULL, 0, 1U << 12, 1U, 0U },
+    { "app_run", bench_app_run, NULL, 0, 1U, 1U, 50U },
+};
+
+bool bench_cases_init(void)
+{
+    pthread_t peer;
+
+    if (app_init() != ERR_OK || app_start() != ERR_OK) {
+        return false;
+    }
+    if (uart_driver_open(BENCH_UART, UART_BAUD_115200) != ERR_OK) {
+        return false;
+    }
+    for (uint32_t i = 0; i < BENCH_UART_CHUNK; i++) {
+        uart_chunk[i] = (uint8_t)i;
+    }
+
+    (void)gpio_driver_configure(BENCH_OUT_PIN, GPIO_MODE_OUTPUT);
+    (void)gpio_driver_configure(BENCH_EDGE_PIN, GPIO_MODE_INPUT);
+    for (uint8_t n = 0; n < BENCH_BUS_PINS; n++) {
+        (void)gpio_driver_configure(GPIO_PIN(BENCH_BUS_PORT, n), GPIO_MODE_OUTPUT);
+    }
+    if (gpio_driver_enable_edge(BENCH_EDGE_PIN, GPIO_EDGE_BOTH, 0U, NULL, NULL) != ERR_OK) {
+        return false;
+    }
+
+    /* Random delays up to an hour, reaching every wheel */
+    for (uint32_t i = 0, seed = 1U; i < BENCH_TIMERS; i++) {
+        seed = seed * 1103515245U + 12345U;
+        timer_delays[i] = 1U + (seed >> 8) % BENCH_TIMER_MAX_DELAY;
+        (void)sw_timer_setup(&timers[i], bench_timer_callback, NULL);
+    }
+
+    if (!bench_frames_init()) {
+        return false;
+    }
+
+    atomic_init(&peer_mode, BENCH_PEER_DRAIN);
+    return pthread_create(&peer, NULL, bench_peer_thread, NULL) == 0 &&
+           pthread_detach(peer) == 0;
+}
+
+const bench_case_t *bench_cases_get(uint32_t *count)
+{
+    *count = (uint32_t)(sizeof(bench_cases) / sizeof(bench_cases[0]));
+    return bench_cases;
+}
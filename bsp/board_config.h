@@ -14,25 +14,91 @@
 #define BOARD_STM32F412ZET6
 
 /* ===== CLOCK CONFIGURATION ===== */
+/* Performance profile (boot default): HSI -> PLL */
 #define SYSTEM_CLOCK_HZ         100000000UL  /* 100 MHz */
 #define AHB_CLOCK_HZ            100000000UL
 #define APB1_CLOCK_HZ           50000000UL   /* APB1 = AHB/2 */
 #define APB2_CLOCK_HZ           100000000UL  /* APB2 = AHB */
 
+/* Low-power profile: HSI direct, PLL off */
+#define LP_SYSTEM_CLOCK_HZ      16000000UL   /* 16 MHz */
+#define LP_AHB_CLOCK_HZ         16000000UL
+#define LP_APB1_CLOCK_HZ        16000000UL
+#define LP_APB2_CLOCK_HZ        16000000UL
+
+/* ===== TIME BASE ===== */
+#define BSP_TICK_HZ             1000U        /* System tick, must divide 1 MHz */
+
 /* ===== LED PIN MAPPING ===== */
-#define LED_PORT                GPIOB
+#define LED_PORT                GPIO_PORT_B
 #define LED_PIN                 0
 
 /* ===== UART PINS ===== */
-#define UART1_TX_PORT           GPIOA
+/* uart_id_t -> peripheral, pins and alternate function (LQFP144).
+ * UART_4/UART_5 map to UART4/UART5, which exist on the pin-compatible
+ * STM32F413/F423 only; the F412 has USART1/2/3/6. Ports are the
+ * GPIO_PORT_x indices of hal_gpio.h. */
+#define UART1_TX_PORT           GPIO_PORT_A /* USART1 */
 #define UART1_TX_PIN            9
-#define UART1_RX_PORT           GPIOA
+#define UART1_RX_PORT           GPIO_PORT_A
 #define UART1_RX_PIN            10
+#define UART1_AF                7
 
-#define UART2_TX_PORT           GPIOA
+#define UART2_TX_PORT           GPIO_PORT_A /* USART2 */
 #define UART2_TX_PIN            2
-#define UART2_RX_PORT           GPIOA
+#define UART2_RX_PORT           GPIO_PORT_A
 #define UART2_RX_PIN            3
+#define UART2_AF                7
+
+#define UART3_TX_PORT           GPIO_PORT_D /* USART3 */
+#define UART3_TX_PIN            8
+#define UART3_RX_PORT           GPIO_PORT_D
+#define UART3_RX_PIN            9
+#define UART3_AF                7
+
+#define UART4_TX_PORT           GPIO_PORT_A /* UART4 (F413/F423) */
+#define UART4_TX_PIN            0
+#define UART4_RX_PORT           GPIO_PORT_A
+#define UART4_RX_PIN            1
+#define UART4_AF                8
+
+#define UART5_TX_PORT           GPIO_PORT_C /* UART5 (F413/F423) */
+#define UART5_TX_PIN            12
+#define UART5_RX_PORT           GPIO_PORT_D
+#define UART5_RX_PIN            2
+#define UART5_AF                8
+
+#define UART6_TX_PORT           GPIO_PORT_C /* USART6 */
+#define UART6_TX_PIN            6
+#define UART6_RX_PORT           GPIO_PORT_C
+#define UART6_RX_PIN            7
+#define UART6_AF                8
+
+/* ===== DIAGNOSTIC CONSOLE ===== */
+#define CONSOLE_UART            UART_2
+#define CONSOLE_BAUD            115200U
+
+/* ===== BINARY LOG OUTPUT ===== */
+#define BINLOG_UART             UART_1
+#define BINLOG_BAUD             460800U      /* Also reachable at LP clocks */
+
+/* ===== UART DRIVER BUFFERS ===== */
+/* Per-port TX/RX ring sizes in bytes (power of two) */
+#define UART1_TX_BUFFER_SIZE    256
+#define UART1_RX_BUFFER_SIZE    256
+#define UART2_TX_BUFFER_SIZE    256
+#define UART2_RX_BUFFER_SIZE    256
+#define UART3_TX_BUFFER_SIZE    64
+#define UART3_RX_BUFFER_SIZE    64
+#define UART4_TX_BUFFER_SIZE    64
+#define UART4_RX_BUFFER_SIZE    64
+#define UART5_TX_BUFFER_SIZE    64
+#define UART5_RX_BUFFER_SIZE    64
+#define UART6_TX_BUFFER_SIZE    64
+#define UART6_RX_BUFFER_SIZE    64
+
+/* Per-port depth of the writev DMA descriptor queue (power of two) */
+#define UART_DMA_QUEUE_DEPTH    8
 
 /* ===== MCU SPECIFIC ===== */
 #define MCU_STM32F412ZET6
@@ -1,57 +1,291 @@
 /*
  * bsp_clock.c - Clock Configuration Implementation
- * 
- * NOTE: This is a stub implementation. In production, replace with actual
- * clock configuration code for your specific MCU (PLL setup, etc.)
+ *
+ * STM32F412: both profiles start from the 16 MHz HSI. Performance runs
+ * the PLL (HSI / 8 * 100 / 2 = 100 MHz, APB1 / 2), low-power runs the
+ * HSI directly with the PLL stopped. Flash wait states are raised before
+ * speeding up and lowered after slowing down.
+ *
+ * BOARD=host builds (BOARD_HOST) keep the bookkeeping (frequencies,
+ * callbacks, timing) and skip the register accesses.
  */
 
 #include "bsp_clock.h"
+#include "bsp_time.h"
 #include "board_config.h"
 
-static const clock_config_t default_clock_config = {
-    .system_clock_hz = SYSTEM_CLOCK_HZ,
-    .ahb_clock_hz = AHB_CLOCK_HZ,
-    .apb1_clock_hz = APB1_CLOCK_HZ,
-    .apb2_clock_hz = APB2_CLOCK_HZ
+/* ===== STM32F4 RCC / Flash Registers ===== */
+#define RCC_CR                  (*(volatile uint32_t *)0x40023800UL)
+#define RCC_PLLCFGR             (*(volatile uint32_t *)0x40023804UL)
+#define RCC_CFGR                (*(volatile uint32_t *)0x40023808UL)
+#define FLASH_ACR               (*(volatile uint32_t *)0x40023C00UL)
+
+#define RCC_CR_HSION            (1UL << 0)
+#define RCC_CR_HSIRDY           (1UL << 1)
+#define RCC_CR_PLLON            (1UL << 24)
+#define RCC_CR_PLLRDY           (1UL << 25)
+#define RCC_PLLCFGR_M(m)        ((uint32_t)(m) << 0)
+#define RCC_PLLCFGR_N(n)        ((uint32_t)(n) << 6)
+#define RCC_PLLCFGR_P_DIV2      (0UL << 16)
+#define RCC_PLLCFGR_SRC_HSI     (0UL << 22)
+#define RCC_PLLCFGR_Q(q)        ((uint32_t)(q) << 24)
+#define RCC_CFGR_SW_MASK        (3UL << 0)
+#define RCC_CFGR_SW_HSI         (0UL << 0)
+#define RCC_CFGR_SW_PLL         (2UL << 0)
+#define RCC_CFGR_SWS_MASK       (3UL << 2)
+#define RCC_CFGR_PRE_MASK       ((0xFUL << 4) | (7UL << 10) | (7UL << 13))
+#define RCC_CFGR_PPRE1_DIV2     (4UL << 10)
+#define FLASH_ACR_LATENCY_MASK  0xFUL
+#define FLASH_ACR_CACHES        ((1UL << 8) | (1UL << 9) | (1UL << 10))
+
+#define BSP_CLOCK_READY_SPINS   100000UL
+
+typedef struct {
+    clock_config_t clocks;
+    bool use_pll;
+    uint32_t pllcfgr;
+    uint32_t prescalers;        /* RCC_CFGR HPRE/PPRE1/PPRE2 */
+    uint32_t flash_latency;     /* Wait states at 2.7-3.6 V */
+} clock_profile_desc_t;
+
+static const clock_profile_desc_t clock_profiles[CLOCK_PROFILE_COUNT] = {
+    [CLOCK_PROFILE_PERFORMANCE] = {
+        .clocks = {
+            .system_clock_hz = SYSTEM_CLOCK_HZ,
+            .ahb_clock_hz = AHB_CLOCK_HZ,
+            .apb1_clock_hz = APB1_CLOCK_HZ,
+            .apb2_clock_hz = APB2_CLOCK_HZ
+        },
+        .use_pll = true,
+        .pllcfgr = RCC_PLLCFGR_M(8) | RCC_PLLCFGR_N(100) | RCC_PLLCFGR_P_DIV2 |
+                   RCC_PLLCFGR_SRC_HSI | RCC_PLLCFGR_Q(4),
+        .prescalers = RCC_CFGR_PPRE1_DIV2,
+        .flash_latency = 3
+    },
+    [CLOCK_PROFILE_LOW_POWER] = {
+        .clocks = {
+            .system_clock_hz = LP_SYSTEM_CLOCK_HZ,
+            .ahb_clock_hz = LP_AHB_CLOCK_HZ,
+            .apb1_clock_hz = LP_APB1_CLOCK_HZ,
+            .apb2_clock_hz = LP_APB2_CLOCK_HZ
+        },
+        .use_pll = false,
+        .pllcfgr = 0,
+        .prescalers = 0,
+        .flash_latency = 0
+    }
 };
 
-error_t bsp_clock_init(void)
+typedef struct {
+    clock_change_callback_t callback;
+    void *context;
+} clock_listener_t;
+
+static clock_profile_t current_profile = CLOCK_PROFILE_PERFORMANCE;
+static clock_listener_t clock_listeners[BSP_CLOCK_MAX_CALLBACKS];
+static uint32_t clock_listener_count = 0;
+
+/* ===== Hardware Switch ===== */
+
+#if !defined(BOARD_HOST)
+
+static bool bsp_clock_wait(volatile uint32_t *reg, uint32_t mask, uint32_t value)
 {
-    /* TODO: Implement actual clock configuration for STM32F412ZET6
-     * Steps:
-     * 1. Configure HSE (external oscillator)
-     * 2. Setup PLL
-     * 3. Configure prescalers
-     * 4. Switch to PLL clock source
-     */
+    for (uint32_t spins = 0; spins < BSP_CLOCK_READY_SPINS; spins++) {
+        if ((*reg & mask) == value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void bsp_clock_set_latency(uint32_t latency)
+{
+    FLASH_ACR = (FLASH_ACR & ~FLASH_ACR_LATENCY_MASK) | FLASH_ACR_CACHES | latency;
+    while ((FLASH_ACR & FLASH_ACR_LATENCY_MASK) != latency) {
+    }
+}
+
+static error_t bsp_clock_apply(const clock_profile_desc_t *profile)
+{
+    RCC_CR |= RCC_CR_HSION;
+    if (!bsp_clock_wait(&RCC_CR, RCC_CR_HSIRDY, RCC_CR_HSIRDY)) {
+        return ERR_HW_FAILURE;
+    }
+
+    if (profile->use_pll) {
+        bsp_clock_set_latency(profile->flash_latency);
+
+        /* Reprogram the PLL from HSI; it must be off to change */
+        RCC_CFGR = (RCC_CFGR & ~RCC_CFGR_SW_MASK) | RCC_CFGR_SW_HSI;
+        if (!bsp_clock_wait(&RCC_CFGR, RCC_CFGR_SWS_MASK, RCC_CFGR_SW_HSI << 2)) {
+            return ERR_HW_FAILURE;
+        }
+        RCC_CR &= ~RCC_CR_PLLON;
+        RCC_PLLCFGR = profile->pllcfgr;
+        RCC_CR |= RCC_CR_PLLON;
+        if (!bsp_clock_wait(&RCC_CR, RCC_CR_PLLRDY, RCC_CR_PLLRDY)) {
+            return ERR_HW_FAILURE;
+        }
+
+        RCC_CFGR = (RCC_CFGR & ~RCC_CFGR_PRE_MASK) | profile->prescalers;
+        RCC_CFGR = (RCC_CFGR & ~RCC_CFGR_SW_MASK) | RCC_CFGR_SW_PLL;
+        if (!bsp_clock_wait(&RCC_CFGR, RCC_CFGR_SWS_MASK, RCC_CFGR_SW_PLL << 2)) {
+            return ERR_HW_FAILURE;
+        }
+    } else {
+        RCC_CFGR = (RCC_CFGR & ~RCC_CFGR_SW_MASK) | RCC_CFGR_SW_HSI;
+        if (!bsp_clock_wait(&RCC_CFGR, RCC_CFGR_SWS_MASK, RCC_CFGR_SW_HSI << 2)) {
+            return ERR_HW_FAILURE;
+        }
+        RCC_CFGR = (RCC_CFGR & ~RCC_CFGR_PRE_MASK) | profile->prescalers;
+        RCC_CR &= ~RCC_CR_PLLON;
+
+        bsp_clock_set_latency(profile->flash_latency);
+    }
+    return ERR_OK;
+}
+
+#else
+
+static error_t bsp_clock_apply(const clock_profile_desc_t *profile)
+{
+    (void)profile;
     return ERR_OK;
 }
 
+#endif /* !BOARD_HOST */
+
+/* ===== Clock API ===== */
+
+error_t bsp_clock_init(void)
+{
+    error_t err = bsp_clock_apply(&clock_profiles[CLOCK_PROFILE_PERFORMANCE]);
+
+    if (err == ERR_OK) {
+        current_profile = CLOCK_PROFILE_PERFORMANCE;
+    }
+    return err;
+}
+
 error_t bsp_clock_get_config(clock_config_t *config)
 {
     if (config == NULL) {
         return ERR_INVALID_PARAM;
     }
-    *config = default_clock_config;
+    *config = clock_profiles[current_profile].clocks;
     return ERR_OK;
 }
 
 uint32_t bsp_clock_get_system_clock(void)
 {
-    return default_clock_config.system_clock_hz;
+    return clock_profiles[current_profile].clocks.system_clock_hz;
 }
 
 uint32_t bsp_clock_get_ahb_clock(void)
 {
-    return default_clock_config.ahb_clock_hz;
+    return clock_profiles[current_profile].clocks.ahb_clock_hz;
 }
 
 uint32_t bsp_clock_get_apb1_clock(void)
 {
-    return default_clock_config.apb1_clock_hz;
+    return clock_profiles[current_profile].clocks.apb1_clock_hz;
 }
 
 uint32_t bsp_clock_get_apb2_clock(void)
 {
-    return default_clock_config.apb2_clock_hz;
+    return clock_profiles[current_profile].clocks.apb2_clock_hz;
+}
+
+/* ===== Runtime Scaling ===== */
+
+error_t bsp_clock_register_callback(clock_change_callback_t callback, void *context)
+{
+    if (callback == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    for (uint32_t i = 0; i < clock_listener_count; i++) {
+        if (clock_listeners[i].callback == callback && clock_listeners[i].context == context) {
+            return ERR_OK;
+        }
+    }
+    if (clock_listener_count >= BSP_CLOCK_MAX_CALLBACKS) {
+        return ERR_MEMORY;
+    }
+    clock_listeners[clock_listener_count].callback = callback;
+    clock_listeners[clock_listener_count].context = context;
+    clock_listener_count++;
+    return ERR_OK;
+}
+
+error_t bsp_clock_set_profile(clock_profile_t profile, uint32_t *switch_time_us)
+{
+    const clock_profile_desc_t *next;
+    uint64_t start = bsp_time_us();
+    error_t result = ERR_OK;
+    error_t err;
+
+    if (switch_time_us != NULL) {
+        *switch_time_us = 0;
+    }
+    if ((uint32_t)profile >= (uint32_t)CLOCK_PROFILE_COUNT) {
+        return ERR_INVALID_PARAM;
+    }
+    if (profile == current_profile) {
+        return ERR_OK;
+    }
+    next = &clock_profiles[profile];
+
+    for (uint32_t i = 0; i < clock_listener_count; i++) {
+        err = clock_listeners[i].callback(CLOCK_CHANGE_PREPARE, &next->clocks,
+                                          clock_listeners[i].context);
+        if (err != ERR_OK) {
+            return err;
+        }
+    }
+
+    err = bsp_clock_apply(next);
+    if (err == ERR_OK) {
+        current_profile = profile;
+    } else {
+        /* The switch may have stopped halfway (core on HSI, prescalers
+         * changed): go back to the old profile, and let the listeners
+         * that accepted PREPARE reprogram for it */
+        result = err;
+        next = &clock_profiles[current_profile];
+        (void)bsp_clock_apply(next);
+    }
+
+    for (uint32_t i = 0; i < clock_listener_count; i++) {
+        err = clock_listeners[i].callback(CLOCK_CHANGE_DONE, &next->clocks,
+                                          clock_listeners[i].context);
+        if (err != ERR_OK && result == ERR_OK) {
+            result = err;
+        }
+    }
+
+    /* The time base was re-timed by its own DONE callback */
+    if (switch_time_us != NULL) {
+        *switch_time_us = (uint32_t)(bsp_time_us() - start);
+    }
+    return result;
+}
+
+clock_profile_t bsp_clock_get_profile(void)
+{
+    return current_profile;
+}
+
+error_t bsp_clock_restore(void)
+{
+    return bsp_clock_apply(&clock_profiles[current_profile]);
+}
+
+error_t bsp_clock_get_profile_config(clock_profile_t profile, clock_config_t *config)
+{
+    if ((uint32_t)profile >= (uint32_t)CLOCK_PROFILE_COUNT || config == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    *config = clock_profiles[profile].clocks;
+    return ERR_OK;
 }
@@ -1,13 +1,34 @@
 /*
  * bsp_clock.h - Board Support Package: Clock Configuration
+ *
+ * The board runs from one of a fixed set of clock profiles, switched at
+ * runtime with bsp_clock_set_profile(). Anything derived from a bus
+ * clock (SysTick reload, UART baud divisors) registers a change
+ * callback, which is run twice per switch:
+ *
+ *   CLOCK_CHANGE_PREPARE  before touching the clocks, with the proposed
+ *                         configuration. Return an error to veto the
+ *                         switch (rate not reachable, transfer in
+ *                         flight); must not change any state.
+ *   CLOCK_CHANGE_DONE     after the switch, with the new configuration,
+ *                         to reprogram dividers. Errors are reported
+ *                         but the switch stands. If the hardware switch
+ *                         itself fails, the old profile is re-applied and
+ *                         DONE carries the old configuration instead.
+ *
+ * Callbacks run in registration order, in the caller's context, and
+ * must not switch profiles themselves.
  */
 
 #ifndef BSP_CLOCK_H
 #define BSP_CLOCK_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include "../common/error.h"
 
+#define BSP_CLOCK_MAX_CALLBACKS 8U
+
 /* Clock Configuration Structure */
 typedef struct {
     uint32_t system_clock_hz;
@@ -16,7 +37,22 @@ typedef struct {
     uint32_t apb2_clock_hz;
 } clock_config_t;
 
-/* Clock Initialization */
+/* Clock Profiles */
+typedef enum {
+    CLOCK_PROFILE_PERFORMANCE = 0,  /* PLL, full speed (boot default) */
+    CLOCK_PROFILE_LOW_POWER,        /* HSI, PLL off */
+    CLOCK_PROFILE_COUNT
+} clock_profile_t;
+
+typedef enum {
+    CLOCK_CHANGE_PREPARE = 0,
+    CLOCK_CHANGE_DONE
+} clock_change_phase_t;
+
+typedef error_t (*clock_change_callback_t)(clock_change_phase_t phase,
+                                           const clock_config_t *config, void *context);
+
+/* Clock Initialization (selects CLOCK_PROFILE_PERFORMANCE) */
 error_t bsp_clock_init(void);
 error_t bsp_clock_get_config(clock_config_t *config);
 uint32_t bsp_clock_get_system_clock(void);
@@ -24,4 +60,21 @@ uint32_t bsp_clock_get_ahb_clock(void);
 uint32_t bsp_clock_get_apb1_clock(void);
 uint32_t bsp_clock_get_apb2_clock(void);
 
+/* Runtime Scaling
+ * switch_time_us (may be NULL) receives the time from entry to the last
+ * DONE callback. Returns the first PREPARE error if the switch was
+ * vetoed, the hardware error if it failed (the old profile stays), or
+ * the first DONE error once it has happened. Switching to the current
+ * profile does nothing.
+ */
+error_t bsp_clock_register_callback(clock_change_callback_t callback, void *context);
+error_t bsp_clock_set_profile(clock_profile_t profile, uint32_t *switch_time_us);
+clock_profile_t bsp_clock_get_profile(void);
+error_t bsp_clock_get_profile_config(clock_profile_t profile, clock_config_t *config);
+
+/* Re-apply the current profile after the hardware fell back to the HSI
+ * on its own (Stop mode exit). No callbacks are run: the bus clocks end
+ * up as they were, so the dividers derived from them still hold. */
+error_t bsp_clock_restore(void);
+
 #endif /* BSP_CLOCK_H */
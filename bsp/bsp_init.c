@@ -4,6 +4,8 @@
 
 #include "bsp_init.h"
 #include "bsp_clock.h"
+#include "bsp_power.h"
+#include "bsp_time.h"
 #include "board_config.h"
 #include "../common/error.h"
 
@@ -18,6 +20,19 @@ error_t bsp_init(void)
         return err;
     }
 
+    /* Start the system tick (needs the final core clock) */
+    err = bsp_time_init();
+    if (err != ERR_OK) {
+        error_log(err, SEVERITY_FATAL, 1);
+        return err;
+    }
+
+    /* Stop mode timing; without it idling only sleeps */
+    err = bsp_power_init();
+    if (err != ERR_OK) {
+        error_log(err, SEVERITY_WARN, 2);
+    }
+
     /* TODO: Enable peripheral clocks
      * - GPIO clocks
      * - UART clocks
@@ -0,0 +1,544 @@
+/*
+ * bsp_power.c - Low-Power Idle Implementation
+ *
+ * STM32F412: Stop runs with the regulator in low-power mode and the
+ * Flash powered down (PWR_CR.LPDS | FPDS), the deepest Stop that keeps
+ * SRAM. Stops are timed and ended by the RTC on the LSI: the
+ * subsecond counter runs at the raw LSI rate (PREDIV_A = 0), read with
+ * the shadow registers bypassed so no resynchronization is needed after
+ * a Stop. The LSI is only specified to 17-47 kHz, so its rate is
+ * measured against SysTick at init and used for both the wake-up timer
+ * (RTC/2, up to ~4 s per Stop) and the time credited on exit. The
+ * calendar itself is not used as a clock.
+ *
+ * The core wakes on HSI 16 MHz; the cycles spent restoring the profile
+ * are counted there and added to the datasheet wake-up time for the
+ * latency. The pending interrupt that woke it runs once the Stop
+ * sequence unmasks, and claims the wake-up with bsp_power_wake().
+ *
+ * BOARD=host builds (BOARD_HOST) model Stop with a CLOCK_MONOTONIC
+ * condition variable (see bsp_power.h) and measure the latency from the
+ * wake event.
+ */
+
+#if defined(BOARD_HOST)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "bsp_power.h"
+#include "bsp_clock.h"
+#include "bsp_time.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* No wake-up claimed yet */
+#define POWER_WAKE_NONE         ((uint32_t)POWER_WAKE_COUNT)
+
+typedef struct {
+    power_stop_callback_t callback;
+    void *context;
+} power_listener_t;
+
+/* Result of one Stop, clocks and time base restored */
+typedef struct {
+    uint64_t stopped_us;
+    uint32_t latency_us;
+} power_stop_exit_t;
+
+static power_listener_t power_listeners[BSP_POWER_MAX_CALLBACKS];
+static uint32_t power_listener_count = 0;
+static uint32_t power_stop_threshold_us = BSP_POWER_STOP_MIN_US;
+static bool power_ready;
+static power_stats_t power_stats;
+static uint64_t power_stats_since_us;
+static atomic_bool power_stopping;
+static _Atomic uint32_t power_wake_source;
+
+/* Claim the Stop in progress for source; true for the first claim */
+static bool bsp_power_claim(power_wake_t source)
+{
+    uint32_t expected = POWER_WAKE_NONE;
+
+    return atomic_load(&power_stopping) &&
+           atomic_compare_exchange_strong(&power_wake_source, &expected, (uint32_t)source);
+}
+
+/* ===== Hardware Stop ===== */
+
+#if !defined(BOARD_HOST)
+
+/* ===== STM32F4 PWR / RCC / RTC / EXTI Registers ===== */
+#define PWR_CR                  (*(volatile uint32_t *)0x40007000UL)
+#define RCC_APB1ENR             (*(volatile uint32_t *)0x40023840UL)
+#define RCC_BDCR                (*(volatile uint32_t *)0x40023870UL)
+#define RCC_CSR                 (*(volatile uint32_t *)0x40023874UL)
+#define RTC_TR                  (*(volatile uint32_t *)0x40002800UL)
+#define RTC_CR                  (*(volatile uint32_t *)0x40002808UL)
+#define RTC_ISR                 (*(volatile uint32_t *)0x4000280CUL)
+#define RTC_PRER                (*(volatile uint32_t *)0x40002810UL)
+#define RTC_WUTR                (*(volatile uint32_t *)0x40002814UL)
+#define RTC_WPR                 (*(volatile uint32_t *)0x40002824UL)
+#define RTC_SSR                 (*(volatile uint32_t *)0x40002828UL)
+#define EXTI_IMR                (*(volatile uint32_t *)0x40013C00UL)
+#define EXTI_RTSR               (*(volatile uint32_t *)0x40013C08UL)
+#define EXTI_PR                 (*(volatile uint32_t *)0x40013C14UL)
+
+/* ===== Cortex-M Core Registers ===== */
+#define SCB_SCR                 (*(volatile uint32_t *)0xE000ED10UL)
+#define NVIC_ISER0              (*(volatile uint32_t *)0xE000E100UL)
+#define DEMCR                   (*(volatile uint32_t *)0xE000EDFCUL)
+#define DWT_CTRL                (*(volatile uint32_t *)0xE0001000UL)
+#define DWT_CYCCNT              (*(volatile uint32_t *)0xE0001004UL)
+#define DBGMCU_CR               (*(volatile uint32_t *)0xE0042004UL)
+
+#define PWR_CR_LPDS             (1UL << 0)
+#define PWR_CR_PDDS             (1UL << 1)
+#define PWR_CR_DBP              (1UL << 8)
+#define PWR_CR_FPDS             (1UL << 9)
+#define RCC_APB1ENR_PWREN       (1UL << 28)
+#define RCC_BDCR_RTCSEL_MASK    (3UL << 8)
+#define RCC_BDCR_RTCSEL_LSI     (2UL << 8)
+#define RCC_BDCR_RTCEN          (1UL << 15)
+#define RCC_BDCR_BDRST          (1UL << 16)
+#define RCC_CSR_LSION           (1UL << 0)
+#define RCC_CSR_LSIRDY          (1UL << 1)
+#define RTC_CR_WUCKSEL_DIV2     (3UL << 0)
+#define RTC_CR_WUCKSEL_MASK     (7UL << 0)
+#define RTC_CR_BYPSHAD          (1UL << 5)
+#define RTC_CR_WUTE             (1UL << 10)
+#define RTC_CR_WUTIE            (1UL << 14)
+#define RTC_ISR_WUTWF           (1UL << 2)
+#define RTC_ISR_INITF           (1UL << 6)
+#define RTC_ISR_INIT            (1UL << 7)
+#define RTC_ISR_WUTF            (1UL << 10)
+#define RTC_WPR_KEY1            0xCAUL
+#define RTC_WPR_KEY2            0x53UL
+#define RTC_WPR_LOCK            0xFFUL
+#define EXTI_LINE_RTC_WKUP      (1UL << 22)
+#define RTC_WKUP_IRQ            3U
+#define SCB_SCR_SLEEPDEEP       (1UL << 2)
+#define DEMCR_TRCENA            (1UL << 24)
+#define DWT_CTRL_CYCCNTENA      (1UL << 0)
+#define DBGMCU_CR_DBG_SLEEP     (1UL << 0)
+#define DBGMCU_CR_DBG_STOP      (1UL << 1)
+
+#define RTC_PREDIV_S            0x7FFFUL        /* Subsecond counter range */
+#define RTC_TICKS_PER_DAY       (86400UL * (RTC_PREDIV_S + 1U))
+#define RTC_WUT_MAX             0x10000UL
+#define LSI_CAL_US              20000U
+#define LSI_READY_SPINS         100000UL
+#define HSI_MHZ                 16U             /* Core clock out of Stop */
+
+static uint32_t lsi_hz;
+
+/* Subsecond ticks since midnight */
+static uint32_t bsp_power_rtc_ticks(void)
+{
+    uint32_t tr;
+    uint32_t ssr;
+    uint32_t seconds;
+
+    /* TR steps when SSR reloads: a stable TR brackets a matching SSR */
+    do {
+        tr = RTC_TR;
+        ssr = RTC_SSR;
+    } while (tr != RTC_TR);
+
+    seconds = (tr & 0xFU) + ((tr >> 4) & 0x7U) * 10U +
+              (((tr >> 8) & 0xFU) + ((tr >> 12) & 0x7U) * 10U) * 60U +
+              (((tr >> 16) & 0xFU) + ((tr >> 20) & 0x3U) * 10U) * 3600U;
+    return seconds * (RTC_PREDIV_S + 1U) + (RTC_PREDIV_S - (ssr & 0xFFFFU));
+}
+
+static uint32_t bsp_power_rtc_elapsed(uint32_t from, uint32_t to)
+{
+    return (to >= from) ? (to - from) : (to + RTC_TICKS_PER_DAY - from);
+}
+
+void RTC_WKUP_IRQHandler(void)
+{
+    RTC_ISR &= ~RTC_ISR_WUTF;
+    EXTI_PR = EXTI_LINE_RTC_WKUP;
+    bsp_power_wake(POWER_WAKE_TIMER);
+}
+
+static error_t bsp_power_hw_init(void)
+{
+    uint32_t spins = 0;
+    uint32_t ticks;
+    uint64_t start;
+    uint64_t elapsed;
+
+    RCC_APB1ENR |= RCC_APB1ENR_PWREN;
+    PWR_CR |= PWR_CR_DBP;
+    RCC_CSR |= RCC_CSR_LSION;
+    while ((RCC_CSR & RCC_CSR_LSIRDY) == 0U) {
+        if (++spins >= LSI_READY_SPINS) {
+            return ERR_HW_FAILURE;
+        }
+    }
+
+    /* The RTC clock can only be chosen once per backup domain reset */
+    if ((RCC_BDCR & RCC_BDCR_RTCSEL_MASK) != RCC_BDCR_RTCSEL_LSI) {
+        RCC_BDCR |= RCC_BDCR_BDRST;
+        RCC_BDCR &= ~RCC_BDCR_BDRST;
+    }
+    RCC_BDCR |= RCC_BDCR_RTCSEL_LSI | RCC_BDCR_RTCEN;
+
+    RTC_WPR = RTC_WPR_KEY1;
+    RTC_WPR = RTC_WPR_KEY2;
+    RTC_ISR |= RTC_ISR_INIT;
+    while ((RTC_ISR & RTC_ISR_INITF) == 0U) {
+    }
+    RTC_PRER = RTC_PREDIV_S;                /* Two writes: S, then A = 0 */
+    RTC_PRER = RTC_PREDIV_S;
+    RTC_CR |= RTC_CR_BYPSHAD;
+    RTC_ISR &= ~RTC_ISR_INIT;
+
+    RTC_CR &= ~RTC_CR_WUTE;
+    while ((RTC_ISR & RTC_ISR_WUTWF) == 0U) {
+    }
+    RTC_CR = (RTC_CR & ~RTC_CR_WUCKSEL_MASK) | RTC_CR_WUCKSEL_DIV2 | RTC_CR_WUTIE;
+    RTC_WPR = RTC_WPR_LOCK;
+
+    EXTI_IMR |= EXTI_LINE_RTC_WKUP;
+    EXTI_RTSR |= EXTI_LINE_RTC_WKUP;
+    NVIC_ISER0 = 1UL << RTC_WKUP_IRQ;
+
+    DEMCR |= DEMCR_TRCENA;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#ifdef DEBUG
+    DBGMCU_CR |= DBGMCU_CR_DBG_SLEEP | DBGMCU_CR_DBG_STOP;
+#endif
+
+    /* Measure the LSI against the (HSI/PLL derived) time base */
+    start = bsp_time_us();
+    ticks = bsp_power_rtc_ticks();
+    do {
+        elapsed = bsp_time_us() - start;
+    } while (elapsed < LSI_CAL_US);
+    ticks = bsp_power_rtc_elapsed(ticks, bsp_power_rtc_ticks());
+    lsi_hz = (uint32_t)((uint64_t)ticks * 1000000U / elapsed);
+    return (lsi_hz != 0U) ? ERR_OK : ERR_HW_FAILURE;
+}
+
+static void bsp_power_irq_disable(void)
+{
+    __asm volatile ("cpsid i" ::: "memory");
+}
+
+static void bsp_power_irq_enable(void)
+{
+    __asm volatile ("cpsie i" ::: "memory");
+}
+
+/* Interrupts masked: Stop until wake_at_us, then restore the clocks
+ * and the time base. Returns the clock restore result; the time base is
+ * resumed either way */
+static error_t bsp_power_hw_stop(uint64_t wake_at_us, power_stop_exit_t *exit)
+{
+    uint64_t now = bsp_time_us();
+    uint64_t delta = (wake_at_us > now) ? wake_at_us - now : 0U;
+    uint64_t delta_max = RTC_WUT_MAX * 1000000ULL / (lsi_hz / 2U);
+    uint64_t wut;
+    uint32_t rtc_start;
+    uint32_t cycles;
+    error_t err;
+
+    /* Clamp to the longest timer period before scaling: a far deadline
+     * (UINT64_MAX when nothing is due) would overflow the product */
+    if (delta > delta_max) {
+        delta = delta_max;
+    }
+    wut = delta * (lsi_hz / 2U) / 1000000U;
+    if (wut == 0U) {
+        wut = 1U;
+    }
+
+    RTC_WPR = RTC_WPR_KEY1;
+    RTC_WPR = RTC_WPR_KEY2;
+    RTC_CR &= ~RTC_CR_WUTE;
+    while ((RTC_ISR & RTC_ISR_WUTWF) == 0U) {
+    }
+    RTC_WUTR = (uint32_t)wut - 1U;
+    RTC_ISR &= ~RTC_ISR_WUTF;
+    RTC_CR |= RTC_CR_WUTE;
+    RTC_WPR = RTC_WPR_LOCK;
+    EXTI_PR = EXTI_LINE_RTC_WKUP;
+
+    rtc_start = bsp_power_rtc_ticks();
+    bsp_time_stop();
+    PWR_CR = (PWR_CR & ~PWR_CR_PDDS) | PWR_CR_LPDS | PWR_CR_FPDS;
+    SCB_SCR |= SCB_SCR_SLEEPDEEP;
+
+    __asm volatile ("dsb\n\twfi\n\tisb" ::: "memory");
+
+    SCB_SCR &= ~SCB_SCR_SLEEPDEEP;
+    cycles = DWT_CYCCNT;
+    err = bsp_clock_restore();
+    /* Counted as HSI cycles: the last few at the PLL rate overstate it */
+    cycles = DWT_CYCCNT - cycles;
+
+    exit->stopped_us = (uint64_t)bsp_power_rtc_elapsed(rtc_start, bsp_power_rtc_ticks()) *
+                       1000000U / lsi_hz;
+    exit->latency_us = BSP_POWER_STOP_WAKEUP_US + cycles / HSI_MHZ;
+    bsp_time_resume(exit->stopped_us);
+
+    /* A Stop ended by another source leaves the timer running */
+    RTC_WPR = RTC_WPR_KEY1;
+    RTC_WPR = RTC_WPR_KEY2;
+    RTC_CR &= ~RTC_CR_WUTE;
+    RTC_WPR = RTC_WPR_LOCK;
+    return err;
+}
+
+void bsp_power_wake(power_wake_t source)
+{
+    (void)bsp_power_claim(source);
+}
+
+#else
+
+#include <pthread.h>
+#include <time.h>
+
+static pthread_mutex_t stop_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t stop_cond;
+static uint64_t stop_woken_at_us;       /* Time of the claiming wake-up */
+
+static error_t bsp_power_hw_init(void)
+{
+    static bool created;
+    pthread_condattr_t attr;
+
+    if (!created) {
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&stop_cond, &attr);
+        pthread_condattr_destroy(&attr);
+        created = true;
+    }
+    return ERR_OK;
+}
+
+/* Interrupts are threads: nothing to mask, the claim orders them */
+static void bsp_power_irq_disable(void)
+{
+}
+
+static void bsp_power_irq_enable(void)
+{
+}
+
+static error_t bsp_power_hw_stop(uint64_t wake_at_us, power_stop_exit_t *exit)
+{
+    uint64_t start = bsp_time_us();
+    uint64_t until = (wake_at_us > start) ? wake_at_us : start;
+    uint64_t woken_at;
+    struct timespec ts;
+    struct timespec now;
+    error_t err;
+
+    /* bsp_time_us() is CLOCK_MONOTONIC minus a fixed epoch */
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ts.tv_sec = now.tv_sec + (time_t)((until - start) / 1000000U);
+    ts.tv_nsec = now.tv_nsec + (long)((until - start) % 1000000U) * 1000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&stop_lock);
+    while (atomic_load(&power_wake_source) == POWER_WAKE_NONE && bsp_time_us() < until) {
+        (void)pthread_cond_timedwait(&stop_cond, &stop_lock, &ts);
+    }
+    pthread_mutex_unlock(&stop_lock);
+
+    if (bsp_power_claim(POWER_WAKE_TIMER)) {
+        woken_at = until;
+    } else {
+        pthread_mutex_lock(&stop_lock);
+        woken_at = stop_woken_at_us;
+        pthread_mutex_unlock(&stop_lock);
+    }
+    exit->stopped_us = bsp_time_us() - start;
+
+    /* Regulator and Flash wake-up, PLL relock */
+    ts.tv_sec = 0;
+    ts.tv_nsec = (long)BSP_POWER_STOP_WAKEUP_US * 1000L;
+    (void)nanosleep(&ts, NULL);
+    err = bsp_clock_restore();
+    exit->latency_us = (uint32_t)(bsp_time_us() - woken_at);
+    return err;
+}
+
+void bsp_power_wake(power_wake_t source)
+{
+    if (!atomic_load(&power_stopping)) {
+        return;
+    }
+    pthread_mutex_lock(&stop_lock);
+    if (bsp_power_claim(source)) {
+        stop_woken_at_us = bsp_time_us();
+        pthread_cond_signal(&stop_cond);
+    }
+    pthread_mutex_unlock(&stop_lock);
+}
+
+#endif /* !BOARD_HOST */
+
+/* ===== Power API ===== */
+
+error_t bsp_power_init(void)
+{
+    error_t err;
+
+    atomic_store(&power_stopping, false);
+    atomic_store(&power_wake_source, POWER_WAKE_NONE);
+    err = bsp_power_hw_init();
+    power_ready = (err == ERR_OK);
+    bsp_power_reset_stats();
+    return err;
+}
+
+error_t bsp_power_register_callback(power_stop_callback_t callback, void *context)
+{
+    if (callback == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    for (uint32_t i = 0; i < power_listener_count; i++) {
+        if (power_listeners[i].callback == callback && power_listeners[i].context == context) {
+            return ERR_OK;
+        }
+    }
+    if (power_listener_count >= BSP_POWER_MAX_CALLBACKS) {
+        return ERR_MEMORY;
+    }
+    power_listeners[power_listener_count].callback = callback;
+    power_listeners[power_listener_count].context = context;
+    power_listener_count++;
+    return ERR_OK;
+}
+
+void bsp_power_set_stop_threshold_us(uint32_t threshold_us)
+{
+    power_stop_threshold_us = threshold_us;
+}
+
+uint32_t bsp_power_get_stop_threshold_us(void)
+{
+    return power_stop_threshold_us;
+}
+
+static error_t bsp_power_notify(power_stop_phase_t phase)
+{
+    for (uint32_t i = 0; i < power_listener_count; i++) {
+        error_t err = power_listeners[i].callback(phase, power_listeners[i].context);
+
+        if (err != ERR_OK && phase == POWER_STOP_PREPARE) {
+            return err;
+        }
+    }
+    return ERR_OK;
+}
+
+static error_t bsp_power_stop(uint64_t wake_at_us, bool (*work_pending)(void), power_mode_t *mode)
+{
+    power_stop_exit_t exit;
+    uint32_t source;
+    error_t err;
+
+    bsp_power_irq_disable();
+
+    /* Claims from here on end the Stop, so work posted after this check
+     * is not slept through */
+    atomic_store(&power_wake_source, POWER_WAKE_NONE);
+    atomic_store(&power_stopping, true);
+    if (work_pending != NULL && work_pending()) {
+        atomic_store(&power_stopping, false);
+        bsp_power_irq_enable();
+        power_stats.entries[POWER_MODE_RUN]++;
+        *mode = POWER_MODE_RUN;
+        return ERR_OK;
+    }
+
+    (void)bsp_power_notify(POWER_STOP_ENTER);
+    err = bsp_power_hw_stop(wake_at_us, &exit);
+    (void)bsp_power_notify(POWER_STOP_EXIT);
+
+    /* The interrupt that woke the core runs now and claims the wake-up */
+    bsp_power_irq_enable();
+    atomic_store(&power_stopping, false);
+    source = atomic_load(&power_wake_source);
+    if (source == POWER_WAKE_NONE) {
+        source = (uint32_t)POWER_WAKE_OTHER;
+    }
+
+    power_stats.entries[POWER_MODE_STOP]++;
+    power_stats.residency_us[POWER_MODE_STOP] += exit.stopped_us;
+    power_stats.wakes[source]++;
+    power_stats.wake_latency_last_us = exit.latency_us;
+    power_stats.wake_latency_total_us += exit.latency_us;
+    if (exit.latency_us > power_stats.wake_latency_max_us) {
+        power_stats.wake_latency_max_us = exit.latency_us;
+    }
+
+    /* The PLL did not relock: the core carries on from the HSI, with
+     * the bus clocks the listeners were not told about */
+    if (err != ERR_OK) {
+        error_log(err, SEVERITY_ERROR, __LINE__);
+    }
+    *mode = POWER_MODE_STOP;
+    return err;
+}
+
+error_t bsp_power_idle_until(uint64_t deadline_us, bool (*work_pending)(void), power_mode_t *mode)
+{
+    uint64_t now = bsp_time_us();
+    power_mode_t used;
+
+    if (mode == NULL) {
+        mode = &used;
+    }
+    if (deadline_us <= now) {
+        power_stats.entries[POWER_MODE_RUN]++;
+        *mode = POWER_MODE_RUN;
+        return ERR_OK;
+    }
+
+    if (power_ready && deadline_us - now >= power_stop_threshold_us &&
+        power_stop_threshold_us != UINT32_MAX) {
+        if (bsp_power_notify(POWER_STOP_PREPARE) == ERR_OK) {
+            return bsp_power_stop(deadline_us - BSP_POWER_STOP_EXIT_US, work_pending, mode);
+        }
+        power_stats.vetoes++;
+    }
+
+    bsp_time_idle_until(deadline_us, work_pending);
+    power_stats.entries[POWER_MODE_SLEEP]++;
+    power_stats.residency_us[POWER_MODE_SLEEP] += bsp_time_us() - now;
+    *mode = POWER_MODE_SLEEP;
+    return ERR_OK;
+}
+
+void bsp_power_get_stats(power_stats_t *stats)
+{
+    uint64_t total;
+    uint64_t idle;
+
+    if (stats == NULL) {
+        return;
+    }
+    *stats = power_stats;
+    total = bsp_time_us() - power_stats_since_us;
+    idle = power_stats.residency_us[POWER_MODE_SLEEP] + power_stats.residency_us[POWER_MODE_STOP];
+    /* Stops are timed on the RTC, the rest on the time base */
+    stats->residency_us[POWER_MODE_RUN] = (total > idle) ? (total - idle) : 0U;
+}
+
+void bsp_power_reset_stats(void)
+{
+    power_stats = (power_stats_t){0};
+    power_stats_since_us = bsp_time_us();
+}
@@ -0,0 +1,125 @@
+/*
+ * bsp_power.h - Board Support Package: Low-Power Idle
+ *
+ * bsp_power_idle_until() replaces bsp_time_idle_until() in the main
+ * loop and picks the idle mode from the time left to the deadline:
+ *
+ *   POWER_MODE_SLEEP  WFI with the clocks running (tickless, see
+ *                     bsp_time.h); any interrupt wakes the core.
+ *   POWER_MODE_STOP   Deep sleep: PLL, HSI and every bus clock stop,
+ *                     SRAM and registers are kept. Only EXTI lines wake
+ *                     the core: GPIO edges, the UART RX pins armed for
+ *                     wake-up, and the RTC wake-up timer that ends the
+ *                     Stop ahead of the deadline. On exit the clock
+ *                     profile is restored through bsp_clock and the
+ *                     time base advanced by the time slept.
+ *
+ * Stop is used when at least the stop threshold (BSP_POWER_STOP_MIN_US
+ * by default) is left, unless a Stop callback vetoes it. Peripherals
+ * whose state does not survive the bus clocks stopping register one,
+ * run in three phases:
+ *
+ *   POWER_STOP_PREPARE  Before anything is touched, interrupts enabled.
+ *                       Return an error to veto (transfer in flight);
+ *                       must not change any state. The idle then falls
+ *                       back to Sleep.
+ *   POWER_STOP_ENTER    Interrupts masked, right before the Stop: arm
+ *                       wake-up sources.
+ *   POWER_STOP_EXIT     Interrupts masked, clocks restored: disarm them.
+ *
+ * A wake-up interrupt reports its source with bsp_power_wake(); that
+ * only counts while a Stop is in progress and attributes the wake-up.
+ * Time spent in each mode, Stop wake-ups per source and the wake-up
+ * latency (wake event to clocks restored) are kept in power_stats_t.
+ *
+ * The independent watchdog keeps counting in Stop: the deadlines passed
+ * here must come well within its timeout.
+ *
+ * The host build (BOARD=host) models Stop as a wait that only wake
+ * sources (bsp_power_wake(), or bsp_time_wake() for an interrupt that
+ * was already pending) and the timer end, followed by the modelled
+ * hardware wake-up time, so the policy and the statistics behave as on
+ * target.
+ */
+
+#ifndef BSP_POWER_H
+#define BSP_POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/error.h"
+
+#define BSP_POWER_MAX_CALLBACKS     8U
+
+/* Shortest idle worth a Stop: below it the wake-up costs more than the
+ * Stop saves */
+#ifndef BSP_POWER_STOP_MIN_US
+#define BSP_POWER_STOP_MIN_US       2000U
+#endif
+
+/* Stop exit, wake event to clocks restored: regulator and Flash
+ * wake-up (tWUSTOP, low-power regulator, Flash in power-down), then the
+ * PLL relock. The RTC ends a Stop this long before the deadline. */
+#define BSP_POWER_STOP_WAKEUP_US    120U
+#define BSP_POWER_STOP_EXIT_US      400U
+
+typedef enum {
+    POWER_MODE_RUN = 0,
+    POWER_MODE_SLEEP,
+    POWER_MODE_STOP,
+    POWER_MODE_COUNT
+} power_mode_t;
+
+/* Stop wake-up sources */
+typedef enum {
+    POWER_WAKE_TIMER = 0,       /* RTC wake-up timer: deadline reached */
+    POWER_WAKE_UART,            /* Start bit on an armed RX pin */
+    POWER_WAKE_GPIO,            /* EXTI edge */
+    POWER_WAKE_OTHER,           /* Interrupt that was pending at entry */
+    POWER_WAKE_COUNT
+} power_wake_t;
+
+typedef enum {
+    POWER_STOP_PREPARE = 0,
+    POWER_STOP_ENTER,
+    POWER_STOP_EXIT
+} power_stop_phase_t;
+
+typedef error_t (*power_stop_callback_t)(power_stop_phase_t phase, void *context);
+
+typedef struct {
+    uint64_t residency_us[POWER_MODE_COUNT];    /* Since the last reset */
+    uint32_t entries[POWER_MODE_COUNT];         /* RUN: idles that returned at once */
+    uint32_t wakes[POWER_WAKE_COUNT];           /* Stop exits per source */
+    uint32_t vetoes;                            /* Stops refused by a callback */
+    uint32_t wake_latency_last_us;
+    uint32_t wake_latency_max_us;
+    uint64_t wake_latency_total_us;             /* Over entries[POWER_MODE_STOP] */
+} power_stats_t;
+
+/* Power Management Initialization (after bsp_time_init()); starts the
+ * RTC used to time and end Stops. Until it has run, idling only sleeps. */
+error_t bsp_power_init(void);
+
+error_t bsp_power_register_callback(power_stop_callback_t callback, void *context);
+
+/* Idle left before a Stop is tried; UINT32_MAX never stops */
+void bsp_power_set_stop_threshold_us(uint32_t threshold_us);
+uint32_t bsp_power_get_stop_threshold_us(void);
+
+/* Idle until deadline_us (bsp_time_us() scale) or a wake-up, in the mode
+ * the time left allows; mode (may be NULL) receives the mode used.
+ * work_pending (may be NULL) is checked with interrupts masked right
+ * before sleeping, as for bsp_time_idle_until(). Callers wanting the
+ * full wait loop on the deadline. Returns the bsp_clock_restore() error
+ * (also logged) if the clock profile could not be restored after a
+ * Stop. */
+error_t bsp_power_idle_until(uint64_t deadline_us, bool (*work_pending)(void), power_mode_t *mode);
+
+/* Report a wake-up source; interrupt context. Ignored outside a Stop. */
+void bsp_power_wake(power_wake_t source);
+
+void bsp_power_get_stats(power_stats_t *stats);
+void bsp_power_reset_stats(void);
+
+#endif /* BSP_POWER_H */
@@ -0,0 +1,249 @@
+/*
+ * bsp_time.c - Monotonic Time Base on the Cortex-M SysTick
+ *
+ * SysTick runs from the core clock and interrupts every tick; the
+ * handler only advances tick_count. Sub-tick resolution comes from the
+ * current SysTick value, so bsp_time_us() is exact to 1 us.
+ *
+ * Tickless idle follows the usual scheme: with interrupts masked the
+ * reload is stretched to cover whole ticks up to the deadline (at most
+ * SYST_MAX_RELOAD cycles, ~167 ms at 100 MHz), WFI waits, and on wake
+ * the counter is read back to credit the ticks slept and to realign the
+ * next tick on the original grid.
+ *
+ * On a clock profile switch the elapsed part of the current tick is
+ * converted to the new rate and the counter restarted from there; time
+ * stays continuous to within the few microseconds the switch itself
+ * runs at a rate that is neither old nor new.
+ */
+
+#include <stddef.h>
+#include "bsp_time.h"
+#include "bsp_clock.h"
+#include "board_config.h"
+#include "../common/hot_path.h"
+
+/* ===== Cortex-M Core Registers ===== */
+#define SYST_CSR            (*(volatile uint32_t *)0xE000E010UL)
+#define SYST_RVR            (*(volatile uint32_t *)0xE000E014UL)
+#define SYST_CVR            (*(volatile uint32_t *)0xE000E018UL)
+#define SCB_ICSR            (*(volatile uint32_t *)0xE000ED04UL)
+
+#define SYST_CSR_ENABLE     (1UL << 0)
+#define SYST_CSR_TICKINT    (1UL << 1)
+#define SYST_CSR_CLKSOURCE  (1UL << 2)     /* Processor clock */
+#define SYST_CSR_COUNTFLAG  (1UL << 16)
+#define SCB_ICSR_PENDSTSET  (1UL << 26)
+#define SCB_ICSR_PENDSTCLR  (1UL << 25)
+
+#define SYST_MAX_RELOAD     0x00FFFFFFUL
+
+#define US_PER_TICK         (1000000UL / BSP_TICK_HZ)
+
+static uint32_t cycles_per_tick;
+static uint32_t cycles_per_us;
+static volatile uint64_t tick_count;
+static uint64_t stopped_at_us;
+
+HOT_FUNC void SysTick_Handler(void)
+{
+    tick_count++;
+}
+
+/* Core clock usable for the tick: whole MHz, tick fits the counter */
+static bool bsp_time_clock_ok(uint32_t hclk)
+{
+    return (hclk % 1000000UL) == 0U && hclk != 0U &&
+           (hclk / 1000000UL) * US_PER_TICK - 1U <= SYST_MAX_RELOAD;
+}
+
+static error_t bsp_time_clock_changed(clock_change_phase_t phase, const clock_config_t *config,
+                                      void *context)
+{
+    uint32_t elapsed_us;
+
+    (void)context;
+    if (!bsp_time_clock_ok(config->system_clock_hz)) {
+        return ERR_INVALID_PARAM;
+    }
+    if (phase == CLOCK_CHANGE_PREPARE) {
+        return ERR_OK;
+    }
+
+    __asm volatile ("cpsid i" ::: "memory");
+
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT;
+    elapsed_us = (cycles_per_tick - 1U - SYST_CVR) / cycles_per_us;
+
+    cycles_per_us = config->system_clock_hz / 1000000UL;
+    cycles_per_tick = cycles_per_us * US_PER_TICK;
+
+    /* Finish the current tick at the new rate, then resume the grid */
+    SYST_RVR = (US_PER_TICK - elapsed_us) * cycles_per_us - 1U;
+    SYST_CVR = 0;
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT | SYST_CSR_ENABLE;
+    SYST_RVR = cycles_per_tick - 1U;
+
+    __asm volatile ("cpsie i" ::: "memory");
+    return ERR_OK;
+}
+
+error_t bsp_time_init(void)
+{
+    uint32_t hclk = bsp_clock_get_system_clock();
+
+    if ((1000000UL % BSP_TICK_HZ) != 0U || !bsp_time_clock_ok(hclk)) {
+        return ERR_INVALID_PARAM;
+    }
+    cycles_per_us = hclk / 1000000UL;
+    cycles_per_tick = cycles_per_us * US_PER_TICK;
+
+    tick_count = 0;
+    SYST_CSR = 0;
+    SYST_RVR = cycles_per_tick - 1U;
+    SYST_CVR = 0;
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT | SYST_CSR_ENABLE;
+
+    /* First listener: later ones may already use the re-timed clock */
+    return bsp_clock_register_callback(bsp_time_clock_changed, NULL);
+}
+
+uint64_t bsp_time_us(void)
+{
+    uint64_t ticks;
+    uint32_t val;
+    bool pending;
+
+    if (cycles_per_us == 0U) {
+        return 0;
+    }
+
+    /* tick_count is 64-bit: re-read until no tick interrupt got between */
+    do {
+        ticks = tick_count;
+        val = SYST_CVR;
+        pending = (SCB_ICSR & SCB_ICSR_PENDSTSET) != 0U;
+    } while (ticks != tick_count);
+
+    /* Counter wrapped but the handler has not run yet (IRQs masked) */
+    if (pending && val > (cycles_per_tick / 2U)) {
+        ticks++;
+    }
+
+    return ticks * US_PER_TICK + (cycles_per_tick - 1U - val) / cycles_per_us;
+}
+
+uint32_t bsp_time_ms(void)
+{
+    return (uint32_t)(bsp_time_us() / 1000U);
+}
+
+void bsp_time_idle_until(uint64_t deadline_us, bool (*work_pending)(void))
+{
+    uint64_t now = bsp_time_us();
+    uint64_t wait_ticks;
+    uint32_t skip;
+    uint32_t val;
+    uint32_t load;
+    uint32_t csr;
+    uint32_t pos;
+
+    if (cycles_per_tick == 0U || deadline_us <= now) {
+        return;
+    }
+
+    wait_ticks = (deadline_us - now) / US_PER_TICK;
+    skip = (uint32_t)((wait_ticks < (SYST_MAX_RELOAD / cycles_per_tick)) ?
+                      wait_ticks : (SYST_MAX_RELOAD / cycles_per_tick));
+
+    __asm volatile ("cpsid i" ::: "memory");
+
+    if (work_pending != NULL && work_pending()) {
+        __asm volatile ("cpsie i" ::: "memory");
+        return;
+    }
+
+    if (skip < 2U) {
+        /* Next tick comes first anyway: plain sleep */
+        __asm volatile ("dsb\n\twfi\n\tisb" ::: "memory");
+        __asm volatile ("cpsie i" ::: "memory");
+        return;
+    }
+
+    /* Stretch the current tick by skip - 1 whole ticks */
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT;
+    val = SYST_CVR;
+    load = val + (skip - 1U) * cycles_per_tick;
+    SYST_RVR = load;
+    SYST_CVR = 0;
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT | SYST_CSR_ENABLE;
+
+    __asm volatile ("dsb\n\twfi\n\tisb" ::: "memory");
+
+    csr = SYST_CSR;
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT;
+
+    if ((csr & SYST_CSR_COUNTFLAG) != 0U) {
+        /* Slept the whole way: the pending tick interrupt adds the last */
+        tick_count += skip - 1U;
+        SYST_RVR = cycles_per_tick - 1U;
+        SYST_CVR = 0;
+    } else {
+        /* Woken early: credit whole ticks, finish the partial one */
+        pos = (cycles_per_tick - 1U - val) + (load - SYST_CVR);
+        tick_count += pos / cycles_per_tick;
+        SYST_RVR = cycles_per_tick - (pos % cycles_per_tick) - 1U;
+        SYST_CVR = 0;
+    }
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT | SYST_CSR_ENABLE;
+    SYST_RVR = cycles_per_tick - 1U;
+
+    __asm volatile ("cpsie i" ::: "memory");
+}
+
+void bsp_time_wake(void)
+{
+    /* The interrupt calling this has ended WFI by being taken */
+}
+
+void bsp_time_stop(void)
+{
+    stopped_at_us = bsp_time_us();
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT;
+    /* A pending tick would keep WFI from stopping; it is in stopped_at_us */
+    SCB_ICSR = SCB_ICSR_PENDSTCLR;
+}
+
+void bsp_time_resume(uint64_t slept_us)
+{
+    uint64_t now = stopped_at_us + slept_us;
+    uint32_t into_tick = (uint32_t)(now % US_PER_TICK);
+
+    /* Back on the grid: the first tick only covers the rest of this one */
+    tick_count = now / US_PER_TICK;
+    SYST_RVR = (US_PER_TICK - into_tick) * cycles_per_us - 1U;
+    SYST_CVR = 0;
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT | SYST_CSR_ENABLE;
+    SYST_RVR = cycles_per_tick - 1U;
+}
+
+/* Idle may end early on any interrupt: go back to sleep until due */
+static void wait_until(uint64_t deadline_us)
+{
+    if (cycles_per_tick == 0U) {
+        return;
+    }
+    while (bsp_time_us() < deadline_us) {
+        bsp_time_idle_until(deadline_us, NULL);
+    }
+}
+
+void bsp_time_delay_us(uint32_t us)
+{
+    wait_until(bsp_time_us() + us);
+}
+
+void bsp_time_delay_ms(uint32_t ms)
+{
+    wait_until(bsp_time_us() + (uint64_t)ms * 1000U);
+}
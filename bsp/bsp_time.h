@@ -0,0 +1,58 @@
+/*
+ * bsp_time.h - Board Support Package: Monotonic Time Base
+ *
+ * A BSP_TICK_HZ system tick (SysTick on target) extended to a 64-bit
+ * microsecond clock that never wraps in practice.
+ *
+ * Waiting is done by sleeping, not spinning: bsp_time_idle_until()
+ * stops the periodic tick, programs a single wake-up for the deadline
+ * (tickless idle) and executes WFI, so the core only wakes for the
+ * deadline or for an interrupt. Any interrupt ends the idle early; the
+ * tick count is corrected for the time spent asleep.
+ *
+ * The host build (BOARD=host) implements the same API on
+ * clock_gettime(CLOCK_MONOTONIC) and clock_nanosleep().
+ */
+
+#ifndef BSP_TIME_H
+#define BSP_TIME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/error.h"
+
+/* Time Base Initialization (after bsp_clock_init()) */
+error_t bsp_time_init(void);
+
+/* Monotonic time since bsp_time_init() */
+uint64_t bsp_time_us(void);
+uint32_t bsp_time_ms(void);             /* Wraps after ~49 days */
+
+/* Sleep until deadline_us (bsp_time_us() scale) or the next interrupt.
+ * Returns at once if the deadline has passed. Callers wanting the full
+ * wait loop on the deadline.
+ *
+ * work_pending (may be NULL) is called with interrupts masked right
+ * before sleeping; if it returns true the call returns instead, so work
+ * posted by an interrupt after the caller's last check is not slept
+ * through.
+ */
+void bsp_time_idle_until(uint64_t deadline_us, bool (*work_pending)(void));
+
+/* End an idle in progress from another context, after posting the work
+ * it should notice. On target any interrupt does that already and this
+ * is empty; the host's simulated interrupts run on threads and need it. */
+void bsp_time_wake(void);
+
+/* Stop mode, interrupts masked: the core clock and the tick halt, so
+ * bsp_time_stop() freezes the time base and bsp_time_resume() restarts
+ * it slept_us later, as measured on a clock that kept running. No-ops
+ * on the host, whose clock never stops. */
+void bsp_time_stop(void);
+void bsp_time_resume(uint64_t slept_us);
+
+/* Sleeping delays */
+void bsp_time_delay_us(uint32_t us);
+void bsp_time_delay_ms(uint32_t ms);
+
+#endif /* BSP_TIME_H */
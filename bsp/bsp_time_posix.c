@@ -0,0 +1,126 @@
+/*
+ * bsp_time_posix.c - Monotonic Time Base for the host (BOARD=host) build
+ *
+ * Time is CLOCK_MONOTONIC relative to bsp_time_init(); idling is a
+ * timed wait on a CLOCK_MONOTONIC condition variable. The simulated
+ * interrupts run on their own threads and only end the wait through
+ * bsp_time_wake() (the app calls it for every event published); otherwise
+ * idle wakes at least once per tick, like WFI without tickless idle,
+ * for callers to notice their work. bsp_time_wake() also ends a
+ * modelled Stop (bsp_power.c).
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bsp_time.h"
+#include "bsp_power.h"
+#include "board_config.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <time.h>
+
+#define US_PER_TICK     (1000000UL / BSP_TICK_HZ)
+
+static uint64_t epoch_ns;
+static pthread_mutex_t idle_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t idle_cond;
+static pthread_once_t idle_once = PTHREAD_ONCE_INIT;
+static bool idle_woken;                 /* bsp_time_wake() since the last idle */
+
+static void idle_create(void)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&idle_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+error_t bsp_time_init(void)
+{
+    epoch_ns = monotonic_ns();
+    return ERR_OK;
+}
+
+uint64_t bsp_time_us(void)
+{
+    return (monotonic_ns() - epoch_ns) / 1000U;
+}
+
+uint32_t bsp_time_ms(void)
+{
+    return (uint32_t)(bsp_time_us() / 1000U);
+}
+
+void bsp_time_idle_until(uint64_t deadline_us, bool (*work_pending)(void))
+{
+    uint64_t now = bsp_time_us();
+    uint64_t abs_ns;
+    struct timespec ts;
+
+    if (deadline_us <= now || (work_pending != NULL && work_pending())) {
+        return;
+    }
+    if (deadline_us - now > US_PER_TICK) {
+        deadline_us = now + US_PER_TICK;
+    }
+    abs_ns = epoch_ns + deadline_us * 1000U;
+    ts.tv_sec = (time_t)(abs_ns / 1000000000ULL);
+    ts.tv_nsec = (long)(abs_ns % 1000000000ULL);
+
+    (void)pthread_once(&idle_once, idle_create);
+    pthread_mutex_lock(&idle_lock);
+    while (!idle_woken && monotonic_ns() < abs_ns) {
+        (void)pthread_cond_timedwait(&idle_cond, &idle_lock, &ts);
+    }
+    idle_woken = false;
+    pthread_mutex_unlock(&idle_lock);
+}
+
+void bsp_time_wake(void)
+{
+    /* On target a pending interrupt keeps a Stop from sleeping too */
+    bsp_power_wake(POWER_WAKE_OTHER);
+
+    (void)pthread_once(&idle_once, idle_create);
+    pthread_mutex_lock(&idle_lock);
+    idle_woken = true;
+    pthread_cond_signal(&idle_cond);
+    pthread_mutex_unlock(&idle_lock);
+}
+
+void bsp_time_stop(void)
+{
+}
+
+void bsp_time_resume(uint64_t slept_us)
+{
+    (void)slept_us;
+}
+
+static void wait_until(uint64_t deadline_us)
+{
+    while (bsp_time_us() < deadline_us) {
+        bsp_time_idle_until(deadline_us, NULL);
+    }
+}
+
+void bsp_time_delay_us(uint32_t us)
+{
+    wait_until(bsp_time_us() + us);
+}
+
+void bsp_time_delay_ms(uint32_t ms)
+{
+    wait_until(bsp_time_us() + (uint64_t)ms * 1000U);
+}
@@ -0,0 +1,93 @@
+/*
+ * bsp_watchdog.c - Independent Watchdog (IWDG) on the STM32F4
+ *
+ * Timeout = (RLR + 1) * 4 * 2^PR / f_LSI. The smallest prescaler whose
+ * 12-bit reload covers the timeout is used, for the finest step.
+ * Register writes to PR/RLR need the 0x5555 unlock and take a few LSI
+ * cycles to reach the LSI domain (SR.PVU/RVU); the reload that follows
+ * waits for them so the new setting is the one being counted.
+ */
+
+#include <stddef.h>
+#include "bsp_watchdog.h"
+
+/* ===== STM32F4 IWDG / RCC / DBGMCU Registers ===== */
+#define IWDG_KR             (*(volatile uint32_t *)0x40003000UL)
+#define IWDG_PR             (*(volatile uint32_t *)0x40003004UL)
+#define IWDG_RLR            (*(volatile uint32_t *)0x40003008UL)
+#define IWDG_SR             (*(volatile uint32_t *)0x4000300CUL)
+#define RCC_CSR             (*(volatile uint32_t *)0x40023874UL)
+#define DBGMCU_APB1_FZ      (*(volatile uint32_t *)0xE0042008UL)
+
+#define IWDG_KEY_RELOAD     0xAAAAUL
+#define IWDG_KEY_UNLOCK     0x5555UL
+#define IWDG_KEY_START      0xCCCCUL
+#define IWDG_SR_BUSY        0x3UL           /* PVU | RVU */
+#define IWDG_RLR_MAX        0x0FFFUL
+#define IWDG_PR_MAX         6U              /* /256 */
+#define RCC_CSR_RMVF        (1UL << 24)
+#define RCC_CSR_IWDGRSTF    (1UL << 29)
+#define DBG_IWDG_STOP       (1UL << 12)
+
+#define LSI_HZ              32000UL
+
+static bool watchdog_reset_read;
+static bool watchdog_reset;
+
+error_t bsp_watchdog_start(uint32_t timeout_ms)
+{
+    uint32_t prescaler = 0;
+    uint64_t ticks;
+
+    if (timeout_ms == 0U || timeout_ms > BSP_WATCHDOG_MAX_TIMEOUT_MS) {
+        return ERR_INVALID_PARAM;
+    }
+
+    /* LSI ticks at /4, halved per prescaler step until the reload fits */
+    ticks = ((uint64_t)timeout_ms * LSI_HZ / 1000U + 3U) / 4U;
+    while (ticks > IWDG_RLR_MAX + 1U && prescaler < IWDG_PR_MAX) {
+        ticks = (ticks + 1U) / 2U;
+        prescaler++;
+    }
+    if (ticks > IWDG_RLR_MAX + 1U) {
+        ticks = IWDG_RLR_MAX + 1U;
+    }
+
+#if !defined(BOARD_HOST)
+#ifdef DEBUG
+    DBGMCU_APB1_FZ |= DBG_IWDG_STOP;
+#endif
+    IWDG_KR = IWDG_KEY_START;
+    IWDG_KR = IWDG_KEY_UNLOCK;
+    IWDG_PR = prescaler;
+    IWDG_RLR = (uint32_t)ticks - 1U;
+    while ((IWDG_SR & IWDG_SR_BUSY) != 0U) {
+    }
+    IWDG_KR = IWDG_KEY_RELOAD;
+#endif
+    return ERR_OK;
+}
+
+void bsp_watchdog_kick(void)
+{
+#if !defined(BOARD_HOST)
+    IWDG_KR = IWDG_KEY_RELOAD;
+#endif
+}
+
+bool bsp_watchdog_caused_reset(void)
+{
+    if (!watchdog_reset_read) {
+#if !defined(BOARD_HOST)
+        watchdog_reset = (RCC_CSR & RCC_CSR_IWDGRSTF) != 0U;
+        RCC_CSR |= RCC_CSR_RMVF;
+#endif
+        watchdog_reset_read = true;
+    }
+    return watchdog_reset;
+}
+
+bool bsp_watchdog_expired(void)
+{
+    return false;
+}
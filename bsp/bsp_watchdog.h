@@ -0,0 +1,44 @@
+/*
+ * bsp_watchdog.h - Board Support Package: Independent Watchdog
+ *
+ * The IWDG runs from the LSI oscillator, independent of the clock
+ * profile and of anything the core does: once started it cannot be
+ * stopped, and unless it is kicked within the timeout it resets the
+ * chip. The LSI is only specified to 17-47 kHz (32 kHz nominal), so
+ * the real timeout may be 0.7x-1.9x the requested one; leave margin.
+ *
+ * In debug builds the watchdog is frozen while the core is halted, so
+ * a breakpoint does not reset the board.
+ *
+ * The host build (BOARD=host) models the timeout on CLOCK_MONOTONIC but
+ * does not reset: an expiry is latched and reported by
+ * bsp_watchdog_expired().
+ */
+
+#ifndef BSP_WATCHDOG_H
+#define BSP_WATCHDOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/error.h"
+
+/* Longest timeout: 4096 ticks of LSI / 256 */
+#define BSP_WATCHDOG_MAX_TIMEOUT_MS     32768U
+
+/* Start the watchdog; ERR_INVALID_PARAM if timeout_ms is 0 or above
+ * BSP_WATCHDOG_MAX_TIMEOUT_MS. Later calls only change the timeout. */
+error_t bsp_watchdog_start(uint32_t timeout_ms);
+
+/* Restart the timeout; any context */
+void bsp_watchdog_kick(void);
+
+/* Whether the last reset was done by the watchdog. The hardware flags
+ * are read and cleared by the first call; later calls repeat its
+ * answer. */
+bool bsp_watchdog_caused_reset(void);
+
+/* Whether the timeout has run out since start (host model only; a
+ * target that expires has reset) */
+bool bsp_watchdog_expired(void);
+
+#endif /* BSP_WATCHDOG_H */
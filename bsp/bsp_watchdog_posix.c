@@ -0,0 +1,63 @@
+/*
+ * bsp_watchdog_posix.c - Watchdog model for the host (BOARD=host) build
+ *
+ * Nothing is reset: the deadline is kept as a CLOCK_MONOTONIC time and
+ * an expiry is latched when it is found passed, at the next kick or
+ * query. A process that stops kicking for good is therefore only seen
+ * as expired when something asks.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bsp_watchdog.h"
+
+#include <stdatomic.h>
+#include <time.h>
+
+static _Atomic uint64_t watchdog_timeout_ns;    /* 0 = not started */
+static _Atomic uint64_t watchdog_deadline_ns;
+static _Atomic bool watchdog_expired;
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void watchdog_check(uint64_t now)
+{
+    if (atomic_load(&watchdog_timeout_ns) != 0U && now > atomic_load(&watchdog_deadline_ns)) {
+        atomic_store(&watchdog_expired, true);
+    }
+}
+
+error_t bsp_watchdog_start(uint32_t timeout_ms)
+{
+    if (timeout_ms == 0U || timeout_ms > BSP_WATCHDOG_MAX_TIMEOUT_MS) {
+        return ERR_INVALID_PARAM;
+    }
+    atomic_store(&watchdog_deadline_ns, monotonic_ns() + (uint64_t)timeout_ms * 1000000U);
+    atomic_store(&watchdog_timeout_ns, (uint64_t)timeout_ms * 1000000U);
+    return ERR_OK;
+}
+
+void bsp_watchdog_kick(void)
+{
+    uint64_t now = monotonic_ns();
+
+    watchdog_check(now);
+    atomic_store(&watchdog_deadline_ns, now + atomic_load(&watchdog_timeout_ns));
+}
+
+bool bsp_watchdog_caused_reset(void)
+{
+    return false;
+}
+
+bool bsp_watchdog_expired(void)
+{
+    watchdog_check(monotonic_ns());
+    return atomic_load(&watchdog_expired);
+}
@@ -14,7 +14,11 @@ PROJECT_NAME="embedded_firmware"
 
 # ===== DEFAULT CONFIGURATION =====
 BOARD="${BOARD:-STM32F412ZET6}"
-HAL="${HAL:-stm32_hal}"
+if [ "$BOARD" = "host" ]; then
+    HAL="${HAL:-posix}"
+else
+    HAL="${HAL:-stm32_hal}"
+fi
 MODE="${MODE:-debug}"
 JOBS="${JOBS:-$(nproc)}"
 
@@ -53,21 +57,25 @@ Usage: ./build.sh [OPTIONS]
 
 Options:
   BOARD=<name>     Target board (default: STM32F412ZET6)
-  HAL=<type>       HAL implementation (default: stm32_hal)
-                   Options: stm32_hal, ll, opencm3
+                   Use BOARD=host for a native Linux build
+  HAL=<type>       HAL implementation (default: stm32_hal, posix for host)
+                   Options: stm32_hal, ll, opencm3, posix
   MODE=<mode>      Build mode (default: debug)
-                   Options: debug, release
+                   Options: debug, release, perf
   JOBS=<n>         Number of parallel build jobs (default: auto-detect)
   
 Special Targets:
   ./build.sh clean           Clean build artifacts
   ./build.sh distclean       Deep clean (build + intermediate files)
+  ./build.sh bench           Run the host benchmarks against this machine's baseline
+  ./build.sh test            Build and run the host tests
   ./build.sh info            Show configuration
   ./build.sh help            Show this help
 
 Examples:
   ./build.sh
   ./build.sh BOARD=STM32F412ZET6 HAL=stm32_hal MODE=release
+  ./build.sh BOARD=host
   ./build.sh clean
   ./build.sh info
 
@@ -79,10 +87,14 @@ validate_board() {
         STM32F412ZET6)
             print_info "Board: $1 (STM32F412ZET6 - 256KB Flash, 192KB RAM)"
             ;;
+        host)
+            print_info "Board: $1 (native Linux build for benchmarking and CI)"
+            ;;
         *)
             print_error "Unknown board: $1"
             echo "Supported boards:"
             echo "  - STM32F412ZET6"
+            echo "  - host"
             exit 1
             ;;
     esac
@@ -99,12 +111,16 @@ validate_hal() {
         opencm3)
             print_info "HAL: libopencm3"
             ;;
+        posix)
+            print_info "HAL: POSIX (in-memory GPIO, socketpair UARTs)"
+            ;;
         *)
             print_error "Unknown HAL: $1"
             echo "Supported HALs:"
             echo "  - stm32_hal (STM32Cube)"
             echo "  - ll        (STM32 Low-Level)"
             echo "  - opencm3   (libopencm3)"
+            echo "  - posix     (host backend)"
             exit 1
             ;;
     esac
@@ -118,11 +134,15 @@ validate_mode() {
         release)
             print_info "Mode: Release (optimized, no symbols)"
             ;;
+        perf)
+            print_info "Mode: Perf (release + LTO, hot code in SRAM)"
+            ;;
         *)
             print_error "Unknown mode: $1"
             echo "Supported modes:"
             echo "  - debug    (Development)"
             echo "  - release  (Production)"
+            echo "  - perf     (Production, lowest ISR latency)"
             exit 1
             ;;
     esac
@@ -139,16 +159,22 @@ build_project() {
         print_success "Build completed successfully"
         
         # Show build information
-        BUILD_DIR="build/$BOARD/$MODE/output"
+        # Same directory as the Makefile's BUILD_DIR_FOR
+        case "$HAL" in
+            stm32_hal|posix) BUILD_DIR="build/$BOARD/$MODE/output" ;;
+            *)               BUILD_DIR="build/$BOARD/$MODE-$HAL/output" ;;
+        esac
         if [ -f "$BUILD_DIR/${PROJECT_NAME}.elf" ]; then
             print_info "Output files:"
             echo "  ELF:  $BUILD_DIR/${PROJECT_NAME}.elf"
-            echo "  BIN:  $BUILD_DIR/${PROJECT_NAME}.bin"
+            if [ "$BOARD" != "host" ]; then
+                echo "  BIN:  $BUILD_DIR/${PROJECT_NAME}.bin"
+            fi
             echo "  MAP:  $BUILD_DIR/${PROJECT_NAME}.map"
             
             # Show size information
             print_info "Binary size:"
-            arm-none-eabi-size "$BUILD_DIR/${PROJECT_NAME}.elf" 2>/dev/null || true
+            "$SIZE_TOOL" "$BUILD_DIR/${PROJECT_NAME}.elf" 2>/dev/null || true
         fi
     else
         print_error "Build failed"
@@ -177,6 +203,28 @@ case "${1:-}" in
         make info BOARD="$BOARD" HAL="$HAL" MODE="$MODE"
         exit 0
         ;;
+    bench)
+        cd "$SCRIPT_DIR"
+        # make bench defaults to the optimized host build
+        if make bench; then
+            print_success "Benchmarks within baseline"
+        else
+            print_error "Benchmark regression (see above)"
+            exit 1
+        fi
+        exit 0
+        ;;
+    test)
+        cd "$SCRIPT_DIR"
+        # make test defaults to the optimized host build
+        if make test; then
+            print_success "All host tests passed"
+        else
+            print_error "Host tests failed (see above)"
+            exit 1
+        fi
+        exit 0
+        ;;
     help|--help|-h)
         show_help
         exit 0
@@ -201,12 +249,21 @@ echo ""
 
 # Check toolchain
 print_header "Checking Toolchain"
-if command -v arm-none-eabi-gcc &> /dev/null; then
-    GCC_VERSION=$(arm-none-eabi-gcc --version | head -n1)
+if [ "$BOARD" = "host" ]; then
+    TOOLCHAIN_GCC="gcc"
+    SIZE_TOOL="size"
+else
+    TOOLCHAIN_GCC="arm-none-eabi-gcc"
+    SIZE_TOOL="arm-none-eabi-size"
+fi
+if command -v "$TOOLCHAIN_GCC" &> /dev/null; then
+    GCC_VERSION=$("$TOOLCHAIN_GCC" --version | head -n1)
     print_success "Toolchain found: $GCC_VERSION"
 else
-    print_error "ARM toolchain not found (arm-none-eabi-gcc)"
-    echo "Please install: apt-get install gcc-arm-none-eabi"
+    print_error "Toolchain not found ($TOOLCHAIN_GCC)"
+    if [ "$BOARD" != "host" ]; then
+        echo "Please install: apt-get install gcc-arm-none-eabi"
+    fi
     exit 1
 fi
 echo ""
@@ -0,0 +1,185 @@
+/*
+ * binlog.c - Deferred Binary Logging Implementation
+ *
+ * The ring holds word records: header, timestamp, then the arguments.
+ * Writers reserve a record with a compare-exchange on head, fill it and
+ * publish it by storing the header last (release); headers always have
+ * BINLOG_HEADER_VALID set, so a zero word at tail means the record
+ * there is reserved but not yet complete. The drain zeroes every word
+ * it consumes before handing it back by advancing tail, which keeps
+ * that invariant across laps.
+ */
+
+#include "binlog.h"
+#include "hot_path.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define BINLOG_RING_MASK        (BINLOG_RING_WORDS - 1U)
+#define BINLOG_HEADER_VALID     (1UL << 31)
+#define BINLOG_HEADER_NARGS(h)  (((h) >> 16) & 0xFFU)
+#define BINLOG_HEADER_ID(h)     ((h) & 0xFFFFU)
+
+_Static_assert((BINLOG_RING_WORDS & BINLOG_RING_MASK) == 0U,
+               "BINLOG_RING_WORDS must be a power of two");
+
+typedef struct {
+    _Atomic uint32_t ring[BINLOG_RING_WORDS];
+    _Atomic uint32_t head;          /* Next word to reserve */
+    _Atomic uint32_t tail;          /* Oldest unconsumed word (drain owned) */
+    _Atomic uint32_t dropped;       /* Records lost to a full ring */
+    uint32_t dropped_reported;      /* Drain owned */
+    uint32_t last_timestamp;        /* Drain owned, base of dt_us */
+    binlog_clock_fn_t clock;
+} binlog_state_t;
+
+static binlog_state_t binlog;
+
+void binlog_init(void)
+{
+    for (uint32_t i = 0; i < BINLOG_RING_WORDS; i++) {
+        atomic_store_explicit(&binlog.ring[i], 0U, memory_order_relaxed);
+    }
+    atomic_store_explicit(&binlog.dropped, 0U, memory_order_relaxed);
+    binlog.dropped_reported = 0;
+    binlog.last_timestamp = 0;
+    atomic_store_explicit(&binlog.tail, 0U, memory_order_relaxed);
+    atomic_store_explicit(&binlog.head, 0U, memory_order_release);
+}
+
+void binlog_set_clock(binlog_clock_fn_t clock)
+{
+    binlog.clock = clock;
+}
+
+HOT_FUNC void binlog_write(uint32_t id, const uint32_t *args, uint32_t nargs)
+{
+    binlog_clock_fn_t clock = binlog.clock;
+    uint32_t head = atomic_load_explicit(&binlog.head, memory_order_relaxed);
+    uint32_t words;
+
+    if (nargs > BINLOG_MAX_ARGS) {
+        nargs = BINLOG_MAX_ARGS;
+    }
+    words = nargs + 2U;
+
+    do {
+        uint32_t tail = atomic_load_explicit(&binlog.tail, memory_order_acquire);
+
+        if (BINLOG_RING_WORDS - (head - tail) < words) {
+            atomic_fetch_add_explicit(&binlog.dropped, 1U, memory_order_relaxed);
+            return;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&binlog.head, &head, head + words,
+                                                    memory_order_relaxed,
+                                                    memory_order_relaxed));
+
+    atomic_store_explicit(&binlog.ring[(head + 1U) & BINLOG_RING_MASK],
+                          (clock != NULL) ? clock() : 0U, memory_order_relaxed);
+    for (uint32_t i = 0; i < nargs; i++) {
+        atomic_store_explicit(&binlog.ring[(head + 2U + i) & BINLOG_RING_MASK], args[i],
+                              memory_order_relaxed);
+    }
+    atomic_store_explicit(&binlog.ring[head & BINLOG_RING_MASK],
+                          (uint32_t)BINLOG_HEADER_VALID | (nargs << 16) | (id & 0xFFFFU),
+                          memory_order_release);
+}
+
+/* ===== Drain ===== */
+
+/* Unsigned LEB128; returns the bytes used (1-5) */
+static uint32_t binlog_put_var(uint8_t *p, uint32_t value)
+{
+    uint32_t n = 0;
+
+    while (value >= 0x80U) {
+        p[n++] = (uint8_t)(value | 0x80U);
+        value >>= 7;
+    }
+    p[n++] = (uint8_t)value;
+    return n;
+}
+
+static uint32_t binlog_frame_header(uint8_t *frame, uint32_t id, uint32_t nargs,
+                                    uint32_t timestamp)
+{
+    frame[0] = BINLOG_FRAME_SYNC;
+    frame[1] = (uint8_t)id;
+    frame[2] = (uint8_t)(id >> 8);
+    frame[3] = (uint8_t)nargs;
+    return 4U + binlog_put_var(&frame[4], timestamp - binlog.last_timestamp);
+}
+
+uint32_t binlog_drain(binlog_sink_fn_t sink, void *context)
+{
+    uint8_t frame[BINLOG_FRAME_MAX];
+    uint32_t frames = 0;
+    uint32_t dropped;
+
+    if (sink == NULL) {
+        return 0;
+    }
+
+    /* Losses first, so the gap shows where it happened. Stamped with the
+     * previous frame's time: the clock now is ahead of the records still
+     * queued, and stamping with it would send their dt_us backwards */
+    dropped = atomic_load_explicit(&binlog.dropped, memory_order_relaxed);
+    if (dropped != binlog.dropped_reported) {
+        uint32_t length = binlog_frame_header(frame, BINLOG_ID_DROPPED, 1U,
+                                              binlog.last_timestamp);
+
+        length += binlog_put_var(&frame[length], dropped - binlog.dropped_reported);
+        if (!sink(frame, length, context)) {
+            return 0;
+        }
+        binlog.dropped_reported = dropped;
+        frames++;
+    }
+
+    for (;;) {
+        uint32_t tail = atomic_load_explicit(&binlog.tail, memory_order_relaxed);
+        uint32_t header = atomic_load_explicit(&binlog.ring[tail & BINLOG_RING_MASK],
+                                               memory_order_acquire);
+        uint32_t nargs = BINLOG_HEADER_NARGS(header);
+        uint32_t timestamp;
+        uint32_t length;
+
+        if (header == 0U) {
+            break;
+        }
+
+        timestamp = atomic_load_explicit(&binlog.ring[(tail + 1U) & BINLOG_RING_MASK],
+                                         memory_order_relaxed);
+        length = binlog_frame_header(frame, BINLOG_HEADER_ID(header), nargs, timestamp);
+        for (uint32_t i = 0; i < nargs; i++) {
+            length += binlog_put_var(&frame[length],
+                atomic_load_explicit(&binlog.ring[(tail + 2U + i) & BINLOG_RING_MASK],
+                                     memory_order_relaxed));
+        }
+        if (!sink(frame, length, context)) {
+            break;
+        }
+        binlog.last_timestamp = timestamp;
+
+        for (uint32_t i = 0; i < nargs + 2U; i++) {
+            atomic_store_explicit(&binlog.ring[(tail + i) & BINLOG_RING_MASK], 0U,
+                                  memory_order_relaxed);
+        }
+        atomic_store_explicit(&binlog.tail, tail + nargs + 2U, memory_order_release);
+        frames++;
+    }
+    return frames;
+}
+
+bool binlog_pending(void)
+{
+    return atomic_load_explicit(&binlog.head, memory_order_relaxed) !=
+               atomic_load_explicit(&binlog.tail, memory_order_relaxed) ||
+           atomic_load_explicit(&binlog.dropped, memory_order_relaxed) !=
+               binlog.dropped_reported;
+}
+
+uint32_t binlog_get_dropped(void)
+{
+    return atomic_load_explicit(&binlog.dropped, memory_order_relaxed);
+}
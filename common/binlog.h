@@ -0,0 +1,111 @@
+/*
+ * binlog.h - Deferred Binary Logging
+ *
+ * BINLOGn(fmt, a1..an) costs a ring reservation and n + 2 word stores:
+ * no formatting, no strlen, no UART access. The format string never
+ * reaches the target's output. It is placed in the "binlog_fmt" section
+ * and the record carries only its offset there (the message ID), a
+ * timestamp and the raw argument words.
+ *
+ * binlog_drain() runs later from a low-priority task and turns records
+ * into frames:
+ *
+ *   [BINLOG_FRAME_SYNC] [id:16 LE] [nargs:8] [dt_us:var] [arg:var]*nargs
+ *
+ * var is an unsigned LEB128 (7 bits per byte, low first, 1-5 bytes) and
+ * dt_us the time since the previous frame, so a typical record costs
+ * 6-10 bytes on the wire against 20-60 for the same line as text.
+ * dt_us is a 32-bit difference and is read back as signed: a writer
+ * interrupted between reserving its record and reading the clock stamps
+ * it earlier than the record before it.
+ *
+ * tools/binlog_decode.py reads the binlog_fmt section back out of the
+ * firmware ELF and prints the frames as text.
+ *
+ * Arguments are integer words (the decoder understands %d %i %u %x %X
+ * %o %c %p and their length modifiers). Strings cannot be logged: only
+ * their address would reach the host.
+ *
+ * Any context may log, including ISRs and several host threads. When
+ * the ring is full the record is dropped and counted; the drain reports
+ * the count as a BINLOG_ID_DROPPED frame, stamped with the time of the
+ * frame before it (dt_us 0).
+ */
+
+#ifndef COMMON_BINLOG_H
+#define COMMON_BINLOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "error.h"
+
+#define BINLOG_RING_WORDS       256U    /* Power of two */
+#define BINLOG_MAX_ARGS         4U
+#define BINLOG_FRAME_SYNC       0xB1U
+#define BINLOG_FRAME_MAX        (4U + 5U * (1U + BINLOG_MAX_ARGS))
+#define BINLOG_ID_DROPPED       0xFFFFU /* One argument: records lost */
+
+/* Frame sink: returns false if the frame cannot be taken whole right now;
+ * the drain stops and retries the record next time */
+typedef bool (*binlog_sink_fn_t)(const uint8_t *frame, uint32_t length, void *context);
+
+/* Timestamp source (microseconds) */
+typedef uint32_t (*binlog_clock_fn_t)(void);
+
+/* Start of the format string section, provided by the linker */
+extern const char __start_binlog_fmt[];
+
+#define BINLOG_DEFINE_FMT_(fmt) \
+    static const char binlog_fmt_[] __attribute__((section("binlog_fmt"), used)) = fmt
+
+#define BINLOG_ID_ (uint32_t)(binlog_fmt_ - __start_binlog_fmt)
+
+#define BINLOG0(fmt) \
+    do { \
+        BINLOG_DEFINE_FMT_(fmt); \
+        binlog_write(BINLOG_ID_, NULL, 0U); \
+    } while (0)
+
+#define BINLOG1(fmt, a1) \
+    do { \
+        BINLOG_DEFINE_FMT_(fmt); \
+        const uint32_t binlog_args_[] = { (uint32_t)(a1) }; \
+        binlog_write(BINLOG_ID_, binlog_args_, 1U); \
+    } while (0)
+
+#define BINLOG2(fmt, a1, a2) \
+    do { \
+        BINLOG_DEFINE_FMT_(fmt); \
+        const uint32_t binlog_args_[] = { (uint32_t)(a1), (uint32_t)(a2) }; \
+        binlog_write(BINLOG_ID_, binlog_args_, 2U); \
+    } while (0)
+
+#define BINLOG3(fmt, a1, a2, a3) \
+    do { \
+        BINLOG_DEFINE_FMT_(fmt); \
+        const uint32_t binlog_args_[] = { (uint32_t)(a1), (uint32_t)(a2), (uint32_t)(a3) }; \
+        binlog_write(BINLOG_ID_, binlog_args_, 3U); \
+    } while (0)
+
+#define BINLOG4(fmt, a1, a2, a3, a4) \
+    do { \
+        BINLOG_DEFINE_FMT_(fmt); \
+        const uint32_t binlog_args_[] = { (uint32_t)(a1), (uint32_t)(a2), \
+                                          (uint32_t)(a3), (uint32_t)(a4) }; \
+        binlog_write(BINLOG_ID_, binlog_args_, 4U); \
+    } while (0)
+
+void binlog_init(void);
+void binlog_set_clock(binlog_clock_fn_t clock);
+
+/* Hot path, used through the BINLOGn macros */
+void binlog_write(uint32_t id, const uint32_t *args, uint32_t nargs);
+
+/* Consumer side (one context): emit queued records to sink, oldest
+ * first. Returns the number of frames taken. */
+uint32_t binlog_drain(binlog_sink_fn_t sink, void *context);
+
+bool binlog_pending(void);
+uint32_t binlog_get_dropped(void);
+
+#endif /* COMMON_BINLOG_H */
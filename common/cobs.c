@@ -0,0 +1,184 @@
+/*
+ * cobs.c - Consistent Overhead Byte Stuffing Implementation
+ *
+ * Encoding: every block is a code byte n (1-255) followed by n - 1 data
+ * bytes; a code below 255 stands for a zero after its data, except at
+ * the very end of the frame.
+ */
+
+#include "cobs.h"
+#include <stddef.h>
+#include <string.h>
+
+#define COBS_BLOCK_MAX          255U
+
+/* ===== Encoder ===== */
+
+static void cobs_encode_put(cobs_encoder_t *enc, uint8_t byte)
+{
+    if (enc->length < enc->capacity) {
+        enc->out[enc->length] = byte;
+    } else {
+        enc->overflow = true;
+    }
+    enc->length++;
+}
+
+static void cobs_encode_close_block(cobs_encoder_t *enc)
+{
+    uint32_t code = enc->length - enc->code_index;
+
+    if (enc->code_index < enc->capacity) {
+        enc->out[enc->code_index] = (uint8_t)code;
+    }
+    enc->code_index = enc->length;
+    cobs_encode_put(enc, 0);    /* Placeholder for the next code */
+}
+
+void cobs_encode_begin(cobs_encoder_t *enc, uint8_t *out, uint32_t capacity)
+{
+    enc->out = out;
+    enc->capacity = capacity;
+    enc->length = 0;
+    enc->code_index = 0;
+    enc->overflow = false;
+    cobs_encode_put(enc, 0);
+}
+
+void cobs_encode_update(cobs_encoder_t *enc, const uint8_t *data, uint32_t length)
+{
+    const uint8_t *end = data + length;
+
+    while (data < end) {
+        /* Longest run of non-zero bytes the open block can still take */
+        uint32_t room = COBS_BLOCK_MAX - (enc->length - enc->code_index);
+        uint32_t span = (uint32_t)(end - data);
+        const uint8_t *zero;
+        uint32_t run;
+
+        if (span > room) {
+            span = room;
+        }
+        zero = memchr(data, 0, span);
+        run = (zero != NULL) ? (uint32_t)(zero - data) : span;
+
+        if (enc->length + run <= enc->capacity) {
+            memcpy(&enc->out[enc->length], data, run);
+        } else {
+            enc->overflow = true;
+        }
+        enc->length += run;
+        data += run;
+
+        if (zero != NULL) {
+            cobs_encode_close_block(enc);
+            data++;
+        } else if (enc->length - enc->code_index == COBS_BLOCK_MAX) {
+            cobs_encode_close_block(enc);
+        }
+    }
+}
+
+uint32_t cobs_encode_end(cobs_encoder_t *enc)
+{
+    uint32_t code = enc->length - enc->code_index;
+
+    if (enc->code_index < enc->capacity) {
+        enc->out[enc->code_index] = (uint8_t)code;
+    }
+    cobs_encode_put(enc, COBS_DELIMITER);
+    return enc->overflow ? 0U : enc->length;
+}
+
+/* ===== Decoder ===== */
+
+static void cobs_decoder_reset(cobs_decoder_t *dec)
+{
+    dec->length = 0;
+    dec->remaining = 0;
+    dec->zero_pending = false;
+    dec->started = false;
+    dec->overflow = false;
+    dec->frame_done = false;
+}
+
+void cobs_decoder_init(cobs_decoder_t *dec, uint8_t *buffer, uint32_t capacity)
+{
+    dec->buffer = buffer;
+    dec->capacity = capacity;
+    cobs_decoder_reset(dec);
+}
+
+static void cobs_decoder_store(cobs_decoder_t *dec, const uint8_t *data, uint32_t length)
+{
+    if (dec->length + length <= dec->capacity) {
+        memcpy(&dec->buffer[dec->length], data, length);
+        dec->length += length;
+    } else {
+        dec->overflow = true;
+    }
+}
+
+uint32_t cobs_decoder_feed(cobs_decoder_t *dec, const uint8_t *data, uint32_t length,
+                           bool *complete, cobs_frame_status_t *status)
+{
+    uint32_t used = 0;
+
+    *complete = false;
+    if (dec->frame_done) {
+        dec->length = 0;
+        dec->frame_done = false;
+    }
+    while (used < length) {
+        if (dec->remaining > 0U) {
+            /* Inside a block: data bytes up to the block end */
+            uint32_t span = length - used;
+            const uint8_t *zero;
+            uint32_t run;
+
+            if (span > dec->remaining) {
+                span = dec->remaining;
+            }
+            zero = memchr(&data[used], COBS_DELIMITER, span);
+            run = (zero != NULL) ? (uint32_t)(zero - &data[used]) : span;
+            cobs_decoder_store(dec, &data[used], run);
+            used += run;
+            dec->remaining = (uint8_t)(dec->remaining - run);
+            if (zero == NULL) {
+                continue;
+            }
+            /* Delimiter inside a block: the frame was cut short */
+            used++;
+            *status = COBS_FRAME_CORRUPT;
+            *complete = true;
+            cobs_decoder_reset(dec);
+            dec->frame_done = true;
+            return used;
+        }
+
+        /* At a code byte, or the delimiter */
+        uint8_t code = data[used++];
+
+        if (code == COBS_DELIMITER) {
+            *status = !dec->started ? COBS_FRAME_EMPTY :
+                      dec->overflow ? COBS_FRAME_OVERFLOW : COBS_FRAME_OK;
+            *complete = true;
+            /* dec->length stays valid until the next feed */
+            dec->remaining = 0;
+            dec->zero_pending = false;
+            dec->started = false;
+            dec->overflow = false;
+            dec->frame_done = true;
+            return used;
+        }
+        if (dec->zero_pending) {
+            const uint8_t zero = 0;
+
+            cobs_decoder_store(dec, &zero, 1U);
+        }
+        dec->started = true;
+        dec->remaining = (uint8_t)(code - 1U);
+        dec->zero_pending = (code < COBS_BLOCK_MAX);
+    }
+    return used;
+}
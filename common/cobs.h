@@ -0,0 +1,74 @@
+/*
+ * cobs.h - Consistent Overhead Byte Stuffing
+ *
+ * COBS rewrites a block so it contains no zero byte, at a cost of one
+ * byte per 254 (plus one), which leaves 0x00 free as an unambiguous
+ * frame delimiter: a receiver that loses sync recovers at the next zero.
+ *
+ * Both directions are incremental. The encoder takes a frame in any
+ * number of spans (payload, then a trailer, without gathering them
+ * first). The decoder takes the received byte stream in whatever spans
+ * arrive and stops at each delimiter with the decoded frame in its
+ * buffer; runs of data bytes are moved with memchr/memcpy, not byte by
+ * byte.
+ */
+
+#ifndef COMMON_COBS_H
+#define COMMON_COBS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "error.h"
+
+#define COBS_DELIMITER          0x00U
+
+/* Largest encoding of length bytes, without the delimiter */
+#define COBS_ENCODED_MAX(length)    ((length) + (length) / 254U + 1U)
+
+/* ===== Encoder ===== */
+
+typedef struct {
+    uint8_t *out;
+    uint32_t capacity;
+    uint32_t length;            /* Bytes written so far */
+    uint32_t code_index;        /* Where the open block's code byte goes */
+    bool overflow;
+} cobs_encoder_t;
+
+void cobs_encode_begin(cobs_encoder_t *enc, uint8_t *out, uint32_t capacity);
+void cobs_encode_update(cobs_encoder_t *enc, const uint8_t *data, uint32_t length);
+
+/* Closes the frame and appends the delimiter. Returns the total length,
+ * or 0 if out was too small (nothing usable was produced). */
+uint32_t cobs_encode_end(cobs_encoder_t *enc);
+
+/* ===== Decoder ===== */
+
+typedef enum {
+    COBS_FRAME_OK = 0,
+    COBS_FRAME_EMPTY,           /* Delimiter with no data (idle fill) */
+    COBS_FRAME_CORRUPT,         /* Delimiter inside a block: truncated */
+    COBS_FRAME_OVERFLOW         /* Longer than the buffer */
+} cobs_frame_status_t;
+
+typedef struct {
+    uint8_t *buffer;
+    uint32_t capacity;
+    uint32_t length;            /* Decoded bytes of the current frame */
+    uint8_t remaining;          /* Data bytes left in the current block */
+    bool zero_pending;          /* Block ended short: a zero comes next */
+    bool started;
+    bool overflow;
+    bool frame_done;            /* length belongs to a delivered frame */
+} cobs_decoder_t;
+
+void cobs_decoder_init(cobs_decoder_t *dec, uint8_t *buffer, uint32_t capacity);
+
+/* Consume data until the end of the span or the first delimiter.
+ * Returns the bytes consumed; *complete is set when a delimiter was
+ * consumed, and *status says what the frame in dec->buffer[0..length)
+ * is worth. The next call starts a new frame. */
+uint32_t cobs_decoder_feed(cobs_decoder_t *dec, const uint8_t *data, uint32_t length,
+                           bool *complete, cobs_frame_status_t *status);
+
+#endif /* COMMON_COBS_H */
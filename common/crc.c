@@ -0,0 +1,96 @@
+/*
+ * crc.c - Table-driven CRC-16 and CRC-32 Implementation
+ *
+ * table[0] is the classic byte table; table[k][b] is the CRC of byte b
+ * followed by k zero bytes, so the bytes of a word can be looked up
+ * independently and their contributions XORed together.
+ *
+ * Words are loaded little-endian with memcpy (an unaligned LDR on the
+ * Cortex-M4); the loop runs on any alignment.
+ */
+
+#include "crc.h"
+#include <string.h>
+
+#define CRC16_POLY      0x8408U         /* 0x1021 reflected */
+#define CRC32_POLY      0xEDB88320UL    /* 0x04C11DB7 reflected */
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "crc.c: slice kernels assume a little-endian target"
+#endif
+
+static uint16_t crc16_table[4][256];
+static uint32_t crc32_table[8][256];
+
+void crc_init(void)
+{
+    for (uint32_t b = 0; b < 256U; b++) {
+        uint32_t c16 = b;
+        uint32_t c32 = b;
+
+        for (uint32_t bit = 0; bit < 8U; bit++) {
+            c16 = (c16 & 1U) ? (c16 >> 1) ^ CRC16_POLY : c16 >> 1;
+            c32 = (c32 & 1U) ? (c32 >> 1) ^ CRC32_POLY : c32 >> 1;
+        }
+        crc16_table[0][b] = (uint16_t)c16;
+        crc32_table[0][b] = c32;
+    }
+    for (uint32_t b = 0; b < 256U; b++) {
+        for (uint32_t k = 1; k < 4U; k++) {
+            uint16_t prev = crc16_table[k - 1U][b];
+            crc16_table[k][b] = (uint16_t)((prev >> 8) ^ crc16_table[0][prev & 0xFFU]);
+        }
+        for (uint32_t k = 1; k < 8U; k++) {
+            uint32_t prev = crc32_table[k - 1U][b];
+            crc32_table[k][b] = (prev >> 8) ^ crc32_table[0][prev & 0xFFU];
+        }
+    }
+}
+
+uint16_t crc16_update(uint16_t crc, const void *data, uint32_t length)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t c = (uint16_t)~crc;
+
+    for (; length >= 4U; length -= 4U, p += 4) {
+        uint32_t word;
+
+        memcpy(&word, p, sizeof(word));
+        word ^= c;
+        c = (uint32_t)crc16_table[3][word & 0xFFU] ^
+            crc16_table[2][(word >> 8) & 0xFFU] ^
+            crc16_table[1][(word >> 16) & 0xFFU] ^
+            crc16_table[0][word >> 24];
+    }
+    while (length-- > 0U) {
+        c = (c >> 8) ^ crc16_table[0][(c ^ *p++) & 0xFFU];
+    }
+    return (uint16_t)~c;
+}
+
+uint32_t crc32_update(uint32_t crc, const void *data, uint32_t length)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t c = ~crc;
+
+    for (; length >= 8U; length -= 8U, p += 8) {
+        uint32_t lo;
+        uint32_t hi;
+
+        memcpy(&lo, p, sizeof(lo));
+        memcpy(&hi, p + 4, sizeof(hi));
+        lo ^= c;
+        c = crc32_table[7][lo & 0xFFU] ^
+            crc32_table[6][(lo >> 8) & 0xFFU] ^
+            crc32_table[5][(lo >> 16) & 0xFFU] ^
+            crc32_table[4][lo >> 24] ^
+            crc32_table[3][hi & 0xFFU] ^
+            crc32_table[2][(hi >> 8) & 0xFFU] ^
+            crc32_table[1][(hi >> 16) & 0xFFU] ^
+            crc32_table[0][hi >> 24];
+    }
+    while (length-- > 0U) {
+        c = (c >> 8) ^ crc32_table[0][(c ^ *p++) & 0xFFU];
+    }
+    return ~c;
+}
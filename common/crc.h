@@ -0,0 +1,31 @@
+/*
+ * crc.h - Table-driven CRC-16 and CRC-32
+ *
+ * CRC-16/X-25 (the HDLC/PPP frame check: poly 0x1021 reflected, init and
+ * xorout 0xFFFF) and CRC-32/ISO-HDLC (Ethernet, zlib: poly 0x04C11DB7
+ * reflected, init and xorout 0xFFFFFFFF).
+ *
+ * Both kernels are slice-by-N: CRC-16 folds 4 bytes and CRC-32 8 bytes
+ * per step with one table lookup per byte and no dependency between the
+ * lookups of a step, instead of a byte-serial table walk. The tables
+ * (2 KB + 8 KB) are built into SRAM by crc_init(), which must run before
+ * the first CRC is taken.
+ *
+ * Values are always final, so a CRC can be extended over several spans:
+ *
+ *   crc = crc32_update(0, a, len_a);
+ *   crc = crc32_update(crc, b, len_b);   == crc32_update(0, ab, len_ab)
+ */
+
+#ifndef COMMON_CRC_H
+#define COMMON_CRC_H
+
+#include <stdint.h>
+
+void crc_init(void);
+
+/* crc: 0 to start, or a previous result to continue */
+uint16_t crc16_update(uint16_t crc, const void *data, uint32_t length);
+uint32_t crc32_update(uint32_t crc, const void *data, uint32_t length);
+
+#endif /* COMMON_CRC_H */
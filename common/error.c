@@ -1,66 +1,193 @@
 /*
  * error.c - Error Handling Implementation
+ *
+ * The log is a ring of ERROR_LOG_SIZE slots shared by every context.
+ * A writer claims the next global index with atomic_fetch_add, so
+ * concurrent writers (main loop, ISRs, host threads) always land in
+ * distinct slots. Each slot carries a sequence word: odd while its
+ * writer fills it, 2 * (index + 1) once complete. Readers copy the
+ * entry between two reads of that word and discard the copy if it
+ * changed. Only a writer lapped by ERROR_LOG_SIZE newer entries while
+ * still writing could collide, which needs that many nested logs.
  */
 
 #include "error.h"
+#include "event_bus.h"
+#include <stdatomic.h>
+#include <stddef.h>
 
-#define ERROR_LOG_SIZE 32
+#define ERROR_LOG_SIZE 32U
+
+_Static_assert((ERROR_LOG_SIZE & (ERROR_LOG_SIZE - 1U)) == 0U,
+               "ERROR_LOG_SIZE must be a power of two");
+
+/* Per-code counter slots: ERR_OK..ERR_MEMORY, then ERR_UNKNOWN and any
+ * other value */
+#define ERROR_CODE_SLOTS        ((uint32_t)ERR_MEMORY + 2U)
+#define ERROR_SEVERITY_SLOTS    ((uint32_t)SEVERITY_FATAL + 1U)
+
+typedef struct {
+    _Atomic uint32_t seq;
+    error_entry_t entry;
+} error_slot_t;
 
 typedef struct {
-    error_entry_t log[ERROR_LOG_SIZE];
-    uint32_t count;
-    uint32_t last_index;
+    error_slot_t log[ERROR_LOG_SIZE];
+    _Atomic uint32_t next_index;        /* Next index to reserve */
+    _Atomic uint32_t cleared_index;     /* error_clear_last() watermark */
+    _Atomic uint32_t code_count[ERROR_CODE_SLOTS];
+    _Atomic uint32_t severity_count[ERROR_SEVERITY_SLOTS];
+    _Atomic uint32_t severity_mask;     /* Sticky, bit per severity seen */
+    error_clock_fn_t clock;
 } error_manager_t;
 
-static error_manager_t error_mgr = {0};
+static error_manager_t error_mgr;
+
+EVENT_TOPIC_DEFINE(error_topic);
+
+static uint32_t error_code_slot(error_t error_code)
+{
+    return ((uint32_t)error_code <= (uint32_t)ERR_MEMORY) ? (uint32_t)error_code
+                                                          : (ERROR_CODE_SLOTS - 1U);
+}
+
+/* Copy of the entry reserved at index, if complete and not overwritten */
+static bool error_read_slot(uint32_t index, error_entry_t *entry)
+{
+    const error_slot_t *slot = &error_mgr.log[index & (ERROR_LOG_SIZE - 1U)];
+    uint32_t expected = 2U * (index + 1U);
+
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != expected) {
+        return false;
+    }
+    *entry = slot->entry;
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->seq, memory_order_relaxed) == expected;
+}
 
 void error_init(void)
 {
-    error_mgr.count = 0;
-    error_mgr.last_index = 0;
+    for (uint32_t i = 0; i < ERROR_LOG_SIZE; i++) {
+        atomic_store_explicit(&error_mgr.log[i].seq, 0U, memory_order_relaxed);
+    }
+    for (uint32_t i = 0; i < ERROR_CODE_SLOTS; i++) {
+        atomic_store_explicit(&error_mgr.code_count[i], 0U, memory_order_relaxed);
+    }
+    for (uint32_t i = 0; i < ERROR_SEVERITY_SLOTS; i++) {
+        atomic_store_explicit(&error_mgr.severity_count[i], 0U, memory_order_relaxed);
+    }
+    atomic_store_explicit(&error_mgr.severity_mask, 0U, memory_order_relaxed);
+    atomic_store_explicit(&error_mgr.cleared_index, 0U, memory_order_relaxed);
+    atomic_store_explicit(&error_mgr.next_index, 0U, memory_order_release);
+}
+
+void error_set_clock(error_clock_fn_t clock)
+{
+    error_mgr.clock = clock;
 }
 
 void error_log(error_t error_code, error_severity_t severity, uint32_t context)
 {
-    uint32_t idx = error_mgr.last_index % ERROR_LOG_SIZE;
-    
-    error_mgr.log[idx].error_code = error_code;
-    error_mgr.log[idx].severity = severity;
-    error_mgr.log[idx].context = context;
-    error_mgr.log[idx].timestamp = 0;  /* TODO: Use system tick */
-    
-    error_mgr.last_index++;
-    if (error_mgr.count < ERROR_LOG_SIZE) {
-        error_mgr.count++;
+    uint32_t index = atomic_fetch_add_explicit(&error_mgr.next_index, 1U, memory_order_relaxed);
+    error_slot_t *slot = &error_mgr.log[index & (ERROR_LOG_SIZE - 1U)];
+    error_clock_fn_t clock = error_mgr.clock;
+
+    /* Odd sequence: readers skip the slot while it is filled */
+    atomic_store_explicit(&slot->seq, 2U * index + 1U, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->entry.error_code = error_code;
+    slot->entry.severity = severity;
+    slot->entry.context = context;
+    slot->entry.timestamp = (clock != NULL) ? clock() : 0U;
+
+    atomic_store_explicit(&slot->seq, 2U * (index + 1U), memory_order_release);
+
+    atomic_fetch_add_explicit(&error_mgr.code_count[error_code_slot(error_code)], 1U,
+                              memory_order_relaxed);
+    if ((uint32_t)severity < ERROR_SEVERITY_SLOTS) {
+        atomic_fetch_add_explicit(&error_mgr.severity_count[severity], 1U, memory_order_relaxed);
+        atomic_fetch_or_explicit(&error_mgr.severity_mask, ERROR_SEVERITY_BIT(severity),
+                                 memory_order_relaxed);
     }
+
+    /* Counted first: a subscriber sees this entry in the totals */
+    (void)event_publish(&error_topic, ERROR_EVENT(error_code, severity));
 }
 
-error_t error_get_last(void)
+error_t error_get_entry(uint32_t age, error_entry_t *entry)
 {
-    if (error_mgr.count == 0) {
-        return ERR_OK;
+    uint32_t next = atomic_load_explicit(&error_mgr.next_index, memory_order_acquire);
+
+    if (entry == NULL || age >= next || age >= ERROR_LOG_SIZE) {
+        return ERR_INVALID_PARAM;
     }
-    uint32_t idx = (error_mgr.last_index - 1) % ERROR_LOG_SIZE;
-    return error_mgr.log[idx].error_code;
+    return error_read_slot(next - 1U - age, entry) ? ERR_OK : ERR_BUSY;
 }
 
-error_severity_t error_get_last_severity(void)
+/* Newest complete entry logged after the last error_clear_last() */
+static bool error_find_last(error_entry_t *entry)
 {
-    if (error_mgr.count == 0) {
-        return SEVERITY_INFO;
+    uint32_t next = atomic_load_explicit(&error_mgr.next_index, memory_order_acquire);
+    uint32_t cleared = atomic_load_explicit(&error_mgr.cleared_index, memory_order_relaxed);
+
+    for (uint32_t age = 0; age < ERROR_LOG_SIZE && next - age != cleared; age++) {
+        if (error_read_slot(next - 1U - age, entry)) {
+            return true;
+        }
     }
-    uint32_t idx = (error_mgr.last_index - 1) % ERROR_LOG_SIZE;
-    return error_mgr.log[idx].severity;
+    return false;
+}
+
+error_t error_get_last(void)
+{
+    error_entry_t entry;
+
+    return error_find_last(&entry) ? entry.error_code : ERR_OK;
+}
+
+error_severity_t error_get_last_severity(void)
+{
+    error_entry_t entry;
+
+    return error_find_last(&entry) ? entry.severity : SEVERITY_INFO;
 }
 
 uint32_t error_get_count(void)
 {
-    return error_mgr.count;
+    uint32_t next = atomic_load_explicit(&error_mgr.next_index, memory_order_relaxed);
+
+    return (next < ERROR_LOG_SIZE) ? next : ERROR_LOG_SIZE;
 }
 
 void error_clear_last(void)
 {
-    if (error_mgr.count > 0) {
-        error_mgr.count--;
+    atomic_store_explicit(&error_mgr.cleared_index,
+                          atomic_load_explicit(&error_mgr.next_index, memory_order_relaxed),
+                          memory_order_relaxed);
+}
+
+uint32_t error_get_code_count(error_t error_code)
+{
+    return atomic_load_explicit(&error_mgr.code_count[error_code_slot(error_code)],
+                                memory_order_relaxed);
+}
+
+uint32_t error_get_severity_count(error_severity_t severity)
+{
+    if ((uint32_t)severity >= ERROR_SEVERITY_SLOTS) {
+        return 0;
     }
+    return atomic_load_explicit(&error_mgr.severity_count[severity], memory_order_relaxed);
+}
+
+uint32_t error_get_severity_mask(void)
+{
+    return atomic_load_explicit(&error_mgr.severity_mask, memory_order_relaxed);
+}
+
+bool error_fatal_latched(void)
+{
+    return (atomic_load_explicit(&error_mgr.severity_mask, memory_order_relaxed) &
+            ERROR_SEVERITY_BIT(SEVERITY_FATAL)) != 0U;
 }
@@ -39,14 +39,50 @@ typedef struct {
     uint32_t context;            /* Additional context information */
 } error_entry_t;
 
-/* Error Manager */
+/* Every error_log() is also published on error_topic (event_bus.h)
+ * with value ERROR_EVENT(code, severity); the entry's context stays in
+ * the log */
+struct event_topic;
+extern struct event_topic error_topic;
+
+#define ERROR_EVENT(code, severity) (((uint32_t)(severity) << 8) | ((uint32_t)(code) & 0xFFU))
+#define ERROR_EVENT_CODE(value)     ((error_t)((value) & 0xFFU))
+#define ERROR_EVENT_SEVERITY(value) ((error_severity_t)(((value) >> 8) & 0xFFU))
+
+/* Timestamp source for new entries (e.g. a ms tick); 0 until set */
+typedef uint32_t (*error_clock_fn_t)(void);
+
+/* Error Manager
+ * error_log() is lock-free and may be called from any context,
+ * including nested interrupts: each call reserves its own log slot with
+ * one atomic increment and publishes the entry with a sequence number,
+ * so readers never see a half-written entry.
+ */
 void error_init(void);
+void error_set_clock(error_clock_fn_t clock);
 void error_log(error_t error_code, error_severity_t severity, uint32_t context);
 error_t error_get_last(void);
 error_severity_t error_get_last_severity(void);
 uint32_t error_get_count(void);
 void error_clear_last(void);
 
+/* Read back the age-th newest entry (0 = newest). ERR_INVALID_PARAM if
+ * no such entry is held, ERR_BUSY if it is being overwritten. */
+error_t error_get_entry(uint32_t age, error_entry_t *entry);
+
+/* Totals since error_init(), O(1) */
+uint32_t error_get_code_count(error_t error_code);
+uint32_t error_get_severity_count(error_severity_t severity);
+
+/* Sticky severity bitmask: ERROR_SEVERITY_BIT(s) is set by the first
+ * entry of severity s and stays set until error_init(), whatever is
+ * logged or cleared after it. One load; error_fatal_latched() is the
+ * SEVERITY_FATAL bit. */
+#define ERROR_SEVERITY_BIT(severity)    (1U << (uint32_t)(severity))
+
+uint32_t error_get_severity_mask(void);
+bool error_fatal_latched(void);
+
 /* Inline error checking macro */
 #define ERROR_CHECK(expr, error_code) do { \
     if (!(expr)) { \
@@ -0,0 +1,229 @@
+/*
+ * event_bus.c - Publish/Subscribe Event Bus Implementation
+ *
+ * The queue is a bounded array of slots, each with a sequence word
+ * (D. Vyukov's bounded MPMC queue, here with a single consumer). Slot
+ * i & mask is free for the producer of position i when its sequence is
+ * i, and holds that producer's event once it is i + 1. Producers claim a
+ * position with a compare-exchange on head, fill the slot and publish
+ * it by storing the sequence (release); the dispatcher hands the slot to
+ * the next lap by storing i + EVENT_QUEUE_SIZE. A producer interrupted
+ * between claiming and publishing holds back later events until it
+ * resumes, as binlog records do.
+ */
+
+#include "event_bus.h"
+#include "hot_path.h"
+#include <stddef.h>
+
+#define EVENT_QUEUE_MASK        (EVENT_QUEUE_SIZE - 1U)
+
+_Static_assert((EVENT_QUEUE_SIZE & EVENT_QUEUE_MASK) == 0U,
+               "EVENT_QUEUE_SIZE must be a power of two");
+
+typedef struct {
+    _Atomic uint32_t seq;
+    event_topic_t *topic;
+    uint32_t value;
+} event_slot_t;
+
+typedef struct {
+    event_slot_t slots[EVENT_QUEUE_SIZE];
+    _Atomic uint32_t head;          /* Next position to claim */
+    _Atomic uint32_t tail;          /* Next position to dispatch (dispatcher owned) */
+    _Atomic uint32_t high_water;
+    _Atomic bool initialized;
+    event_notify_fn_t notify;
+    void *notify_context;
+} event_bus_t;
+
+static event_bus_t event_bus;
+
+static void event_raise_max(_Atomic uint32_t *max, uint32_t value)
+{
+    uint32_t seen = atomic_load_explicit(max, memory_order_relaxed);
+
+    while (value > seen &&
+           !atomic_compare_exchange_weak_explicit(max, &seen, value, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+void event_bus_init(event_notify_fn_t notify, void *context)
+{
+    atomic_store_explicit(&event_bus.initialized, false, memory_order_relaxed);
+    for (uint32_t i = 0; i < EVENT_QUEUE_SIZE; i++) {
+        atomic_store_explicit(&event_bus.slots[i].seq, i, memory_order_relaxed);
+    }
+    atomic_store_explicit(&event_bus.tail, 0U, memory_order_relaxed);
+    atomic_store_explicit(&event_bus.head, 0U, memory_order_relaxed);
+    atomic_store_explicit(&event_bus.high_water, 0U, memory_order_relaxed);
+    event_bus.notify = notify;
+    event_bus.notify_context = context;
+    atomic_store_explicit(&event_bus.initialized, true, memory_order_release);
+}
+
+HOT_FUNC error_t event_publish(event_topic_t *topic, uint32_t value)
+{
+    uint32_t pos;
+    event_slot_t *slot;
+    event_notify_fn_t notify;
+
+    if (topic == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    if (!atomic_load_explicit(&event_bus.initialized, memory_order_acquire)) {
+        return ERR_NOT_INITIALIZED;
+    }
+
+    pos = atomic_load_explicit(&event_bus.head, memory_order_relaxed);
+    for (;;) {
+        int32_t diff;
+
+        slot = &event_bus.slots[pos & EVENT_QUEUE_MASK];
+        diff = (int32_t)(atomic_load_explicit(&slot->seq, memory_order_acquire) - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&event_bus.head, &pos, pos + 1U,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* Slot still holds the event of the previous lap */
+            atomic_fetch_add_explicit(&topic->drops, 1U, memory_order_relaxed);
+            return ERR_MEMORY;
+        } else {
+            pos = atomic_load_explicit(&event_bus.head, memory_order_relaxed);
+        }
+    }
+
+    /* Count before publishing: the dispatcher cannot pass this slot, so
+     * pending never goes below zero and tail is at most pos */
+    atomic_fetch_add_explicit(&topic->posts, 1U, memory_order_relaxed);
+    event_raise_max(&topic->high_water,
+                    atomic_fetch_add_explicit(&topic->pending, 1U, memory_order_relaxed) + 1U);
+    event_raise_max(&event_bus.high_water,
+                    pos + 1U - atomic_load_explicit(&event_bus.tail, memory_order_relaxed));
+
+    slot->topic = topic;
+    slot->value = value;
+    atomic_store_explicit(&slot->seq, pos + 1U, memory_order_release);
+
+    notify = event_bus.notify;
+    if (notify != NULL) {
+        notify(event_bus.notify_context);
+    }
+    return ERR_OK;
+}
+
+/* ===== Subscribers ===== */
+
+error_t event_subscribe(event_topic_t *topic, event_subscriber_t *subscriber,
+                        event_handler_t handler, void *context)
+{
+    event_subscriber_t **link;
+
+    if (topic == NULL || subscriber == NULL || handler == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    if (subscriber->topic != NULL) {
+        return ERR_BUSY;
+    }
+
+    subscriber->next = NULL;
+    subscriber->topic = topic;
+    subscriber->handler = handler;
+    subscriber->context = context;
+
+    link = &topic->subscribers;
+    while (*link != NULL) {
+        link = &(*link)->next;
+    }
+    *link = subscriber;
+    return ERR_OK;
+}
+
+error_t event_unsubscribe(event_subscriber_t *subscriber)
+{
+    event_subscriber_t **link;
+
+    if (subscriber == NULL || subscriber->topic == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+
+    for (link = &subscriber->topic->subscribers; *link != NULL; link = &(*link)->next) {
+        if (*link == subscriber) {
+            *link = subscriber->next;
+            break;
+        }
+    }
+    subscriber->topic = NULL;
+    return ERR_OK;
+}
+
+/* ===== Dispatch ===== */
+
+uint32_t event_bus_dispatch(void)
+{
+    uint32_t delivered = 0;
+
+    if (!atomic_load_explicit(&event_bus.initialized, memory_order_acquire)) {
+        return 0;
+    }
+
+    while (delivered < EVENT_QUEUE_SIZE) {
+        uint32_t pos = atomic_load_explicit(&event_bus.tail, memory_order_relaxed);
+        event_slot_t *slot = &event_bus.slots[pos & EVENT_QUEUE_MASK];
+        event_topic_t *topic;
+        uint32_t value;
+        event_subscriber_t *subscriber;
+
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1U) {
+            return delivered;
+        }
+        topic = slot->topic;
+        value = slot->value;
+
+        /* Free the slot before the handlers run, so they can publish */
+        atomic_store_explicit(&slot->seq, pos + EVENT_QUEUE_SIZE, memory_order_release);
+        atomic_store_explicit(&event_bus.tail, pos + 1U, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&topic->pending, 1U, memory_order_relaxed);
+
+        subscriber = topic->subscribers;
+        while (subscriber != NULL) {
+            event_subscriber_t *next = subscriber->next;
+
+            subscriber->handler(topic, value, subscriber->context);
+            subscriber = next;
+        }
+        delivered++;
+    }
+
+    if (event_bus_pending() && event_bus.notify != NULL) {
+        event_bus.notify(event_bus.notify_context);
+    }
+    return delivered;
+}
+
+bool event_bus_pending(void)
+{
+    return atomic_load_explicit(&event_bus.head, memory_order_relaxed) !=
+           atomic_load_explicit(&event_bus.tail, memory_order_relaxed);
+}
+
+error_t event_topic_get_stats(const event_topic_t *topic, event_topic_stats_t *stats)
+{
+    if (topic == NULL || stats == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    stats->posts = atomic_load_explicit(&topic->posts, memory_order_relaxed);
+    stats->drops = atomic_load_explicit(&topic->drops, memory_order_relaxed);
+    stats->pending = atomic_load_explicit(&topic->pending, memory_order_relaxed);
+    stats->high_water = atomic_load_explicit(&topic->high_water, memory_order_relaxed);
+    return ERR_OK;
+}
+
+uint32_t event_bus_get_high_water(void)
+{
+    return atomic_load_explicit(&event_bus.high_water, memory_order_relaxed);
+}
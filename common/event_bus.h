@@ -0,0 +1,100 @@
+/*
+ * event_bus.h - Publish/Subscribe Event Bus
+ *
+ * Lets a lower layer tell whoever is interested that something happened
+ * without knowing who that is, and without the app polling for it.
+ *
+ * Topics are statically declared by the module that publishes them:
+ * EVENT_TOPIC_DEFINE(name) in its .c file, EVENT_TOPIC_DECLARE(name) in
+ * its header. An event is a topic and one 32-bit value whose meaning the
+ * topic defines.
+ *
+ * event_publish() may be called from any context, including nested
+ * interrupts and several host threads. It takes one slot of a bounded
+ * lock-free queue (EVENT_QUEUE_SIZE events shared by all topics) and
+ * never blocks or allocates; when the queue is full the event is
+ * dropped and counted on its topic.
+ *
+ * event_bus_dispatch() runs in task context, normally from one
+ * scheduler task woken by the notify hook given to event_bus_init(),
+ * and calls the topic's subscribers in subscription order, oldest event
+ * first. Subscribers are caller-owned nodes (no heap) and, like the
+ * dispatch, are only touched from task context.
+ */
+
+#ifndef COMMON_EVENT_BUS_H
+#define COMMON_EVENT_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "error.h"
+
+#ifndef EVENT_QUEUE_SIZE
+#define EVENT_QUEUE_SIZE        32U     /* Power of two */
+#endif
+
+typedef struct event_topic event_topic_t;
+typedef struct event_subscriber event_subscriber_t;
+
+typedef void (*event_handler_t)(const event_topic_t *topic, uint32_t value, void *context);
+
+/* Called after every successful publish, in the publisher's context: it
+ * must be interrupt safe (e.g. sched_post() to the dispatching task) */
+typedef void (*event_notify_fn_t)(void *context);
+
+struct event_subscriber {
+    event_subscriber_t *next;   /* Topic list link (private) */
+    event_topic_t *topic;       /* NULL while unsubscribed */
+    event_handler_t handler;
+    void *context;
+};
+
+struct event_topic {
+    const char *name;
+    event_subscriber_t *subscribers;
+    _Atomic uint32_t posts;
+    _Atomic uint32_t drops;
+    _Atomic uint32_t pending;
+    _Atomic uint32_t high_water;
+};
+
+#define EVENT_TOPIC_DEFINE(topic)   event_topic_t topic = { .name = #topic }
+#define EVENT_TOPIC_DECLARE(topic)  extern event_topic_t topic
+
+/* Per-topic counters, since boot */
+typedef struct {
+    uint32_t posts;             /* Events queued */
+    uint32_t drops;             /* Events lost to a full queue */
+    uint32_t pending;           /* Queued, not yet dispatched */
+    uint32_t high_water;        /* Most events of this topic queued at once */
+} event_topic_stats_t;
+
+/* Empty the queue and set the wake-up hook (may be NULL). Publishing
+ * before this returns ERR_NOT_INITIALIZED. */
+void event_bus_init(event_notify_fn_t notify, void *context);
+
+/* Queue an event: ERR_OK, or ERR_MEMORY if the queue is full (the drop
+ * is counted on the topic) */
+error_t event_publish(event_topic_t *topic, uint32_t value);
+
+/* Task context only. A subscriber belongs to one topic at a time
+ * (ERR_BUSY if still subscribed). Handlers may publish, subscribe new
+ * nodes (they see the next event on), and unsubscribe their own node. */
+error_t event_subscribe(event_topic_t *topic, event_subscriber_t *subscriber,
+                        event_handler_t handler, void *context);
+error_t event_unsubscribe(event_subscriber_t *subscriber);
+
+/* Deliver queued events, at most EVENT_QUEUE_SIZE per call so handlers
+ * that publish cannot keep it running; if events remain, the notify hook
+ * is called again. Returns the number of events delivered. */
+uint32_t event_bus_dispatch(void);
+
+bool event_bus_pending(void);
+
+error_t event_topic_get_stats(const event_topic_t *topic, event_topic_stats_t *stats);
+
+/* Most events queued at once, all topics */
+uint32_t event_bus_get_high_water(void);
+
+#endif /* COMMON_EVENT_BUS_H */
@@ -0,0 +1,412 @@
+/*
+ * fmt.c - Streaming printf-style Formatter Implementation
+ *
+ * Each conversion is rendered as prefix (sign or "0x"), zeros (from the
+ * precision or the 0 flag), body (digits, or the string itself) and
+ * padding. Only numeric bodies go through a small local buffer; strings
+ * and literal text are copied into the window a span at a time.
+ */
+
+#include "fmt.h"
+#include <stddef.h>
+#include <string.h>
+
+#define FMT_LEFT                (1U << 0)
+#define FMT_ZERO                (1U << 1)
+#define FMT_PLUS                (1U << 2)
+#define FMT_SPACE               (1U << 3)
+
+/* 20 digits of a uint64_t, the point and FMT_FIXED_MAX_PRECISION */
+#define FMT_NUMBER_MAX          40U
+
+typedef enum {
+    FMT_LENGTH_INT = 0,
+    FMT_LENGTH_CHAR,
+    FMT_LENGTH_SHORT,
+    FMT_LENGTH_LONG,
+    FMT_LENGTH_LLONG,
+    FMT_LENGTH_SIZE
+} fmt_length_t;
+
+typedef struct {
+    uint32_t flags;
+    uint32_t width;
+    uint32_t precision;
+    bool has_precision;
+    fmt_length_t length;
+} fmt_spec_t;
+
+/* ===== Output ===== */
+
+static bool fmt_room(fmt_out_t *out)
+{
+    return out->pos < out->end || (out->refill != NULL && out->refill(out));
+}
+
+static bool fmt_put(fmt_out_t *out, const char *data, size_t length)
+{
+    while (length > 0U) {
+        size_t room;
+
+        if (!fmt_room(out)) {
+            return false;
+        }
+        room = (size_t)(out->end - out->pos);
+        if (room > length) {
+            room = length;
+        }
+        memcpy(out->pos, data, room);
+        out->pos += room;
+        data += room;
+        length -= room;
+    }
+    return true;
+}
+
+static bool fmt_fill(fmt_out_t *out, char c, size_t count)
+{
+    while (count > 0U) {
+        size_t room;
+
+        if (!fmt_room(out)) {
+            return false;
+        }
+        room = (size_t)(out->end - out->pos);
+        if (room > count) {
+            room = count;
+        }
+        memset(out->pos, c, room);
+        out->pos += room;
+        count -= room;
+    }
+    return true;
+}
+
+/* prefix, zeros, body, justified in spec->width */
+static bool fmt_field(fmt_out_t *out, const fmt_spec_t *spec, const char *prefix,
+                      const char *body, size_t body_length, uint32_t zeros)
+{
+    size_t prefix_length = strlen(prefix);
+    size_t used = prefix_length + zeros + body_length;
+    size_t pad = (spec->width > used) ? spec->width - used : 0U;
+
+    if ((spec->flags & FMT_LEFT) != 0U) {
+        return fmt_put(out, prefix, prefix_length) && fmt_fill(out, '0', zeros) &&
+               fmt_put(out, body, body_length) && fmt_fill(out, ' ', pad);
+    }
+    if ((spec->flags & FMT_ZERO) != 0U) {
+        return fmt_put(out, prefix, prefix_length) && fmt_fill(out, '0', zeros + pad) &&
+               fmt_put(out, body, body_length);
+    }
+    return fmt_fill(out, ' ', pad) && fmt_put(out, prefix, prefix_length) &&
+           fmt_fill(out, '0', zeros) && fmt_put(out, body, body_length);
+}
+
+/* ===== Numbers ===== */
+
+/* Digits of value ending at end, most significant first; returns the
+ * count. 32-bit values skip the 64-bit division. */
+static uint32_t fmt_digits(uint64_t value, uint32_t base, bool upper, char *end)
+{
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char *p = end;
+
+    if (value <= UINT32_MAX) {
+        uint32_t small = (uint32_t)value;
+
+        do {
+            *--p = digits[small % base];
+            small /= base;
+        } while (small != 0U);
+    } else {
+        do {
+            *--p = digits[value % base];
+            value /= base;
+        } while (value != 0U);
+    }
+    return (uint32_t)(end - p);
+}
+
+static int64_t fmt_arg_signed(va_list *args, fmt_length_t length)
+{
+    switch (length) {
+    case FMT_LENGTH_CHAR:
+        return (signed char)va_arg(*args, int);
+    case FMT_LENGTH_SHORT:
+        return (short)va_arg(*args, int);
+    case FMT_LENGTH_LONG:
+        return va_arg(*args, long);
+    case FMT_LENGTH_LLONG:
+        return va_arg(*args, long long);
+    case FMT_LENGTH_SIZE:
+        return va_arg(*args, ptrdiff_t);
+    default:
+        return va_arg(*args, int);
+    }
+}
+
+static uint64_t fmt_arg_unsigned(va_list *args, fmt_length_t length)
+{
+    switch (length) {
+    case FMT_LENGTH_CHAR:
+        return (unsigned char)va_arg(*args, unsigned int);
+    case FMT_LENGTH_SHORT:
+        return (unsigned short)va_arg(*args, unsigned int);
+    case FMT_LENGTH_LONG:
+        return va_arg(*args, unsigned long);
+    case FMT_LENGTH_LLONG:
+        return va_arg(*args, unsigned long long);
+    case FMT_LENGTH_SIZE:
+        return va_arg(*args, size_t);
+    default:
+        return va_arg(*args, unsigned int);
+    }
+}
+
+/* Magnitude of value; sign (if any) into prefix */
+static uint64_t fmt_sign(int64_t value, const fmt_spec_t *spec, const char **prefix)
+{
+    if (value < 0) {
+        *prefix = "-";
+        return 0U - (uint64_t)value;
+    }
+    if ((spec->flags & FMT_PLUS) != 0U) {
+        *prefix = "+";
+    } else if ((spec->flags & FMT_SPACE) != 0U) {
+        *prefix = " ";
+    } else {
+        *prefix = "";
+    }
+    return (uint64_t)value;
+}
+
+static bool fmt_integer(fmt_out_t *out, fmt_spec_t *spec, uint64_t value, uint32_t base,
+                        bool upper, const char *prefix)
+{
+    char number[FMT_NUMBER_MAX];
+    char *end = &number[FMT_NUMBER_MAX];
+    uint32_t count = 0;
+    uint32_t zeros = 0;
+
+    if (spec->has_precision) {
+        /* The precision replaces the 0 flag; %.0d of 0 prints nothing */
+        spec->flags &= ~FMT_ZERO;
+        if (value != 0U || spec->precision != 0U) {
+            count = fmt_digits(value, base, upper, end);
+        }
+        zeros = (spec->precision > count) ? spec->precision - count : 0U;
+    } else {
+        count = fmt_digits(value, base, upper, end);
+    }
+    return fmt_field(out, spec, prefix, end - count, count, zeros);
+}
+
+/* value / 10^decimals, as "whole.fraction" */
+static bool fmt_fixed(fmt_out_t *out, const fmt_spec_t *spec, int64_t value)
+{
+    char number[FMT_NUMBER_MAX];
+    char *end = &number[FMT_NUMBER_MAX];
+    char *p = end;
+    const char *prefix;
+    uint32_t decimals = spec->has_precision ? spec->precision : FMT_FIXED_PRECISION;
+    uint64_t magnitude = fmt_sign(value, spec, &prefix);
+    uint64_t scale = 1;
+
+    if (decimals > FMT_FIXED_MAX_PRECISION) {
+        decimals = FMT_FIXED_MAX_PRECISION;
+    }
+    for (uint32_t i = 0; i < decimals; i++) {
+        scale *= 10U;
+    }
+
+    uint64_t fraction = magnitude % scale;
+
+    for (uint32_t i = 0; i < decimals; i++) {
+        *--p = (char)('0' + (char)(fraction % 10U));
+        fraction /= 10U;
+    }
+    if (decimals > 0U) {
+        *--p = '.';
+    }
+    p -= fmt_digits(magnitude / scale, 10U, false, p);
+    return fmt_field(out, spec, prefix, p, (size_t)(end - p), 0U);
+}
+
+/* ===== Strings ===== */
+
+static bool fmt_string(fmt_out_t *out, fmt_spec_t *spec, const char *text)
+{
+    size_t length = 0;
+
+    if (text == NULL) {
+        text = "(null)";
+    }
+    /* With a precision the text need not be terminated */
+    while ((!spec->has_precision || length < spec->precision) && text[length] != '\0') {
+        length++;
+    }
+    spec->flags &= ~FMT_ZERO;
+    return fmt_field(out, spec, "", text, length, 0U);
+}
+
+/* ===== Conversion Specification ===== */
+
+static uint32_t fmt_parse_number(const char **format)
+{
+    uint32_t value = 0;
+
+    while (**format >= '0' && **format <= '9') {
+        if (value < UINT16_MAX) {
+            value = value * 10U + (uint32_t)(**format - '0');
+        }
+        (*format)++;
+    }
+    return value;
+}
+
+/* Flags, width, precision and length after the '%' */
+static void fmt_parse_spec(const char **format, va_list *args, fmt_spec_t *spec)
+{
+    const char *f = *format;
+
+    spec->flags = 0;
+    for (;; f++) {
+        if (*f == '-') {
+            spec->flags |= FMT_LEFT;
+        } else if (*f == '0') {
+            spec->flags |= FMT_ZERO;
+        } else if (*f == '+') {
+            spec->flags |= FMT_PLUS;
+        } else if (*f == ' ') {
+            spec->flags |= FMT_SPACE;
+        } else {
+            break;
+        }
+    }
+
+    if (*f == '*') {
+        int width = va_arg(*args, int);
+
+        f++;
+        if (width < 0) {
+            spec->flags |= FMT_LEFT;
+            width = -width;
+        }
+        spec->width = (uint32_t)width;
+    } else {
+        spec->width = fmt_parse_number(&f);
+    }
+    if ((spec->flags & FMT_LEFT) != 0U) {
+        spec->flags &= ~FMT_ZERO;
+    }
+
+    spec->has_precision = false;
+    spec->precision = 0;
+    if (*f == '.') {
+        f++;
+        spec->has_precision = true;
+        if (*f == '*') {
+            int precision = va_arg(*args, int);
+
+            f++;
+            /* A negative precision is taken as omitted */
+            spec->has_precision = (precision >= 0);
+            spec->precision = (precision >= 0) ? (uint32_t)precision : 0U;
+        } else {
+            spec->precision = fmt_parse_number(&f);
+        }
+    }
+
+    spec->length = FMT_LENGTH_INT;
+    if (*f == 'h') {
+        f++;
+        spec->length = FMT_LENGTH_SHORT;
+        if (*f == 'h') {
+            f++;
+            spec->length = FMT_LENGTH_CHAR;
+        }
+    } else if (*f == 'l') {
+        f++;
+        spec->length = FMT_LENGTH_LONG;
+        if (*f == 'l') {
+            f++;
+            spec->length = FMT_LENGTH_LLONG;
+        }
+    } else if (*f == 'z') {
+        f++;
+        spec->length = FMT_LENGTH_SIZE;
+    }
+    *format = f;
+}
+
+/* ===== Formatter ===== */
+
+static bool fmt_convert(fmt_out_t *out, const char *start, const char **format, va_list *args)
+{
+    fmt_spec_t spec;
+    const char *prefix;
+    char c;
+
+    fmt_parse_spec(format, args, &spec);
+    c = **format;
+    if (c == '\0') {
+        /* Trailing '%': copy what there is */
+        return fmt_put(out, start, (size_t)(*format - start));
+    }
+    (*format)++;
+
+    switch (c) {
+    case 'd':
+    case 'i': {
+        uint64_t magnitude = fmt_sign(fmt_arg_signed(args, spec.length), &spec, &prefix);
+
+        return fmt_integer(out, &spec, magnitude, 10U, false, prefix);
+    }
+    case 'u':
+        return fmt_integer(out, &spec, fmt_arg_unsigned(args, spec.length), 10U, false, "");
+    case 'x':
+    case 'X':
+        return fmt_integer(out, &spec, fmt_arg_unsigned(args, spec.length), 16U, c == 'X', "");
+    case 'p':
+        return fmt_integer(out, &spec, (uintptr_t)va_arg(*args, void *), 16U, false, "0x");
+    case 'k':
+        return fmt_fixed(out, &spec, fmt_arg_signed(args, spec.length));
+    case 'c': {
+        char ch = (char)va_arg(*args, int);
+
+        spec.flags &= ~FMT_ZERO;
+        return fmt_field(out, &spec, "", &ch, 1U, 0U);
+    }
+    case 's':
+        return fmt_string(out, &spec, va_arg(*args, const char *));
+    case '%':
+        return fmt_put(out, "%", 1U);
+    default:
+        return fmt_put(out, start, (size_t)(*format - start));
+    }
+}
+
+bool fmt_vformat(fmt_out_t *out, const char *format, va_list args)
+{
+    va_list ap;
+    bool ok = true;
+
+    /* A copy, so the argument list can be passed on by address */
+    va_copy(ap, args);
+    while (ok && *format != '\0') {
+        const char *literal = format;
+
+        while (*format != '\0' && *format != '%') {
+            format++;
+        }
+        if (format > literal) {
+            ok = fmt_put(out, literal, (size_t)(format - literal));
+        } else {
+            const char *start = format++;
+
+            ok = fmt_convert(out, start, &format, &ap);
+        }
+    }
+    va_end(ap);
+    return ok;
+}
@@ -0,0 +1,60 @@
+/*
+ * fmt.h - Streaming printf-style Formatter
+ *
+ * fmt_vformat() writes characters straight into an output window owned
+ * by the caller. When the window is full it asks out->refill() for the
+ * next one, so there is no string: a driver points the window at free
+ * space in its TX ring and the output is never staged, nor limited in
+ * length by a buffer.
+ *
+ * No libc printf, no floating point, no heap; a few dozen bytes of
+ * stack. The supported subset:
+ *
+ *   %[flags][width][.precision][length]conversion
+ *
+ *   flags       -  left-justify         0      pad with zeros
+ *               +  always show a sign   space  space before a positive value
+ *   width       digits or *            minimum field width
+ *   precision   digits or *            s: at most this many characters
+ *                                      d i u x X: at least this many digits
+ *                                      k: fractional digits (default 3)
+ *   length      hh h l ll z
+ *   conversion  d i  signed decimal     u      unsigned decimal
+ *               x X  hexadecimal         c      character
+ *               s    string              p      pointer (0x + hex)
+ *               k    fixed point         %      literal %
+ *
+ * %k prints a signed integer scaled by 10^precision as a decimal
+ * fraction: %.2k of -1234 is "-12.34", %k of 3300 (mV) is "3.300". It is
+ * not a C conversion, so format strings are not checked by the
+ * compiler; the length modifier must match the argument as for %d. An
+ * unknown conversion is copied out as written.
+ */
+
+#ifndef COMMON_FMT_H
+#define COMMON_FMT_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FMT_FIXED_PRECISION         3U      /* %k without a precision */
+#define FMT_FIXED_MAX_PRECISION     18U     /* 10^18 < 2^63 */
+
+typedef struct fmt_out fmt_out_t;
+
+/* Provide the next window when pos has reached end: set pos/end to a
+ * non-empty range and return true, or return false to end the output */
+typedef bool (*fmt_refill_t)(fmt_out_t *out);
+
+struct fmt_out {
+    char *pos;                  /* Next character goes here */
+    char *end;                  /* End of the current window */
+    fmt_refill_t refill;        /* NULL: the first window is all there is */
+    void *context;
+};
+
+/* Format into out; false if the output was cut short by refill */
+bool fmt_vformat(fmt_out_t *out, const char *format, va_list args);
+
+#endif /* COMMON_FMT_H */
@@ -0,0 +1,235 @@
+/*
+ * health.c - Liveness Supervision Implementation
+ *
+ * Check-in times are the low 32 bits of the clock; a gap only has to
+ * be measured up to the watchdog timeout, far below the 71 minutes that
+ * covers. Lateness is evaluated both by the supervisor and at the next
+ * check-in, so a task that comes back between two supervision passes
+ * still has its miss counted; the late bit makes sure an episode seen
+ * by both is counted once.
+ */
+
+#include "health.h"
+#include "crc.h"
+#include <stddef.h>
+
+#define HEALTH_MAGIC            0x48454C54UL    /* "HELT" */
+
+_Static_assert(HEALTH_MAX_CHECKS <= 32U, "late masks are 32 bits");
+
+/* Survives a watchdog reset: not zeroed by the startup code */
+#if !defined(BOARD_HOST)
+#define HEALTH_NOINIT           __attribute__((section(".noinit")))
+#else
+#define HEALTH_NOINIT
+#endif
+
+typedef struct {
+    uint32_t magic;
+    uint32_t boots;
+    uint32_t watchdog_resets;
+    uint32_t late_mask;                 /* At the last supervision pass */
+    uint32_t reset_late_mask;
+    uint32_t misses[HEALTH_MAX_CHECKS];
+    uint32_t worst_late_us[HEALTH_MAX_CHECKS];
+    uint32_t crc;                       /* Over everything above */
+} health_history_t;
+
+typedef struct {
+    const char *name;
+    uint32_t deadline_us;
+    uint32_t last_checkin_us;
+    uint32_t misses;
+} health_check_t;
+
+typedef struct {
+    health_check_t checks[HEALTH_MAX_CHECKS];
+    uint8_t check_count;
+    uint32_t kicks;
+    uint32_t kicks_withheld;
+    health_clock_fn_t clock;
+    health_kick_fn_t kick;
+} health_monitor_t;
+
+static health_monitor_t health;
+static health_history_t health_history HEALTH_NOINIT;
+
+static uint32_t health_history_crc(void)
+{
+    return crc32_update(0U, &health_history, (uint32_t)offsetof(health_history_t, crc));
+}
+
+static void health_history_seal(void)
+{
+    health_history.crc = health_history_crc();
+}
+
+void health_clear_history(void)
+{
+    uint8_t *bytes = (uint8_t *)&health_history;
+
+    for (uint32_t i = 0; i < sizeof(health_history); i++) {
+        bytes[i] = 0;
+    }
+    health_history.magic = HEALTH_MAGIC;
+    health_history_seal();
+}
+
+void health_init(health_clock_fn_t clock, health_kick_fn_t kick, bool watchdog_reset)
+{
+    if (health_history.magic != HEALTH_MAGIC || health_history.crc != health_history_crc()) {
+        health_clear_history();
+    }
+    health_history.boots++;
+    if (watchdog_reset) {
+        health_history.watchdog_resets++;
+        health_history.reset_late_mask = health_history.late_mask;
+    }
+    health_history.late_mask = 0;
+    health_history_seal();
+
+    health.check_count = 0;
+    health.kicks = 0;
+    health.kicks_withheld = 0;
+    health.clock = clock;
+    health.kick = kick;
+}
+
+static uint32_t health_now_us(void)
+{
+    return (health.clock != NULL) ? (uint32_t)health.clock() : 0U;
+}
+
+error_t health_register(const char *name, uint32_t deadline_us, health_id_t *id)
+{
+    health_check_t *check;
+
+    if (deadline_us == 0U || deadline_us > (uint32_t)INT32_MAX) {
+        return ERR_INVALID_PARAM;
+    }
+    if (health.check_count >= HEALTH_MAX_CHECKS) {
+        return ERR_MEMORY;
+    }
+
+    check = &health.checks[health.check_count];
+    check->name = name;
+    check->deadline_us = deadline_us;
+    check->last_checkin_us = health_now_us();
+    check->misses = 0;
+    if (id != NULL) {
+        *id = health.check_count;
+    }
+    health.check_count++;
+    return ERR_OK;
+}
+
+/* Late by age: count the episode once, track the worst; true if the
+ * history changed */
+static bool health_note_late(health_id_t id, uint32_t age)
+{
+    health_check_t *check = &health.checks[id];
+    uint32_t late_us = age - check->deadline_us;
+    uint32_t bit = 1U << id;
+    bool changed = false;
+
+    if ((health_history.late_mask & bit) == 0U) {
+        health_history.late_mask |= bit;
+        health_history.misses[id]++;
+        check->misses++;
+        changed = true;
+    }
+    if (late_us > health_history.worst_late_us[id]) {
+        health_history.worst_late_us[id] = late_us;
+        changed = true;
+    }
+    return changed;
+}
+
+void health_checkin(health_id_t id)
+{
+    health_check_t *check;
+    uint32_t now;
+    uint32_t age;
+    bool changed = false;
+
+    if (id >= health.check_count) {
+        return;
+    }
+    check = &health.checks[id];
+    now = health_now_us();
+    age = now - check->last_checkin_us;
+
+    if (age > check->deadline_us) {
+        changed = health_note_late(id, age);
+    }
+    if ((health_history.late_mask & (1U << id)) != 0U) {
+        health_history.late_mask &= ~(1U << id);
+        changed = true;
+    }
+    check->last_checkin_us = now;
+    if (changed) {
+        health_history_seal();
+    }
+}
+
+uint32_t health_supervise(void)
+{
+    uint32_t now = health_now_us();
+    bool changed = false;
+
+    for (health_id_t id = 0; id < health.check_count; id++) {
+        const health_check_t *check = &health.checks[id];
+        uint32_t age = now - check->last_checkin_us;
+
+        if (age > check->deadline_us && health_note_late(id, age)) {
+            changed = true;
+        }
+    }
+    if (changed) {
+        health_history_seal();
+    }
+
+    if (health_history.late_mask != 0U) {
+        health.kicks_withheld++;
+        return health_history.late_mask;
+    }
+    if (health.kick != NULL) {
+        health.kick();
+    }
+    health.kicks++;
+    return 0;
+}
+
+error_t health_get_check_stats(health_id_t id, health_check_stats_t *stats)
+{
+    const health_check_t *check;
+
+    if (id >= health.check_count || stats == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    check = &health.checks[id];
+    stats->misses = check->misses;
+    stats->misses_total = health_history.misses[id];
+    stats->worst_late_us = health_history.worst_late_us[id];
+    stats->since_checkin_us = health_now_us() - check->last_checkin_us;
+    stats->late = (health_history.late_mask & (1U << id)) != 0U;
+    return ERR_OK;
+}
+
+const char *health_get_check_name(health_id_t id)
+{
+    return (id < health.check_count) ? health.checks[id].name : NULL;
+}
+
+void health_get_status(health_status_t *status)
+{
+    if (status == NULL) {
+        return;
+    }
+    status->boots = health_history.boots;
+    status->watchdog_resets = health_history.watchdog_resets;
+    status->reset_late_mask = health_history.reset_late_mask;
+    status->late_mask = health_history.late_mask;
+    status->kicks = health.kicks;
+    status->kicks_withheld = health.kicks_withheld;
+}
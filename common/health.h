@@ -0,0 +1,81 @@
+/*
+ * health.h - Liveness Supervision and Watchdog Gating
+ *
+ * Each supervised task registers a check with a deadline and calls
+ * health_checkin() whenever it has done a round of work. A check is
+ * late once more than deadline_us has passed since its last check-in;
+ * each late episode counts one miss, and the worst lateness is kept.
+ *
+ * health_supervise() runs periodically (more often than the watchdog
+ * timeout) and kicks the watchdog only when no check is late. A task
+ * that stalls, or is starved by others, so stops the kicks and the
+ * watchdog resets the chip; so does a stalled supervisor.
+ *
+ * Miss counts, worst lateness and which checks were late when the
+ * watchdog hit survive that reset: they are kept in a CRC-protected
+ * block in uninitialized RAM (.noinit on target) that health_init()
+ * only clears when the CRC does not match, e.g. after power-on. Checks
+ * must be registered in the same order every boot for the history to
+ * keep its meaning.
+ *
+ * Time and the watchdog are passed to health_init() so this module does
+ * not depend on the BSP. Everything runs in task context; crc_init()
+ * must have run first.
+ */
+
+#ifndef COMMON_HEALTH_H
+#define COMMON_HEALTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "error.h"
+
+#ifndef HEALTH_MAX_CHECKS
+#define HEALTH_MAX_CHECKS       8U
+#endif
+
+typedef uint8_t health_id_t;
+
+/* Monotonic microsecond clock */
+typedef uint64_t (*health_clock_fn_t)(void);
+
+/* Restart the watchdog timeout */
+typedef void (*health_kick_fn_t)(void);
+
+typedef struct {
+    uint32_t misses;            /* Late episodes since boot */
+    uint32_t misses_total;      /* Late episodes, across watchdog resets */
+    uint32_t worst_late_us;     /* Most time past the deadline, across resets */
+    uint32_t since_checkin_us;  /* Now */
+    bool late;
+} health_check_stats_t;
+
+typedef struct {
+    uint32_t boots;             /* Since the history was last cleared */
+    uint32_t watchdog_resets;
+    uint32_t reset_late_mask;   /* Checks (bit per id) late at the last watchdog reset */
+    uint32_t late_mask;         /* Checks late now */
+    uint32_t kicks;             /* Since boot */
+    uint32_t kicks_withheld;    /* Supervision passes that found a check late */
+} health_status_t;
+
+/* watchdog_reset: the reset that led here was the watchdog's */
+void health_init(health_clock_fn_t clock, health_kick_fn_t kick, bool watchdog_reset);
+
+/* Add a check; its first deadline runs from now */
+error_t health_register(const char *name, uint32_t deadline_us, health_id_t *id);
+
+void health_checkin(health_id_t id);
+
+/* Update lateness and kick if every check is on time; returns the late
+ * mask (0 = kicked) */
+uint32_t health_supervise(void);
+
+error_t health_get_check_stats(health_id_t id, health_check_stats_t *stats);
+const char *health_get_check_name(health_id_t id);
+void health_get_status(health_status_t *status);
+
+/* Forget the kept history (miss totals, worst lateness, reset counts) */
+void health_clear_history(void);
+
+#endif /* COMMON_HEALTH_H */
@@ -0,0 +1,33 @@
+/*
+ * hot_path.h - Placement of Latency-critical Code and Data
+ *
+ * HOT_FUNC   function executed from SRAM instead of flash: no flash
+ *            wait states (3 at 100 MHz) and no prefetch/ART misses, so
+ *            ISR and dispatch timing stays flat.
+ * HOT_DATA   read-only table used on a hot path (HAL vtables, lookup
+ *            tables), copied to SRAM at reset for the same reason.
+ *            Only for const objects: writable data is in zero-wait SRAM
+ *            already, and mixing both in one file would be a section
+ *            type conflict.
+ *
+ * Both take effect on target builds with HOT_PLACEMENT (MODE=perf); the
+ * startup code copies .ramfunc and .hotdata from flash with .data. On
+ * BOARD=host (BOARD_HOST) and in other modes they expand to nothing.
+ *
+ * A HOT_FUNC only helps as far as its callees are hot too: a call into
+ * plain code runs from flash again (and the linker adds a long-branch
+ * veneer for calls between flash and SRAM).
+ */
+
+#ifndef COMMON_HOT_PATH_H
+#define COMMON_HOT_PATH_H
+
+#if defined(HOT_PLACEMENT) && !defined(BOARD_HOST)
+#define HOT_FUNC    __attribute__((section(".ramfunc")))
+#define HOT_DATA    __attribute__((section(".hotdata")))
+#else
+#define HOT_FUNC
+#define HOT_DATA
+#endif
+
+#endif /* COMMON_HOT_PATH_H */
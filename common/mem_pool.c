@@ -0,0 +1,213 @@
+/*
+ * mem_pool.c - Fixed-block Memory Pools Implementation
+ */
+
+#include "mem_pool.h"
+#include <stddef.h>
+
+/* links[] values other than a next index */
+#define MEM_POOL_END            0xFFFFU     /* Bottom of the free stack */
+#define MEM_POOL_ALLOCATED      0xFFFEU
+#define MEM_POOL_RELEASING      0xFFFDU     /* Being pushed back */
+
+#define MEM_POOL_INDEX(head)    ((head) & 0xFFFFU)
+#define MEM_POOL_TAG_STEP       0x10000U
+
+_Static_assert(MEM_POOL_MAX_BLOCKS < MEM_POOL_RELEASING, "block index range");
+
+/* ===== Single Pool ===== */
+
+error_t mem_pool_init(mem_pool_t *pool, void *storage, _Atomic uint16_t *links,
+                      uint32_t block_size, uint32_t block_count)
+{
+    if (pool == NULL || storage == NULL || links == NULL || block_size == 0U ||
+        block_count == 0U || block_count > MEM_POOL_MAX_BLOCKS) {
+        return ERR_INVALID_PARAM;
+    }
+
+    pool->storage = (uint8_t *)storage;
+    pool->links = links;
+    pool->block_size = block_size;
+    pool->block_count = block_count;
+    for (uint32_t i = 0; i < block_count; i++) {
+        atomic_store_explicit(&links[i], (uint16_t)((i + 1U < block_count) ? i + 1U : MEM_POOL_END),
+                              memory_order_relaxed);
+    }
+    atomic_store_explicit(&pool->in_use, 0U, memory_order_relaxed);
+    atomic_store_explicit(&pool->high_water, 0U, memory_order_relaxed);
+    atomic_store_explicit(&pool->failures, 0U, memory_order_relaxed);
+    atomic_store_explicit(&pool->head, 0U, memory_order_release);
+    return ERR_OK;
+}
+
+/* Pop a block; NULL when empty, nothing counted */
+static void *mem_pool_take(mem_pool_t *pool)
+{
+    uint32_t head = atomic_load_explicit(&pool->head, memory_order_acquire);
+    uint32_t index;
+    uint32_t next;
+    uint32_t in_use;
+    uint32_t high;
+
+    do {
+        index = MEM_POOL_INDEX(head);
+        if (index == MEM_POOL_END) {
+            return NULL;
+        }
+        /* May be stale if index is taken meanwhile; the tag catches it */
+        next = atomic_load_explicit(&pool->links[index], memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->head, &head,
+                                                    ((head & ~0xFFFFU) + MEM_POOL_TAG_STEP) | next,
+                                                    memory_order_acquire,
+                                                    memory_order_acquire));
+
+    atomic_store_explicit(&pool->links[index], MEM_POOL_ALLOCATED, memory_order_relaxed);
+
+    in_use = atomic_fetch_add_explicit(&pool->in_use, 1U, memory_order_relaxed) + 1U;
+    high = atomic_load_explicit(&pool->high_water, memory_order_relaxed);
+    while (in_use > high &&
+           !atomic_compare_exchange_weak_explicit(&pool->high_water, &high, in_use,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+    return &pool->storage[index * pool->block_size];
+}
+
+void *mem_pool_alloc(mem_pool_t *pool)
+{
+    void *block;
+
+    if (pool == NULL || pool->storage == NULL) {
+        return NULL;
+    }
+    block = mem_pool_take(pool);
+    if (block == NULL) {
+        atomic_fetch_add_explicit(&pool->failures, 1U, memory_order_relaxed);
+    }
+    return block;
+}
+
+bool mem_pool_owns(const mem_pool_t *pool, const void *block)
+{
+    const uint8_t *p = (const uint8_t *)block;
+
+    return pool != NULL && pool->storage != NULL && p >= pool->storage &&
+           p < pool->storage + (size_t)pool->block_size * pool->block_count;
+}
+
+error_t mem_pool_free(mem_pool_t *pool, void *block)
+{
+    uint32_t offset;
+    uint32_t index;
+    uint32_t head;
+
+    if (!mem_pool_owns(pool, block)) {
+        return ERR_INVALID_PARAM;
+    }
+    offset = (uint32_t)((uint8_t *)block - pool->storage);
+    if ((offset % pool->block_size) != 0U) {
+        return ERR_INVALID_PARAM;
+    }
+    index = offset / pool->block_size;
+
+    /* A block already free is rejected. Only the owner frees a block,
+     * so a plain check suffices; two racing frees of one block are a
+     * caller bug this does not promise to catch. */
+    if (atomic_load_explicit(&pool->links[index], memory_order_relaxed) != MEM_POOL_ALLOCATED) {
+        return ERR_INVALID_PARAM;
+    }
+    atomic_store_explicit(&pool->links[index], MEM_POOL_RELEASING, memory_order_relaxed);
+
+    /* Uncount first: in_use never exceeds the blocks actually out */
+    atomic_fetch_sub_explicit(&pool->in_use, 1U, memory_order_relaxed);
+
+    head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+    do {
+        atomic_store_explicit(&pool->links[index], (uint16_t)MEM_POOL_INDEX(head),
+                              memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->head, &head,
+                                                    ((head & ~0xFFFFU) + MEM_POOL_TAG_STEP) | index,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+    return ERR_OK;
+}
+
+error_t mem_pool_get_stats(mem_pool_t *pool, mem_pool_stats_t *stats)
+{
+    if (pool == NULL || stats == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    stats->block_size = pool->block_size;
+    stats->block_count = pool->block_count;
+    stats->in_use = atomic_load_explicit(&pool->in_use, memory_order_relaxed);
+    stats->high_water = atomic_load_explicit(&pool->high_water, memory_order_relaxed);
+    stats->failures = atomic_load_explicit(&pool->failures, memory_order_relaxed);
+    return ERR_OK;
+}
+
+/* ===== Size Classes ===== */
+
+MEM_POOL_STORAGE(mem_class0, MEM_CLASS_0_SIZE, MEM_CLASS_0_BLOCKS, MEM_POOL_ALIGN);
+MEM_POOL_STORAGE(mem_class1, MEM_CLASS_1_SIZE, MEM_CLASS_1_BLOCKS, MEM_POOL_ALIGN);
+MEM_POOL_STORAGE(mem_class2, MEM_CLASS_2_SIZE, MEM_CLASS_2_BLOCKS, MEM_POOL_ALIGN);
+
+static mem_pool_t mem_classes[MEM_CLASS_COUNT];
+
+error_t mem_init(void)
+{
+    error_t err;
+
+    err = mem_pool_init(&mem_classes[0], mem_class0_blocks, mem_class0_links,
+                        MEM_POOL_ROUND(MEM_CLASS_0_SIZE, MEM_POOL_ALIGN), MEM_CLASS_0_BLOCKS);
+    if (err == ERR_OK) {
+        err = mem_pool_init(&mem_classes[1], mem_class1_blocks, mem_class1_links,
+                            MEM_POOL_ROUND(MEM_CLASS_1_SIZE, MEM_POOL_ALIGN), MEM_CLASS_1_BLOCKS);
+    }
+    if (err == ERR_OK) {
+        err = mem_pool_init(&mem_classes[2], mem_class2_blocks, mem_class2_links,
+                            MEM_POOL_ROUND(MEM_CLASS_2_SIZE, MEM_POOL_ALIGN), MEM_CLASS_2_BLOCKS);
+    }
+    return err;
+}
+
+void *mem_alloc(uint32_t size)
+{
+    uint32_t first = MEM_CLASS_COUNT;
+
+    for (uint32_t i = 0; i < MEM_CLASS_COUNT; i++) {
+        void *block;
+
+        if (mem_classes[i].storage == NULL || size > mem_classes[i].block_size) {
+            continue;
+        }
+        if (first == MEM_CLASS_COUNT) {
+            first = i;
+        }
+        block = mem_pool_take(&mem_classes[i]);
+        if (block != NULL) {
+            return block;
+        }
+    }
+    if (first < MEM_CLASS_COUNT) {
+        atomic_fetch_add_explicit(&mem_classes[first].failures, 1U, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+error_t mem_free(void *block)
+{
+    for (uint32_t i = 0; i < MEM_CLASS_COUNT; i++) {
+        if (mem_pool_owns(&mem_classes[i], block)) {
+            return mem_pool_free(&mem_classes[i], block);
+        }
+    }
+    return ERR_INVALID_PARAM;
+}
+
+error_t mem_get_class_stats(uint32_t class_index, mem_pool_stats_t *stats)
+{
+    if (class_index >= MEM_CLASS_COUNT) {
+        return ERR_INVALID_PARAM;
+    }
+    return mem_pool_get_stats(&mem_classes[class_index], stats);
+}
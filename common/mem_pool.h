@@ -0,0 +1,99 @@
+/*
+ * mem_pool.h - Fixed-block Memory Pools
+ *
+ * A pool hands out equal-size blocks from static storage. Allocation and
+ * release are O(1), never fragment (any free block fits any request the
+ * pool accepts) and are lock-free, so ISRs, the main loop and host
+ * threads may share a pool.
+ *
+ * The free list is a stack of block indices. Its head packs the top
+ * index with a 16-bit modification tag, so a compare-exchange cannot be
+ * fooled by a block popped and pushed back in between (ABA) unless the
+ * head changes 65536 times meanwhile. Links live in a side array, not in
+ * the blocks, so a stale reader never looks at user data.
+ *
+ * Two ways to use it:
+ *  - Own pool: MEM_POOL_STORAGE() + mem_pool_init(), then
+ *    mem_pool_alloc()/mem_pool_free().
+ *  - Size classes: mem_alloc(size) takes a block from the smallest class
+ *    that fits and has one free (falling back to larger classes);
+ *    mem_free() finds the class from the address.
+ *
+ * Blocks start MEM_POOL_ALIGN-aligned in the size classes (DMA bursts,
+ * cache lines on parts that have a data cache).
+ */
+
+#ifndef COMMON_MEM_POOL_H
+#define COMMON_MEM_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "error.h"
+
+#define MEM_POOL_MAX_BLOCKS     0xFFF0U
+#define MEM_POOL_ALIGN          32U
+
+/* Size classes for mem_alloc(): block size and count, smallest first */
+#define MEM_CLASS_COUNT         3U
+#define MEM_CLASS_0_SIZE        32U
+#define MEM_CLASS_0_BLOCKS      64U
+#define MEM_CLASS_1_SIZE        128U
+#define MEM_CLASS_1_BLOCKS      32U
+#define MEM_CLASS_2_SIZE        512U
+#define MEM_CLASS_2_BLOCKS      16U
+
+/* Round size up to a multiple of align (a power of two) */
+#define MEM_POOL_ROUND(size, align)     (((size) + (align) - 1U) & ~((align) - 1U))
+
+/* Storage for a pool called name: count blocks of block_size bytes,
+ * each aligned to align (a power of two) */
+#define MEM_POOL_STORAGE(name, block_size, count, align) \
+    static uint8_t name##_blocks[MEM_POOL_ROUND(block_size, align) * (count)] \
+        __attribute__((aligned(align))); \
+    static _Atomic uint16_t name##_links[count]
+
+typedef struct {
+    uint8_t *storage;
+    _Atomic uint16_t *links;    /* Next free index, or a block state */
+    uint32_t block_size;        /* Stride between blocks */
+    uint32_t block_count;
+    _Atomic uint32_t head;      /* tag << 16 | top free index */
+    _Atomic uint32_t in_use;
+    _Atomic uint32_t high_water;
+    _Atomic uint32_t failures;
+} mem_pool_t;
+
+typedef struct {
+    uint32_t block_size;
+    uint32_t block_count;
+    uint32_t in_use;
+    uint32_t high_water;        /* Most blocks ever in use at once */
+    uint32_t failures;          /* Allocations refused: pool empty */
+} mem_pool_stats_t;
+
+/* ===== Single Pool ===== */
+
+/* block_size must be a multiple of the storage alignment wanted for
+ * every block; MEM_POOL_STORAGE's arrays may be passed as they are */
+error_t mem_pool_init(mem_pool_t *pool, void *storage, _Atomic uint16_t *links,
+                      uint32_t block_size, uint32_t block_count);
+void *mem_pool_alloc(mem_pool_t *pool);
+
+/* ERR_INVALID_PARAM for a pointer that is not an allocated block of
+ * this pool (foreign, misaligned, or already freed) */
+error_t mem_pool_free(mem_pool_t *pool, void *block);
+bool mem_pool_owns(const mem_pool_t *pool, const void *block);
+error_t mem_pool_get_stats(mem_pool_t *pool, mem_pool_stats_t *stats);
+
+/* ===== Size Classes ===== */
+
+error_t mem_init(void);
+
+/* NULL (and a failure counted on the best-fitting class) if no class
+ * that fits has a free block */
+void *mem_alloc(uint32_t size);
+error_t mem_free(void *block);
+error_t mem_get_class_stats(uint32_t class_index, mem_pool_stats_t *stats);
+
+#endif /* COMMON_MEM_POOL_H */
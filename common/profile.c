@@ -0,0 +1,180 @@
+/*
+ * profile.c - Cycle-accurate Hot-path Profiling Implementation
+ */
+
+#if defined(BOARD_HOST) && !defined(__x86_64__) && !defined(__i386__)
+#define _POSIX_C_SOURCE 200809L
+#include <time.h>
+#endif
+
+#include "profile.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+#if !defined(BOARD_HOST)
+/* ===== Cortex-M Debug Registers ===== */
+#define PROFILE_DEMCR           (*(volatile uint32_t *)0xE000EDFCUL)
+#define PROFILE_DWT_CTRL        (*(volatile uint32_t *)0xE0001000UL)
+#define PROFILE_DEMCR_TRCENA    (1UL << 24)
+#define PROFILE_DWT_CYCCNTENA   (1UL << 0)
+#elif !defined(__x86_64__) && !defined(__i386__)
+uint32_t profile_cycles(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+#endif
+
+/* Registered probes, newest first */
+static _Atomic(profile_probe_t *) profile_probes = NULL;
+
+error_t profile_init(void)
+{
+#if !defined(BOARD_HOST)
+    PROFILE_DEMCR |= PROFILE_DEMCR_TRCENA;
+    PROFILE_DWT_CYCCNT = 0;
+    PROFILE_DWT_CTRL |= PROFILE_DWT_CYCCNTENA;
+#endif
+    return ERR_OK;
+}
+
+static void profile_register(profile_probe_t *probe)
+{
+    profile_probe_t *head = atomic_load_explicit(&profile_probes, memory_order_relaxed);
+
+    probe->min = UINT32_MAX;
+    do {
+        probe->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&profile_probes, &head, probe,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+void profile_record(profile_probe_t *probe, uint32_t cycles)
+{
+    uint32_t bucket = 0;
+
+    if (!probe->registered) {
+        probe->registered = true;
+        profile_register(probe);
+    }
+
+    probe->count++;
+    probe->total += cycles;
+    if (cycles < probe->min) {
+        probe->min = cycles;
+    }
+    if (cycles > probe->max) {
+        probe->max = cycles;
+    }
+
+    /* Bucket n: 2^(n-1) <= cycles < 2^n (0 holds zero-cost samples) */
+    if (cycles != 0U) {
+        bucket = 32U - (uint32_t)__builtin_clz(cycles);
+        if (bucket >= PROFILE_HIST_BUCKETS) {
+            bucket = PROFILE_HIST_BUCKETS - 1U;
+        }
+    }
+    probe->hist[bucket]++;
+}
+
+uint32_t profile_probe_count(void)
+{
+    uint32_t count = 0;
+
+    for (profile_probe_t *p = atomic_load_explicit(&profile_probes, memory_order_acquire);
+         p != NULL; p = p->next) {
+        count++;
+    }
+    return count;
+}
+
+const profile_probe_t *profile_probe_get(uint32_t index)
+{
+    profile_probe_t *p = atomic_load_explicit(&profile_probes, memory_order_acquire);
+
+    while (p != NULL && index > 0U) {
+        p = p->next;
+        index--;
+    }
+    return p;
+}
+
+void profile_reset(void)
+{
+    for (profile_probe_t *p = atomic_load_explicit(&profile_probes, memory_order_acquire);
+         p != NULL; p = p->next) {
+        p->count = 0;
+        p->min = UINT32_MAX;
+        p->max = 0;
+        p->total = 0;
+        for (uint32_t i = 0; i < PROFILE_HIST_BUCKETS; i++) {
+            p->hist[i] = 0;
+        }
+    }
+}
+
+/* ===== Dump ===== */
+
+/* Append the decimal form of value at *pos */
+static void profile_put_u32(char *buf, uint32_t *pos, uint32_t value)
+{
+    char digits[10];
+    uint32_t n = 0;
+
+    do {
+        digits[n++] = (char)('0' + (value % 10U));
+        value /= 10U;
+    } while (value != 0U);
+    while (n > 0U) {
+        buf[(*pos)++] = digits[--n];
+    }
+}
+
+static void profile_put_str(char *buf, uint32_t *pos, const char *text, uint32_t limit)
+{
+    for (uint32_t i = 0; text[i] != '\0' && i < limit; i++) {
+        buf[(*pos)++] = text[i];
+    }
+}
+
+void profile_dump(profile_write_fn_t write, void *context)
+{
+    /* Longest line: 24-char name, 4 fields, every bucket, CR LF NUL */
+    char line[24 + 4 * 11 + PROFILE_HIST_BUCKETS * 17 + 3];
+
+    if (write == NULL) {
+        return;
+    }
+    write("probe count min mean max hist\r\n", context);
+
+    for (profile_probe_t *p = atomic_load_explicit(&profile_probes, memory_order_acquire);
+         p != NULL; p = p->next) {
+        uint32_t pos = 0;
+        uint32_t count = p->count;
+
+        profile_put_str(line, &pos, p->name, 24U);
+        line[pos++] = ' ';
+        profile_put_u32(line, &pos, count);
+        line[pos++] = ' ';
+        profile_put_u32(line, &pos, (count != 0U) ? p->min : 0U);
+        line[pos++] = ' ';
+        profile_put_u32(line, &pos, (count != 0U) ? (uint32_t)(p->total / count) : 0U);
+        line[pos++] = ' ';
+        profile_put_u32(line, &pos, p->max);
+        for (uint32_t b = 0; b < PROFILE_HIST_BUCKETS; b++) {
+            if (p->hist[b] != 0U) {
+                profile_put_str(line, &pos, " <2^", 4U);
+                profile_put_u32(line, &pos, b);
+                line[pos++] = ':';
+                profile_put_u32(line, &pos, p->hist[b]);
+            }
+        }
+        line[pos++] = '\r';
+        line[pos++] = '\n';
+        line[pos] = '\0';
+        write(line, context);
+    }
+}
@@ -0,0 +1,102 @@
+/*
+ * profile.h - Cycle-accurate Hot-path Profiling
+ *
+ * Wrap a region in PROFILE_BEGIN(name) / PROFILE_END(name) to record
+ * its cost in CPU cycles into a probe called name: count, min, max,
+ * mean and a log2 histogram (bucket n holds costs in [2^(n-1), 2^n)).
+ * Probes are static and register themselves on first use; the table is
+ * read back with profile_probe_count()/profile_probe_get() or printed
+ * with profile_dump().
+ *
+ * Build with PROFILE=1 (-DPROFILE_ENABLED) to compile probes in;
+ * otherwise both macros expand to nothing.
+ *
+ * Cycle source: the DWT cycle counter on the target; on BOARD=host
+ * (-DBOARD_HOST) the TSC on x86, CLOCK_MONOTONIC nanoseconds elsewhere.
+ *
+ * A probe must only be recorded from one context (a function that runs
+ * in both thread and interrupt context needs two probes).
+ */
+
+#ifndef COMMON_PROFILE_H
+#define COMMON_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "error.h"
+
+#define PROFILE_HIST_BUCKETS    32U
+
+typedef struct profile_probe {
+    const char *name;
+    struct profile_probe *next;     /* Registration list (private) */
+    bool registered;
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t hist[PROFILE_HIST_BUCKETS];
+} profile_probe_t;
+
+/* Text sink for profile_dump() */
+typedef void (*profile_write_fn_t)(const char *text, void *context);
+
+/* ===== Cycle Counter ===== */
+
+#if !defined(BOARD_HOST)
+
+#define PROFILE_DWT_CYCCNT  (*(volatile uint32_t *)0xE0001004UL)
+
+static inline uint32_t profile_cycles(void)
+{
+    return PROFILE_DWT_CYCCNT;
+}
+
+#elif defined(__x86_64__) || defined(__i386__)
+
+#include <x86intrin.h>
+
+static inline uint32_t profile_cycles(void)
+{
+    return (uint32_t)__rdtsc();
+}
+
+#else
+
+uint32_t profile_cycles(void);
+
+#endif
+
+/* ===== Probes ===== */
+
+#ifdef PROFILE_ENABLED
+
+#define PROFILE_BEGIN(probe_name) \
+    static profile_probe_t profile_probe_##probe_name = { .name = #probe_name }; \
+    const uint32_t profile_start_##probe_name = profile_cycles()
+
+#define PROFILE_END(probe_name) \
+    profile_record(&profile_probe_##probe_name, profile_cycles() - profile_start_##probe_name)
+
+#else
+
+#define PROFILE_BEGIN(probe_name)   ((void)0)
+#define PROFILE_END(probe_name)     ((void)0)
+
+#endif /* PROFILE_ENABLED */
+
+/* Start the cycle counter (DWT needs enabling on target) */
+error_t profile_init(void);
+
+void profile_record(profile_probe_t *probe, uint32_t cycles);
+
+/* Runtime access to the probe table */
+uint32_t profile_probe_count(void);
+const profile_probe_t *profile_probe_get(uint32_t index);
+void profile_reset(void);
+
+/* One line per probe: name count min mean max, then the non-empty
+ * histogram buckets as <2^n:count */
+void profile_dump(profile_write_fn_t write, void *context);
+
+#endif /* COMMON_PROFILE_H */
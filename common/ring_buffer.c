@@ -0,0 +1,133 @@
+/*
+ * ring_buffer.c - Lock-free SPSC Byte Ring Implementation
+ */
+
+#include "ring_buffer.h"
+#include "hot_path.h"
+#include <string.h>
+
+error_t ring_buffer_init(ring_buffer_t *rb, uint8_t *storage, uint32_t size)
+{
+    if (rb == NULL || storage == NULL || size == 0 || (size & (size - 1U)) != 0) {
+        return ERR_INVALID_PARAM;
+    }
+    rb->buffer = storage;
+    rb->mask = size - 1U;
+    atomic_init(&rb->head, 0);
+    atomic_init(&rb->tail, 0);
+    return ERR_OK;
+}
+
+void ring_buffer_reset(ring_buffer_t *rb)
+{
+    atomic_store_explicit(&rb->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&rb->tail, 0, memory_order_relaxed);
+}
+
+HOT_FUNC uint32_t ring_buffer_write(ring_buffer_t *rb, const uint8_t *data, uint32_t length)
+{
+    uint32_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    uint32_t space = (rb->mask + 1U) - (head - tail);
+    uint32_t offset = head & rb->mask;
+    uint32_t first;
+
+    if (length > space) {
+        length = space;
+    }
+
+    /* Copy up to the end of storage, then wrap */
+    first = (rb->mask + 1U) - offset;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(&rb->buffer[offset], data, first);
+    memcpy(rb->buffer, &data[first], length - first);
+
+    atomic_store_explicit(&rb->head, head + length, memory_order_release);
+    return length;
+}
+
+HOT_FUNC bool ring_buffer_put(ring_buffer_t *rb, uint8_t byte)
+{
+    uint32_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+
+    if ((head - tail) > rb->mask) {
+        return false;
+    }
+    rb->buffer[head & rb->mask] = byte;
+    atomic_store_explicit(&rb->head, head + 1U, memory_order_release);
+    return true;
+}
+
+HOT_FUNC uint32_t ring_buffer_reserve_linear(ring_buffer_t *rb, uint8_t **span)
+{
+    uint32_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    uint32_t space = (rb->mask + 1U) - (head - tail);
+    uint32_t offset = head & rb->mask;
+    uint32_t to_end = (rb->mask + 1U) - offset;
+
+    *span = &rb->buffer[offset];
+    return (space < to_end) ? space : to_end;
+}
+
+HOT_FUNC void ring_buffer_commit(ring_buffer_t *rb, uint32_t length)
+{
+    uint32_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    atomic_store_explicit(&rb->head, head + length, memory_order_release);
+}
+
+HOT_FUNC uint32_t ring_buffer_read(ring_buffer_t *rb, uint8_t *data, uint32_t length)
+{
+    uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+    uint32_t used = head - tail;
+    uint32_t offset = tail & rb->mask;
+    uint32_t first;
+
+    if (length > used) {
+        length = used;
+    }
+
+    first = (rb->mask + 1U) - offset;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(data, &rb->buffer[offset], first);
+    memcpy(&data[first], rb->buffer, length - first);
+
+    atomic_store_explicit(&rb->tail, tail + length, memory_order_release);
+    return length;
+}
+
+HOT_FUNC uint32_t ring_buffer_peek_linear(ring_buffer_t *rb, const uint8_t **span)
+{
+    uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+    uint32_t used = head - tail;
+    uint32_t offset = tail & rb->mask;
+    uint32_t to_end = (rb->mask + 1U) - offset;
+
+    *span = &rb->buffer[offset];
+    return (used < to_end) ? used : to_end;
+}
+
+HOT_FUNC void ring_buffer_consume(ring_buffer_t *rb, uint32_t length)
+{
+    uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    atomic_store_explicit(&rb->tail, tail + length, memory_order_release);
+}
+
+HOT_FUNC uint32_t ring_buffer_used(ring_buffer_t *rb)
+{
+    uint32_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    return head - tail;
+}
+
+HOT_FUNC uint32_t ring_buffer_free(ring_buffer_t *rb)
+{
+    return (rb->mask + 1U) - ring_buffer_used(rb);
+}
@@ -0,0 +1,47 @@
+/*
+ * ring_buffer.h - Lock-free Single-Producer/Single-Consumer Byte Ring
+ *
+ * One context writes (producer), one context reads (consumer), e.g.
+ * main loop -> UART TX ISR, or UART RX ISR -> main loop. No locks and no
+ * interrupt masking: head is only written by the producer, tail only by
+ * the consumer, and both are published with acquire/release ordering.
+ *
+ * Capacity must be a power of two; indices run free and are masked.
+ */
+
+#ifndef COMMON_RING_BUFFER_H
+#define COMMON_RING_BUFFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "error.h"
+
+typedef struct {
+    uint8_t *buffer;
+    uint32_t mask;              /* capacity - 1 */
+    _Atomic uint32_t head;      /* Next write index (producer owned) */
+    _Atomic uint32_t tail;      /* Next read index (consumer owned) */
+} ring_buffer_t;
+
+/* Setup (not concurrent with producer/consumer) */
+error_t ring_buffer_init(ring_buffer_t *rb, uint8_t *storage, uint32_t size);
+void ring_buffer_reset(ring_buffer_t *rb);
+
+/* Producer side */
+uint32_t ring_buffer_write(ring_buffer_t *rb, const uint8_t *data, uint32_t length);
+bool ring_buffer_put(ring_buffer_t *rb, uint8_t byte);
+/* Zero-copy: fill the contiguous free span in place, then publish */
+uint32_t ring_buffer_reserve_linear(ring_buffer_t *rb, uint8_t **span);
+void ring_buffer_commit(ring_buffer_t *rb, uint32_t length);
+
+/* Consumer side */
+uint32_t ring_buffer_read(ring_buffer_t *rb, uint8_t *data, uint32_t length);
+uint32_t ring_buffer_peek_linear(ring_buffer_t *rb, const uint8_t **span);
+void ring_buffer_consume(ring_buffer_t *rb, uint32_t length);
+
+/* Either side */
+uint32_t ring_buffer_used(ring_buffer_t *rb);
+uint32_t ring_buffer_free(ring_buffer_t *rb);
+
+#endif /* COMMON_RING_BUFFER_H */
@@ -0,0 +1,191 @@
+/*
+ * scheduler.c - Run-to-completion Priority Task Scheduler Implementation
+ */
+
+#include "scheduler.h"
+#include "hot_path.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+typedef struct {
+    sched_task_config_t config;
+    _Atomic uint32_t events;    /* Posted, not yet handed to the task */
+    uint64_t next_release_us;   /* Periodic tasks only */
+    uint64_t ready_since_us;    /* Start of the deadline window */
+    bool ready_seen;
+    sched_task_stats_t stats;
+} sched_task_t;
+
+static sched_task_t sched_tasks[SCHED_MAX_TASKS];
+static uint8_t sched_task_count = 0;
+static sched_clock_fn_t sched_clock = NULL;
+
+/* Raise SCHED_EVENT_PERIODIC on every periodic task that is due */
+static HOT_FUNC void sched_release_periodic(uint64_t now)
+{
+    for (uint8_t i = 0; i < sched_task_count; i++) {
+        sched_task_t *task = &sched_tasks[i];
+
+        if (task->config.period_us == 0U || task->next_release_us > now) {
+            continue;
+        }
+        if (!task->ready_seen) {
+            task->ready_since_us = task->next_release_us;
+            task->ready_seen = true;
+        }
+        atomic_fetch_or_explicit(&task->events, SCHED_EVENT_PERIODIC, memory_order_relaxed);
+
+        /* Stay on the period grid; releases missed by an overrun collapse
+         * into this one instead of firing back-to-back */
+        task->next_release_us += task->config.period_us;
+        if (task->next_release_us <= now) {
+            task->next_release_us = now + task->config.period_us;
+        }
+    }
+}
+
+/* Highest-priority ready task (lowest value, table order on ties) */
+static HOT_FUNC sched_task_t *sched_pick(uint64_t now)
+{
+    sched_task_t *best = NULL;
+
+    for (uint8_t i = 0; i < sched_task_count; i++) {
+        sched_task_t *task = &sched_tasks[i];
+
+        if (atomic_load_explicit(&task->events, memory_order_acquire) == 0U) {
+            continue;
+        }
+        if (!task->ready_seen) {
+            task->ready_since_us = now;
+            task->ready_seen = true;
+        }
+        if (best == NULL || task->config.priority < best->config.priority) {
+            best = task;
+        }
+    }
+    return best;
+}
+
+error_t sched_init(sched_clock_fn_t clock)
+{
+    if (clock == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    sched_task_count = 0;
+    sched_clock = clock;
+    return ERR_OK;
+}
+
+error_t sched_add_task(const sched_task_config_t *config, sched_task_id_t *id)
+{
+    sched_task_t *task;
+
+    if (config == NULL || config->run == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    if (sched_clock == NULL) {
+        return ERR_NOT_INITIALIZED;
+    }
+    if (sched_task_count >= SCHED_MAX_TASKS) {
+        return ERR_MEMORY;
+    }
+
+    task = &sched_tasks[sched_task_count];
+    task->config = *config;
+    if (task->config.deadline_us == 0U) {
+        task->config.deadline_us = task->config.period_us;
+    }
+    atomic_init(&task->events, 0U);
+    task->next_release_us = sched_clock() + config->period_us;
+    task->ready_since_us = 0;
+    task->ready_seen = false;
+    task->stats = (sched_task_stats_t){0};
+
+    if (id != NULL) {
+        *id = sched_task_count;
+    }
+    sched_task_count++;
+    return ERR_OK;
+}
+
+HOT_FUNC error_t sched_post(sched_task_id_t id, uint32_t events)
+{
+    if (id >= sched_task_count || events == 0U) {
+        return ERR_INVALID_PARAM;
+    }
+    atomic_fetch_or_explicit(&sched_tasks[id].events, events, memory_order_release);
+    return ERR_OK;
+}
+
+HOT_FUNC uint32_t sched_run_ready(void)
+{
+    uint32_t runs = 0;
+
+    if (sched_clock == NULL) {
+        return 0;
+    }
+
+    for (;;) {
+        uint64_t start = sched_clock();
+        sched_task_t *task;
+        uint32_t events;
+        uint64_t end;
+        uint32_t runtime;
+
+        sched_release_periodic(start);
+        task = sched_pick(start);
+        if (task == NULL) {
+            break;
+        }
+
+        events = atomic_exchange_explicit(&task->events, 0U, memory_order_acquire);
+        task->config.run(events, task->config.context);
+        end = sched_clock();
+
+        runtime = (uint32_t)(end - start);
+        task->stats.runs++;
+        task->stats.last_runtime_us = runtime;
+        task->stats.total_runtime_us += runtime;
+        if (runtime > task->stats.max_runtime_us) {
+            task->stats.max_runtime_us = runtime;
+        }
+        if (task->config.deadline_us != 0U &&
+            (end - task->ready_since_us) > task->config.deadline_us) {
+            task->stats.deadline_misses++;
+        }
+        task->ready_seen = false;
+        runs++;
+    }
+    return runs;
+}
+
+HOT_FUNC uint64_t sched_next_release_us(void)
+{
+    uint64_t next = UINT64_MAX;
+
+    for (uint8_t i = 0; i < sched_task_count; i++) {
+        if (sched_tasks[i].config.period_us != 0U && sched_tasks[i].next_release_us < next) {
+            next = sched_tasks[i].next_release_us;
+        }
+    }
+    return next;
+}
+
+HOT_FUNC bool sched_events_pending(void)
+{
+    for (uint8_t i = 0; i < sched_task_count; i++) {
+        if (atomic_load_explicit(&sched_tasks[i].events, memory_order_relaxed) != 0U) {
+            return true;
+        }
+    }
+    return false;
+}
+
+error_t sched_get_stats(sched_task_id_t id, sched_task_stats_t *stats)
+{
+    if (stats == NULL || id >= sched_task_count) {
+        return ERR_INVALID_PARAM;
+    }
+    *stats = sched_tasks[id].stats;
+    return ERR_OK;
+}
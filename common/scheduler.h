@@ -0,0 +1,86 @@
+/*
+ * scheduler.h - Run-to-completion Priority Task Scheduler
+ *
+ * A fixed table of tasks, registered once at init; no heap. A task is
+ * ready when it has pending events: bits posted with sched_post() (from
+ * any context, including interrupts) or SCHED_EVENT_PERIODIC, raised
+ * by the scheduler at each release of a periodic task. Tasks run only
+ * when ready, one at a time and to completion, highest priority first;
+ * between two tasks the choice is made again, so urgent work never
+ * waits behind more than one running task.
+ *
+ * Per task the scheduler records run count and runtime and counts a
+ * deadline miss whenever a run completes later than deadline_us after
+ * the task became ready (after its release time, for periodic runs).
+ *
+ * The time source is passed to sched_init() so this module does not
+ * depend on the BSP.
+ */
+
+#ifndef COMMON_SCHEDULER_H
+#define COMMON_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "error.h"
+
+#ifndef SCHED_MAX_TASKS
+#define SCHED_MAX_TASKS         16U
+#endif
+
+/* Raised by the scheduler on each release of a periodic task */
+#define SCHED_EVENT_PERIODIC    (1UL << 31)
+
+/* Priority 0 is the most urgent */
+#define SCHED_PRIORITY_HIGH     0U
+#define SCHED_PRIORITY_NORMAL   8U
+#define SCHED_PRIORITY_LOW      15U
+
+typedef uint8_t sched_task_id_t;
+
+/* Task body: events holds every bit posted since the previous run */
+typedef void (*sched_task_fn_t)(uint32_t events, void *context);
+
+/* Monotonic microsecond clock */
+typedef uint64_t (*sched_clock_fn_t)(void);
+
+typedef struct {
+    const char *name;
+    sched_task_fn_t run;
+    void *context;
+    uint8_t priority;
+    uint32_t period_us;         /* 0 = event-triggered only */
+    uint32_t deadline_us;       /* 0 = period_us (or none if not periodic) */
+} sched_task_config_t;
+
+typedef struct {
+    uint32_t runs;
+    uint32_t deadline_misses;
+    uint32_t last_runtime_us;
+    uint32_t max_runtime_us;
+    uint64_t total_runtime_us;
+} sched_task_stats_t;
+
+/* Setup (before any task runs) */
+error_t sched_init(sched_clock_fn_t clock);
+error_t sched_add_task(const sched_task_config_t *config, sched_task_id_t *id);
+
+/* Make a task ready; safe from interrupt context */
+error_t sched_post(sched_task_id_t id, uint32_t events);
+
+/* Run ready tasks in priority order until none is left.
+ * Returns the number of task runs.
+ */
+uint32_t sched_run_ready(void);
+
+/* Idle support: next periodic release (UINT64_MAX if none) and whether
+ * posted events are waiting. sched_events_pending() is cheap enough to
+ * call with interrupts masked right before sleeping.
+ */
+uint64_t sched_next_release_us(void);
+bool sched_events_pending(void);
+
+/* Statistics */
+error_t sched_get_stats(sched_task_id_t id, sched_task_stats_t *stats);
+
+#endif /* COMMON_SCHEDULER_H */
@@ -0,0 +1,262 @@
+/*
+ * sw_timer.c - Hierarchical Timing Wheel Implementation
+ */
+
+#include "sw_timer.h"
+#include <stddef.h>
+
+#define WHEEL_LEVELS        4U
+#define WHEEL_BITS          6U
+#define WHEEL_SLOTS         (1U << WHEEL_BITS)
+#define WHEEL_MASK          (WHEEL_SLOTS - 1U)
+
+/* Longest delta placed exactly; longer timers are parked at this
+ * distance and re-placed when their top-wheel slot comes round */
+#define WHEEL_MAX_DELTA     ((1UL << (WHEEL_LEVELS * WHEEL_BITS)) - 1U)
+
+#define WHEEL_INDEX(tick, level)    (((tick) >> ((level) * WHEEL_BITS)) & WHEEL_MASK)
+
+static sw_timer_t *wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static uint32_t wheel_count[WHEEL_LEVELS];
+static uint32_t wheel_now;
+
+/* ===== Slot Lists ===== */
+
+static void wheel_link(sw_timer_t **slot, sw_timer_t *timer, uint8_t level)
+{
+    timer->next = *slot;
+    if (*slot != NULL) {
+        (*slot)->pprev = &timer->next;
+    }
+    timer->pprev = slot;
+    timer->level = level;
+    *slot = timer;
+    wheel_count[level]++;
+}
+
+static void wheel_unlink(sw_timer_t *timer)
+{
+    *timer->pprev = timer->next;
+    if (timer->next != NULL) {
+        timer->next->pprev = timer->pprev;
+    }
+    timer->next = NULL;
+    timer->pprev = NULL;
+    wheel_count[timer->level]--;
+}
+
+/* Place a timer by its distance from wheel_now */
+static void wheel_insert(sw_timer_t *timer)
+{
+    uint32_t delta = timer->expires - wheel_now;
+    uint32_t target = timer->expires;
+    uint8_t level = 0;
+
+    if ((int32_t)delta < 0) {
+        /* Already due: the slot being processed now */
+        delta = 0;
+        target = wheel_now;
+    } else if (delta > WHEEL_MAX_DELTA) {
+        delta = WHEEL_MAX_DELTA;
+        target = wheel_now + WHEEL_MAX_DELTA;
+    }
+
+    while (level < (WHEEL_LEVELS - 1U) && delta >= (1UL << ((level + 1U) * WHEEL_BITS))) {
+        level++;
+    }
+    wheel_link(&wheel[level][WHEEL_INDEX(target, level)], timer, level);
+}
+
+/* Redistribute one upper-wheel slot; returns its index */
+static uint32_t wheel_cascade(uint8_t level)
+{
+    uint32_t index = WHEEL_INDEX(wheel_now, level);
+    sw_timer_t *timer;
+
+    while ((timer = wheel[level][index]) != NULL) {
+        wheel_unlink(timer);
+        wheel_insert(timer);
+    }
+    return index;
+}
+
+/* Ticks from wheel_now until the k-th slot ahead (1..WHEEL_SLOTS) of a
+ * level comes round: level 0 fires it, upper levels cascade it. The
+ * current slot of an upper level comes round last, one turn on. */
+static uint32_t wheel_slot_ticks(uint32_t level, uint32_t k)
+{
+    uint32_t shift = level * WHEEL_BITS;
+
+    return (((wheel_now >> shift) + k) << shift) - wheel_now;
+}
+
+static sw_timer_t *wheel_slot_ahead(uint32_t level, uint32_t k)
+{
+    return wheel[level][(WHEEL_INDEX(wheel_now, level) + k) & WHEEL_MASK];
+}
+
+/* Ticks to the next tick at which the wheel has work: an occupied level-0
+ * slot or an occupied upper slot to cascade. Ticks before it can be
+ * skipped without stepping. */
+static uint32_t wheel_next_event(void)
+{
+    uint32_t best = UINT32_MAX;
+
+    for (uint32_t level = 0; level < WHEEL_LEVELS; level++) {
+        if (wheel_count[level] == 0U) {
+            continue;
+        }
+        for (uint32_t k = 1; k <= WHEEL_SLOTS; k++) {
+            uint32_t ticks = wheel_slot_ticks(level, k);
+
+            if (ticks >= best) {
+                break;
+            }
+            if (wheel_slot_ahead(level, k) != NULL) {
+                best = ticks;
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+/* ===== Timer API ===== */
+
+void sw_timer_init(uint32_t now)
+{
+    for (uint32_t level = 0; level < WHEEL_LEVELS; level++) {
+        for (uint32_t slot = 0; slot < WHEEL_SLOTS; slot++) {
+            wheel[level][slot] = NULL;
+        }
+        wheel_count[level] = 0;
+    }
+    wheel_now = now;
+}
+
+error_t sw_timer_setup(sw_timer_t *timer, sw_timer_callback_t callback, void *context)
+{
+    if (timer == NULL || callback == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->level = 0;
+    timer->expires = 0;
+    timer->period = 0;
+    timer->callback = callback;
+    timer->context = context;
+    timer->active = false;
+    return ERR_OK;
+}
+
+error_t sw_timer_start(sw_timer_t *timer, uint32_t delay, uint32_t period)
+{
+    if (timer == NULL || timer->callback == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+
+    /* Restarting an armed timer moves it */
+    if (timer->active) {
+        wheel_unlink(timer);
+    }
+
+    /* Zero delay means the next tick, never the one being processed */
+    timer->expires = wheel_now + ((delay == 0U) ? 1U : delay);
+    timer->period = period;
+    timer->active = true;
+    wheel_insert(timer);
+    return ERR_OK;
+}
+
+error_t sw_timer_stop(sw_timer_t *timer)
+{
+    if (timer == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    if (timer->active) {
+        wheel_unlink(timer);
+        timer->active = false;
+    }
+    return ERR_OK;
+}
+
+bool sw_timer_is_active(const sw_timer_t *timer)
+{
+    return (timer != NULL) && timer->active;
+}
+
+void sw_timer_process(uint32_t now)
+{
+    /* Nothing armed: jump straight there */
+    if (wheel_count[0] + wheel_count[1] + wheel_count[2] + wheel_count[3] == 0U) {
+        wheel_now = now;
+        return;
+    }
+
+    while ((int32_t)(now - wheel_now) > 0) {
+        uint32_t index;
+        sw_timer_t *timer;
+
+        /* Catching up after skipped ticks: jump the stretch in which
+         * nothing fires or cascades */
+        if (now - wheel_now > 1U) {
+            uint32_t skip = wheel_next_event();
+
+            if (skip > now - wheel_now) {
+                wheel_now = now;
+                break;
+            }
+            wheel_now += skip - 1U;
+        }
+
+        wheel_now++;
+        index = WHEEL_INDEX(wheel_now, 0U);
+
+        /* Pull the next stretch of each upper wheel down as lower ones wrap */
+        if (index == 0U && wheel_cascade(1U) == 0U && wheel_cascade(2U) == 0U) {
+            (void)wheel_cascade(3U);
+        }
+
+        /* Callbacks may start/stop any timer, so take one at a time */
+        while ((timer = wheel[0][index]) != NULL) {
+            wheel_unlink(timer);
+            timer->active = false;
+            if (timer->period != 0U) {
+                timer->expires += timer->period;
+                timer->active = true;
+                wheel_insert(timer);
+            }
+            timer->callback(timer, timer->context);
+        }
+    }
+}
+
+uint32_t sw_timer_ticks_to_next(void)
+{
+    uint32_t best = UINT32_MAX;
+
+    /* A slot holds no timer due before it comes round, so each level is
+     * scanned in slot order only until its slots start past the best
+     * expiry found. Timers parked beyond the top wheel keep their real
+     * expiry, later than their slot. */
+    for (uint32_t level = 0; level < WHEEL_LEVELS; level++) {
+        if (wheel_count[level] == 0U) {
+            continue;
+        }
+        for (uint32_t k = 1; k <= WHEEL_SLOTS; k++) {
+            if (wheel_slot_ticks(level, k) >= best) {
+                break;
+            }
+            for (const sw_timer_t *timer = wheel_slot_ahead(level, k); timer != NULL;
+                 timer = timer->next) {
+                uint32_t ticks = timer->expires - wheel_now;
+
+                if (ticks < best) {
+                    best = ticks;
+                }
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,63 @@
+/*
+ * sw_timer.h - Software Timers on a Hierarchical Timing Wheel
+ *
+ * Four wheels of 64 slots; wheel n has a resolution of 64^n ticks, so
+ * delays up to 2^24 ticks (4.6 hours at 1 ms) are placed directly and
+ * longer ones are re-placed as they come closer. Starting and stopping
+ * a timer is O(1) (insert into/unlink from a slot list) regardless of
+ * how many timers are armed; each elapsed tick expires one level-0 slot
+ * and, every 64 ticks, redistributes one slot of the next wheel.
+ *
+ * Timers are caller-owned (no heap). The tick unit is whatever the
+ * caller feeds sw_timer_process(); the application uses milliseconds.
+ * The service is not interrupt-safe: start, stop and process must all
+ * run in the same (thread/main-loop) context. Callbacks run from
+ * sw_timer_process() and may start or stop any timer, including their
+ * own.
+ */
+
+#ifndef COMMON_SW_TIMER_H
+#define COMMON_SW_TIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "error.h"
+
+typedef struct sw_timer sw_timer_t;
+
+typedef void (*sw_timer_callback_t)(sw_timer_t *timer, void *context);
+
+struct sw_timer {
+    sw_timer_t *next;           /* Slot list links (private) */
+    sw_timer_t **pprev;
+    uint8_t level;
+    uint32_t expires;           /* Absolute expiry tick */
+    uint32_t period;            /* Re-arm interval, 0 = one-shot */
+    sw_timer_callback_t callback;
+    void *context;
+    bool active;
+};
+
+/* Service setup: now is the current tick */
+void sw_timer_init(uint32_t now);
+
+/* Timer API */
+error_t sw_timer_setup(sw_timer_t *timer, sw_timer_callback_t callback, void *context);
+error_t sw_timer_start(sw_timer_t *timer, uint32_t delay, uint32_t period);
+error_t sw_timer_stop(sw_timer_t *timer);
+bool sw_timer_is_active(const sw_timer_t *timer);
+
+/* Advance to tick now, running the callbacks of every timer that is due.
+ * Ticks may be skipped (e.g. after tickless idle); due timers still
+ * fire, in expiry order.
+ */
+void sw_timer_process(uint32_t now);
+
+/* Ticks from the last processed tick to the earliest expiry of any armed
+ * timer, on every wheel level; sleeping that long and then calling
+ * sw_timer_process() cascades and fires everything on time. UINT32_MAX
+ * when no timer is armed.
+ */
+uint32_t sw_timer_ticks_to_next(void);
+
+#endif /* COMMON_SW_TIMER_H */
@@ -1,8 +1,55 @@
 /*
  * gpio_driver.c - GPIO Driver Implementation
+ *
+ * Debounced edges: the interrupt is the only writer of a line's edge
+ * record (sequence, latest edge time, burst start, level, interrupts
+ * taken) and publishes
+ * it seqlock-style: seq is odd while the record is being written and
+ * advances by two per edge. gpio_driver_process() reads a consistent
+ * copy, and a burst has settled when seq has not moved since the last
+ * confirmation and the latest edge is debounce_us old. Edge times are
+ * kept as the low 32 bits of bsp_time_us() (atomic on every target) and
+ * widened back against the main loop's clock; bursts are far shorter
+ * than the 71 minutes that covers.
  */
 
 #include "gpio_driver.h"
+#include "../common/hot_path.h"
+#include "../common/event_bus.h"
+#include <stdatomic.h>
+
+typedef struct {
+    gpio_pin_t pin;
+    gpio_edge_t edge;
+    uint32_t debounce_us;
+    gpio_driver_edge_callback_t callback;
+    void *context;
+    _Atomic bool active;
+
+    /* Interrupt owned */
+    bool raw_level;                 /* Level at the latest interrupt */
+    bool seen_edge;                 /* An edge since enable */
+    _Atomic uint32_t seq;
+    _Atomic uint32_t last_edge_us;
+    _Atomic uint32_t burst_start_us;
+    _Atomic bool level;
+    _Atomic uint32_t record_edges;  /* edges as of this record */
+    _Atomic uint32_t edges;
+    _Atomic uint32_t missed;
+    _Atomic uint32_t accepted;
+
+    /* Main loop owned (debounced lines) */
+    uint32_t confirmed_seq;
+    uint32_t confirmed_edges;       /* edges counted at that confirmation */
+    uint32_t filtered;
+    bool stable_level;              /* Last accepted level */
+} gpio_edge_line_t;
+
+static gpio_edge_line_t gpio_edge_lines[GPIO_EXTI_LINES];
+static uint16_t gpio_debounced_lines;   /* Lines gpio_driver_process() watches */
+static uint64_t gpio_process_now_us;    /* Last now_us given to gpio_driver_process() */
+
+EVENT_TOPIC_DEFINE(gpio_edge_topic);
 
 error_t gpio_driver_init(void)
 {
@@ -12,9 +59,16 @@ error_t gpio_driver_init(void)
 
 error_t gpio_driver_deinit(void)
 {
+    for (uint32_t line = 0; line < GPIO_EXTI_LINES; line++) {
+        if (atomic_load_explicit(&gpio_edge_lines[line].active, memory_order_relaxed)) {
+            (void)gpio_driver_disable_edge(gpio_edge_lines[line].pin);
+        }
+    }
     return ERR_OK;
 }
 
+#ifndef HAL_STATIC_BINDING
+
 error_t gpio_driver_configure(gpio_pin_t pin, gpio_mode_t mode)
 {
     gpio_configure(pin, mode, GPIO_OUTPUT_PP, GPIO_PULL_NONE, GPIO_SPEED_HIGH);
@@ -47,3 +101,266 @@ error_t gpio_driver_read(gpio_pin_t pin, bool *value)
     *value = gpio_read(pin);
     return ERR_OK;
 }
+
+error_t gpio_driver_port_write_masked(gpio_port_t port, uint16_t mask, uint16_t value)
+{
+    if (port >= GPIO_BOARD_PORT_COUNT) {
+        return ERR_INVALID_PARAM;
+    }
+    gpio_port_write_masked(port, mask, value);
+    return ERR_OK;
+}
+
+error_t gpio_driver_port_set_clear(gpio_port_t port, uint16_t set_mask, uint16_t clear_mask)
+{
+    if (port >= GPIO_BOARD_PORT_COUNT) {
+        return ERR_INVALID_PARAM;
+    }
+    gpio_port_set_clear(port, set_mask, clear_mask);
+    return ERR_OK;
+}
+
+error_t gpio_driver_port_read(gpio_port_t port, uint16_t *value)
+{
+    if (port >= GPIO_BOARD_PORT_COUNT || value == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    *value = gpio_port_read(port);
+    return ERR_OK;
+}
+
+#endif /* !HAL_STATIC_BINDING */
+
+/* ===== Edge Events ===== */
+
+static HOT_FUNC void gpio_driver_edge_isr(gpio_pin_t pin, bool level, uint64_t timestamp_us)
+{
+    gpio_edge_line_t *line = &gpio_edge_lines[GPIO_PIN_NUMBER(pin)];
+    uint32_t now = (uint32_t)timestamp_us;
+    uint32_t seq;
+    uint32_t edges;
+    gpio_edge_t edge;
+
+    if (!atomic_load_explicit(&line->active, memory_order_acquire) || line->pin != pin) {
+        return;
+    }
+    edges = atomic_fetch_add_explicit(&line->edges, 1U, memory_order_relaxed) + 1U;
+
+    /* With both edges armed every interrupt flips the level; finding it
+     * unchanged means the edges in between merged into this one */
+    if (line->edge == GPIO_EDGE_BOTH || line->debounce_us != 0U) {
+        if (level == line->raw_level) {
+            atomic_fetch_add_explicit(&line->missed, 1U, memory_order_relaxed);
+        }
+        line->raw_level = level;
+    }
+
+    if (line->debounce_us == 0U) {
+        edge = line->edge;
+        if (edge == GPIO_EDGE_BOTH) {
+            edge = level ? GPIO_EDGE_RISING : GPIO_EDGE_FALLING;
+        }
+        atomic_fetch_add_explicit(&line->accepted, 1U, memory_order_relaxed);
+        (void)event_publish(&gpio_edge_topic, GPIO_EDGE_EVENT(pin, edge));
+        if (line->callback != NULL) {
+            line->callback(pin, edge, timestamp_us, line->context);
+        }
+        return;
+    }
+
+    seq = atomic_load_explicit(&line->seq, memory_order_relaxed);
+    atomic_store_explicit(&line->seq, seq + 1U, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    /* An edge after a quiet period starts a new burst */
+    if (!line->seen_edge ||
+        now - atomic_load_explicit(&line->last_edge_us, memory_order_relaxed) >= line->debounce_us) {
+        atomic_store_explicit(&line->burst_start_us, now, memory_order_relaxed);
+    }
+    line->seen_edge = true;
+    atomic_store_explicit(&line->last_edge_us, now, memory_order_relaxed);
+    atomic_store_explicit(&line->level, level, memory_order_relaxed);
+    atomic_store_explicit(&line->record_edges, edges, memory_order_relaxed);
+
+    atomic_store_explicit(&line->seq, seq + 2U, memory_order_release);
+}
+
+error_t gpio_driver_enable_edge(gpio_pin_t pin, gpio_edge_t edge, uint32_t debounce_us,
+                                gpio_driver_edge_callback_t callback, void *context)
+{
+    gpio_edge_line_t *line = &gpio_edge_lines[GPIO_PIN_NUMBER(pin)];
+    uint16_t mask = GPIO_PIN_MASK(pin);
+    bool level;
+    error_t err;
+
+    if (GPIO_PIN_PORT(pin) >= GPIO_BOARD_PORT_COUNT || edge == GPIO_EDGE_NONE ||
+        (uint32_t)edge > (uint32_t)GPIO_EDGE_BOTH || debounce_us > (uint32_t)INT32_MAX) {
+        return ERR_INVALID_PARAM;
+    }
+    if (atomic_load_explicit(&line->active, memory_order_relaxed)) {
+        return ERR_BUSY;
+    }
+
+    level = gpio_read(pin);
+    line->pin = pin;
+    line->edge = edge;
+    line->debounce_us = debounce_us;
+    line->callback = callback;
+    line->context = context;
+    line->raw_level = level;
+    line->seen_edge = false;
+    line->stable_level = level;
+    line->confirmed_seq = 0;
+    line->confirmed_edges = 0;
+    line->filtered = 0;
+    atomic_store_explicit(&line->seq, 0U, memory_order_relaxed);
+    atomic_store_explicit(&line->level, level, memory_order_relaxed);
+    atomic_store_explicit(&line->edges, 0U, memory_order_relaxed);
+    atomic_store_explicit(&line->record_edges, 0U, memory_order_relaxed);
+    atomic_store_explicit(&line->missed, 0U, memory_order_relaxed);
+    atomic_store_explicit(&line->accepted, 0U, memory_order_relaxed);
+    atomic_store_explicit(&line->active, true, memory_order_release);
+
+    if (debounce_us != 0U) {
+        gpio_debounced_lines |= mask;
+    } else {
+        gpio_debounced_lines &= (uint16_t)~mask;
+    }
+
+    gpio_hal_register_edge_callback(pin, gpio_driver_edge_isr);
+    err = gpio_irq_configure(pin, (debounce_us != 0U) ? GPIO_EDGE_BOTH : edge);
+    if (err != ERR_OK) {
+        atomic_store_explicit(&line->active, false, memory_order_release);
+        gpio_debounced_lines &= (uint16_t)~mask;
+    }
+    return err;
+}
+
+error_t gpio_driver_disable_edge(gpio_pin_t pin)
+{
+    gpio_edge_line_t *line = &gpio_edge_lines[GPIO_PIN_NUMBER(pin)];
+    error_t err;
+
+    if (!atomic_load_explicit(&line->active, memory_order_relaxed) || line->pin != pin) {
+        return ERR_INVALID_PARAM;
+    }
+    err = gpio_irq_configure(pin, GPIO_EDGE_NONE);
+    if (err != ERR_OK) {
+        return err;
+    }
+    atomic_store_explicit(&line->active, false, memory_order_release);
+    gpio_debounced_lines &= (uint16_t)~GPIO_PIN_MASK(pin);
+    return ERR_OK;
+}
+
+error_t gpio_driver_get_edge_stats(gpio_pin_t pin, gpio_edge_stats_t *stats)
+{
+    const gpio_edge_line_t *line = &gpio_edge_lines[GPIO_PIN_NUMBER(pin)];
+
+    if (stats == NULL || line->pin != pin) {
+        return ERR_INVALID_PARAM;
+    }
+    stats->edges = atomic_load_explicit(&line->edges, memory_order_relaxed);
+    stats->accepted = atomic_load_explicit(&line->accepted, memory_order_relaxed);
+    stats->filtered = line->filtered;
+    stats->missed = atomic_load_explicit(&line->missed, memory_order_relaxed);
+    return ERR_OK;
+}
+
+/* Consistent copy of a line's edge record; false if an edge is being
+ * recorded right now */
+static bool gpio_driver_read_edge(gpio_edge_line_t *line, uint32_t *seq, uint32_t *last_edge_us,
+                                  uint32_t *burst_start_us, bool *level, uint32_t *edges)
+{
+    uint32_t begin = atomic_load_explicit(&line->seq, memory_order_acquire);
+
+    if ((begin & 1U) != 0U) {
+        return false;
+    }
+    *last_edge_us = atomic_load_explicit(&line->last_edge_us, memory_order_relaxed);
+    *burst_start_us = atomic_load_explicit(&line->burst_start_us, memory_order_relaxed);
+    *level = atomic_load_explicit(&line->level, memory_order_relaxed);
+    *edges = atomic_load_explicit(&line->record_edges, memory_order_relaxed);
+    atomic_thread_fence(memory_order_acquire);
+    *seq = begin;
+    return atomic_load_explicit(&line->seq, memory_order_relaxed) == begin;
+}
+
+void gpio_driver_process(uint64_t now_us)
+{
+    uint32_t lines = gpio_debounced_lines;
+
+    gpio_process_now_us = now_us;
+    while (lines != 0U) {
+        gpio_edge_line_t *line = &gpio_edge_lines[__builtin_ctz(lines)];
+        uint32_t seq;
+        uint32_t last_edge;
+        uint32_t burst_start;
+        uint32_t edges;
+        gpio_edge_t edge;
+        bool level;
+
+        lines &= lines - 1U;
+        /* Signed: an edge may have landed after now_us was read */
+        if (atomic_load_explicit(&line->seq, memory_order_relaxed) == line->confirmed_seq ||
+            !gpio_driver_read_edge(line, &seq, &last_edge, &burst_start, &level, &edges) ||
+            (int32_t)((uint32_t)now_us - last_edge) < (int32_t)line->debounce_us) {
+            continue;
+        }
+
+        /* Settled: every edge of the burst but an accepted one is noise.
+         * The count comes from the same record, so an edge of the next
+         * burst is never charged to this one */
+        line->confirmed_seq = seq;
+        line->filtered += edges - line->confirmed_edges;
+        line->confirmed_edges = edges;
+        if (level == line->stable_level) {
+            continue;
+        }
+        line->filtered--;
+        line->stable_level = level;
+        atomic_fetch_add_explicit(&line->accepted, 1U, memory_order_relaxed);
+
+        edge = level ? GPIO_EDGE_RISING : GPIO_EDGE_FALLING;
+        if (line->edge != GPIO_EDGE_BOTH && line->edge != edge) {
+            continue;
+        }
+        (void)event_publish(&gpio_edge_topic, GPIO_EDGE_EVENT(line->pin, edge));
+        if (line->callback != NULL) {
+            line->callback(line->pin, edge, now_us - ((uint32_t)now_us - burst_start),
+                           line->context);
+        }
+    }
+}
+
+uint64_t gpio_driver_next_deadline_us(void)
+{
+    uint64_t next = UINT64_MAX;
+    uint32_t lines = gpio_debounced_lines;
+
+    while (lines != 0U) {
+        gpio_edge_line_t *line = &gpio_edge_lines[__builtin_ctz(lines)];
+        uint32_t seq;
+        uint32_t last_edge;
+        uint32_t burst_start;
+        uint32_t edges;
+        uint64_t due;
+        bool level;
+
+        lines &= lines - 1U;
+        if (atomic_load_explicit(&line->seq, memory_order_relaxed) == line->confirmed_seq) {
+            continue;
+        }
+        if (!gpio_driver_read_edge(line, &seq, &last_edge, &burst_start, &level, &edges)) {
+            return gpio_process_now_us;
+        }
+        /* Edges may be newer than the last process pass: signed offset */
+        due = gpio_process_now_us +
+              (uint64_t)(int64_t)(int32_t)(last_edge - (uint32_t)gpio_process_now_us) +
+              line->debounce_us;
+        if (due < next) {
+            next = due;
+        }
+    }
+    return next;
+}
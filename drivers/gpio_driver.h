@@ -3,6 +3,26 @@
  *
  * Application-facing GPIO driver.
  * Depends only on HAL abstraction, not on specific hardware.
+ *
+ * Edge events: instead of polling an input, gpio_driver_enable_edge()
+ * arms its interrupt line and reports each rising and/or falling edge
+ * to a per-pin callback, with the time the edge was seen.
+ *
+ *  - debounce_us = 0: the callback runs from the interrupt, once per
+ *    interrupt, timestamped at IRQ entry.
+ *  - debounce_us > 0: both edges are armed and the interrupt only
+ *    records edge times. A new level is accepted once the input has
+ *    gone debounce_us without an edge; gpio_driver_process(), called
+ *    from the main loop, then runs the callback with the time of the
+ *    first edge of the burst. A burst that settles back at the level it
+ *    started from (a glitch) reports nothing. The decision is made from
+ *    the timestamps alone: the pin is never sampled.
+ *
+ * Every reported edge is also published on gpio_edge_topic
+ * (common/event_bus.h), so the callback may be NULL.
+ *
+ * One pin per line number (see hal_gpio.h): a second pin with the same
+ * number gets ERR_BUSY.
  */
 
 #ifndef DRIVERS_GPIO_DRIVER_H
@@ -11,12 +31,115 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "../common/error.h"
+#include "../common/event_bus.h"
 #include "../hal/hal_gpio.h"
 
+/* Edge event callback. edge is GPIO_EDGE_RISING or GPIO_EDGE_FALLING;
+ * timestamp_us is on the bsp_time_us() scale. */
+typedef void (*gpio_driver_edge_callback_t)(gpio_pin_t pin, gpio_edge_t edge,
+                                            uint64_t timestamp_us, void *context);
+
+/* gpio_edge_topic event value: pin in bits 0..15, edge above */
+#define GPIO_EDGE_EVENT(pin, edge)  (((uint32_t)(edge) << 16) | ((uint32_t)(pin) & 0xFFFFU))
+#define GPIO_EDGE_EVENT_PIN(value)  ((gpio_pin_t)((value) & 0xFFFFU))
+#define GPIO_EDGE_EVENT_EDGE(value) ((gpio_edge_t)((value) >> 16))
+
+EVENT_TOPIC_DECLARE(gpio_edge_topic);
+
+typedef struct {
+    uint32_t edges;         /* Interrupts taken */
+    uint32_t accepted;      /* Edges accepted as level changes */
+    uint32_t filtered;      /* Settled edges rejected as bounce or glitch */
+    uint32_t missed;        /* Interrupts that found the level unchanged,
+                             * i.e. at least one edge merged away (both-edge
+                             * and debounced pins only) */
+} gpio_edge_stats_t;
+
 /* GPIO Driver Initialization */
 error_t gpio_driver_init(void);
 error_t gpio_driver_deinit(void);
 
+/* Edge events; the pin must already be configured as an input.
+ * ERR_BUSY if the pin's interrupt line (shared by pin n of every port)
+ * is already armed, by a pin or as a UART RX wake-up. */
+error_t gpio_driver_enable_edge(gpio_pin_t pin, gpio_edge_t edge, uint32_t debounce_us,
+                                gpio_driver_edge_callback_t callback, void *context);
+error_t gpio_driver_disable_edge(gpio_pin_t pin);
+error_t gpio_driver_get_edge_stats(gpio_pin_t pin, gpio_edge_stats_t *stats);
+
+/* Main loop side of debouncing: report every burst that has settled by
+ * now_us. gpio_driver_next_deadline_us() is when the earliest unsettled
+ * burst can settle, UINT64_MAX if there is none. */
+void gpio_driver_process(uint64_t now_us);
+uint64_t gpio_driver_next_deadline_us(void);
+
+#ifdef HAL_STATIC_BINDING
+
+/* GPIO Driver API - inlined onto the statically bound HAL */
+static inline error_t gpio_driver_configure(gpio_pin_t pin, gpio_mode_t mode)
+{
+    gpio_configure(pin, mode, GPIO_OUTPUT_PP, GPIO_PULL_NONE, GPIO_SPEED_HIGH);
+    return ERR_OK;
+}
+
+static inline error_t gpio_driver_set(gpio_pin_t pin)
+{
+    gpio_write(pin, true);
+    return ERR_OK;
+}
+
+static inline error_t gpio_driver_clear(gpio_pin_t pin)
+{
+    gpio_write(pin, false);
+    return ERR_OK;
+}
+
+static inline error_t gpio_driver_toggle(gpio_pin_t pin)
+{
+    gpio_toggle(pin);
+    return ERR_OK;
+}
+
+static inline error_t gpio_driver_read(gpio_pin_t pin, bool *value)
+{
+    if (value == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    *value = gpio_read(pin);
+    return ERR_OK;
+}
+
+static inline error_t gpio_driver_port_write_masked(gpio_port_t port, uint16_t mask,
+                                                    uint16_t value)
+{
+    if (port >= GPIO_BOARD_PORT_COUNT) {
+        return ERR_INVALID_PARAM;
+    }
+    gpio_port_write_masked(port, mask, value);
+    return ERR_OK;
+}
+
+static inline error_t gpio_driver_port_set_clear(gpio_port_t port, uint16_t set_mask,
+                                                 uint16_t clear_mask)
+{
+    if (port >= GPIO_BOARD_PORT_COUNT) {
+        return ERR_INVALID_PARAM;
+    }
+    gpio_port_set_clear(port, set_mask, clear_mask);
+    return ERR_OK;
+}
+
+static inline error_t gpio_driver_port_read(gpio_port_t port, uint16_t *value)
+{
+    if (port >= GPIO_BOARD_PORT_COUNT || value == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    *value = gpio_port_read(port);
+    return ERR_OK;
+}
+
+#else
+
 /* GPIO Driver API */
 error_t gpio_driver_configure(gpio_pin_t pin, gpio_mode_t mode);
 error_t gpio_driver_set(gpio_pin_t pin);
@@ -24,4 +147,11 @@ error_t gpio_driver_clear(gpio_pin_t pin);
 error_t gpio_driver_toggle(gpio_pin_t pin);
 error_t gpio_driver_read(gpio_pin_t pin, bool *value);
 
+/* Whole-port API: all pins in the masks change in one access */
+error_t gpio_driver_port_write_masked(gpio_port_t port, uint16_t mask, uint16_t value);
+error_t gpio_driver_port_set_clear(gpio_port_t port, uint16_t set_mask, uint16_t clear_mask);
+error_t gpio_driver_port_read(gpio_port_t port, uint16_t *value);
+
+#endif /* HAL_STATIC_BINDING */
+
 #endif /* DRIVERS_GPIO_DRIVER_H */
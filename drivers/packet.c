@@ -0,0 +1,225 @@
+/*
+ * packet.c - COBS-framed Packet Transport Implementation
+ *
+ * TX: payload and CRC are COBS-encoded in one pass into a block from
+ *   mem_alloc() sized for this frame, which uart_driver_write_block()
+ *   sends by DMA and returns to the pool.
+ * RX: the RX stream callback feeds each DMA span to the link's decoder;
+ *   the CRC is checked over the whole decoded frame at the delimiter,
+ *   where the slice-by-N kernels run on one contiguous buffer.
+ */
+
+#include "packet.h"
+#include "uart_driver.h"
+#include "../common/crc.h"
+#include "../common/mem_pool.h"
+#include <stddef.h>
+
+typedef struct {
+    bool open;
+    packet_decoder_t decoder;
+    uint32_t tx_frames;
+    uint32_t tx_errors;
+} packet_link_t;
+
+static packet_link_t packet_links[UART_COUNT];
+
+static uint32_t packet_crc_size(packet_crc_t crc)
+{
+    return (crc == PACKET_CRC32) ? 4U : 2U;
+}
+
+/* CRC of payload, little-endian in trailer; returns its size */
+static uint32_t packet_crc_trailer(packet_crc_t crc, const uint8_t *payload, uint32_t length,
+                                   uint8_t *trailer)
+{
+    uint32_t value = (crc == PACKET_CRC32) ? crc32_update(0, payload, length) :
+                                             crc16_update(0, payload, length);
+    uint32_t size = packet_crc_size(crc);
+
+    for (uint32_t i = 0; i < size; i++) {
+        trailer[i] = (uint8_t)(value >> (8U * i));
+    }
+    return size;
+}
+
+/* ===== Standalone Encoder / Decoder ===== */
+
+error_t packet_decoder_init(packet_decoder_t *dec, packet_crc_t crc,
+                            packet_callback_t on_frame, void *context)
+{
+    if (dec == NULL || on_frame == NULL || (crc != PACKET_CRC16 && crc != PACKET_CRC32)) {
+        return ERR_INVALID_PARAM;
+    }
+    cobs_decoder_init(&dec->cobs, dec->buffer, PACKET_MAX_PAYLOAD + packet_crc_size(crc));
+    dec->crc = crc;
+    dec->on_frame = on_frame;
+    dec->context = context;
+    dec->stats = (packet_stats_t){ 0 };
+    return ERR_OK;
+}
+
+static void packet_decoder_frame(packet_decoder_t *dec, cobs_frame_status_t status)
+{
+    uint32_t crc_size = packet_crc_size(dec->crc);
+    uint32_t length = dec->cobs.length;
+    uint8_t expected[PACKET_MAX_CRC];
+
+    switch (status) {
+    case COBS_FRAME_EMPTY:
+        return;
+    case COBS_FRAME_CORRUPT:
+        dec->stats.rx_framing_errors++;
+        return;
+    case COBS_FRAME_OVERFLOW:
+        dec->stats.rx_oversize++;
+        return;
+    case COBS_FRAME_OK:
+    default:
+        break;
+    }
+
+    if (length < crc_size) {
+        dec->stats.rx_framing_errors++;
+        return;
+    }
+    length -= crc_size;
+    (void)packet_crc_trailer(dec->crc, dec->buffer, length, expected);
+    for (uint32_t i = 0; i < crc_size; i++) {
+        if (dec->buffer[length + i] != expected[i]) {
+            dec->stats.rx_crc_errors++;
+            return;
+        }
+    }
+    dec->stats.rx_frames++;
+    dec->on_frame(dec->buffer, (uint16_t)length, dec->context);
+}
+
+void packet_decoder_feed(packet_decoder_t *dec, const uint8_t *data, uint32_t length)
+{
+    while (length > 0U) {
+        bool complete;
+        cobs_frame_status_t status;
+        uint32_t used = cobs_decoder_feed(&dec->cobs, data, length, &complete, &status);
+
+        data += used;
+        length -= used;
+        if (complete) {
+            packet_decoder_frame(dec, status);
+        }
+    }
+}
+
+uint32_t packet_encode(packet_crc_t crc, const uint8_t *payload, uint16_t length,
+                       uint8_t *out, uint32_t capacity)
+{
+    cobs_encoder_t enc;
+    uint8_t trailer[PACKET_MAX_CRC];
+    uint32_t trailer_size;
+
+    if ((payload == NULL && length > 0U) || length > PACKET_MAX_PAYLOAD || out == NULL ||
+        (crc != PACKET_CRC16 && crc != PACKET_CRC32)) {
+        return 0;
+    }
+    trailer_size = packet_crc_trailer(crc, payload, length, trailer);
+
+    cobs_encode_begin(&enc, out, capacity);
+    cobs_encode_update(&enc, payload, length);
+    cobs_encode_update(&enc, trailer, trailer_size);
+    return cobs_encode_end(&enc);
+}
+
+/* ===== UART Links ===== */
+
+static void packet_rx_stream(uart_id_t uart_id, const uint8_t *data, uint16_t length,
+                             uart_rx_event_t event, void *context)
+{
+    (void)uart_id; (void)event;
+    packet_decoder_feed(&((packet_link_t *)context)->decoder, data, length);
+}
+
+error_t packet_open(uart_id_t uart_id, packet_crc_t crc, packet_callback_t on_frame,
+                    void *context)
+{
+    packet_link_t *link;
+    error_t err;
+
+    if (uart_id >= UART_COUNT) {
+        return ERR_INVALID_PARAM;
+    }
+    link = &packet_links[uart_id];
+    if (link->open) {
+        return ERR_BUSY;
+    }
+    err = packet_decoder_init(&link->decoder, crc, on_frame, context);
+    if (err != ERR_OK) {
+        return err;
+    }
+    link->tx_frames = 0;
+    link->tx_errors = 0;
+
+    err = uart_driver_start_rx_stream(uart_id, packet_rx_stream, link);
+    if (err == ERR_OK) {
+        link->open = true;
+    }
+    return err;
+}
+
+error_t packet_close(uart_id_t uart_id)
+{
+    if (uart_id >= UART_COUNT || !packet_links[uart_id].open) {
+        return ERR_NOT_INITIALIZED;
+    }
+    packet_links[uart_id].open = false;
+    return uart_driver_stop_rx_stream(uart_id);
+}
+
+error_t packet_send(uart_id_t uart_id, const uint8_t *payload, uint16_t length)
+{
+    packet_link_t *link;
+    packet_crc_t crc;
+    uint32_t capacity;
+    uint32_t frame_length;
+    uint8_t *block;
+    error_t err;
+
+    if ((payload == NULL && length > 0U) || length > PACKET_MAX_PAYLOAD) {
+        return ERR_INVALID_PARAM;
+    }
+    if (uart_id >= UART_COUNT || !packet_links[uart_id].open) {
+        return ERR_NOT_INITIALIZED;
+    }
+    link = &packet_links[uart_id];
+    crc = link->decoder.crc;
+
+    capacity = COBS_ENCODED_MAX((uint32_t)length + packet_crc_size(crc)) + 1U;
+    block = mem_alloc(capacity);
+    if (block == NULL) {
+        link->tx_errors++;
+        return ERR_MEMORY;
+    }
+    frame_length = packet_encode(crc, payload, length, block, capacity);
+
+    /* The block belongs to the driver from here, sent or not */
+    err = uart_driver_write_block(uart_id, block, (uint16_t)frame_length);
+    if (err == ERR_OK) {
+        link->tx_frames++;
+    } else {
+        link->tx_errors++;
+    }
+    return err;
+}
+
+error_t packet_get_stats(uart_id_t uart_id, packet_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    if (uart_id >= UART_COUNT || !packet_links[uart_id].open) {
+        return ERR_NOT_INITIALIZED;
+    }
+    *stats = packet_links[uart_id].decoder.stats;
+    stats->tx_frames = packet_links[uart_id].tx_frames;
+    stats->tx_errors = packet_links[uart_id].tx_errors;
+    return ERR_OK;
+}
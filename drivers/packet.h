@@ -0,0 +1,90 @@
+/*
+ * packet.h - COBS-framed Packet Transport
+ *
+ * Frame on the wire:
+ *
+ *   COBS( payload || CRC ) 0x00
+ *
+ * The CRC (common/crc.h) is CRC-16/X-25 or CRC-32/ISO-HDLC over the
+ * payload, appended little-endian; the choice is per link and both ends
+ * must agree. COBS (common/cobs.h) keeps 0x00 out of the frame so it can
+ * delimit frames and resynchronize a receiver that joined mid-stream.
+ *
+ * Reception is incremental: bytes are decoded as they arrive (on a UART
+ * link, straight out of the circular RX DMA buffer) into the link's
+ * frame buffer, and a frame that passes its CRC is handed to the
+ * callback in place. Frames that are truncated, too long or fail the CRC
+ * are counted and dropped.
+ *
+ * A decoder can also be used on its own, fed from any byte source.
+ */
+
+#ifndef DRIVERS_PACKET_H
+#define DRIVERS_PACKET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/cobs.h"
+#include "../common/error.h"
+#include "../hal/hal_uart.h"
+
+#define PACKET_MAX_PAYLOAD      256U
+#define PACKET_MAX_CRC          4U
+
+/* Longest frame on the wire, delimiter included */
+#define PACKET_FRAME_MAX        (COBS_ENCODED_MAX(PACKET_MAX_PAYLOAD + PACKET_MAX_CRC) + 1U)
+
+typedef enum {
+    PACKET_CRC16 = 0,
+    PACKET_CRC32
+} packet_crc_t;
+
+typedef struct {
+    uint32_t rx_frames;         /* Delivered to the callback */
+    uint32_t rx_crc_errors;
+    uint32_t rx_framing_errors; /* Truncated, or shorter than the CRC */
+    uint32_t rx_oversize;       /* Payload over PACKET_MAX_PAYLOAD */
+    uint32_t tx_frames;         /* Queued for transmission */
+    uint32_t tx_errors;         /* Not queued: no buffer, or port busy */
+} packet_stats_t;
+
+/* Received frame. payload points into the decoder's buffer and is valid
+ * until the callback returns. On a UART link this runs in interrupt
+ * context (the RX stream callback). */
+typedef void (*packet_callback_t)(const uint8_t *payload, uint16_t length, void *context);
+
+/* ===== Standalone Encoder / Decoder ===== */
+
+typedef struct {
+    cobs_decoder_t cobs;
+    packet_crc_t crc;
+    packet_callback_t on_frame;
+    void *context;
+    packet_stats_t stats;       /* rx_* fields only */
+    uint8_t buffer[PACKET_MAX_PAYLOAD + PACKET_MAX_CRC];
+} packet_decoder_t;
+
+error_t packet_decoder_init(packet_decoder_t *dec, packet_crc_t crc,
+                            packet_callback_t on_frame, void *context);
+void packet_decoder_feed(packet_decoder_t *dec, const uint8_t *data, uint32_t length);
+
+/* Encode one frame into out (at most PACKET_FRAME_MAX bytes needed).
+ * Returns the frame length, 0 if payload or out is too large/small. */
+uint32_t packet_encode(packet_crc_t crc, const uint8_t *payload, uint16_t length,
+                       uint8_t *out, uint32_t capacity);
+
+/* ===== UART Links ===== */
+
+/* The port must already be open (uart_driver_open()); it is switched to
+ * stream reception until packet_close() */
+error_t packet_open(uart_id_t uart_id, packet_crc_t crc, packet_callback_t on_frame,
+                    void *context);
+error_t packet_close(uart_id_t uart_id);
+
+/* Encode into a pool block and queue it for zero-copy DMA transmit.
+ * ERR_MEMORY if no block is free, ERR_BUSY if the port cannot take
+ * the frame now. */
+error_t packet_send(uart_id_t uart_id, const uint8_t *payload, uint16_t length);
+error_t packet_get_stats(uart_id_t uart_id, packet_stats_t *stats);
+
+#endif /* DRIVERS_PACKET_H */
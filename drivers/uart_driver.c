@@ -1,60 +1,1015 @@
 /*
  * uart_driver.c - UART Driver Implementation
+ *
+ * TX path: uart_driver_write() (producer) -> tx ring -> TX ISR (consumer).
+ *   The largest contiguous span of the ring is handed to transmit_it();
+ *   its completion callback consumes the span and starts the next one.
+ *   tx_busy arbitrates who may start a transfer, so the writer and the
+ *   ISR never both own the ring tail.
+ * RX path: RX ISR (producer) -> rx ring -> uart_driver_read() (consumer).
+ *   Reception is armed one byte at a time, as with an RXNE interrupt.
+ * DMA path: uart_driver_writev() (producer) -> descriptor queue -> TX ISR.
+ *   Each iovec entry becomes one descriptor pointing at the caller's
+ *   buffer; the transfer-complete interrupt retires it and chains the
+ *   next. The TX engine serves descriptors before ring data.
+ * Stream path: circular DMA over the port's RX storage (instead of the
+ *   rx ring). Each HALF/FULL/IDLE event delivers the bytes between the
+ *   last delivered offset and the DMA position, split in two on wrap.
+ * Timeouts: a per-port sw_timer polls the byte counters in thread
+ *   context, and only while there is unread RX data or queued TX to
+ *   time. Once nothing is left to watch the poll parks; the interrupt
+ *   that next moves data finds it parked, flags the port and wakes the
+ *   main loop, whose uart_driver_process() restarts it. An idle port
+ *   keeps no timer armed, so it does not hold the core out of Stop.
+ * Clock changes: open ports keep their requested rate across clock
+ *   profile switches. A switch is vetoed if a port cannot be re-timed
+ *   for the new bus clock, or has a transfer on the wire.
+ * Formatted path: uart_driver_printf() formats into the free span of the
+ *   tx ring (ring_buffer_reserve_linear()) and commits each span as it
+ *   fills, kicking TX so the wire drains while the rest is formatted.
+ * Stop mode: vetoed while TX data is queued or in flight, since the
+ *   unclocked USART would freeze it mid-frame. Ports set for RX wake-up
+ *   have their RX pin armed for the duration of the Stop.
+ *
+ * Every port has its own control block, buffers, HAL callbacks and
+ * timer, so all of them can stream at once. Within a port the rings and
+ * the descriptor queue have exactly one producer and one consumer on
+ * the caller side; tx_owner/rx_owner enforce that, turning a second
+ * concurrent writer (or reader) into ERR_BUSY instead of interleaved or
+ * corrupted data. open/close move the port state with compare-exchange,
+ * so racing opens cannot both configure the hardware.
  */
 
 #include "uart_driver.h"
+#include "../bsp/board_config.h"
+#include "../bsp/bsp_clock.h"
+#include "../bsp/bsp_power.h"
+#include "../bsp/bsp_time.h"
+#include "../common/fmt.h"
+#include "../common/hot_path.h"
+#include "../common/mem_pool.h"
+#include "../common/profile.h"
+#include "../common/ring_buffer.h"
+#include "../common/sw_timer.h"
+#include <stdatomic.h>
 #include <string.h>
 
+#define UART_DMA_QUEUE_MASK     (UART_DMA_QUEUE_DEPTH - 1U)
+
+_Static_assert((UART_DMA_QUEUE_DEPTH & UART_DMA_QUEUE_MASK) == 0,
+               "UART_DMA_QUEUE_DEPTH must be a power of two");
+
+typedef struct {
+    const uint8_t *data;
+    uint16_t length;
+    bool last;                          /* Final descriptor of its frame */
+    uart_writev_callback_t on_complete;
+    void *context;
+} uart_dma_desc_t;
+
+typedef enum {
+    UART_PORT_CLOSED = 0,
+    UART_PORT_OPENING,          /* uart_driver_open() in progress */
+    UART_PORT_OPEN,
+    UART_PORT_CLOSING           /* uart_driver_close() in progress */
+} uart_port_state_t;
+
+typedef struct {
+    _Atomic uart_port_state_t state;
+    atomic_flag tx_owner;       /* Held by the caller queueing TX data */
+    atomic_flag rx_owner;       /* Held by the caller taking RX data */
+    uart_config_t config;       /* As requested at open */
+    uart_baud_timing_t timing;  /* Rate actually programmed */
+    ring_buffer_t tx_ring;
+    ring_buffer_t rx_ring;
+    atomic_bool tx_busy;        /* A TX span or descriptor is in flight */
+    atomic_bool tx_waiting;     /* uart_driver_printf() waits for TX room */
+    bool tx_from_dma;           /* In-flight transfer is a DMA descriptor */
+    uint16_t tx_inflight;       /* Length of the in-flight transfer */
+    uart_dma_desc_t dma_queue[UART_DMA_QUEUE_DEPTH];
+    _Atomic uint32_t dma_head;  /* Next free descriptor (writev owned) */
+    _Atomic uint32_t dma_tail;  /* Oldest queued descriptor (ISR owned) */
+    uint8_t rx_byte;            /* Landing byte for receive_it() */
+    uart_rx_stream_callback_t rx_stream;    /* Non-NULL in stream mode */
+    void *rx_stream_context;
+    uint16_t rx_stream_position;            /* Offset delivered so far */
+    bool rx_wake;               /* Arm the RX pin across Stops */
+    uart_driver_stats_t stats;
+    sw_timer_t timeout_timer;   /* Polls every timeout_poll ticks */
+    uint32_t timeout_poll;
+    uint32_t rx_idle_ms;
+    uint32_t tx_stall_ms;
+    uint32_t rx_idle_elapsed;   /* Ticks since rx_bytes last moved */
+    uint32_t tx_stall_elapsed;  /* Ticks since tx_bytes last moved */
+    uint32_t rx_bytes_seen;
+    uint32_t tx_bytes_seen;
+    bool rx_idle_reported;
+    atomic_bool timeout_armed;  /* Poll timer running; thread context only writes */
+    atomic_bool timeout_kick;   /* Data moved while parked: restart the poll */
+    uart_timeout_callback_t on_timeout;
+    void *timeout_context;
+} uart_port_t;
+
+static uint8_t uart1_tx_storage[UART1_TX_BUFFER_SIZE];
+static uint8_t uart1_rx_storage[UART1_RX_BUFFER_SIZE];
+static uint8_t uart2_tx_storage[UART2_TX_BUFFER_SIZE];
+static uint8_t uart2_rx_storage[UART2_RX_BUFFER_SIZE];
+static uint8_t uart3_tx_storage[UART3_TX_BUFFER_SIZE];
+static uint8_t uart3_rx_storage[UART3_RX_BUFFER_SIZE];
+static uint8_t uart4_tx_storage[UART4_TX_BUFFER_SIZE];
+static uint8_t uart4_rx_storage[UART4_RX_BUFFER_SIZE];
+static uint8_t uart5_tx_storage[UART5_TX_BUFFER_SIZE];
+static uint8_t uart5_rx_storage[UART5_RX_BUFFER_SIZE];
+static uint8_t uart6_tx_storage[UART6_TX_BUFFER_SIZE];
+static uint8_t uart6_rx_storage[UART6_RX_BUFFER_SIZE];
+
+typedef struct {
+    uint8_t *tx_storage;
+    uint32_t tx_size;
+    uint8_t *rx_storage;
+    uint32_t rx_size;
+} uart_port_buffers_t;
+
+static const uart_port_buffers_t uart_port_buffers[UART_COUNT] = {
+    [UART_1] = { uart1_tx_storage, UART1_TX_BUFFER_SIZE, uart1_rx_storage, UART1_RX_BUFFER_SIZE },
+    [UART_2] = { uart2_tx_storage, UART2_TX_BUFFER_SIZE, uart2_rx_storage, UART2_RX_BUFFER_SIZE },
+    [UART_3] = { uart3_tx_storage, UART3_TX_BUFFER_SIZE, uart3_rx_storage, UART3_RX_BUFFER_SIZE },
+    [UART_4] = { uart4_tx_storage, UART4_TX_BUFFER_SIZE, uart4_rx_storage, UART4_RX_BUFFER_SIZE },
+    [UART_5] = { uart5_tx_storage, UART5_TX_BUFFER_SIZE, uart5_rx_storage, UART5_RX_BUFFER_SIZE },
+    [UART_6] = { uart6_tx_storage, UART6_TX_BUFFER_SIZE, uart6_rx_storage, UART6_RX_BUFFER_SIZE }
+};
+
+static uart_port_t uart_ports[UART_COUNT];
+
+/* ===== Port Ownership ===== */
+
+static bool uart_driver_is_open(uart_id_t uart_id)
+{
+    return uart_id < UART_COUNT &&
+           atomic_load_explicit(&uart_ports[uart_id].state, memory_order_acquire) == UART_PORT_OPEN;
+}
+
+static atomic_flag *uart_driver_owner(uart_id_t uart_id, bool tx)
+{
+    return tx ? &uart_ports[uart_id].tx_owner : &uart_ports[uart_id].rx_owner;
+}
+
+/* Claim the TX (or RX) side of an open port for one API call */
+static error_t uart_driver_enter(uart_id_t uart_id, bool tx)
+{
+    if (uart_id >= UART_COUNT) {
+        return ERR_NOT_INITIALIZED;
+    }
+    if (atomic_flag_test_and_set_explicit(uart_driver_owner(uart_id, tx), memory_order_acquire)) {
+        return ERR_BUSY;
+    }
+    if (!uart_driver_is_open(uart_id)) {
+        atomic_flag_clear_explicit(uart_driver_owner(uart_id, tx), memory_order_release);
+        return ERR_NOT_INITIALIZED;
+    }
+    return ERR_OK;
+}
+
+static void uart_driver_leave(uart_id_t uart_id, bool tx)
+{
+    atomic_flag_clear_explicit(uart_driver_owner(uart_id, tx), memory_order_release);
+}
+
+/* ===== Interrupt-side Helpers ===== */
+
+static HOT_FUNC uint32_t uart_driver_dma_pending(uart_port_t *port)
+{
+    return atomic_load_explicit(&port->dma_head, memory_order_acquire) -
+           atomic_load_explicit(&port->dma_tail, memory_order_relaxed);
+}
+
+static HOT_FUNC bool uart_driver_tx_pending(uart_port_t *port)
+{
+    return atomic_load_explicit(&port->tx_busy, memory_order_acquire) ||
+           uart_driver_dma_pending(port) != 0U || ring_buffer_used(&port->tx_ring) != 0U;
+}
+
+/* Data moved on a port whose timeout poll may be parked: have the main
+ * loop restart it. The fence orders the data before the armed check,
+ * against the poll's clear-then-recheck when it parks. */
+static HOT_FUNC void uart_driver_timeout_wake(uart_port_t *port)
+{
+    if (port->on_timeout == NULL) {
+        return;
+    }
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!atomic_load_explicit(&port->timeout_armed, memory_order_relaxed) &&
+        !atomic_exchange(&port->timeout_kick, true)) {
+        bsp_time_wake();
+    }
+}
+
+/* Start the next TX transfer unless one is already in flight */
+static HOT_FUNC void uart_driver_tx_kick(uart_id_t uart_id)
+{
+    uart_port_t *port = &uart_ports[uart_id];
+    const uint8_t *span;
+    uint32_t length;
+    error_t err;
+    bool expected = false;
+
+    if (uart_driver_dma_pending(port) == 0 && ring_buffer_used(&port->tx_ring) == 0) {
+        return;
+    }
+    if (port->tx_stall_ms != 0U) {
+        uart_driver_timeout_wake(port);
+    }
+    if (!atomic_compare_exchange_strong(&port->tx_busy, &expected, true)) {
+        return;
+    }
+
+    if (uart_driver_dma_pending(port) > 0) {
+        uint32_t tail = atomic_load_explicit(&port->dma_tail, memory_order_relaxed);
+        const uart_dma_desc_t *desc = &port->dma_queue[tail & UART_DMA_QUEUE_MASK];
+
+        port->tx_from_dma = true;
+        port->tx_inflight = desc->length;
+        err = uart_transmit_dma(uart_id, desc->data, desc->length);
+        if (err == ERR_NOT_INITIALIZED) {
+            /* Backend without DMA: same buffer, interrupt driven */
+            err = uart_transmit_it(uart_id, desc->data, desc->length);
+        }
+    } else {
+        length = ring_buffer_peek_linear(&port->tx_ring, &span);
+        if (length > UINT16_MAX) {
+            length = UINT16_MAX;
+        }
+        port->tx_from_dma = false;
+        port->tx_inflight = (uint16_t)length;
+        err = (length == 0) ? ERR_BUSY : uart_transmit_it(uart_id, span, (uint16_t)length);
+    }
+
+    if (err != ERR_OK) {
+        port->tx_inflight = 0;
+        atomic_store(&port->tx_busy, false);
+    }
+}
+
+static HOT_FUNC void uart_driver_tx_complete(uart_id_t uart_id)
+{
+    uart_port_t *port = &uart_ports[uart_id];
+
+    port->stats.tx_bytes += port->tx_inflight;
+    if (port->tx_from_dma) {
+        uint32_t tail = atomic_load_explicit(&port->dma_tail, memory_order_relaxed);
+        uart_dma_desc_t desc = port->dma_queue[tail & UART_DMA_QUEUE_MASK];
+
+        atomic_store_explicit(&port->dma_tail, tail + 1U, memory_order_release);
+        port->tx_inflight = 0;
+        atomic_store(&port->tx_busy, false);
+        if (desc.last && desc.on_complete != NULL) {
+            desc.on_complete(uart_id, desc.context, ERR_OK);
+        }
+    } else {
+        ring_buffer_consume(&port->tx_ring, port->tx_inflight);
+        port->tx_inflight = 0;
+        atomic_store(&port->tx_busy, false);
+    }
+
+    /* Data queued while the span was on the wire */
+    uart_driver_tx_kick(uart_id);
+
+    if (atomic_load_explicit(&port->tx_waiting, memory_order_relaxed)) {
+        bsp_time_wake();
+    }
+}
+
+static HOT_FUNC void uart_driver_rx_complete(uart_id_t uart_id)
+{
+    uart_port_t *port = &uart_ports[uart_id];
+
+    if (ring_buffer_put(&port->rx_ring, port->rx_byte)) {
+        port->stats.rx_bytes++;
+        if (port->rx_idle_ms != 0U) {
+            uart_driver_timeout_wake(port);
+        }
+    } else {
+        port->stats.rx_dropped++;
+    }
+    (void)uart_receive_it(uart_id, &port->rx_byte, 1);
+}
+
+static HOT_FUNC void uart_driver_rx_stream_deliver(uart_id_t uart_id, uart_port_t *port,
+                                          uint16_t from, uint16_t to, uart_rx_event_t event)
+{
+    if (to > from) {
+        port->rx_stream(uart_id, &uart_port_buffers[uart_id].rx_storage[from],
+                        (uint16_t)(to - from), event, port->rx_stream_context);
+        port->stats.rx_bytes += (uint32_t)(to - from);
+        if (port->rx_idle_ms != 0U) {
+            uart_driver_timeout_wake(port);
+        }
+    }
+}
+
+static HOT_FUNC void uart_driver_rx_event(uart_id_t uart_id, uart_rx_event_t event, uint16_t position)
+{
+    uart_port_t *port = &uart_ports[uart_id];
+    uint16_t size = (uint16_t)uart_port_buffers[uart_id].rx_size;
+    uint16_t last = port->rx_stream_position;
+
+    if (port->rx_stream == NULL || position > size) {
+        return;
+    }
+
+    if (position >= last) {
+        uart_driver_rx_stream_deliver(uart_id, port, last, position, event);
+    } else {
+        /* DMA wrapped since the previous event */
+        uart_driver_rx_stream_deliver(uart_id, port, last, size, event);
+        uart_driver_rx_stream_deliver(uart_id, port, 0, position, event);
+    }
+    port->rx_stream_position = (position == size) ? 0 : position;
+}
+
+/* ===== Timeout Supervision (sw_timer context) ===== */
+
+/* True while the poll has something to time: bytes it has not seen yet,
+ * unread RX data not yet reported idle, or TX data that may stall */
+static bool uart_driver_timeout_watching(uart_port_t *port)
+{
+    return port->stats.rx_bytes != port->rx_bytes_seen ||
+           (port->rx_idle_ms != 0U && !port->rx_idle_reported &&
+            ring_buffer_used(&port->rx_ring) != 0U) ||
+           (port->tx_stall_ms != 0U && uart_driver_tx_pending(port));
+}
+
+static void uart_driver_timeout_poll(sw_timer_t *timer, void *context)
+{
+    uart_id_t uart_id = (uart_id_t)(uintptr_t)context;
+    uart_port_t *port = &uart_ports[uart_id];
+    uint32_t rx_bytes = port->stats.rx_bytes;
+    uint32_t tx_bytes = port->stats.tx_bytes;
+    bool tx_pending;
+
+    if (rx_bytes != port->rx_bytes_seen) {
+        port->rx_bytes_seen = rx_bytes;
+        port->rx_idle_elapsed = 0;
+        port->rx_idle_reported = false;
+    } else if (port->rx_idle_ms != 0U && !port->rx_idle_reported &&
+               ring_buffer_used(&port->rx_ring) != 0U) {
+        port->rx_idle_elapsed += port->timeout_poll;
+        if (port->rx_idle_elapsed >= port->rx_idle_ms) {
+            port->rx_idle_reported = true;
+            port->stats.rx_timeouts++;
+            port->on_timeout(uart_id, UART_TIMEOUT_RX_IDLE, port->timeout_context);
+        }
+    }
+
+    tx_pending = uart_driver_tx_pending(port);
+    if (tx_bytes != port->tx_bytes_seen || !tx_pending) {
+        port->tx_bytes_seen = tx_bytes;
+        port->tx_stall_elapsed = 0;
+    } else if (port->tx_stall_ms != 0U) {
+        port->tx_stall_elapsed += port->timeout_poll;
+        if (port->tx_stall_elapsed >= port->tx_stall_ms) {
+            /* Report once per stall length while it persists */
+            port->tx_stall_elapsed = 0;
+            port->stats.tx_timeouts++;
+            port->on_timeout(uart_id, UART_TIMEOUT_TX_STALL, port->timeout_context);
+        }
+    }
+
+    /* Nothing left to watch: park. Recheck after clearing armed, since
+     * an interrupt that moved data before the clear saw the poll armed
+     * and did not ask for a restart. */
+    if (!uart_driver_timeout_watching(port)) {
+        atomic_store(&port->timeout_armed, false);
+        if (uart_driver_timeout_watching(port)) {
+            atomic_store(&port->timeout_armed, true);
+        } else {
+            (void)sw_timer_stop(timer);
+        }
+    }
+}
+
+/* ===== Clock Changes ===== */
+
+static error_t uart_driver_clock_changed(clock_change_phase_t phase, const clock_config_t *config,
+                                         void *context)
+{
+    error_t result = ERR_OK;
+
+    (void)context;
+    for (uint32_t i = 0; i < (uint32_t)UART_COUNT; i++) {
+        uart_port_t *port = &uart_ports[i];
+        uart_baud_timing_t timing;
+        error_t err;
+
+        if (!uart_driver_is_open((uart_id_t)i)) {
+            continue;
+        }
+        err = uart_compute_baud_for_clock((uart_id_t)i, port->config.baud_rate, config, &timing);
+
+        if (phase == CLOCK_CHANGE_PREPARE) {
+            if (err != ERR_OK) {
+                return err;
+            }
+            /* The character on the wire would be garbled */
+            if (atomic_load_explicit(&port->tx_busy, memory_order_acquire)) {
+                return ERR_BUSY;
+            }
+            continue;
+        }
+
+        if (err == ERR_OK) {
+            err = uart_set_timing((uart_id_t)i, &timing);
+        }
+        if (err == ERR_OK) {
+            port->timing = timing;
+        } else if (result == ERR_OK) {
+            result = err;
+        }
+    }
+    return result;
+}
+
+/* ===== Stop Mode ===== */
+
+static error_t uart_driver_power_changed(power_stop_phase_t phase, void *context)
+{
+    (void)context;
+    for (uint32_t i = 0; i < (uint32_t)UART_COUNT; i++) {
+        uart_port_t *port = &uart_ports[i];
+
+        if (!uart_driver_is_open((uart_id_t)i)) {
+            continue;
+        }
+        if (phase == POWER_STOP_PREPARE) {
+            if (uart_driver_tx_pending(port)) {
+                return ERR_BUSY;
+            }
+        } else if (port->rx_wake) {
+            (void)uart_set_rx_wake((uart_id_t)i, phase == POWER_STOP_ENTER);
+        }
+    }
+    return ERR_OK;
+}
+
+/* ===== Driver API ===== */
+
 error_t uart_driver_init(void)
 {
+    error_t err;
+
     uart_hal_init();
-    return ERR_OK;
+    for (uint32_t i = 0; i < (uint32_t)UART_COUNT; i++) {
+        atomic_init(&uart_ports[i].state, UART_PORT_CLOSED);
+        atomic_flag_clear(&uart_ports[i].tx_owner);
+        atomic_flag_clear(&uart_ports[i].rx_owner);
+    }
+    err = bsp_clock_register_callback(uart_driver_clock_changed, NULL);
+    if (err == ERR_OK) {
+        err = bsp_power_register_callback(uart_driver_power_changed, NULL);
+    }
+    return err;
 }
 
 error_t uart_driver_deinit(void)
 {
+    for (uint32_t i = 0; i < (uint32_t)UART_COUNT; i++) {
+        if (uart_driver_is_open((uart_id_t)i)) {
+            (void)uart_driver_close((uart_id_t)i);
+        }
+    }
     return ERR_OK;
 }
 
 error_t uart_driver_open(uart_id_t uart_id, uint32_t baud_rate)
 {
-    uart_config_t config = {
+    uart_port_t *port;
+    uart_port_state_t expected = UART_PORT_CLOSED;
+    error_t err;
+
+    if (uart_id >= UART_COUNT) {
+        return ERR_INVALID_PARAM;
+    }
+    port = &uart_ports[uart_id];
+    if (!atomic_compare_exchange_strong(&port->state, &expected, UART_PORT_OPENING)) {
+        return ERR_BUSY;
+    }
+
+    port->config = (uart_config_t){
         .uart_id = uart_id,
-        .baud_rate = (uart_baud_t)baud_rate,
+        .baud_rate = baud_rate,
         .data_bits = UART_DATA_8,
         .stop_bits = UART_STOP_1,
         .parity = UART_PARITY_NONE
     };
-    
-    return uart_configure(uart_id, &config);
+
+    err = ring_buffer_init(&port->tx_ring, uart_port_buffers[uart_id].tx_storage,
+                           uart_port_buffers[uart_id].tx_size);
+    if (err == ERR_OK) {
+        err = ring_buffer_init(&port->rx_ring, uart_port_buffers[uart_id].rx_storage,
+                               uart_port_buffers[uart_id].rx_size);
+    }
+    if (err != ERR_OK) {
+        atomic_store(&port->state, UART_PORT_CLOSED);
+        return err;
+    }
+    atomic_init(&port->tx_busy, false);
+    atomic_init(&port->tx_waiting, false);
+    port->tx_from_dma = false;
+    port->tx_inflight = 0;
+    atomic_init(&port->dma_head, 0);
+    atomic_init(&port->dma_tail, 0);
+    port->rx_stream = NULL;
+    port->rx_wake = false;
+    memset(&port->stats, 0, sizeof(port->stats));
+    (void)sw_timer_setup(&port->timeout_timer, uart_driver_timeout_poll,
+                         (void *)(uintptr_t)uart_id);
+    atomic_init(&port->timeout_armed, false);
+    atomic_init(&port->timeout_kick, false);
+    port->on_timeout = NULL;
+
+    uart_hal_register_callbacks(uart_id, uart_driver_tx_complete, uart_driver_rx_complete);
+    err = uart_configure(uart_id, &port->config, &port->timing);
+    if (err == ERR_OK) {
+        err = uart_receive_it(uart_id, &port->rx_byte, 1);
+    }
+    if (err != ERR_OK) {
+        (void)uart_deinit(uart_id);
+        uart_hal_register_callbacks(uart_id, NULL, NULL);
+        atomic_store(&port->state, UART_PORT_CLOSED);
+        return err;
+    }
+
+    atomic_store_explicit(&port->state, UART_PORT_OPEN, memory_order_release);
+    return ERR_OK;
 }
 
 error_t uart_driver_close(uart_id_t uart_id)
 {
-    return uart_deinit(uart_id);
+    uart_port_t *port;
+    uart_port_state_t expected = UART_PORT_OPEN;
+    uint32_t head;
+    error_t err;
+
+    if (uart_id >= UART_COUNT) {
+        return ERR_NOT_INITIALIZED;
+    }
+    port = &uart_ports[uart_id];
+    if (!atomic_compare_exchange_strong(&port->state, &expected, UART_PORT_CLOSING)) {
+        return ERR_NOT_INITIALIZED;
+    }
+
+    /* New calls now fail; let the ones already inside finish */
+    while (atomic_flag_test_and_set_explicit(&port->tx_owner, memory_order_acquire)) {
+    }
+    while (atomic_flag_test_and_set_explicit(&port->rx_owner, memory_order_acquire)) {
+    }
+
+    err = uart_deinit(uart_id);
+    uart_hal_register_callbacks(uart_id, NULL, NULL);
+    uart_hal_register_rx_event_callback(uart_id, NULL);
+    port->rx_stream = NULL;
+    (void)sw_timer_stop(&port->timeout_timer);
+    port->on_timeout = NULL;
+    atomic_store(&port->timeout_armed, false);
+    atomic_store(&port->timeout_kick, false);
+
+    /* Hand back buffers of frames that never went out */
+    head = atomic_load(&port->dma_head);
+    for (uint32_t i = atomic_load(&port->dma_tail); i != head; i++) {
+        const uart_dma_desc_t *desc = &port->dma_queue[i & UART_DMA_QUEUE_MASK];
+        if (desc->last && desc->on_complete != NULL) {
+            desc->on_complete(uart_id, desc->context, ERR_NOT_INITIALIZED);
+        }
+    }
+    atomic_store(&port->dma_tail, head);
+
+    atomic_store_explicit(&port->state, UART_PORT_CLOSED, memory_order_release);
+    atomic_flag_clear_explicit(&port->rx_owner, memory_order_release);
+    atomic_flag_clear_explicit(&port->tx_owner, memory_order_release);
+    return err;
 }
 
-error_t uart_driver_write(uart_id_t uart_id, const uint8_t *data, uint16_t length)
+error_t uart_driver_write(uart_id_t uart_id, const uint8_t *data, uint16_t length,
+                          uint16_t *written)
 {
+    uint32_t accepted;
+    error_t err;
+
     if (data == NULL || length == 0) {
         return ERR_INVALID_PARAM;
     }
-    return uart_transmit(uart_id, data, length);
+    err = uart_driver_enter(uart_id, true);
+    if (err != ERR_OK) {
+        return err;
+    }
+
+    PROFILE_BEGIN(uart_driver_write);
+    accepted = ring_buffer_write(&uart_ports[uart_id].tx_ring, data, length);
+    uart_driver_tx_kick(uart_id);
+    PROFILE_END(uart_driver_write);
+    uart_driver_leave(uart_id, true);
+
+    if (written != NULL) {
+        *written = (uint16_t)accepted;
+    }
+    return ERR_OK;
 }
 
-error_t uart_driver_read(uart_id_t uart_id, uint8_t *data, uint16_t length)
+error_t uart_driver_read(uart_id_t uart_id, uint8_t *data, uint16_t length,
+                         uint16_t *received)
 {
+    uint32_t count = 0;
+    error_t err;
+
     if (data == NULL || length == 0) {
         return ERR_INVALID_PARAM;
     }
-    return uart_receive(uart_id, data, length);
+    err = uart_driver_enter(uart_id, false);
+    if (err != ERR_OK) {
+        return err;
+    }
+    if (uart_ports[uart_id].rx_stream != NULL) {
+        err = ERR_BUSY;
+    } else {
+        count = ring_buffer_read(&uart_ports[uart_id].rx_ring, data, length);
+    }
+    uart_driver_leave(uart_id, false);
+
+    if (err != ERR_OK) {
+        return err;
+    }
+    if (received != NULL) {
+        *received = (uint16_t)count;
+    }
+    return ERR_OK;
 }
 
-error_t uart_driver_write_string(uart_id_t uart_id, const char *str)
+error_t uart_driver_write_string(uart_id_t uart_id, uint32_t wait_us, const char *str)
 {
     if (str == NULL) {
         return ERR_INVALID_PARAM;
     }
-    uint16_t length = (uint16_t)strlen(str);
-    return uart_transmit(uart_id, (const uint8_t *)str, length);
+    /* Formatted path: any length, where a uint16_t write would wrap */
+    return uart_driver_printf(uart_id, wait_us, "%s", str);
+}
+
+/* ===== Formatted Output ===== */
+
+typedef struct {
+    uart_id_t uart_id;
+    uint8_t *span;              /* Reserved tx ring span being filled */
+    uint32_t wait_us;
+    uint64_t deadline_us;
+} uart_printf_t;
+
+/* Idle work check: a waiting printf has TX room again */
+static bool uart_driver_tx_room(void)
+{
+    for (uint32_t i = 0; i < UART_COUNT; i++) {
+        uart_port_t *port = &uart_ports[i];
+
+        if (atomic_load_explicit(&port->tx_waiting, memory_order_relaxed) &&
+            ring_buffer_free(&port->tx_ring) > 0U) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Publish what was formatted into the span */
+static void uart_driver_printf_commit(fmt_out_t *out)
+{
+    uart_printf_t *printf_state = out->context;
+
+    ring_buffer_commit(&uart_ports[printf_state->uart_id].tx_ring,
+                       (uint32_t)((uint8_t *)out->pos - printf_state->span));
+    uart_driver_tx_kick(printf_state->uart_id);
+}
+
+/* Span full: send it and reserve the next, waiting for room if allowed */
+static bool uart_driver_printf_refill(fmt_out_t *out)
+{
+    uart_printf_t *printf_state = out->context;
+    uart_port_t *port = &uart_ports[printf_state->uart_id];
+    uint32_t length;
+
+    uart_driver_printf_commit(out);
+    /* Published: a give-up below leaves nothing for the final commit */
+    out->pos = (char *)printf_state->span;
+    out->end = out->pos;
+    while ((length = ring_buffer_reserve_linear(&port->tx_ring, &printf_state->span)) == 0U) {
+        if (printf_state->wait_us == 0U) {
+            return false;
+        }
+        if (printf_state->deadline_us == 0U) {
+            /* First wait: the clock is only read when the ring is full */
+            printf_state->deadline_us = bsp_time_us() + printf_state->wait_us;
+        } else if (bsp_time_us() >= printf_state->deadline_us) {
+            return false;
+        }
+        atomic_store(&port->tx_waiting, true);
+        bsp_time_idle_until(printf_state->deadline_us, uart_driver_tx_room);
+        atomic_store(&port->tx_waiting, false);
+    }
+    out->pos = (char *)printf_state->span;
+    out->end = out->pos + length;
+    return true;
+}
+
+error_t uart_driver_vprintf(uart_id_t uart_id, uint32_t wait_us, const char *format,
+                            va_list args)
+{
+    uart_printf_t printf_state = { .uart_id = uart_id, .wait_us = wait_us };
+    fmt_out_t out = { .refill = uart_driver_printf_refill, .context = &printf_state };
+    uint32_t length;
+    bool complete;
+    error_t err;
+
+    if (format == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    err = uart_driver_enter(uart_id, true);
+    if (err != ERR_OK) {
+        return err;
+    }
+
+    PROFILE_BEGIN(uart_driver_printf);
+    length = ring_buffer_reserve_linear(&uart_ports[uart_id].tx_ring, &printf_state.span);
+    out.pos = (char *)printf_state.span;
+    out.end = out.pos + length;
+    complete = fmt_vformat(&out, format, args);
+    uart_driver_printf_commit(&out);
+    PROFILE_END(uart_driver_printf);
+    uart_driver_leave(uart_id, true);
+
+    /* The TX ring filled: the tail was not queued */
+    return complete ? ERR_OK : ERR_BUSY;
+}
+
+error_t uart_driver_printf(uart_id_t uart_id, uint32_t wait_us, const char *format, ...)
+{
+    va_list args;
+    error_t err;
+
+    va_start(args, format);
+    err = uart_driver_vprintf(uart_id, wait_us, format, args);
+    va_end(args);
+    return err;
+}
+
+error_t uart_driver_writev(uart_id_t uart_id, const uart_iovec_t *iov, uint8_t iov_count,
+                           uart_writev_callback_t on_complete, void *context)
+{
+    uart_port_t *port;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t needed = 0;
+    uart_dma_desc_t *desc = NULL;
+    error_t err;
+
+    if (iov == NULL || iov_count == 0) {
+        return ERR_INVALID_PARAM;
+    }
+    for (uint8_t i = 0; i < iov_count; i++) {
+        if (iov[i].length > 0) {
+            if (iov[i].data == NULL) {
+                return ERR_INVALID_PARAM;
+            }
+            needed++;
+        }
+    }
+    if (needed == 0) {
+        return ERR_INVALID_PARAM;
+    }
+    err = uart_driver_enter(uart_id, true);
+    if (err != ERR_OK) {
+        return err;
+    }
+
+    port = &uart_ports[uart_id];
+    head = atomic_load_explicit(&port->dma_head, memory_order_relaxed);
+    tail = atomic_load_explicit(&port->dma_tail, memory_order_acquire);
+    if (UART_DMA_QUEUE_DEPTH - (head - tail) < needed) {
+        uart_driver_leave(uart_id, true);
+        return ERR_BUSY;
+    }
+
+    for (uint8_t i = 0; i < iov_count; i++) {
+        if (iov[i].length == 0) {
+            continue;
+        }
+        desc = &port->dma_queue[head & UART_DMA_QUEUE_MASK];
+        desc->data = iov[i].data;
+        desc->length = iov[i].length;
+        desc->last = false;
+        desc->on_complete = NULL;
+        desc->context = NULL;
+        head++;
+    }
+    desc->last = true;
+    desc->on_complete = on_complete;
+    desc->context = context;
+
+    /* Publish the whole frame at once */
+    atomic_store_explicit(&port->dma_head, head, memory_order_release);
+    uart_driver_tx_kick(uart_id);
+    uart_driver_leave(uart_id, true);
+    return ERR_OK;
+}
+
+static void uart_driver_block_sent(uart_id_t uart_id, void *context, error_t status)
+{
+    (void)uart_id; (void)status;
+    (void)mem_free(context);
+}
+
+error_t uart_driver_write_block(uart_id_t uart_id, void *block, uint16_t length)
+{
+    uart_iovec_t iov = { .data = (const uint8_t *)block, .length = length };
+    error_t err;
+
+    if (block == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    err = uart_driver_writev(uart_id, &iov, 1, uart_driver_block_sent, block);
+    if (err != ERR_OK) {
+        (void)mem_free(block);
+    }
+    return err;
+}
+
+/* Back to byte-wise reception; caller owns the RX side */
+static error_t uart_driver_end_rx_stream(uart_id_t uart_id)
+{
+    uart_port_t *port = &uart_ports[uart_id];
+
+    if (port->rx_stream == NULL) {
+        return ERR_OK;
+    }
+    (void)uart_abort_receive(uart_id);
+    uart_hal_register_rx_event_callback(uart_id, NULL);
+    port->rx_stream = NULL;
+    ring_buffer_reset(&port->rx_ring);
+    return uart_receive_it(uart_id, &port->rx_byte, 1);
+}
+
+error_t uart_driver_start_rx_stream(uart_id_t uart_id, uart_rx_stream_callback_t on_data,
+                                    void *context)
+{
+    uart_port_t *port;
+    error_t err;
+
+    if (on_data == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    err = uart_driver_enter(uart_id, false);
+    if (err != ERR_OK) {
+        return err;
+    }
+    port = &uart_ports[uart_id];
+    if (port->rx_stream != NULL) {
+        uart_driver_leave(uart_id, false);
+        return ERR_BUSY;
+    }
+
+    /* Stop byte-wise reception; the RX storage becomes the DMA buffer */
+    (void)uart_abort_receive(uart_id);
+    ring_buffer_reset(&port->rx_ring);
+    port->rx_stream_context = context;
+    port->rx_stream_position = 0;
+    port->rx_stream = on_data;
+    uart_hal_register_rx_event_callback(uart_id, uart_driver_rx_event);
+
+    err = uart_receive_dma(uart_id, uart_port_buffers[uart_id].rx_storage,
+                           (uint16_t)uart_port_buffers[uart_id].rx_size);
+    if (err != ERR_OK) {
+        (void)uart_driver_end_rx_stream(uart_id);
+    }
+    uart_driver_leave(uart_id, false);
+    return err;
+}
+
+error_t uart_driver_stop_rx_stream(uart_id_t uart_id)
+{
+    error_t err = uart_driver_enter(uart_id, false);
+
+    if (err != ERR_OK) {
+        return err;
+    }
+    err = uart_driver_end_rx_stream(uart_id);
+    uart_driver_leave(uart_id, false);
+    return err;
+}
+
+error_t uart_driver_set_timeouts(uart_id_t uart_id, uint32_t rx_idle_ms, uint32_t tx_stall_ms,
+                                 uart_timeout_callback_t on_timeout, void *context)
+{
+    uart_port_t *port;
+    uint32_t shortest;
+
+    if (!uart_driver_is_open(uart_id)) {
+        return ERR_NOT_INITIALIZED;
+    }
+    port = &uart_ports[uart_id];
+    (void)sw_timer_stop(&port->timeout_timer);
+    atomic_store(&port->timeout_armed, false);
+    if (rx_idle_ms == 0U && tx_stall_ms == 0U) {
+        port->on_timeout = NULL;
+        return ERR_OK;
+    }
+    if (on_timeout == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+
+    shortest = (rx_idle_ms == 0U) ? tx_stall_ms :
+               (tx_stall_ms == 0U || rx_idle_ms < tx_stall_ms) ? rx_idle_ms : tx_stall_ms;
+    port->timeout_poll = (shortest >= 4U) ? (shortest / 4U) : 1U;
+    port->rx_idle_ms = rx_idle_ms;
+    port->tx_stall_ms = tx_stall_ms;
+    port->rx_idle_elapsed = 0;
+    port->tx_stall_elapsed = 0;
+    port->rx_bytes_seen = port->stats.rx_bytes;
+    port->tx_bytes_seen = port->stats.tx_bytes;
+    port->rx_idle_reported = false;
+    port->on_timeout = on_timeout;
+    port->timeout_context = context;
+
+    /* The first poll parks the timer if there is nothing to watch yet */
+    atomic_store(&port->timeout_armed, true);
+    return sw_timer_start(&port->timeout_timer, port->timeout_poll, port->timeout_poll);
+}
+
+void uart_driver_process(void)
+{
+    for (uint32_t i = 0; i < (uint32_t)UART_COUNT; i++) {
+        uart_port_t *port = &uart_ports[i];
+
+        if (!atomic_exchange(&port->timeout_kick, false) || port->on_timeout == NULL ||
+            atomic_load(&port->timeout_armed)) {
+            continue;
+        }
+        atomic_store(&port->timeout_armed, true);
+        (void)sw_timer_start(&port->timeout_timer, port->timeout_poll, port->timeout_poll);
+    }
+}
+
+error_t uart_driver_get_config(uart_id_t uart_id, uart_config_t *config)
+{
+    if (config == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    if (!uart_driver_is_open(uart_id)) {
+        return ERR_NOT_INITIALIZED;
+    }
+    *config = uart_ports[uart_id].config;
+    return ERR_OK;
+}
+
+error_t uart_driver_get_timing(uart_id_t uart_id, uart_baud_timing_t *timing)
+{
+    if (timing == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    if (!uart_driver_is_open(uart_id)) {
+        return ERR_NOT_INITIALIZED;
+    }
+    *timing = uart_ports[uart_id].timing;
+    return ERR_OK;
+}
+
+uint16_t uart_driver_rx_available(uart_id_t uart_id)
+{
+    if (!uart_driver_is_open(uart_id)) {
+        return 0;
+    }
+    return (uint16_t)ring_buffer_used(&uart_ports[uart_id].rx_ring);
+}
+
+uint16_t uart_driver_tx_free(uart_id_t uart_id)
+{
+    if (!uart_driver_is_open(uart_id)) {
+        return 0;
+    }
+    return (uint16_t)ring_buffer_free(&uart_ports[uart_id].tx_ring);
+}
+
+error_t uart_driver_set_rx_wake(uart_id_t uart_id, bool enable)
+{
+    if (!uart_driver_is_open(uart_id)) {
+        return ERR_NOT_INITIALIZED;
+    }
+    uart_ports[uart_id].rx_wake = enable;
+    return ERR_OK;
+}
+
+error_t uart_driver_get_stats(uart_id_t uart_id, uart_driver_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    if (!uart_driver_is_open(uart_id)) {
+        return ERR_NOT_INITIALIZED;
+    }
+    *stats = uart_ports[uart_id].stats;
+    return ERR_OK;
 }
@@ -3,25 +3,178 @@
  *
  * Application-facing UART driver.
  * Depends only on HAL abstraction.
+ *
+ * Transfers are interrupt driven and never block: each port owns a TX
+ * and an RX ring buffer (sizes in board_config.h). uart_driver_write()
+ * queues what fits and the TX interrupt drains it; the RX interrupt
+ * fills the RX ring and uart_driver_read() takes what has arrived.
+ *
+ * uart_driver_writev() sends a frame split across several caller-owned
+ * buffers straight from those buffers (no staging copy). Queued frames
+ * take priority over ring data not yet handed to the hardware. Only the
+ * host backend has a TX DMA path so far; on STM32 the buffers are sent
+ * interrupt driven, still without a copy.
+ *
+ * uart_driver_start_rx_stream() switches a port's receiver to circular
+ * DMA over its RX buffer for continuous variable-length traffic. Data is
+ * handed out in place on half-transfer, transfer-complete and idle-line
+ * events; nothing is copied and no length has to be known up front.
+ * Only the host backend has RX DMA so far: on STM32 the start fails and
+ * the port stays on ring-buffered reception.
+ *
+ * uart_driver_set_timeouts() watches a port with a software timer
+ * (common/sw_timer.h) and reports an RX line that went quiet with
+ * unread data, or a TX queue that stopped draining. The timer only
+ * runs while there is something to time; uart_driver_process(), called
+ * from the main loop, restarts it when data moves again.
+ *
+ * Ports are independent: each has its own state, buffers, interrupt and
+ * DMA path, and all UART_COUNT of them may run at once. On one port, one
+ * caller at a time may transmit (write/writev) and one may receive
+ * (read/stream control); a concurrent second caller on the same side
+ * gets ERR_BUSY with nothing queued or taken, so writes never
+ * interleave. Open and close from thread context only.
  */
 
 #ifndef DRIVERS_UART_DRIVER_H
 #define DRIVERS_UART_DRIVER_H
 
+#include <stdarg.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include "../common/error.h"
 #include "../hal/hal_uart.h"
 
+/* Per-port Statistics */
+typedef struct {
+    uint32_t tx_bytes;      /* Bytes handed to the hardware */
+    uint32_t rx_bytes;      /* Bytes stored in the RX ring */
+    uint32_t rx_dropped;    /* Bytes lost because the RX ring was full */
+    uint32_t rx_timeouts;   /* RX idle timeouts reported */
+    uint32_t tx_timeouts;   /* TX stall timeouts reported */
+} uart_driver_stats_t;
+
+/* Timeout kinds */
+typedef enum {
+    UART_TIMEOUT_RX_IDLE = 0,   /* Unread data and no new byte for rx_idle_ms */
+    UART_TIMEOUT_TX_STALL       /* TX pending but nothing sent for tx_stall_ms */
+} uart_timeout_t;
+
+/* Scatter/gather element for uart_driver_writev() */
+typedef struct {
+    const uint8_t *data;
+    uint16_t length;
+} uart_iovec_t;
+
+/* Frame completion, called from interrupt context once the last byte of
+ * a writev frame has left its buffer. status is ERR_OK, or
+ * ERR_NOT_INITIALIZED if the port was closed first. The buffers may be
+ * reused or released from here on.
+ */
+typedef void (*uart_writev_callback_t)(uart_id_t uart_id, void *context, error_t status);
+
+/* Received span in stream mode, called from interrupt context.
+ * data points into the port's DMA buffer and stays valid until the DMA
+ * comes round again (half the buffer later at the earliest), so the
+ * callback must consume or hand it off within that time.
+ */
+typedef void (*uart_rx_stream_callback_t)(uart_id_t uart_id, const uint8_t *data,
+                                          uint16_t length, uart_rx_event_t event,
+                                          void *context);
+
+/* Timeout notification, called from sw_timer_process() context (not an
+ * interrupt). An RX idle timeout is reported once per burst of data. */
+typedef void (*uart_timeout_callback_t)(uart_id_t uart_id, uart_timeout_t timeout,
+                                        void *context);
+
 /* UART Driver Initialization */
 error_t uart_driver_init(void);
 error_t uart_driver_deinit(void);
 
-/* UART Driver API */
+/* UART Driver API
+ * baud_rate is any integer rate; open fails with ERR_INVALID_PARAM when
+ * the port's bus clock cannot generate it within UART_BAUD_MAX_ERROR_PPM.
+ * Open ports are re-timed on every clock profile switch (bsp_clock.h);
+ * uart_driver_get_timing() reports the divisors currently programmed,
+ * uart_driver_get_config() the line settings the port was opened with.
+ * Opening a port that is already open (or being opened) is ERR_BUSY.
+ */
 error_t uart_driver_open(uart_id_t uart_id, uint32_t baud_rate);
 error_t uart_driver_close(uart_id_t uart_id);
-error_t uart_driver_write(uart_id_t uart_id, const uint8_t *data, uint16_t length);
-error_t uart_driver_read(uart_id_t uart_id, uint8_t *data, uint16_t length);
-error_t uart_driver_write_string(uart_id_t uart_id, const char *str);
+error_t uart_driver_get_timing(uart_id_t uart_id, uart_baud_timing_t *timing);
+error_t uart_driver_get_config(uart_id_t uart_id, uart_config_t *config);
+
+/* Non-blocking data path
+ * written/received report how many bytes were queued/copied (may be
+ * fewer than length, including zero); either pointer may be NULL.
+ */
+error_t uart_driver_write(uart_id_t uart_id, const uint8_t *data, uint16_t length,
+                          uint16_t *written);
+error_t uart_driver_read(uart_id_t uart_id, uint8_t *data, uint16_t length,
+                         uint16_t *received);
+
+/* The whole of str, any length, through uart_driver_printf(): when the
+ * TX ring is full it waits up to wait_us in all for it to drain. With 0
+ * it never waits, and a string longer than the free space is cut short
+ * with ERR_BUSY. */
+error_t uart_driver_write_string(uart_id_t uart_id, uint32_t wait_us, const char *str);
+
+/* Formatted output (common/fmt.h conversions, including %k fixed point)
+ * rendered straight into the TX ring, a free span at a time, so output
+ * of any length needs no staging buffer. When the ring is full it waits,
+ * in thread context, up to wait_us for the TX interrupt to make room;
+ * with 0 it never waits. ERR_BUSY if the output was cut short (what was
+ * formatted so far is sent) or another caller is transmitting.
+ */
+error_t uart_driver_printf(uart_id_t uart_id, uint32_t wait_us, const char *format, ...);
+error_t uart_driver_vprintf(uart_id_t uart_id, uint32_t wait_us, const char *format,
+                            va_list args);
+
+/* Zero-copy transmit of iov[0..iov_count-1] as one frame, by DMA where
+ * the backend has it (host only for now), else interrupt driven
+ * The buffers must stay valid until on_complete runs. Returns ERR_BUSY
+ * if the descriptor queue (UART_DMA_QUEUE_DEPTH) cannot take the frame.
+ */
+error_t uart_driver_writev(uart_id_t uart_id, const uart_iovec_t *iov, uint8_t iov_count,
+                           uart_writev_callback_t on_complete, void *context);
+
+/* Zero-copy transmit of a block from mem_alloc() (common/mem_pool.h) as
+ * one frame. The driver owns the block from here: it goes back to the
+ * pool once sent, or at once if the frame cannot be queued.
+ */
+error_t uart_driver_write_block(uart_id_t uart_id, void *block, uint16_t length);
+
+/* Circular DMA reception (host backend only for now)
+ * While streaming, uart_driver_read() returns ERR_BUSY; stopping
+ * returns the port to ring-buffered reception. A backend without RX DMA
+ * fails the start with ERR_NOT_INITIALIZED and the port keeps
+ * ring-buffered reception.
+ */
+error_t uart_driver_start_rx_stream(uart_id_t uart_id, uart_rx_stream_callback_t on_data,
+                                    void *context);
+error_t uart_driver_stop_rx_stream(uart_id_t uart_id);
+
+/* Timeout supervision, in sw_timer ticks (ms); 0 disables a check,
+ * both 0 stops supervision. The counters are polled every quarter of
+ * the shortest timeout, so a report may come up to half a timeout late.
+ * The poll stops while a port has no unread RX data and no TX queued.
+ */
+error_t uart_driver_set_timeouts(uart_id_t uart_id, uint32_t rx_idle_ms, uint32_t tx_stall_ms,
+                                 uart_timeout_callback_t on_timeout, void *context);
+
+/* Main loop service: restarts the timeout poll of ports whose data
+ * moved while it was stopped (the interrupt also wakes the loop). Call
+ * before sw_timer_process(), from the same thread. */
+void uart_driver_process(void);
+
+/* Wake from Stop on incoming data (bsp_power.h); off at open. On
+ * target the character that wakes the core is lost, so a peer that
+ * talks to a sleeping port leads with a byte that may be dropped. */
+error_t uart_driver_set_rx_wake(uart_id_t uart_id, bool enable);
+
+/* Buffer State */
+uint16_t uart_driver_rx_available(uart_id_t uart_id);
+uint16_t uart_driver_tx_free(uart_id_t uart_id);
+error_t uart_driver_get_stats(uart_id_t uart_id, uart_driver_stats_t *stats);
 
 #endif /* DRIVERS_UART_DRIVER_H */
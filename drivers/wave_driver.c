@@ -0,0 +1,184 @@
+/*
+ * wave_driver.c - Waveform Generator Driver Implementation
+ *
+ * The HAL reports DMA half-transfer and transfer-complete; the driver
+ * maps them to the mode: DOUBLE hands out the half just finished, the
+ * others count passes and end a one-shot. running is claimed with a
+ * compare-exchange so two starts cannot both program the engine, and
+ * released by wave_driver_stop(), by the one-shot completion or by a
+ * DMA error.
+ */
+
+#include "wave_driver.h"
+#include "../bsp/bsp_clock.h"
+#include "../bsp/bsp_power.h"
+#include "../common/hot_path.h"
+#include <stdatomic.h>
+
+typedef struct {
+    _Atomic bool running;
+    wave_mode_t mode;
+    wave_word_t *words;
+    uint16_t count;
+    uint32_t sample_rate_hz;
+    wave_callback_t callback;
+    void *context;
+    wave_timing_t timing;
+    _Atomic uint32_t passes;
+    _Atomic uint32_t errors;
+} wave_state_t;
+
+static wave_state_t wave;
+
+static HOT_FUNC void wave_driver_event(wave_event_t event)
+{
+    uint16_t half = (uint16_t)(wave.count / 2U);
+
+    if (!atomic_load_explicit(&wave.running, memory_order_acquire)) {
+        return;
+    }
+
+    switch (event) {
+    case WAVE_EVENT_HALF:
+        if (wave.mode == WAVE_MODE_DOUBLE) {
+            wave.callback(wave.words, half, wave.context);
+        }
+        break;
+
+    case WAVE_EVENT_FULL:
+        atomic_fetch_add_explicit(&wave.passes, 1U, memory_order_relaxed);
+        if (wave.mode == WAVE_MODE_DOUBLE) {
+            wave.callback(&wave.words[half], (uint16_t)(wave.count - half), wave.context);
+        } else {
+            if (wave.mode == WAVE_MODE_ONESHOT) {
+                atomic_store_explicit(&wave.running, false, memory_order_release);
+            }
+            if (wave.callback != NULL) {
+                wave.callback(wave.words, wave.count, wave.context);
+            }
+        }
+        break;
+
+    case WAVE_EVENT_ERROR:
+    default:
+        atomic_fetch_add_explicit(&wave.errors, 1U, memory_order_relaxed);
+        atomic_store_explicit(&wave.running, false, memory_order_release);
+        break;
+    }
+}
+
+/* ===== Clock Changes ===== */
+
+static error_t wave_driver_clock_changed(clock_change_phase_t phase, const clock_config_t *config,
+                                         void *context)
+{
+    wave_timing_t timing;
+    error_t err;
+
+    (void)context;
+    if (!atomic_load_explicit(&wave.running, memory_order_acquire)) {
+        return ERR_OK;
+    }
+    err = wave_compute_timing_for_clock(wave.sample_rate_hz, config, &timing);
+    if (phase == CLOCK_CHANGE_PREPARE || err != ERR_OK) {
+        return err;
+    }
+    err = wave_set_timing(&timing);
+    if (err == ERR_OK) {
+        wave.timing = timing;
+    }
+    return err;
+}
+
+/* The timer and DMA stop with the bus clocks: no Stop while running */
+static error_t wave_driver_power_changed(power_stop_phase_t phase, void *context)
+{
+    (void)context;
+    if (phase == POWER_STOP_PREPARE && atomic_load_explicit(&wave.running, memory_order_acquire)) {
+        return ERR_BUSY;
+    }
+    return ERR_OK;
+}
+
+/* ===== Driver API ===== */
+
+error_t wave_driver_init(void)
+{
+    error_t err;
+
+    wave_hal_init();
+    wave_hal_register_event_callback(wave_driver_event);
+    atomic_init(&wave.running, false);
+    err = bsp_clock_register_callback(wave_driver_clock_changed, NULL);
+    if (err == ERR_OK) {
+        err = bsp_power_register_callback(wave_driver_power_changed, NULL);
+    }
+    return err;
+}
+
+error_t wave_driver_start(gpio_port_t port, wave_word_t *words, uint16_t count,
+                          uint32_t sample_rate_hz, wave_mode_t mode,
+                          wave_callback_t callback, void *context)
+{
+    wave_timing_t timing;
+    bool idle = false;
+    error_t err;
+
+    if (port >= GPIO_BOARD_PORT_COUNT || words == NULL || count == 0U ||
+        (uint32_t)mode > (uint32_t)WAVE_MODE_DOUBLE) {
+        return ERR_INVALID_PARAM;
+    }
+    if (mode == WAVE_MODE_DOUBLE && (callback == NULL || (count & 1U) != 0U)) {
+        return ERR_INVALID_PARAM;
+    }
+    err = wave_compute_timing(sample_rate_hz, &timing);
+    if (err != ERR_OK) {
+        return err;
+    }
+    if (!atomic_compare_exchange_strong_explicit(&wave.running, &idle, true,
+                                                 memory_order_acquire,
+                                                 memory_order_relaxed)) {
+        return ERR_BUSY;
+    }
+
+    wave.mode = mode;
+    wave.words = words;
+    wave.count = count;
+    wave.sample_rate_hz = sample_rate_hz;
+    wave.callback = callback;
+    wave.context = context;
+    wave.timing = timing;
+    atomic_store_explicit(&wave.passes, 0U, memory_order_relaxed);
+    atomic_store_explicit(&wave.errors, 0U, memory_order_relaxed);
+
+    err = wave_start(port, words, count, &timing, mode != WAVE_MODE_ONESHOT);
+    if (err != ERR_OK) {
+        atomic_store_explicit(&wave.running, false, memory_order_release);
+    }
+    return err;
+}
+
+error_t wave_driver_stop(void)
+{
+    wave_stop();
+    atomic_store_explicit(&wave.running, false, memory_order_release);
+    return ERR_OK;
+}
+
+bool wave_driver_is_running(void)
+{
+    return atomic_load_explicit(&wave.running, memory_order_acquire);
+}
+
+error_t wave_driver_get_status(wave_status_t *status)
+{
+    if (status == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    status->running = atomic_load_explicit(&wave.running, memory_order_acquire);
+    status->mode = wave.mode;
+    status->timing = wave.timing;
+    status->passes = atomic_load_explicit(&wave.passes, memory_order_relaxed);
+    status->errors = atomic_load_explicit(&wave.errors, memory_order_relaxed);
+    return ERR_OK;
+}
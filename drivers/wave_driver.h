@@ -0,0 +1,73 @@
+/*
+ * wave_driver.h - Waveform Generator Driver
+ *
+ * Plays a buffer of port set/clear words (WAVE_SET() | WAVE_CLEAR(),
+ * see hal/hal_wave.h) on a GPIO port at a fixed sample rate, paced by a
+ * hardware timer and moved by DMA: pulse trains, PWM patterns and slow
+ * serial protocols without a gpio_driver_set()/clear() loop, and without
+ * the main loop's jitter. Sample n goes out n periods after start, the
+ * first one immediately.
+ *
+ * Modes:
+ *  - WAVE_MODE_ONESHOT: the buffer once; the callback (optional) runs
+ *    after the last word, whose pin states then stay.
+ *  - WAVE_MODE_REPEAT: the buffer in a loop until wave_driver_stop();
+ *    the callback (optional) runs after every pass.
+ *  - WAVE_MODE_DOUBLE: the buffer is played in a loop as two halves.
+ *    The callback gets each half as soon as it has been output, to
+ *    refill it while the other half plays; it has count / 2 sample
+ *    periods to do so.
+ *
+ * Callbacks run in interrupt context; a ONESHOT callback may start the
+ * next waveform. The pins must already be configured as outputs.
+ *
+ * A running waveform keeps its rate across clock profile switches: it
+ * is re-timed for the new timer clock, and a switch to a clock that
+ * cannot generate the rate is vetoed. Stop mode is vetoed while a
+ * waveform runs, since the timer and DMA would halt with the clocks.
+ */
+
+#ifndef DRIVERS_WAVE_DRIVER_H
+#define DRIVERS_WAVE_DRIVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/error.h"
+#include "../hal/hal_wave.h"
+
+typedef enum {
+    WAVE_MODE_ONESHOT = 0,
+    WAVE_MODE_REPEAT,
+    WAVE_MODE_DOUBLE
+} wave_mode_t;
+
+/* words/count: the whole buffer (ONESHOT, REPEAT) or the half that is
+ * free to refill (DOUBLE) */
+typedef void (*wave_callback_t)(wave_word_t *words, uint16_t count, void *context);
+
+typedef struct {
+    bool running;
+    wave_mode_t mode;
+    wave_timing_t timing;       /* Of the running or last waveform */
+    uint32_t passes;            /* Whole buffers output */
+    uint32_t errors;            /* Transfers aborted by a DMA error */
+} wave_status_t;
+
+error_t wave_driver_init(void);
+
+/* ERR_BUSY if a waveform is running, ERR_INVALID_PARAM for a port the
+ * board does not have (GPIO_BOARD_PORT_COUNT: the DMA writes straight to
+ * that port's BSRR), a rate the timer cannot generate (see
+ * wave_compute_timing()), an empty buffer, or DOUBLE without a callback
+ * or with an odd count */
+error_t wave_driver_start(gpio_port_t port, wave_word_t *words, uint16_t count,
+                          uint32_t sample_rate_hz, wave_mode_t mode,
+                          wave_callback_t callback, void *context);
+
+/* Stop after the word in progress; the pins keep their state */
+error_t wave_driver_stop(void);
+
+bool wave_driver_is_running(void);
+error_t wave_driver_get_status(wave_status_t *status);
+
+#endif /* DRIVERS_WAVE_DRIVER_H */
@@ -2,63 +2,45 @@
  * hal_gpio.c - GPIO HAL Implementation (Stub - Ready for STM32 HAL integration)
  *
  * This stub demonstrates the HAL abstraction pattern.
- * Replace the TODO sections with actual STM32 HAL calls.
+ * Backend operations live in hal_gpio_<backend>.h; replace the TODO
+ * sections there with actual STM32 HAL calls.
+ *
+ * With HAL_STATIC_BINDING the GPIO API is inlined from hal_gpio.h and
+ * only the edge interrupt dispatch below remains here.
  */
 
 #include "hal_gpio.h"
 #include "../bsp/board_config.h"
+#include "../bsp/bsp_power.h"
+#include "../bsp/bsp_time.h"
+#include "../common/hot_path.h"
 
-/* GPIO HAL instance - will be set during initialization */
-static gpio_hal_t *gpio_hal = NULL;
-
-/* ===== STM32 HAL Stub Functions (Replace with actual STM32 HAL) ===== */
-
-static void stm32_gpio_init(gpio_pin_t pin, gpio_mode_t mode, gpio_output_type_t otype,
-                           gpio_pull_t pull, gpio_speed_t speed)
-{
-    /* TODO: Implement STM32 HAL GPIO initialization
-     * Example (for reference):
-     * 
-     * GPIO_InitTypeDef GPIO_InitStruct = {0};
-     * GPIO_InitStruct.Pin = (1 << (pin & 0x0F));
-     * GPIO_InitStruct.Mode = (mode == GPIO_MODE_INPUT ? GPIO_MODE_INPUT : 
-     *                         mode == GPIO_MODE_OUTPUT ? GPIO_MODE_OUTPUT : 
-     *                         GPIO_MODE_AF);
-     * GPIO_InitStruct.Pull = (pull == GPIO_PULL_UP ? GPIO_PULLUP :
-     *                         pull == GPIO_PULL_DOWN ? GPIO_PULLDOWN : GPIO_NOPULL);
-     * GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
-     * HAL_GPIO_Init((GPIO_TypeDef*)(pin >> 8), &GPIO_InitStruct);
-     */
-    (void)pin; (void)mode; (void)otype; (void)pull; (void)speed;
-}
+#ifndef HAL_STATIC_BINDING
 
-static void stm32_gpio_write(gpio_pin_t pin, bool value)
-{
-    /* TODO: HAL_GPIO_WritePin() */
-    (void)pin; (void)value;
-}
+#ifdef USE_POSIX_HAL
+#include "hal_gpio_posix.h"
+#else
+#include "hal_gpio_stm32.h"
+#endif
 
-static bool stm32_gpio_read(gpio_pin_t pin)
-{
-    /* TODO: HAL_GPIO_ReadPin() */
-    (void)pin;
-    return false;
-}
+/* GPIO HAL instance - will be set during initialization */
+static gpio_hal_t *gpio_hal = NULL;
 
-static void stm32_gpio_toggle(gpio_pin_t pin)
-{
-    /* TODO: HAL_GPIO_TogglePin() */
-    (void)pin;
-}
+#ifndef USE_POSIX_HAL
 
 /* GPIO HAL structure for STM32 */
-static const gpio_hal_t stm32_gpio_hal = {
+static const gpio_hal_t stm32_gpio_hal HOT_DATA = {
     .init = stm32_gpio_init,
     .write = stm32_gpio_write,
     .read = stm32_gpio_read,
-    .toggle = stm32_gpio_toggle
+    .toggle = stm32_gpio_toggle,
+    .port_set_clear = stm32_gpio_port_set_clear,
+    .port_read = stm32_gpio_port_read,
+    .irq_configure = stm32_gpio_irq_configure
 };
 
+#endif /* !USE_POSIX_HAL */
+
 /* ===== HAL Abstraction API ===== */
 
 void gpio_hal_init(void)
@@ -70,6 +52,8 @@ void gpio_hal_init(void)
     /* gpio_hal = &stm32_ll_gpio_hal; */
 #elif defined(USE_OPENCM3)
     /* gpio_hal = &opencm3_gpio_hal; */
+#elif defined(USE_POSIX_HAL)
+    gpio_hal = (gpio_hal_t *)&posix_gpio_hal;
 #else
     /* Default to STM32 HAL */
     gpio_hal = (gpio_hal_t *)&stm32_gpio_hal;
@@ -105,3 +89,122 @@ void gpio_toggle(gpio_pin_t pin)
         gpio_hal->toggle(pin);
     }
 }
+
+void gpio_port_set_clear(gpio_port_t port, uint16_t set_mask, uint16_t clear_mask)
+{
+    if (gpio_hal != NULL && gpio_hal->port_set_clear != NULL) {
+        gpio_hal->port_set_clear(port, set_mask, clear_mask);
+    }
+}
+
+void gpio_port_write_masked(gpio_port_t port, uint16_t mask, uint16_t value)
+{
+    gpio_port_set_clear(port, (uint16_t)(value & mask), (uint16_t)(~value & mask));
+}
+
+uint16_t gpio_port_read(gpio_port_t port)
+{
+    if (gpio_hal != NULL && gpio_hal->port_read != NULL) {
+        return gpio_hal->port_read(port);
+    }
+    return 0;
+}
+
+error_t gpio_irq_configure(gpio_pin_t pin, gpio_edge_t edge)
+{
+    if (gpio_hal == NULL || gpio_hal->irq_configure == NULL) {
+        return ERR_NOT_INITIALIZED;
+    }
+    return gpio_hal->irq_configure(pin, edge);
+}
+
+#endif /* !HAL_STATIC_BINDING */
+
+/* ===== Edge Interrupt Callbacks ===== */
+
+static gpio_edge_callback_t gpio_edge_callbacks[GPIO_EXTI_LINES];
+
+void gpio_hal_register_edge_callback(gpio_pin_t pin, gpio_edge_callback_t on_edge)
+{
+    gpio_edge_callbacks[GPIO_PIN_NUMBER(pin)] = on_edge;
+}
+
+HOT_FUNC void gpio_hal_edge_isr(gpio_pin_t pin, bool level, uint64_t timestamp_us)
+{
+    gpio_edge_callback_t on_edge = gpio_edge_callbacks[GPIO_PIN_NUMBER(pin)];
+
+    /* EXTI lines wake Stop as they stand; claim it before the callback
+     * posts work */
+    bsp_power_wake(POWER_WAKE_GPIO);
+    if (on_edge != NULL) {
+        on_edge(pin, level, timestamp_us);
+    }
+}
+
+#if !defined(BOARD_HOST) && !defined(USE_POSIX_HAL)
+
+#include "hal_gpio_stm32.h"
+
+volatile uint32_t stm32_exti_uart_wake_lines;
+
+/* Service the pending lines among lines; timestamp_us was read first
+ * thing in the handler. Pending bits are cleared before the levels are
+ * read, so an edge from then on raises a new interrupt. A UART RX wake
+ * line fires once: it is masked until uart_set_rx_wake() arms it again. */
+static HOT_FUNC void stm32_gpio_exti_service(uint32_t lines, uint64_t timestamp_us)
+{
+    uint32_t pending = STM32_EXTI_PR & lines;
+    uint32_t uart_wake = pending & stm32_exti_uart_wake_lines;
+
+    STM32_EXTI_PR = pending;
+    if (uart_wake != 0U) {
+        STM32_EXTI_IMR &= ~uart_wake;
+        bsp_power_wake(POWER_WAKE_UART);
+        pending &= ~uart_wake;
+    }
+    while (pending != 0U) {
+        uint32_t line = (uint32_t)__builtin_ctz(pending);
+        uint32_t port = (STM32_SYSCFG_EXTICR(line >> 2) >> ((line & 3U) * 4U)) & 0xFUL;
+
+        pending &= pending - 1U;
+        gpio_hal_edge_isr(GPIO_PIN(port, line), (STM32_GPIO_IDR(port) & (1UL << line)) != 0U,
+                          timestamp_us);
+    }
+}
+
+HOT_FUNC void EXTI0_IRQHandler(void)
+{
+    stm32_gpio_exti_service(1UL << 0, bsp_time_us());
+}
+
+HOT_FUNC void EXTI1_IRQHandler(void)
+{
+    stm32_gpio_exti_service(1UL << 1, bsp_time_us());
+}
+
+HOT_FUNC void EXTI2_IRQHandler(void)
+{
+    stm32_gpio_exti_service(1UL << 2, bsp_time_us());
+}
+
+HOT_FUNC void EXTI3_IRQHandler(void)
+{
+    stm32_gpio_exti_service(1UL << 3, bsp_time_us());
+}
+
+HOT_FUNC void EXTI4_IRQHandler(void)
+{
+    stm32_gpio_exti_service(1UL << 4, bsp_time_us());
+}
+
+HOT_FUNC void EXTI9_5_IRQHandler(void)
+{
+    stm32_gpio_exti_service(0x03E0UL, bsp_time_us());
+}
+
+HOT_FUNC void EXTI15_10_IRQHandler(void)
+{
+    stm32_gpio_exti_service(0xFC00UL, bsp_time_us());
+}
+
+#endif /* !BOARD_HOST && !USE_POSIX_HAL */
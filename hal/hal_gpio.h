@@ -6,16 +6,53 @@
  * - STM32 LL
  * - libopencm3
  * - Custom HAL
+ *
+ * By default calls dispatch through a gpio_hal_t table chosen at init.
+ * Defining HAL_STATIC_BINDING (make BINDING=static) binds the API to the
+ * selected backend at compile time instead.
+ *
+ * Edge interrupts: a pin can raise an interrupt on its rising and/or
+ * falling edges (EXTI on STM32). There is one interrupt line per pin
+ * number, shared by all ports: only one of PA3, PB3, ... can use line 3
+ * at a time.
  */
 
 #ifndef HAL_GPIO_H
 #define HAL_GPIO_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "../common/error.h"
 
-/* GPIO Pin Definition */
+/* GPIO Pin Definition
+ * A pin is encoded as (port << 8) | number: bits 8..11 select the port
+ * (GPIO_PORT_A = 0, GPIO_PORT_B = 1, ...), bits 0..3 the pin within it.
+ * Build pins with GPIO_PIN(); the port operations below take the port
+ * index and a 16-bit pin mask (bit n = pin n).
+ */
 typedef uint32_t gpio_pin_t;
+typedef uint32_t gpio_port_t;
+
+#define GPIO_PORT_A             0U
+#define GPIO_PORT_B             1U
+#define GPIO_PORT_C             2U
+#define GPIO_PORT_D             3U
+#define GPIO_PORT_E             4U
+#define GPIO_PORT_F             5U
+#define GPIO_PORT_G             6U
+#define GPIO_PORT_H             7U
+#define GPIO_PORT_COUNT         16U     /* Ports the encoding can address */
+
+/* Ports that exist on the STM32F412 (GPIOA..GPIOH). The register blocks
+ * of indices 8..15 belong to other peripherals (CRC at 12, RCC at 14),
+ * so every port index taken from a caller is checked against this. */
+#define GPIO_BOARD_PORT_COUNT   (GPIO_PORT_H + 1U)
+
+#define GPIO_PIN(port, number)  ((gpio_pin_t)(((uint32_t)(port) << 8) | ((uint32_t)(number) & 0x0FU)))
+#define GPIO_PIN_PORT(pin)      (((uint32_t)(pin) >> 8) & 0x0FU)
+#define GPIO_PIN_NUMBER(pin)    ((uint32_t)(pin) & 0x0FU)
+#define GPIO_PIN_MASK(pin)      ((uint16_t)(1U << GPIO_PIN_NUMBER(pin)))
 
 /* GPIO Mode */
 typedef enum {
@@ -46,6 +83,21 @@ typedef enum {
     GPIO_SPEED_VERY_HIGH
 } gpio_speed_t;
 
+/* Edge interrupt selection */
+typedef enum {
+    GPIO_EDGE_NONE = 0,  /* Interrupt disabled */
+    GPIO_EDGE_RISING,
+    GPIO_EDGE_FALLING,
+    GPIO_EDGE_BOTH
+} gpio_edge_t;
+
+#define GPIO_EXTI_LINES         16U
+
+/* Edge interrupt callback, invoked from interrupt context. timestamp_us
+ * (bsp_time_us() scale) is taken on entry to the interrupt handler,
+ * level is the pin level read afterwards. */
+typedef void (*gpio_edge_callback_t)(gpio_pin_t pin, bool level, uint64_t timestamp_us);
+
 /* GPIO HAL Function Pointers */
 typedef struct {
     void (*init)(gpio_pin_t pin, gpio_mode_t mode, gpio_output_type_t otype, 
@@ -53,8 +105,75 @@ typedef struct {
     void (*write)(gpio_pin_t pin, bool value);
     bool (*read)(gpio_pin_t pin);
     void (*toggle)(gpio_pin_t pin);
+    void (*port_set_clear)(gpio_port_t port, uint16_t set_mask, uint16_t clear_mask);
+    uint16_t (*port_read)(gpio_port_t port);
+    error_t (*irq_configure)(gpio_pin_t pin, gpio_edge_t edge);
 } gpio_hal_t;
 
+#ifdef HAL_STATIC_BINDING
+
+/* ===== Static Binding =====
+ * The backend is fixed at compile time by the HAL selection define and
+ * every call below inlines straight into the backend operation: no
+ * function-pointer dispatch and no NULL checks.
+ */
+#if defined(USE_POSIX_HAL)
+#include "hal_gpio_posix.h"
+#define GPIO_HAL_OP(op)     posix_gpio_##op
+#elif defined(USE_STM32_LL) || defined(USE_OPENCM3)
+#error "HAL_STATIC_BINDING: no static GPIO backend for the selected HAL yet"
+#else
+#include "hal_gpio_stm32.h"
+#define GPIO_HAL_OP(op)     stm32_gpio_##op
+#endif
+
+static inline void gpio_hal_init(void)
+{
+}
+
+static inline void gpio_configure(gpio_pin_t pin, gpio_mode_t mode, gpio_output_type_t otype,
+                                  gpio_pull_t pull, gpio_speed_t speed)
+{
+    GPIO_HAL_OP(init)(pin, mode, otype, pull, speed);
+}
+
+static inline void gpio_write(gpio_pin_t pin, bool value)
+{
+    GPIO_HAL_OP(write)(pin, value);
+}
+
+static inline bool gpio_read(gpio_pin_t pin)
+{
+    return GPIO_HAL_OP(read)(pin);
+}
+
+static inline void gpio_toggle(gpio_pin_t pin)
+{
+    GPIO_HAL_OP(toggle)(pin);
+}
+
+static inline void gpio_port_set_clear(gpio_port_t port, uint16_t set_mask, uint16_t clear_mask)
+{
+    GPIO_HAL_OP(port_set_clear)(port, set_mask, clear_mask);
+}
+
+static inline void gpio_port_write_masked(gpio_port_t port, uint16_t mask, uint16_t value)
+{
+    GPIO_HAL_OP(port_set_clear)(port, (uint16_t)(value & mask), (uint16_t)(~value & mask));
+}
+
+static inline uint16_t gpio_port_read(gpio_port_t port)
+{
+    return GPIO_HAL_OP(port_read)(port);
+}
+
+static inline error_t gpio_irq_configure(gpio_pin_t pin, gpio_edge_t edge)
+{
+    return GPIO_HAL_OP(irq_configure)(pin, edge);
+}
+
+#else
+
 /* GPIO HAL API */
 void gpio_hal_init(void);
 void gpio_configure(gpio_pin_t pin, gpio_mode_t mode, gpio_output_type_t otype,
@@ -63,4 +182,31 @@ void gpio_write(gpio_pin_t pin, bool value);
 bool gpio_read(gpio_pin_t pin);
 void gpio_toggle(gpio_pin_t pin);
 
+/* Whole-port access
+ * Every pin in the masks changes in the same register write (BSRR on
+ * STM32), so a parallel bus updates without skew. A pin in both masks
+ * ends up set. gpio_port_write_masked() drives the pins in mask to the
+ * matching bits of value and leaves the others untouched.
+ */
+void gpio_port_set_clear(gpio_port_t port, uint16_t set_mask, uint16_t clear_mask);
+void gpio_port_write_masked(gpio_port_t port, uint16_t mask, uint16_t value);
+uint16_t gpio_port_read(gpio_port_t port);
+
+/* Route the pin's interrupt line to it and arm the selected edges;
+ * GPIO_EDGE_NONE disarms the line. ERR_BUSY if the line is taken as a
+ * UART RX wake-up (uart_set_rx_wake()). */
+error_t gpio_irq_configure(gpio_pin_t pin, gpio_edge_t edge);
+
+#endif /* HAL_STATIC_BINDING */
+
+/* Edge interrupts
+ * The driver registers one callback per line (pin number); the backend
+ * ISR reports every serviced edge through gpio_hal_edge_isr(). Edges
+ * that arrive while a line is still pending are merged into one
+ * interrupt, as the hardware does. Every edge also wakes the core from
+ * Stop (bsp_power).
+ */
+void gpio_hal_register_edge_callback(gpio_pin_t pin, gpio_edge_callback_t on_edge);
+void gpio_hal_edge_isr(gpio_pin_t pin, bool level, uint64_t timestamp_us);
+
 #endif /* HAL_GPIO_H */
@@ -0,0 +1,169 @@
+/*
+ * hal_gpio_posix.c - GPIO HAL Implementation for the host (POSIX) backend
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "hal_gpio.h"
+#include "hal_gpio_posix.h"
+#include "../bsp/bsp_time.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+posix_gpio_port_t posix_gpio_ports[POSIX_GPIO_PORT_COUNT];
+
+const gpio_hal_t posix_gpio_hal = {
+    .init = posix_gpio_init,
+    .write = posix_gpio_write,
+    .read = posix_gpio_read,
+    .toggle = posix_gpio_toggle,
+    .port_set_clear = posix_gpio_port_set_clear,
+    .port_read = posix_gpio_port_read,
+    .irq_configure = posix_gpio_irq_configure
+};
+
+/* ===== Simulated EXTI ===== */
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool running;
+    uint8_t line_port[GPIO_EXTI_LINES];     /* SYSCFG line mux */
+    uint16_t rtsr;                          /* Lines armed for rising edges */
+    uint16_t ftsr;                          /* Lines armed for falling edges */
+    uint16_t pr;                            /* Pending lines */
+} posix_gpio_exti_t;
+
+static posix_gpio_exti_t posix_exti = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER
+};
+
+/* Interrupt handler: one pass per wake-up services every pending line */
+static void *posix_gpio_exti_isr(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&posix_exti.lock);
+    for (;;) {
+        uint64_t now;
+        uint16_t pending;
+        uint16_t levels = 0;
+        uint8_t ports[GPIO_EXTI_LINES];
+
+        while (posix_exti.pr == 0U) {
+            pthread_cond_wait(&posix_exti.cond, &posix_exti.lock);
+        }
+        now = bsp_time_us();
+        pending = posix_exti.pr;
+        posix_exti.pr = 0;
+        for (uint32_t line = 0; line < GPIO_EXTI_LINES; line++) {
+            ports[line] = posix_exti.line_port[line];
+            if ((posix_gpio_ports[ports[line]].idr & (1U << line)) != 0U) {
+                levels |= (uint16_t)(1U << line);
+            }
+        }
+        pthread_mutex_unlock(&posix_exti.lock);
+
+        while (pending != 0U) {
+            uint32_t line = (uint32_t)__builtin_ctz(pending);
+
+            pending &= (uint16_t)(pending - 1U);
+            gpio_hal_edge_isr(GPIO_PIN(ports[line], line),
+                              (levels & (1U << line)) != 0U, now);
+        }
+
+        pthread_mutex_lock(&posix_exti.lock);
+    }
+    return NULL;
+}
+
+error_t posix_gpio_irq_configure(gpio_pin_t pin, gpio_edge_t edge)
+{
+    uint32_t line = GPIO_PIN_NUMBER(pin);
+    uint16_t bit = GPIO_PIN_MASK(pin);
+
+    pthread_mutex_lock(&posix_exti.lock);
+    if (!posix_exti.running && edge != GPIO_EDGE_NONE) {
+        posix_exti.running = pthread_create(&posix_exti.thread, NULL,
+                                            posix_gpio_exti_isr, NULL) == 0;
+    }
+    posix_exti.line_port[line] = (uint8_t)GPIO_PIN_PORT(pin);
+    posix_exti.rtsr &= (uint16_t)~bit;
+    posix_exti.ftsr &= (uint16_t)~bit;
+    if (edge == GPIO_EDGE_RISING || edge == GPIO_EDGE_BOTH) {
+        posix_exti.rtsr |= bit;
+    }
+    if (edge == GPIO_EDGE_FALLING || edge == GPIO_EDGE_BOTH) {
+        posix_exti.ftsr |= bit;
+    }
+    posix_exti.pr &= (uint16_t)~bit;
+    pthread_mutex_unlock(&posix_exti.lock);
+    return ERR_OK;
+}
+
+/* ===== Host Harness Hooks ===== */
+
+void posix_gpio_set_input(gpio_pin_t pin, bool level)
+{
+    posix_gpio_port_t *port = &posix_gpio_ports[GPIO_PIN_PORT(pin)];
+    uint32_t line = GPIO_PIN_NUMBER(pin);
+    uint16_t bit = GPIO_PIN_MASK(pin);
+    uint16_t armed;
+
+    pthread_mutex_lock(&posix_exti.lock);
+    if (((port->idr & bit) != 0U) == level) {
+        pthread_mutex_unlock(&posix_exti.lock);
+        return;
+    }
+    if (level) {
+        port->idr |= bit;
+    } else {
+        port->idr &= (uint16_t)~bit;
+    }
+
+    armed = level ? posix_exti.rtsr : posix_exti.ftsr;
+    if ((armed & bit) != 0U && posix_exti.line_port[line] == GPIO_PIN_PORT(pin)) {
+        posix_exti.pr |= bit;
+        pthread_cond_signal(&posix_exti.cond);
+    }
+    pthread_mutex_unlock(&posix_exti.lock);
+}
+
+void posix_gpio_inject_edges(gpio_pin_t pin, const uint32_t *intervals_us, uint32_t count,
+                             uint64_t *edge_times_us)
+{
+    uint64_t due = bsp_time_us();
+    bool level = (posix_gpio_ports[GPIO_PIN_PORT(pin)].idr & GPIO_PIN_MASK(pin)) != 0U;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t now = bsp_time_us();
+
+        due += intervals_us[i];
+        if (due > now) {
+            struct timespec ts = {
+                .tv_sec = (time_t)((due - now) / 1000000U),
+                .tv_nsec = (long)((due - now) % 1000000U) * 1000L
+            };
+
+            while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+            }
+        }
+        level = !level;
+        if (edge_times_us != NULL) {
+            edge_times_us[i] = bsp_time_us();
+        }
+        posix_gpio_set_input(pin, level);
+    }
+}
+
+uint16_t posix_gpio_get_port_output(uint32_t port)
+{
+    if (port >= POSIX_GPIO_PORT_COUNT) {
+        return 0;
+    }
+    return posix_gpio_ports[port].odr;
+}
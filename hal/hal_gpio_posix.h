@@ -0,0 +1,123 @@
+/*
+ * hal_gpio_posix.h - GPIO HAL backend for the host (POSIX) build
+ *
+ * Native implementation selected with HAL=posix (BOARD=host). Pins live
+ * in an in-memory register file modelled on the STM32 GPIO block
+ * (per-port output mask, ODR and IDR), so the drivers and application
+ * run unchanged off-target for benchmarking and CI.
+ *
+ * Operations are static inline so HAL_STATIC_BINDING can fold them
+ * into the caller, exactly as the target backends do.
+ *
+ * Edge interrupts are modelled like EXTI: a level change on an input
+ * whose line is armed for that edge sets the line's pending bit, and an
+ * "ISR" thread services the pending lines, timestamping on wake-up and
+ * reading the level afterwards. Edges on a line that is still pending
+ * merge into one interrupt, so a train that outruns the ISR loses edges
+ * just as it would on the target.
+ */
+
+#ifndef HAL_GPIO_POSIX_H
+#define HAL_GPIO_POSIX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_gpio.h"
+
+/* One simulated port per encodable port index (see gpio_pin_t) */
+#define POSIX_GPIO_PORT_COUNT   GPIO_PORT_COUNT
+
+typedef struct {
+    uint16_t output_mask;   /* Pins configured as outputs */
+    uint16_t odr;           /* Output data register */
+    uint16_t idr;           /* Externally driven input levels */
+} posix_gpio_port_t;
+
+extern posix_gpio_port_t posix_gpio_ports[POSIX_GPIO_PORT_COUNT];
+
+/* HAL instance selected by gpio_hal_init() */
+extern const gpio_hal_t posix_gpio_hal;
+
+static inline void posix_gpio_init(gpio_pin_t pin, gpio_mode_t mode, gpio_output_type_t otype,
+                                   gpio_pull_t pull, gpio_speed_t speed)
+{
+    posix_gpio_port_t *port = &posix_gpio_ports[GPIO_PIN_PORT(pin)];
+    uint16_t mask = GPIO_PIN_MASK(pin);
+
+    if (mode == GPIO_MODE_OUTPUT) {
+        port->output_mask |= mask;
+    } else {
+        port->output_mask &= (uint16_t)~mask;
+    }
+
+    /* Pull resistors set the idle level of an undriven input */
+    if (pull == GPIO_PULL_UP) {
+        port->idr |= mask;
+    } else if (pull == GPIO_PULL_DOWN) {
+        port->idr &= (uint16_t)~mask;
+    }
+    (void)otype; (void)speed;
+}
+
+static inline void posix_gpio_write(gpio_pin_t pin, bool value)
+{
+    posix_gpio_port_t *port = &posix_gpio_ports[GPIO_PIN_PORT(pin)];
+
+    if (value) {
+        port->odr |= GPIO_PIN_MASK(pin);
+    } else {
+        port->odr &= (uint16_t)~GPIO_PIN_MASK(pin);
+    }
+}
+
+static inline bool posix_gpio_read(gpio_pin_t pin)
+{
+    const posix_gpio_port_t *port = &posix_gpio_ports[GPIO_PIN_PORT(pin)];
+    uint16_t mask = GPIO_PIN_MASK(pin);
+
+    /* Outputs read back their driven level, inputs the external level */
+    if ((port->output_mask & mask) != 0U) {
+        return (port->odr & mask) != 0U;
+    }
+    return (port->idr & mask) != 0U;
+}
+
+static inline void posix_gpio_toggle(gpio_pin_t pin)
+{
+    posix_gpio_ports[GPIO_PIN_PORT(pin)].odr ^= GPIO_PIN_MASK(pin);
+}
+
+static inline void posix_gpio_port_set_clear(gpio_port_t port, uint16_t set_mask, uint16_t clear_mask)
+{
+    posix_gpio_port_t *p = &posix_gpio_ports[port & 0x0FU];
+
+    /* Same precedence as BSRR: set wins over clear */
+    p->odr = (uint16_t)((p->odr & ~clear_mask) | set_mask);
+}
+
+static inline uint16_t posix_gpio_port_read(gpio_port_t port)
+{
+    const posix_gpio_port_t *p = &posix_gpio_ports[port & 0x0FU];
+
+    return (uint16_t)((p->odr & p->output_mask) | (p->idr & ~p->output_mask));
+}
+
+error_t posix_gpio_irq_configure(gpio_pin_t pin, gpio_edge_t edge);
+
+/* ===== Host Harness Hooks ===== */
+
+/* Drive the external level seen by an input pin (raises the armed edge
+ * interrupt if the level changes) */
+void posix_gpio_set_input(gpio_pin_t pin, bool level);
+
+/* Edge train: toggle the input count times, the i-th toggle
+ * intervals_us[i] after the previous one (the first after the call).
+ * Blocks until done. If edge_times_us is not NULL it receives the
+ * bsp_time_us() of each toggle, for latency measurements. */
+void posix_gpio_inject_edges(gpio_pin_t pin, const uint32_t *intervals_us, uint32_t count,
+                             uint64_t *edge_times_us);
+
+/* Raw output register of a simulated port (for inspection) */
+uint16_t posix_gpio_get_port_output(uint32_t port);
+
+#endif /* HAL_GPIO_POSIX_H */
@@ -0,0 +1,166 @@
+/*
+ * hal_gpio_stm32.h - STM32 GPIO backend (Stub - Ready for STM32 HAL integration)
+ *
+ * Backend operations are static inline so they can be used both by the
+ * function-pointer table in hal_gpio.c and, with HAL_STATIC_BINDING,
+ * directly by the GPIO API in hal_gpio.h.
+ * Replace the TODO sections with actual STM32 HAL calls.
+ *
+ * Edge interrupts are programmed at register level (SYSCFG line mux,
+ * EXTI edge and mask registers, NVIC): the EXTIx_IRQHandlers in
+ * hal_gpio.c must read the clock before anything else runs, which
+ * HAL_GPIO_EXTI_IRQHandler() does not allow.
+ */
+
+#ifndef HAL_GPIO_STM32_H
+#define HAL_GPIO_STM32_H
+
+#include "hal_gpio.h"
+
+/* ===== STM32F4 RCC, GPIO and EXTI Registers ===== */
+#define STM32_RCC_APB2ENR           (*(volatile uint32_t *)0x40023844UL)
+#define STM32_RCC_APB2ENR_SYSCFGEN  (1UL << 14)
+#define STM32_SYSCFG_EXTICR(n)      (*(volatile uint32_t *)(0x40013808UL + 4UL * (n)))
+#define STM32_EXTI_IMR              (*(volatile uint32_t *)0x40013C00UL)
+#define STM32_EXTI_RTSR             (*(volatile uint32_t *)0x40013C08UL)
+#define STM32_EXTI_FTSR             (*(volatile uint32_t *)0x40013C0CUL)
+#define STM32_EXTI_PR               (*(volatile uint32_t *)0x40013C14UL)
+#define STM32_NVIC_ISER(n)          (*(volatile uint32_t *)(0xE000E100UL + 4UL * (n)))
+#define STM32_RCC_AHB1ENR           (*(volatile uint32_t *)0x40023830UL)
+#define STM32_GPIO_MODER(port)      (*(volatile uint32_t *)(0x40020000UL + 0x400UL * (port)))
+#define STM32_GPIO_OSPEEDR(port)    (*(volatile uint32_t *)(0x40020008UL + 0x400UL * (port)))
+#define STM32_GPIO_PUPDR(port)      (*(volatile uint32_t *)(0x4002000CUL + 0x400UL * (port)))
+#define STM32_GPIO_IDR(port)        (*(volatile uint32_t *)(0x40020010UL + 0x400UL * (port)))
+#define STM32_GPIO_ODR(port)        (*(volatile uint32_t *)(0x40020014UL + 0x400UL * (port)))
+#define STM32_GPIO_BSRR(port)       (*(volatile uint32_t *)(0x40020018UL + 0x400UL * (port)))
+#define STM32_GPIO_AFR(port, n)     (*(volatile uint32_t *)(0x40020020UL + 0x400UL * (port) + 4UL * (n)))
+
+/* EXTI lines routed to a UART RX pin for Stop wake-up (hal_uart_stm32.h);
+ * the EXTI handlers report these as POWER_WAKE_UART, not as GPIO edges */
+extern volatile uint32_t stm32_exti_uart_wake_lines;
+
+/* EXTI0..4 have their own IRQs (6..10), lines 5..9 share 23, 10..15 share 40 */
+#define STM32_EXTI_IRQ(line)        ((line) < 5U ? 6U + (line) : (line) < 10U ? 23U : 40U)
+
+static inline void stm32_gpio_init(gpio_pin_t pin, gpio_mode_t mode, gpio_output_type_t otype,
+                                   gpio_pull_t pull, gpio_speed_t speed)
+{
+    /* TODO: Implement STM32 HAL GPIO initialization
+     * Example (for reference):
+     *
+     * GPIO_InitTypeDef GPIO_InitStruct = {0};
+     * GPIO_InitStruct.Pin = GPIO_PIN_MASK(pin);
+     * GPIO_InitStruct.Mode = (mode == GPIO_MODE_INPUT ? GPIO_MODE_INPUT :
+     *                         mode == GPIO_MODE_OUTPUT ? GPIO_MODE_OUTPUT :
+     *                         GPIO_MODE_AF);
+     * GPIO_InitStruct.Pull = (pull == GPIO_PULL_UP ? GPIO_PULLUP :
+     *                         pull == GPIO_PULL_DOWN ? GPIO_PULLDOWN : GPIO_NOPULL);
+     * GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+     * HAL_GPIO_Init(port_base[GPIO_PIN_PORT(pin)], &GPIO_InitStruct);
+     */
+    (void)pin; (void)mode; (void)otype; (void)pull; (void)speed;
+}
+
+static inline void stm32_gpio_write(gpio_pin_t pin, bool value)
+{
+#if !defined(BOARD_HOST)
+    uint32_t bit = GPIO_PIN_MASK(pin);
+
+    /* One store, no read-modify-write: statically bound this is a
+     * single STR */
+    STM32_GPIO_BSRR(GPIO_PIN_PORT(pin)) = value ? bit : bit << 16;
+#else
+    (void)pin; (void)value;
+#endif
+}
+
+static inline bool stm32_gpio_read(gpio_pin_t pin)
+{
+#if !defined(BOARD_HOST)
+    return (STM32_GPIO_IDR(GPIO_PIN_PORT(pin)) & GPIO_PIN_MASK(pin)) != 0U;
+#else
+    (void)pin;
+    return false;
+#endif
+}
+
+static inline void stm32_gpio_toggle(gpio_pin_t pin)
+{
+#if !defined(BOARD_HOST)
+    uint32_t port = GPIO_PIN_PORT(pin);
+    uint32_t bit = GPIO_PIN_MASK(pin);
+
+    /* Through BSRR rather than ODR ^=, so an interrupt writing another
+     * pin of the port between the read and the store is not undone */
+    STM32_GPIO_BSRR(port) = ((STM32_GPIO_ODR(port) & bit) != 0U) ? bit << 16 : bit;
+#else
+    (void)pin;
+#endif
+}
+
+static inline void stm32_gpio_port_set_clear(gpio_port_t port, uint16_t set_mask, uint16_t clear_mask)
+{
+#if !defined(BOARD_HOST)
+    /* One store updates all 16 pins at once; a pin in both masks ends
+     * up set, as BSRR gives the set half priority */
+    STM32_GPIO_BSRR(port) = ((uint32_t)clear_mask << 16) | set_mask;
+#else
+    (void)port; (void)set_mask; (void)clear_mask;
+#endif
+}
+
+static inline uint16_t stm32_gpio_port_read(gpio_port_t port)
+{
+#if !defined(BOARD_HOST)
+    return (uint16_t)STM32_GPIO_IDR(port);
+#else
+    (void)port;
+    return 0;
+#endif
+}
+
+static inline error_t stm32_gpio_irq_configure(gpio_pin_t pin, gpio_edge_t edge)
+{
+#if !defined(BOARD_HOST)
+    uint32_t line = GPIO_PIN_NUMBER(pin);
+    uint32_t bit = 1UL << line;
+    uint32_t shift = (line & 3U) * 4U;
+    uint32_t irq = STM32_EXTI_IRQ(line);
+
+    /* Pin n of every port shares line n; one armed as a UART RX wake-up
+     * stays with the UART, as stm32_uart_set_rx_wake() does for GPIO */
+    if ((stm32_exti_uart_wake_lines & bit) != 0U) {
+        return ERR_BUSY;
+    }
+
+    STM32_EXTI_IMR &= ~bit;
+    if (edge == GPIO_EDGE_NONE) {
+        STM32_EXTI_PR = bit;
+        return ERR_OK;
+    }
+
+    STM32_RCC_APB2ENR |= STM32_RCC_APB2ENR_SYSCFGEN;
+    STM32_SYSCFG_EXTICR(line >> 2) = (STM32_SYSCFG_EXTICR(line >> 2) & ~(0xFUL << shift)) |
+                                     ((uint32_t)GPIO_PIN_PORT(pin) << shift);
+    if (edge == GPIO_EDGE_RISING || edge == GPIO_EDGE_BOTH) {
+        STM32_EXTI_RTSR |= bit;
+    } else {
+        STM32_EXTI_RTSR &= ~bit;
+    }
+    if (edge == GPIO_EDGE_FALLING || edge == GPIO_EDGE_BOTH) {
+        STM32_EXTI_FTSR |= bit;
+    } else {
+        STM32_EXTI_FTSR &= ~bit;
+    }
+
+    /* Drop anything latched while the line was being rerouted */
+    STM32_EXTI_PR = bit;
+    STM32_EXTI_IMR |= bit;
+    STM32_NVIC_ISER(irq >> 5) = 1UL << (irq & 31U);
+#else
+    (void)pin; (void)edge;
+#endif
+    return ERR_OK;
+}
+
+#endif /* HAL_GPIO_STM32_H */
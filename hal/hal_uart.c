@@ -1,85 +1,45 @@
 /*
  * hal_uart.c - UART HAL Implementation (Stub - Ready for STM32 HAL integration)
+ *
+ * With HAL_STATIC_BINDING the UART API is resolved at compile time in
+ * hal_uart.h and this file compiles to nothing.
  */
 
 #include "hal_uart.h"
 #include "../bsp/board_config.h"
+#include "../bsp/bsp_clock.h"
+#include "../common/hot_path.h"
 
-static uart_hal_t *uart_hal = NULL;
-
-/* ===== STM32 HAL Stub Functions ===== */
-
-static error_t stm32_uart_init(uart_id_t uart_id, const uart_config_t *config)
-{
-    /* TODO: Implement STM32 HAL UART initialization
-     * 1. Configure GPIO pins (TX, RX)
-     * 2. Setup UART handle
-     * 3. Initialize with config parameters
-     */
-    (void)uart_id; (void)config;
-    return ERR_OK;
-}
-
-static error_t stm32_uart_deinit(uart_id_t uart_id)
-{
-    /* TODO: HAL_UART_DeInit() */
-    (void)uart_id;
-    return ERR_OK;
-}
-
-static error_t stm32_uart_transmit(uart_id_t uart_id, const uint8_t *data, uint16_t length)
-{
-    /* TODO: HAL_UART_Transmit() */
-    (void)uart_id; (void)data; (void)length;
-    return ERR_OK;
-}
+#ifndef HAL_STATIC_BINDING
 
-static error_t stm32_uart_receive(uart_id_t uart_id, uint8_t *data, uint16_t length)
-{
-    /* TODO: HAL_UART_Receive() */
-    (void)uart_id; (void)data; (void)length;
-    return ERR_OK;
-}
-
-static error_t stm32_uart_transmit_it(uart_id_t uart_id, const uint8_t *data, uint16_t length)
-{
-    /* TODO: HAL_UART_Transmit_IT() */
-    (void)uart_id; (void)data; (void)length;
-    return ERR_OK;
-}
-
-static error_t stm32_uart_receive_it(uart_id_t uart_id, uint8_t *data, uint16_t length)
-{
-    /* TODO: HAL_UART_Receive_IT() */
-    (void)uart_id; (void)data; (void)length;
-    return ERR_OK;
-}
+#ifdef USE_POSIX_HAL
+#include "hal_uart_posix.h"
+#else
+#include "hal_uart_stm32.h"
+#endif
 
-static bool stm32_uart_is_tx_complete(uart_id_t uart_id)
-{
-    /* TODO: Check UART status */
-    (void)uart_id;
-    return true;
-}
+static uart_hal_t *uart_hal = NULL;
 
-static bool stm32_uart_is_rx_available(uart_id_t uart_id)
-{
-    /* TODO: Check if data is available */
-    (void)uart_id;
-    return false;
-}
+#ifndef USE_POSIX_HAL
 
-static const uart_hal_t stm32_uart_hal = {
+static const uart_hal_t stm32_uart_hal HOT_DATA = {
     .init = stm32_uart_init,
     .deinit = stm32_uart_deinit,
+    .set_timing = stm32_uart_set_timing,
     .transmit = stm32_uart_transmit,
     .receive = stm32_uart_receive,
     .transmit_it = stm32_uart_transmit_it,
     .receive_it = stm32_uart_receive_it,
+    .transmit_dma = NULL,                   /* Driver falls back to transmit_it */
+    .receive_dma = NULL,                    /* No RX streams yet */
+    .abort_receive = NULL,
     .is_tx_complete = stm32_uart_is_tx_complete,
-    .is_rx_available = stm32_uart_is_rx_available
+    .is_rx_available = stm32_uart_is_rx_available,
+    .set_rx_wake = stm32_uart_set_rx_wake
 };
 
+#endif /* !USE_POSIX_HAL */
+
 /* ===== HAL Abstraction API ===== */
 
 void uart_hal_init(void)
@@ -90,17 +50,31 @@ void uart_hal_init(void)
     /* uart_hal = &stm32_ll_uart_hal; */
 #elif defined(USE_OPENCM3)
     /* uart_hal = &opencm3_uart_hal; */
+#elif defined(USE_POSIX_HAL)
+    uart_hal = (uart_hal_t *)&posix_uart_hal;
 #else
     uart_hal = (uart_hal_t *)&stm32_uart_hal;
 #endif
 }
 
-error_t uart_configure(uart_id_t uart_id, const uart_config_t *config)
+error_t uart_configure(uart_id_t uart_id, const uart_config_t *config,
+                       uart_baud_timing_t *timing)
 {
+    uart_baud_timing_t local;
+    uart_baud_timing_t *t = (timing != NULL) ? timing : &local;
+    error_t err;
+
     if (uart_hal == NULL || uart_hal->init == NULL) {
         return ERR_NOT_INITIALIZED;
     }
-    return uart_hal->init(uart_id, config);
+    if (config == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    err = uart_compute_baud(uart_id, config->baud_rate, t);
+    if (err != ERR_OK) {
+        return err;
+    }
+    return uart_hal->init(uart_id, config, t);
 }
 
 error_t uart_deinit(uart_id_t uart_id)
@@ -111,23 +85,36 @@ error_t uart_deinit(uart_id_t uart_id)
     return uart_hal->deinit(uart_id);
 }
 
-error_t uart_transmit(uart_id_t uart_id, const uint8_t *data, uint16_t length)
+error_t uart_set_timing(uart_id_t uart_id, const uart_baud_timing_t *timing)
+{
+    if (uart_hal == NULL || uart_hal->set_timing == NULL) {
+        return ERR_NOT_INITIALIZED;
+    }
+    if (timing == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    return uart_hal->set_timing(uart_id, timing);
+}
+
+error_t uart_transmit(uart_id_t uart_id, const uint8_t *data, uint16_t length,
+                      uint32_t timeout_ms)
 {
     if (uart_hal == NULL || uart_hal->transmit == NULL) {
         return ERR_NOT_INITIALIZED;
     }
-    return uart_hal->transmit(uart_id, data, length);
+    return uart_hal->transmit(uart_id, data, length, timeout_ms);
 }
 
-error_t uart_receive(uart_id_t uart_id, uint8_t *data, uint16_t length)
+error_t uart_receive(uart_id_t uart_id, uint8_t *data, uint16_t length,
+                     uint32_t timeout_ms)
 {
     if (uart_hal == NULL || uart_hal->receive == NULL) {
         return ERR_NOT_INITIALIZED;
     }
-    return uart_hal->receive(uart_id, data, length);
+    return uart_hal->receive(uart_id, data, length, timeout_ms);
 }
 
-error_t uart_transmit_it(uart_id_t uart_id, const uint8_t *data, uint16_t length)
+HOT_FUNC error_t uart_transmit_it(uart_id_t uart_id, const uint8_t *data, uint16_t length)
 {
     if (uart_hal == NULL || uart_hal->transmit_it == NULL) {
         return ERR_NOT_INITIALIZED;
@@ -135,7 +122,7 @@ error_t uart_transmit_it(uart_id_t uart_id, const uint8_t *data, uint16_t length
     return uart_hal->transmit_it(uart_id, data, length);
 }
 
-error_t uart_receive_it(uart_id_t uart_id, uint8_t *data, uint16_t length)
+HOT_FUNC error_t uart_receive_it(uart_id_t uart_id, uint8_t *data, uint16_t length)
 {
     if (uart_hal == NULL || uart_hal->receive_it == NULL) {
         return ERR_NOT_INITIALIZED;
@@ -143,6 +130,30 @@ error_t uart_receive_it(uart_id_t uart_id, uint8_t *data, uint16_t length)
     return uart_hal->receive_it(uart_id, data, length);
 }
 
+HOT_FUNC error_t uart_transmit_dma(uart_id_t uart_id, const uint8_t *data, uint16_t length)
+{
+    if (uart_hal == NULL || uart_hal->transmit_dma == NULL) {
+        return ERR_NOT_INITIALIZED;
+    }
+    return uart_hal->transmit_dma(uart_id, data, length);
+}
+
+error_t uart_receive_dma(uart_id_t uart_id, uint8_t *buffer, uint16_t length)
+{
+    if (uart_hal == NULL || uart_hal->receive_dma == NULL) {
+        return ERR_NOT_INITIALIZED;
+    }
+    return uart_hal->receive_dma(uart_id, buffer, length);
+}
+
+error_t uart_abort_receive(uart_id_t uart_id)
+{
+    if (uart_hal == NULL || uart_hal->abort_receive == NULL) {
+        return ERR_NOT_INITIALIZED;
+    }
+    return uart_hal->abort_receive(uart_id);
+}
+
 bool uart_is_tx_complete(uart_id_t uart_id)
 {
     if (uart_hal == NULL || uart_hal->is_tx_complete == NULL) {
@@ -158,3 +169,115 @@ bool uart_is_rx_available(uart_id_t uart_id)
     }
     return uart_hal->is_rx_available(uart_id);
 }
+
+error_t uart_set_rx_wake(uart_id_t uart_id, bool enable)
+{
+    if (uart_hal == NULL || uart_hal->set_rx_wake == NULL) {
+        return ERR_NOT_INITIALIZED;
+    }
+    return uart_hal->set_rx_wake(uart_id, enable);
+}
+
+#endif /* !HAL_STATIC_BINDING */
+
+/* ===== Baud Rate Generator ===== */
+
+/* STM32F4: USART1/USART6 sit on APB2, the others on APB1 */
+static uint32_t uart_get_pclk(uart_id_t uart_id, const clock_config_t *clocks)
+{
+    if (uart_id == UART_1 || uart_id == UART_6) {
+        return clocks->apb2_clock_hz;
+    }
+    return clocks->apb1_clock_hz;
+}
+
+error_t uart_compute_baud(uart_id_t uart_id, uint32_t baud_rate, uart_baud_timing_t *timing)
+{
+    clock_config_t clocks;
+
+    (void)bsp_clock_get_config(&clocks);
+    return uart_compute_baud_for_clock(uart_id, baud_rate, &clocks, timing);
+}
+
+error_t uart_compute_baud_for_clock(uart_id_t uart_id, uint32_t baud_rate,
+                                    const clock_config_t *clocks, uart_baud_timing_t *timing)
+{
+    uint32_t pclk;
+    uint32_t divisor;
+    int64_t error;
+
+    if (uart_id >= UART_COUNT || baud_rate == 0 || clocks == NULL || timing == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+
+    /* divisor = 16 * USARTDIV (OVER8=0) or 8 * USARTDIV (OVER8=1);
+     * either way the generated rate is pclk / divisor */
+    pclk = uart_get_pclk(uart_id, clocks);
+    divisor = (uint32_t)(((uint64_t)pclk + (baud_rate / 2U)) / baud_rate);
+    if (divisor < 8U || divisor > 0xFFFFU) {
+        return ERR_INVALID_PARAM;
+    }
+
+    timing->pclk_hz = pclk;
+    timing->divisor = divisor;
+    timing->oversampling_8 = (divisor < 16U);
+    if (timing->oversampling_8) {
+        /* Fraction is 3 bits, BRR[3] must stay clear */
+        timing->brr = (uint16_t)(((divisor >> 3) << 4) | (divisor & 0x7U));
+    } else {
+        timing->brr = (uint16_t)divisor;
+    }
+    timing->actual_baud = (pclk + (divisor / 2U)) / divisor;
+
+    error = ((int64_t)timing->actual_baud - (int64_t)baud_rate) * 1000000 / (int64_t)baud_rate;
+    timing->error_ppm = (int32_t)error;
+    if (error > UART_BAUD_MAX_ERROR_PPM || error < -UART_BAUD_MAX_ERROR_PPM) {
+        return ERR_INVALID_PARAM;
+    }
+    return ERR_OK;
+}
+
+/* ===== Interrupt Completion Callbacks ===== */
+
+static uart_callback_t uart_tx_callbacks[UART_COUNT];
+static uart_callback_t uart_rx_callbacks[UART_COUNT];
+static uart_rx_event_callback_t uart_rx_event_callbacks[UART_COUNT];
+
+void uart_hal_register_callbacks(uart_id_t uart_id, uart_callback_t tx_complete,
+                                 uart_callback_t rx_complete)
+{
+    if (uart_id >= UART_COUNT) {
+        return;
+    }
+    uart_tx_callbacks[uart_id] = tx_complete;
+    uart_rx_callbacks[uart_id] = rx_complete;
+}
+
+HOT_FUNC void uart_hal_tx_complete_isr(uart_id_t uart_id)
+{
+    if (uart_id < UART_COUNT && uart_tx_callbacks[uart_id] != NULL) {
+        uart_tx_callbacks[uart_id](uart_id);
+    }
+}
+
+HOT_FUNC void uart_hal_rx_complete_isr(uart_id_t uart_id)
+{
+    if (uart_id < UART_COUNT && uart_rx_callbacks[uart_id] != NULL) {
+        uart_rx_callbacks[uart_id](uart_id);
+    }
+}
+
+void uart_hal_register_rx_event_callback(uart_id_t uart_id, uart_rx_event_callback_t on_event)
+{
+    if (uart_id >= UART_COUNT) {
+        return;
+    }
+    uart_rx_event_callbacks[uart_id] = on_event;
+}
+
+HOT_FUNC void uart_hal_rx_event_isr(uart_id_t uart_id, uart_rx_event_t event, uint16_t position)
+{
+    if (uart_id < UART_COUNT && uart_rx_event_callbacks[uart_id] != NULL) {
+        uart_rx_event_callbacks[uart_id](uart_id, event, position);
+    }
+}
@@ -2,14 +2,18 @@
  * hal_uart.h - UART Hardware Abstraction Layer (HAL)
  *
  * Portable UART interface for different HAL implementations.
+ * Dispatch is through uart_hal_t unless HAL_STATIC_BINDING is defined,
+ * in which case calls resolve to the selected backend at compile time.
  */
 
 #ifndef HAL_UART_H
 #define HAL_UART_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include "../common/error.h"
+#include "../bsp/bsp_clock.h"
 
 /* UART Peripheral IDs */
 typedef enum {
@@ -18,16 +22,31 @@ typedef enum {
     UART_3,
     UART_4,
     UART_5,
-    UART_6
+    UART_6,
+    UART_COUNT
 } uart_id_t;
 
-/* UART Baud Rates */
-typedef enum {
-    UART_BAUD_9600 = 9600,
-    UART_BAUD_19200 = 19200,
-    UART_BAUD_38400 = 38400,
-    UART_BAUD_115200 = 115200
-} uart_baud_t;
+/* UART Baud Rate
+ * Any integer rate the port's peripheral clock can generate (see
+ * uart_compute_baud()); the common rates are provided for convenience.
+ */
+typedef uint32_t uart_baud_t;
+
+#define UART_BAUD_9600          9600U
+#define UART_BAUD_19200         19200U
+#define UART_BAUD_38400         38400U
+#define UART_BAUD_115200        115200U
+#define UART_BAUD_921600        921600U
+#define UART_BAUD_1000000       1000000U
+#define UART_BAUD_2000000       2000000U
+#define UART_BAUD_3000000       3000000U
+#define UART_BAUD_6000000       6000000U
+
+/* Blocking transfers: wait without limit */
+#define UART_TIMEOUT_INFINITE   0xFFFFFFFFU
+
+/* Largest accepted deviation of the generated rate (ppm, 20000 = 2 %) */
+#define UART_BAUD_MAX_ERROR_PPM 20000
 
 /* UART Data Bits */
 typedef enum {
@@ -57,27 +76,218 @@ typedef struct {
     uart_parity_t parity;
 } uart_config_t;
 
+/* Baud Rate Generator Setting
+ * Result of fitting a requested rate to the peripheral clock:
+ * rate = pclk / divisor, with 16x oversampling when divisor >= 16 and
+ * 8x oversampling (OVER8) for the fastest rates.
+ */
+typedef struct {
+    uint32_t pclk_hz;           /* APB clock feeding this UART */
+    uint32_t divisor;           /* pclk / rate, in 1/16 (or 1/8) bit units */
+    bool oversampling_8;        /* OVER8 required */
+    uint16_t brr;               /* Register value for USART_BRR */
+    uint32_t actual_baud;       /* Rate really generated */
+    int32_t error_ppm;          /* (actual - requested) / requested */
+} uart_baud_timing_t;
+
+/* Circular DMA reception events */
+typedef enum {
+    UART_RX_EVENT_HALF = 0,     /* DMA half-transfer: first half filled */
+    UART_RX_EVENT_FULL,         /* DMA transfer-complete: buffer wrapped */
+    UART_RX_EVENT_IDLE          /* Line went idle mid-buffer */
+} uart_rx_event_t;
+
+/* Transfer completion callback, invoked from UART interrupt context */
+typedef void (*uart_callback_t)(uart_id_t uart_id);
+
+/* Circular reception callback, invoked from UART/DMA interrupt context.
+ * position is the DMA write offset (0..length of the circular buffer;
+ * length means the buffer has just wrapped).
+ */
+typedef void (*uart_rx_event_callback_t)(uart_id_t uart_id, uart_rx_event_t event,
+                                         uint16_t position);
+
 /* UART HAL Function Pointers */
 typedef struct {
-    error_t (*init)(uart_id_t uart_id, const uart_config_t *config);
+    error_t (*init)(uart_id_t uart_id, const uart_config_t *config,
+                    const uart_baud_timing_t *timing);
     error_t (*deinit)(uart_id_t uart_id);
-    error_t (*transmit)(uart_id_t uart_id, const uint8_t *data, uint16_t length);
-    error_t (*receive)(uart_id_t uart_id, uint8_t *data, uint16_t length);
+    error_t (*set_timing)(uart_id_t uart_id, const uart_baud_timing_t *timing);
+    error_t (*transmit)(uart_id_t uart_id, const uint8_t *data, uint16_t length,
+                        uint32_t timeout_ms);
+    error_t (*receive)(uart_id_t uart_id, uint8_t *data, uint16_t length,
+                       uint32_t timeout_ms);
     error_t (*transmit_it)(uart_id_t uart_id, const uint8_t *data, uint16_t length);
     error_t (*receive_it)(uart_id_t uart_id, uint8_t *data, uint16_t length);
+    error_t (*transmit_dma)(uart_id_t uart_id, const uint8_t *data, uint16_t length);
+    error_t (*receive_dma)(uart_id_t uart_id, uint8_t *buffer, uint16_t length);
+    error_t (*abort_receive)(uart_id_t uart_id);
     bool (*is_tx_complete)(uart_id_t uart_id);
     bool (*is_rx_available)(uart_id_t uart_id);
+    error_t (*set_rx_wake)(uart_id_t uart_id, bool enable);
 } uart_hal_t;
 
+/* Fit baud_rate to the UART's current peripheral clock (APB1/APB2 from
+ * bsp_clock). Fails with ERR_INVALID_PARAM if the rate is out of range
+ * or off by more than UART_BAUD_MAX_ERROR_PPM; a rejected rate still
+ * reports the closest setting in *timing.
+ */
+error_t uart_compute_baud(uart_id_t uart_id, uint32_t baud_rate, uart_baud_timing_t *timing);
+
+/* As uart_compute_baud(), for the bus clocks in clocks (e.g. a clock
+ * profile about to be selected) */
+error_t uart_compute_baud_for_clock(uart_id_t uart_id, uint32_t baud_rate,
+                                    const clock_config_t *clocks, uart_baud_timing_t *timing);
+
+#ifdef HAL_STATIC_BINDING
+
+/* ===== Static Binding ===== */
+#if defined(USE_POSIX_HAL)
+#include "hal_uart_posix.h"
+#define UART_HAL_OP(op)     posix_uart_##op
+#elif defined(USE_STM32_LL) || defined(USE_OPENCM3)
+#error "HAL_STATIC_BINDING: no static UART backend for the selected HAL yet"
+#else
+#include "hal_uart_stm32.h"
+#define UART_HAL_OP(op)     stm32_uart_##op
+#endif
+
+static inline void uart_hal_init(void)
+{
+}
+
+static inline error_t uart_configure(uart_id_t uart_id, const uart_config_t *config,
+                                     uart_baud_timing_t *timing)
+{
+    uart_baud_timing_t local;
+    uart_baud_timing_t *t = (timing != NULL) ? timing : &local;
+    error_t err;
+
+    if (config == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    err = uart_compute_baud(uart_id, config->baud_rate, t);
+    if (err != ERR_OK) {
+        return err;
+    }
+    return UART_HAL_OP(init)(uart_id, config, t);
+}
+
+static inline error_t uart_deinit(uart_id_t uart_id)
+{
+    return UART_HAL_OP(deinit)(uart_id);
+}
+
+static inline error_t uart_set_timing(uart_id_t uart_id, const uart_baud_timing_t *timing)
+{
+    if (timing == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    return UART_HAL_OP(set_timing)(uart_id, timing);
+}
+
+static inline error_t uart_transmit(uart_id_t uart_id, const uint8_t *data, uint16_t length,
+                                    uint32_t timeout_ms)
+{
+    return UART_HAL_OP(transmit)(uart_id, data, length, timeout_ms);
+}
+
+static inline error_t uart_receive(uart_id_t uart_id, uint8_t *data, uint16_t length,
+                                   uint32_t timeout_ms)
+{
+    return UART_HAL_OP(receive)(uart_id, data, length, timeout_ms);
+}
+
+static inline error_t uart_transmit_it(uart_id_t uart_id, const uint8_t *data, uint16_t length)
+{
+    return UART_HAL_OP(transmit_it)(uart_id, data, length);
+}
+
+static inline error_t uart_receive_it(uart_id_t uart_id, uint8_t *data, uint16_t length)
+{
+    return UART_HAL_OP(receive_it)(uart_id, data, length);
+}
+
+static inline error_t uart_transmit_dma(uart_id_t uart_id, const uint8_t *data, uint16_t length)
+{
+    return UART_HAL_OP(transmit_dma)(uart_id, data, length);
+}
+
+static inline error_t uart_receive_dma(uart_id_t uart_id, uint8_t *buffer, uint16_t length)
+{
+    return UART_HAL_OP(receive_dma)(uart_id, buffer, length);
+}
+
+static inline error_t uart_abort_receive(uart_id_t uart_id)
+{
+    return UART_HAL_OP(abort_receive)(uart_id);
+}
+
+static inline bool uart_is_tx_complete(uart_id_t uart_id)
+{
+    return UART_HAL_OP(is_tx_complete)(uart_id);
+}
+
+static inline bool uart_is_rx_available(uart_id_t uart_id)
+{
+    return UART_HAL_OP(is_rx_available)(uart_id);
+}
+
+static inline error_t uart_set_rx_wake(uart_id_t uart_id, bool enable)
+{
+    return UART_HAL_OP(set_rx_wake)(uart_id, enable);
+}
+
+#else
+
 /* UART HAL API */
 void uart_hal_init(void);
-error_t uart_configure(uart_id_t uart_id, const uart_config_t *config);
+error_t uart_configure(uart_id_t uart_id, const uart_config_t *config,
+                       uart_baud_timing_t *timing);
 error_t uart_deinit(uart_id_t uart_id);
-error_t uart_transmit(uart_id_t uart_id, const uint8_t *data, uint16_t length);
-error_t uart_receive(uart_id_t uart_id, uint8_t *data, uint16_t length);
+
+/* Reprogram the rate of an open port (after a bus clock change) without
+ * resetting it or its transfers */
+error_t uart_set_timing(uart_id_t uart_id, const uart_baud_timing_t *timing);
+
+/* Blocking transfers: ERR_TIMEOUT if not done within timeout_ms
+ * (UART_TIMEOUT_INFINITE to wait forever) */
+error_t uart_transmit(uart_id_t uart_id, const uint8_t *data, uint16_t length,
+                      uint32_t timeout_ms);
+error_t uart_receive(uart_id_t uart_id, uint8_t *data, uint16_t length,
+                     uint32_t timeout_ms);
 error_t uart_transmit_it(uart_id_t uart_id, const uint8_t *data, uint16_t length);
 error_t uart_receive_it(uart_id_t uart_id, uint8_t *data, uint16_t length);
+error_t uart_transmit_dma(uart_id_t uart_id, const uint8_t *data, uint16_t length);
+error_t uart_receive_dma(uart_id_t uart_id, uint8_t *buffer, uint16_t length);
+error_t uart_abort_receive(uart_id_t uart_id);
 bool uart_is_tx_complete(uart_id_t uart_id);
 bool uart_is_rx_available(uart_id_t uart_id);
 
+/* Let a start bit on the RX pin wake the core from Stop, where the
+ * USART itself is unclocked; the wake-up is reported through
+ * bsp_power_wake(POWER_WAKE_UART). The character that woke the core is
+ * lost on target: the USART only runs again once the clocks are back. */
+error_t uart_set_rx_wake(uart_id_t uart_id, bool enable);
+
+#endif /* HAL_STATIC_BINDING */
+
+/* Interrupt/DMA transfer completion (transmit_it, transmit_dma, receive_it)
+ * The driver registers per-port callbacks; the backend ISR reports each
+ * finished transfer through uart_hal_tx_complete_isr() (TX interrupt or
+ * DMA transfer-complete) / uart_hal_rx_complete_isr().
+ */
+void uart_hal_register_callbacks(uart_id_t uart_id, uart_callback_t tx_complete,
+                                 uart_callback_t rx_complete);
+void uart_hal_tx_complete_isr(uart_id_t uart_id);
+void uart_hal_rx_complete_isr(uart_id_t uart_id);
+
+/* Circular DMA reception (receive_dma)
+ * The DMA stream runs continuously over the buffer; the backend reports
+ * half-transfer, transfer-complete and idle-line interrupts through
+ * uart_hal_rx_event_isr() until abort_receive() stops it.
+ */
+void uart_hal_register_rx_event_callback(uart_id_t uart_id, uart_rx_event_callback_t on_event);
+void uart_hal_rx_event_isr(uart_id_t uart_id, uart_rx_event_t event, uint16_t position);
+
 #endif /* HAL_UART_H */
@@ -0,0 +1,563 @@
+/*
+ * hal_uart_posix.c - UART HAL Implementation for the host (POSIX) backend
+ *
+ * Firmware side is fds[0], harness (peer) side is fds[1].
+ *
+ * Interrupt-driven transfers are modelled by two "ISR" threads per open
+ * UART: transmit_it/receive_it hand a buffer to the thread, which moves
+ * the bytes over the socket and then reports completion through
+ * uart_hal_tx_complete_isr()/uart_hal_rx_complete_isr(), concurrently
+ * with the main loop just like a real interrupt.
+ *
+ * Circular DMA reception is modelled by the RX thread as well: it fills
+ * the buffer as bytes arrive and raises HALF/FULL at the boundaries and
+ * IDLE whenever the socket runs dry mid-buffer.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "hal_uart.h"
+#include "hal_uart_posix.h"
+#include "../bsp/bsp_power.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#define POSIX_UART_DEV   0
+#define POSIX_UART_PEER  1
+
+/* RX thread re-checks its state at least this often (ms) */
+#define POSIX_UART_RX_POLL_MS   10
+
+typedef struct {
+    int fds[2];
+    bool running;
+    pthread_t tx_thread;
+    pthread_t rx_thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    const uint8_t *tx_data;     /* Pending IT transmit (NULL when idle) */
+    uint16_t tx_length;
+    bool tx_link_down;          /* A send failed: later transmits fail too */
+    uint8_t *rx_data;           /* Armed IT receive (NULL when idle) */
+    uint16_t rx_length;
+    uint16_t rx_received;
+    uint8_t *rx_dma_buffer;     /* Circular DMA target (NULL when stopped) */
+    uint16_t rx_dma_length;
+    uint16_t rx_dma_position;
+    bool rx_wake;               /* Arrivals wake a Stop */
+} posix_uart_t;
+
+static posix_uart_t posix_uarts[UART_COUNT] = {
+    [UART_1] = { .fds = {-1, -1} },
+    [UART_2] = { .fds = {-1, -1} },
+    [UART_3] = { .fds = {-1, -1} },
+    [UART_4] = { .fds = {-1, -1} },
+    [UART_5] = { .fds = {-1, -1} },
+    [UART_6] = { .fds = {-1, -1} }
+};
+
+static bool posix_uart_is_open(uart_id_t uart_id)
+{
+    return (uart_id < UART_COUNT) && (posix_uarts[uart_id].fds[POSIX_UART_DEV] >= 0);
+}
+
+static uint64_t posix_uart_now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000U + (uint64_t)ts.tv_nsec / 1000000U;
+}
+
+/* Wait until fd is ready for events or the deadline passes */
+static error_t posix_uart_wait(int fd, short events, uint32_t timeout_ms, uint64_t deadline)
+{
+    struct pollfd pfd = { .fd = fd, .events = events };
+    int wait_ms = -1;
+    int n;
+
+    if (timeout_ms != UART_TIMEOUT_INFINITE) {
+        uint64_t now = posix_uart_now_ms();
+        wait_ms = (now >= deadline) ? 0 : (int)(deadline - now);
+    }
+    n = poll(&pfd, 1, wait_ms);
+    if (n == 0) {
+        return ERR_TIMEOUT;
+    }
+    if (n < 0 && errno != EINTR) {
+        return ERR_HW_FAILURE;
+    }
+    return ERR_OK;
+}
+
+static error_t posix_uart_send_all(int fd, const uint8_t *data, size_t length, uint32_t timeout_ms)
+{
+    uint64_t deadline = posix_uart_now_ms() + timeout_ms;
+    size_t sent = 0;
+
+    while (sent < length) {
+        error_t err = posix_uart_wait(fd, POLLOUT, timeout_ms, deadline);
+        ssize_t n;
+
+        if (err != ERR_OK) {
+            return err;
+        }
+        n = send(fd, &data[sent], length - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+                continue;
+            }
+            return ERR_HW_FAILURE;
+        }
+        sent += (size_t)n;
+    }
+    return ERR_OK;
+}
+
+static error_t posix_uart_recv_all(int fd, uint8_t *data, size_t length, uint32_t timeout_ms)
+{
+    uint64_t deadline = posix_uart_now_ms() + timeout_ms;
+    size_t received = 0;
+
+    while (received < length) {
+        error_t err = posix_uart_wait(fd, POLLIN, timeout_ms, deadline);
+        ssize_t n;
+
+        if (err != ERR_OK) {
+            return err;
+        }
+        n = recv(fd, &data[received], length - received, MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+                continue;
+            }
+            return ERR_HW_FAILURE;
+        }
+        if (n == 0) {
+            /* Peer closed the link - equivalent to a dead line */
+            return ERR_HW_FAILURE;
+        }
+        received += (size_t)n;
+    }
+    return ERR_OK;
+}
+
+/* ===== Simulated Interrupt Context ===== */
+
+static void *posix_uart_tx_isr(void *arg)
+{
+    uart_id_t uart_id = (uart_id_t)(uintptr_t)arg;
+    posix_uart_t *uart = &posix_uarts[uart_id];
+
+    pthread_mutex_lock(&uart->lock);
+    while (uart->running) {
+        if (uart->tx_data == NULL) {
+            pthread_cond_wait(&uart->cond, &uart->lock);
+            continue;
+        }
+        const uint8_t *data = uart->tx_data;
+        uint16_t length = uart->tx_length;
+        pthread_mutex_unlock(&uart->lock);
+
+        bool ok = posix_uart_send_all(uart->fds[POSIX_UART_DEV], data, length,
+                                      UART_TIMEOUT_INFINITE) == ERR_OK;
+
+        /* A dead link loses the transfer as a broken line would, but
+         * it still completes so the driver releases it; the next one is
+         * refused with ERR_HW_FAILURE */
+        pthread_mutex_lock(&uart->lock);
+        uart->tx_data = NULL;
+        if (!ok) {
+            uart->tx_link_down = true;
+        }
+        pthread_mutex_unlock(&uart->lock);
+        /* The callback may start the next transfer */
+        uart_hal_tx_complete_isr(uart_id);
+        pthread_mutex_lock(&uart->lock);
+    }
+    pthread_mutex_unlock(&uart->lock);
+    return NULL;
+}
+
+static bool posix_uart_rx_pending(int fd, int timeout_ms)
+{
+    struct pollfd pfd;
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    return (poll(&pfd, 1, timeout_ms) > 0) && (pfd.revents != 0);
+}
+
+/* One circular DMA step; returns false when the link is gone.
+ * Called with the lock held. */
+static bool posix_uart_rx_dma_step(uart_id_t uart_id, posix_uart_t *uart)
+{
+    uint16_t half = (uint16_t)(uart->rx_dma_length / 2U);
+    uint16_t position = uart->rx_dma_position;
+    uint16_t boundary = (position < half) ? half : uart->rx_dma_length;
+    uart_rx_event_t event;
+    ssize_t n;
+
+    n = recv(uart->fds[POSIX_UART_DEV], &uart->rx_dma_buffer[position],
+             (size_t)(boundary - position), MSG_DONTWAIT);
+    if (n == 0) {
+        return false;
+    }
+    if (n < 0) {
+        return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR);
+    }
+
+    position = (uint16_t)(position + n);
+    if (position == half) {
+        event = UART_RX_EVENT_HALF;
+    } else if (position == uart->rx_dma_length) {
+        event = UART_RX_EVENT_FULL;
+    } else if (!posix_uart_rx_pending(uart->fds[POSIX_UART_DEV], 0)) {
+        event = UART_RX_EVENT_IDLE;
+    } else {
+        uart->rx_dma_position = position;
+        return true;
+    }
+    uart->rx_dma_position = (position == uart->rx_dma_length) ? 0 : position;
+
+    pthread_mutex_unlock(&uart->lock);
+    uart_hal_rx_event_isr(uart_id, event, position);
+    pthread_mutex_lock(&uart->lock);
+    return true;
+}
+
+/* One IT receive step; returns false when the link is gone.
+ * Called with the lock held. */
+static bool posix_uart_rx_it_step(uart_id_t uart_id, posix_uart_t *uart)
+{
+    ssize_t n = recv(uart->fds[POSIX_UART_DEV], &uart->rx_data[uart->rx_received],
+                     (size_t)(uart->rx_length - uart->rx_received), MSG_DONTWAIT);
+    if (n == 0) {
+        return false;
+    }
+    if (n < 0) {
+        return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR);
+    }
+
+    uart->rx_received = (uint16_t)(uart->rx_received + n);
+    if (uart->rx_received == uart->rx_length) {
+        uart->rx_data = NULL;
+        /* The callback normally re-arms reception */
+        pthread_mutex_unlock(&uart->lock);
+        uart_hal_rx_complete_isr(uart_id);
+        pthread_mutex_lock(&uart->lock);
+    }
+    return true;
+}
+
+static void *posix_uart_rx_isr(void *arg)
+{
+    uart_id_t uart_id = (uart_id_t)(uintptr_t)arg;
+    posix_uart_t *uart = &posix_uarts[uart_id];
+    bool link_up = true;
+
+    pthread_mutex_lock(&uart->lock);
+    while (uart->running && link_up) {
+        if (uart->rx_data == NULL && uart->rx_dma_buffer == NULL) {
+            pthread_cond_wait(&uart->cond, &uart->lock);
+            continue;
+        }
+
+        /* Wait for bytes without holding the lock, so reception can be
+         * re-armed or aborted meanwhile */
+        pthread_mutex_unlock(&uart->lock);
+        bool readable = posix_uart_rx_pending(uart->fds[POSIX_UART_DEV], POSIX_UART_RX_POLL_MS);
+        pthread_mutex_lock(&uart->lock);
+        if (!readable) {
+            continue;
+        }
+        if (uart->rx_wake) {
+            /* Start bit on the armed pin; the byte itself is kept */
+            bsp_power_wake(POWER_WAKE_UART);
+        }
+
+        if (uart->rx_dma_buffer != NULL) {
+            link_up = posix_uart_rx_dma_step(uart_id, uart);
+        } else if (uart->rx_data != NULL) {
+            link_up = posix_uart_rx_it_step(uart_id, uart);
+        }
+    }
+    pthread_mutex_unlock(&uart->lock);
+    return NULL;
+}
+
+/* Stop the ISR threads that were started, then drop the link */
+static void posix_uart_teardown(posix_uart_t *uart, bool tx_started, bool rx_started)
+{
+    pthread_mutex_lock(&uart->lock);
+    uart->running = false;
+    pthread_cond_broadcast(&uart->cond);
+    pthread_mutex_unlock(&uart->lock);
+
+    /* Unblock an ISR thread parked in send()/recv() */
+    (void)shutdown(uart->fds[POSIX_UART_DEV], SHUT_RDWR);
+    if (tx_started) {
+        (void)pthread_join(uart->tx_thread, NULL);
+    }
+    if (rx_started) {
+        (void)pthread_join(uart->rx_thread, NULL);
+    }
+
+    (void)close(uart->fds[POSIX_UART_DEV]);
+    (void)close(uart->fds[POSIX_UART_PEER]);
+    uart->fds[POSIX_UART_DEV] = -1;
+    uart->fds[POSIX_UART_PEER] = -1;
+    pthread_cond_destroy(&uart->cond);
+    pthread_mutex_destroy(&uart->lock);
+}
+
+/* ===== Backend Operations ===== */
+
+error_t posix_uart_init(uart_id_t uart_id, const uart_config_t *config,
+                        const uart_baud_timing_t *timing)
+{
+    posix_uart_t *uart;
+
+    /* Socket links run at memory speed; the rate was validated already */
+    (void)timing;
+
+    if (uart_id >= UART_COUNT || config == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+    if (posix_uart_is_open(uart_id)) {
+        /* Reconfiguring an open port keeps the existing link */
+        return ERR_OK;
+    }
+
+    uart = &posix_uarts[uart_id];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, uart->fds) != 0) {
+        return ERR_HW_FAILURE;
+    }
+    pthread_mutex_init(&uart->lock, NULL);
+    pthread_cond_init(&uart->cond, NULL);
+    uart->tx_data = NULL;
+    uart->tx_link_down = false;
+    uart->rx_data = NULL;
+    uart->rx_dma_buffer = NULL;
+    uart->rx_wake = false;
+    uart->running = true;
+
+    void *arg = (void *)(uintptr_t)uart_id;
+    if (pthread_create(&uart->tx_thread, NULL, posix_uart_tx_isr, arg) != 0) {
+        posix_uart_teardown(uart, false, false);
+        return ERR_HW_FAILURE;
+    }
+    if (pthread_create(&uart->rx_thread, NULL, posix_uart_rx_isr, arg) != 0) {
+        posix_uart_teardown(uart, true, false);
+        return ERR_HW_FAILURE;
+    }
+    return ERR_OK;
+}
+
+error_t posix_uart_set_timing(uart_id_t uart_id, const uart_baud_timing_t *timing)
+{
+    /* No line rate to change on a socket */
+    (void)timing;
+    return posix_uart_is_open(uart_id) ? ERR_OK : ERR_NOT_INITIALIZED;
+}
+
+error_t posix_uart_deinit(uart_id_t uart_id)
+{
+    posix_uart_t *uart;
+
+    if (!posix_uart_is_open(uart_id)) {
+        return ERR_NOT_INITIALIZED;
+    }
+    uart = &posix_uarts[uart_id];
+    posix_uart_teardown(uart, true, true);
+    return ERR_OK;
+}
+
+error_t posix_uart_transmit(uart_id_t uart_id, const uint8_t *data, uint16_t length,
+                            uint32_t timeout_ms)
+{
+    if (!posix_uart_is_open(uart_id)) {
+        return ERR_NOT_INITIALIZED;
+    }
+    return posix_uart_send_all(posix_uarts[uart_id].fds[POSIX_UART_DEV], data, length, timeout_ms);
+}
+
+error_t posix_uart_receive(uart_id_t uart_id, uint8_t *data, uint16_t length,
+                           uint32_t timeout_ms)
+{
+    if (!posix_uart_is_open(uart_id)) {
+        return ERR_NOT_INITIALIZED;
+    }
+    return posix_uart_recv_all(posix_uarts[uart_id].fds[POSIX_UART_DEV], data, length, timeout_ms);
+}
+
+error_t posix_uart_transmit_it(uart_id_t uart_id, const uint8_t *data, uint16_t length)
+{
+    posix_uart_t *uart;
+    error_t err = ERR_OK;
+
+    if (!posix_uart_is_open(uart_id)) {
+        return ERR_NOT_INITIALIZED;
+    }
+    if (data == NULL || length == 0) {
+        return ERR_INVALID_PARAM;
+    }
+
+    uart = &posix_uarts[uart_id];
+    pthread_mutex_lock(&uart->lock);
+    if (uart->tx_link_down) {
+        err = ERR_HW_FAILURE;
+    } else if (uart->tx_data != NULL) {
+        err = ERR_BUSY;
+    } else {
+        uart->tx_data = data;
+        uart->tx_length = length;
+        pthread_cond_broadcast(&uart->cond);
+    }
+    pthread_mutex_unlock(&uart->lock);
+    return err;
+}
+
+error_t posix_uart_receive_it(uart_id_t uart_id, uint8_t *data, uint16_t length)
+{
+    posix_uart_t *uart;
+    error_t err = ERR_OK;
+
+    if (!posix_uart_is_open(uart_id)) {
+        return ERR_NOT_INITIALIZED;
+    }
+    if (data == NULL || length == 0) {
+        return ERR_INVALID_PARAM;
+    }
+
+    uart = &posix_uarts[uart_id];
+    pthread_mutex_lock(&uart->lock);
+    if (uart->rx_data != NULL || uart->rx_dma_buffer != NULL) {
+        err = ERR_BUSY;
+    } else {
+        uart->rx_data = data;
+        uart->rx_length = length;
+        uart->rx_received = 0;
+        pthread_cond_broadcast(&uart->cond);
+    }
+    pthread_mutex_unlock(&uart->lock);
+    return err;
+}
+
+/* DMA is modelled by the same TX thread: the CPU is free until the
+ * transfer-complete "interrupt" fires */
+error_t posix_uart_transmit_dma(uart_id_t uart_id, const uint8_t *data, uint16_t length)
+{
+    return posix_uart_transmit_it(uart_id, data, length);
+}
+
+error_t posix_uart_receive_dma(uart_id_t uart_id, uint8_t *buffer, uint16_t length)
+{
+    posix_uart_t *uart;
+    error_t err = ERR_OK;
+
+    if (!posix_uart_is_open(uart_id)) {
+        return ERR_NOT_INITIALIZED;
+    }
+    if (buffer == NULL || length < 2U) {
+        return ERR_INVALID_PARAM;
+    }
+
+    uart = &posix_uarts[uart_id];
+    pthread_mutex_lock(&uart->lock);
+    if (uart->rx_data != NULL || uart->rx_dma_buffer != NULL) {
+        err = ERR_BUSY;
+    } else {
+        uart->rx_dma_buffer = buffer;
+        uart->rx_dma_length = length;
+        uart->rx_dma_position = 0;
+        pthread_cond_broadcast(&uart->cond);
+    }
+    pthread_mutex_unlock(&uart->lock);
+    return err;
+}
+
+error_t posix_uart_abort_receive(uart_id_t uart_id)
+{
+    posix_uart_t *uart;
+
+    if (!posix_uart_is_open(uart_id)) {
+        return ERR_NOT_INITIALIZED;
+    }
+    uart = &posix_uarts[uart_id];
+    pthread_mutex_lock(&uart->lock);
+    uart->rx_data = NULL;
+    uart->rx_dma_buffer = NULL;
+    pthread_mutex_unlock(&uart->lock);
+    return ERR_OK;
+}
+
+bool posix_uart_is_tx_complete(uart_id_t uart_id)
+{
+    bool complete;
+
+    if (!posix_uart_is_open(uart_id)) {
+        return false;
+    }
+    pthread_mutex_lock(&posix_uarts[uart_id].lock);
+    complete = (posix_uarts[uart_id].tx_data == NULL);
+    pthread_mutex_unlock(&posix_uarts[uart_id].lock);
+    return complete;
+}
+
+bool posix_uart_is_rx_available(uart_id_t uart_id)
+{
+    struct pollfd pfd;
+
+    if (!posix_uart_is_open(uart_id)) {
+        return false;
+    }
+    pfd.fd = posix_uarts[uart_id].fds[POSIX_UART_DEV];
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    return (poll(&pfd, 1, 0) > 0) && ((pfd.revents & POLLIN) != 0);
+}
+
+error_t posix_uart_set_rx_wake(uart_id_t uart_id, bool enable)
+{
+    if (!posix_uart_is_open(uart_id)) {
+        return ERR_NOT_INITIALIZED;
+    }
+    pthread_mutex_lock(&posix_uarts[uart_id].lock);
+    posix_uarts[uart_id].rx_wake = enable;
+    pthread_mutex_unlock(&posix_uarts[uart_id].lock);
+    return ERR_OK;
+}
+
+const uart_hal_t posix_uart_hal = {
+    .init = posix_uart_init,
+    .deinit = posix_uart_deinit,
+    .set_timing = posix_uart_set_timing,
+    .transmit = posix_uart_transmit,
+    .receive = posix_uart_receive,
+    .transmit_it = posix_uart_transmit_it,
+    .receive_it = posix_uart_receive_it,
+    .transmit_dma = posix_uart_transmit_dma,
+    .receive_dma = posix_uart_receive_dma,
+    .abort_receive = posix_uart_abort_receive,
+    .is_tx_complete = posix_uart_is_tx_complete,
+    .is_rx_available = posix_uart_is_rx_available,
+    .set_rx_wake = posix_uart_set_rx_wake
+};
+
+/* ===== Host Harness Hooks ===== */
+
+int posix_uart_get_peer_fd(uart_id_t uart_id)
+{
+    if (!posix_uart_is_open(uart_id)) {
+        return -1;
+    }
+    return posix_uarts[uart_id].fds[POSIX_UART_PEER];
+}
@@ -0,0 +1,42 @@
+/*
+ * hal_uart_posix.h - UART HAL backend for the host (POSIX) build
+ *
+ * Each UART is an AF_UNIX stream socketpair created on init. The firmware
+ * side reads and writes one end; a host harness (benchmark, loopback,
+ * terminal bridge) uses posix_uart_get_peer_fd() to reach the other.
+ */
+
+#ifndef HAL_UART_POSIX_H
+#define HAL_UART_POSIX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_uart.h"
+
+/* HAL instance selected by uart_hal_init() */
+extern const uart_hal_t posix_uart_hal;
+
+/* Backend operations (also called directly under HAL_STATIC_BINDING) */
+error_t posix_uart_init(uart_id_t uart_id, const uart_config_t *config,
+                        const uart_baud_timing_t *timing);
+error_t posix_uart_deinit(uart_id_t uart_id);
+error_t posix_uart_set_timing(uart_id_t uart_id, const uart_baud_timing_t *timing);
+error_t posix_uart_transmit(uart_id_t uart_id, const uint8_t *data, uint16_t length,
+                            uint32_t timeout_ms);
+error_t posix_uart_receive(uart_id_t uart_id, uint8_t *data, uint16_t length,
+                           uint32_t timeout_ms);
+error_t posix_uart_transmit_it(uart_id_t uart_id, const uint8_t *data, uint16_t length);
+error_t posix_uart_receive_it(uart_id_t uart_id, uint8_t *data, uint16_t length);
+error_t posix_uart_transmit_dma(uart_id_t uart_id, const uint8_t *data, uint16_t length);
+error_t posix_uart_receive_dma(uart_id_t uart_id, uint8_t *buffer, uint16_t length);
+error_t posix_uart_abort_receive(uart_id_t uart_id);
+bool posix_uart_is_tx_complete(uart_id_t uart_id);
+bool posix_uart_is_rx_available(uart_id_t uart_id);
+error_t posix_uart_set_rx_wake(uart_id_t uart_id, bool enable);
+
+/* ===== Host Harness Hooks ===== */
+
+/* Peer end of a UART socketpair, or -1 if the UART is not open */
+int posix_uart_get_peer_fd(uart_id_t uart_id);
+
+#endif /* HAL_UART_POSIX_H */
@@ -0,0 +1,349 @@
+/*
+ * hal_uart_stm32.h - STM32 UART backend (Stub - Ready for STM32 HAL integration)
+ *
+ * Shared by the function-pointer table in hal_uart.c and, with
+ * HAL_STATIC_BINDING, by the UART API in hal_uart.h.
+ *
+ * Bring-up and retiming are register level (RCC, pin mux, CR1..CR3,
+ * BRR) so the baud timing computed by uart_compute_baud() is programmed
+ * as is; the transfers are still TODOs for the STM32 HAL.
+ */
+
+#ifndef HAL_UART_STM32_H
+#define HAL_UART_STM32_H
+
+#include "hal_uart.h"
+#include "hal_gpio.h"
+#include "hal_gpio_stm32.h"
+#include "../bsp/board_config.h"
+
+/* ===== STM32F4 USART Registers ===== */
+/* UART_1..UART_6 -> USART1, USART2, USART3, UART4, UART5, USART6 */
+#define STM32_USART_BASE(id)        ((id) == UART_1 ? 0x40011000UL : \
+                                     (id) == UART_2 ? 0x40004400UL : \
+                                     (id) == UART_3 ? 0x40004800UL : \
+                                     (id) == UART_4 ? 0x40004C00UL : \
+                                     (id) == UART_5 ? 0x40005000UL : 0x40011400UL)
+#define STM32_USART_SR(id)          (*(volatile uint32_t *)(STM32_USART_BASE(id) + 0x00UL))
+#define STM32_USART_BRR(id)         (*(volatile uint32_t *)(STM32_USART_BASE(id) + 0x08UL))
+#define STM32_USART_CR1(id)         (*(volatile uint32_t *)(STM32_USART_BASE(id) + 0x0CUL))
+#define STM32_USART_CR2(id)         (*(volatile uint32_t *)(STM32_USART_BASE(id) + 0x10UL))
+#define STM32_USART_CR3(id)         (*(volatile uint32_t *)(STM32_USART_BASE(id) + 0x14UL))
+#define STM32_USART_SR_TC           (1UL << 6)
+#define STM32_USART_CR1_RE          (1UL << 2)
+#define STM32_USART_CR1_TE          (1UL << 3)
+#define STM32_USART_CR1_PS          (1UL << 9)
+#define STM32_USART_CR1_PCE         (1UL << 10)
+#define STM32_USART_CR1_M           (1UL << 12)
+#define STM32_USART_CR1_UE          (1UL << 13)
+#define STM32_USART_CR1_OVER8       (1UL << 15)
+#define STM32_USART_CR2_STOP_2      (2UL << 12)
+
+/* USART1/6 hang off APB2, the others off APB1 */
+#define STM32_RCC_APB1ENR           (*(volatile uint32_t *)0x40023840UL)
+#define STM32_USART_ON_APB2(id)     ((id) == UART_1 || (id) == UART_6)
+#define STM32_USART_RCC_BIT(id)     ((id) == UART_1 ? (1UL << 4) : \
+                                     (id) == UART_2 ? (1UL << 17) : \
+                                     (id) == UART_3 ? (1UL << 18) : \
+                                     (id) == UART_4 ? (1UL << 19) : \
+                                     (id) == UART_5 ? (1UL << 20) : (1UL << 5))
+
+/* Polls of SR.TC before a retime gives up; the driver refuses the clock
+ * switch while a transfer is queued, so at most the last character is
+ * still shifting out */
+#define STM32_USART_TC_POLLS        100000UL
+
+static inline gpio_pin_t stm32_uart_tx_pin(uart_id_t uart_id)
+{
+    static const gpio_pin_t tx_pins[UART_COUNT] = {
+        GPIO_PIN(UART1_TX_PORT, UART1_TX_PIN), GPIO_PIN(UART2_TX_PORT, UART2_TX_PIN),
+        GPIO_PIN(UART3_TX_PORT, UART3_TX_PIN), GPIO_PIN(UART4_TX_PORT, UART4_TX_PIN),
+        GPIO_PIN(UART5_TX_PORT, UART5_TX_PIN), GPIO_PIN(UART6_TX_PORT, UART6_TX_PIN)
+    };
+
+    return tx_pins[uart_id];
+}
+
+static inline gpio_pin_t stm32_uart_rx_pin(uart_id_t uart_id)
+{
+    static const gpio_pin_t rx_pins[UART_COUNT] = {
+        GPIO_PIN(UART1_RX_PORT, UART1_RX_PIN), GPIO_PIN(UART2_RX_PORT, UART2_RX_PIN),
+        GPIO_PIN(UART3_RX_PORT, UART3_RX_PIN), GPIO_PIN(UART4_RX_PORT, UART4_RX_PIN),
+        GPIO_PIN(UART5_RX_PORT, UART5_RX_PIN), GPIO_PIN(UART6_RX_PORT, UART6_RX_PIN)
+    };
+
+    return rx_pins[uart_id];
+}
+
+#if !defined(BOARD_HOST)
+/* Hand a pin to the USART: alternate function, high speed, pull-up so an
+ * unconnected RX idles at the stop level */
+static inline void stm32_uart_pin_af(gpio_pin_t pin, uint32_t af)
+{
+    uint32_t port = GPIO_PIN_PORT(pin);
+    uint32_t n = GPIO_PIN_NUMBER(pin);
+    uint32_t shift2 = n * 2U;
+    uint32_t shift4 = (n & 7U) * 4U;
+
+    STM32_RCC_AHB1ENR |= 1UL << port;
+    STM32_GPIO_AFR(port, n >> 3) = (STM32_GPIO_AFR(port, n >> 3) & ~(0xFUL << shift4)) |
+                                   (af << shift4);
+    STM32_GPIO_OSPEEDR(port) = (STM32_GPIO_OSPEEDR(port) & ~(3UL << shift2)) | (2UL << shift2);
+    STM32_GPIO_PUPDR(port) = (STM32_GPIO_PUPDR(port) & ~(3UL << shift2)) | (1UL << shift2);
+    STM32_GPIO_MODER(port) = (STM32_GPIO_MODER(port) & ~(3UL << shift2)) | (2UL << shift2);
+}
+#endif
+
+static inline error_t stm32_uart_init(uart_id_t uart_id, const uart_config_t *config,
+                                      const uart_baud_timing_t *timing)
+{
+    if ((uint32_t)uart_id >= (uint32_t)UART_COUNT) {
+        return ERR_INVALID_PARAM;
+    }
+    /* M selects a 9-bit frame, parity included: 9 data bits leave no
+     * room for a parity bit */
+    if (config->data_bits == UART_DATA_9 && config->parity != UART_PARITY_NONE) {
+        return ERR_INVALID_PARAM;
+    }
+#if !defined(BOARD_HOST)
+    static const uint8_t afs[UART_COUNT] = {
+        UART1_AF, UART2_AF, UART3_AF, UART4_AF, UART5_AF, UART6_AF
+    };
+    uint32_t cr1 = STM32_USART_CR1_TE | STM32_USART_CR1_RE;
+
+    if (config->data_bits == UART_DATA_9 || config->parity != UART_PARITY_NONE) {
+        cr1 |= STM32_USART_CR1_M;
+    }
+    if (config->parity != UART_PARITY_NONE) {
+        cr1 |= STM32_USART_CR1_PCE;
+        if (config->parity == UART_PARITY_ODD) {
+            cr1 |= STM32_USART_CR1_PS;
+        }
+    }
+    if (timing->oversampling_8) {
+        cr1 |= STM32_USART_CR1_OVER8;
+    }
+
+    if (STM32_USART_ON_APB2(uart_id)) {
+        STM32_RCC_APB2ENR |= STM32_USART_RCC_BIT(uart_id);
+    } else {
+        STM32_RCC_APB1ENR |= STM32_USART_RCC_BIT(uart_id);
+    }
+    (void)STM32_USART_CR1(uart_id);     /* Clock reaches the USART before the first write */
+
+    /* Frame format and rate are only taken with UE clear */
+    STM32_USART_CR1(uart_id) = 0;
+    STM32_USART_CR2(uart_id) = (config->stop_bits == UART_STOP_2) ? STM32_USART_CR2_STOP_2 : 0U;
+    STM32_USART_CR3(uart_id) = 0;
+    STM32_USART_BRR(uart_id) = timing->brr;
+    STM32_USART_CR1(uart_id) = cr1;
+
+    stm32_uart_pin_af(stm32_uart_tx_pin(uart_id), afs[uart_id]);
+    stm32_uart_pin_af(stm32_uart_rx_pin(uart_id), afs[uart_id]);
+    STM32_USART_CR1(uart_id) = cr1 | STM32_USART_CR1_UE;
+#else
+    (void)timing;
+#endif
+    return ERR_OK;
+}
+
+static inline error_t stm32_uart_deinit(uart_id_t uart_id)
+{
+    if ((uint32_t)uart_id >= (uint32_t)UART_COUNT) {
+        return ERR_INVALID_PARAM;
+    }
+#if !defined(BOARD_HOST)
+    /* Pins keep their alternate function; with the USART unclocked TX
+     * floats to the pull-up */
+    STM32_USART_CR1(uart_id) = 0;
+    if (STM32_USART_ON_APB2(uart_id)) {
+        STM32_RCC_APB2ENR &= ~STM32_USART_RCC_BIT(uart_id);
+    } else {
+        STM32_RCC_APB1ENR &= ~STM32_USART_RCC_BIT(uart_id);
+    }
+#endif
+    return ERR_OK;
+}
+
+static inline error_t stm32_uart_set_timing(uart_id_t uart_id, const uart_baud_timing_t *timing)
+{
+#if !defined(BOARD_HOST)
+    uint32_t polls = 0;
+    uint32_t cr1;
+
+    /* TC only means something on a clocked, enabled USART */
+    if ((STM32_USART_CR1(uart_id) & STM32_USART_CR1_UE) == 0U) {
+        return ERR_NOT_INITIALIZED;
+    }
+
+    /* Let the last character leave at the old rate */
+    while ((STM32_USART_SR(uart_id) & STM32_USART_SR_TC) == 0U) {
+        if (++polls >= STM32_USART_TC_POLLS) {
+            return ERR_TIMEOUT;
+        }
+    }
+
+    /* OVER8 and BRR only take effect with the USART disabled; the rest
+     * of the configuration stays in CR1..CR3 */
+    cr1 = STM32_USART_CR1(uart_id) & ~STM32_USART_CR1_UE;
+    STM32_USART_CR1(uart_id) = cr1;
+    if (timing->oversampling_8) {
+        cr1 |= STM32_USART_CR1_OVER8;
+    } else {
+        cr1 &= ~STM32_USART_CR1_OVER8;
+    }
+    STM32_USART_CR1(uart_id) = cr1;
+    STM32_USART_BRR(uart_id) = timing->brr;
+    STM32_USART_CR1(uart_id) = cr1 | STM32_USART_CR1_UE;
+#else
+    (void)uart_id; (void)timing;
+#endif
+    return ERR_OK;
+}
+
+static inline error_t stm32_uart_transmit(uart_id_t uart_id, const uint8_t *data, uint16_t length,
+                                          uint32_t timeout_ms)
+{
+    /* TODO: HAL_UART_Transmit(huart, data, length, timeout_ms)
+     * (UART_TIMEOUT_INFINITE == HAL_MAX_DELAY); HAL_TIMEOUT -> ERR_TIMEOUT
+     */
+    (void)uart_id; (void)data; (void)length; (void)timeout_ms;
+    return ERR_OK;
+}
+
+static inline error_t stm32_uart_receive(uart_id_t uart_id, uint8_t *data, uint16_t length,
+                                         uint32_t timeout_ms)
+{
+    /* TODO: HAL_UART_Receive(huart, data, length, timeout_ms);
+     * HAL_TIMEOUT -> ERR_TIMEOUT
+     */
+    (void)uart_id; (void)data; (void)length; (void)timeout_ms;
+    return ERR_OK;
+}
+
+/* Completion of the IT transfers below must be reported from the STM32
+ * HAL callbacks, e.g.:
+ *
+ * void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+ * {
+ *     uart_hal_tx_complete_isr(uart_id_from_handle(huart));
+ * }
+ */
+static inline error_t stm32_uart_transmit_it(uart_id_t uart_id, const uint8_t *data, uint16_t length)
+{
+    /* TODO: HAL_UART_Transmit_IT() */
+    (void)uart_id; (void)data; (void)length;
+    return ERR_OK;
+}
+
+static inline error_t stm32_uart_receive_it(uart_id_t uart_id, uint8_t *data, uint16_t length)
+{
+    /* TODO: HAL_UART_Receive_IT() */
+    (void)uart_id; (void)data; (void)length;
+    return ERR_OK;
+}
+
+/* No TX DMA yet: the function table leaves .transmit_dma NULL and this
+ * gives the same ERR_NOT_INITIALIZED under HAL_STATIC_BINDING, so the
+ * driver sends its DMA descriptors interrupt driven. A DMA path would
+ * use HAL_UART_Transmit_DMA() on the port's TX stream
+ * (memory-to-peripheral, memory increment, byte width), ending in
+ * HAL_UART_TxCpltCallback(). */
+static inline error_t stm32_uart_transmit_dma(uart_id_t uart_id, const uint8_t *data, uint16_t length)
+{
+    (void)uart_id; (void)data; (void)length;
+    return ERR_NOT_INITIALIZED;
+}
+
+/* No circular RX DMA yet: as for transmit_dma, the function table
+ * leaves .receive_dma and .abort_receive NULL and these return
+ * ERR_NOT_INITIALIZED, so uart_driver_start_rx_stream() reports the
+ * stream unavailable and the port stays on byte-wise reception.
+ *
+ * The DMA path would use HAL_UARTEx_ReceiveToIdle_DMA() with the RX
+ * stream in DMA_CIRCULAR mode. Half-transfer, transfer-complete and IDLE
+ * all end in HAL_UARTEx_RxEventCallback(huart, Size), which maps to:
+ *
+ * uart_hal_rx_event_isr(id, HAL_UARTEx_GetRxEventType(huart) ==
+ *                       HAL_UART_RXEVENT_HT ? UART_RX_EVENT_HALF : ...,
+ *                       Size);
+ *
+ * and abort_receive to HAL_UART_AbortReceive().
+ */
+static inline error_t stm32_uart_receive_dma(uart_id_t uart_id, uint8_t *buffer, uint16_t length)
+{
+    (void)uart_id; (void)buffer; (void)length;
+    return ERR_NOT_INITIALIZED;
+}
+
+static inline error_t stm32_uart_abort_receive(uart_id_t uart_id)
+{
+    (void)uart_id;
+    return ERR_NOT_INITIALIZED;
+}
+
+static inline bool stm32_uart_is_tx_complete(uart_id_t uart_id)
+{
+    /* TODO: Check UART status */
+    (void)uart_id;
+    return true;
+}
+
+static inline bool stm32_uart_is_rx_available(uart_id_t uart_id)
+{
+    /* TODO: Check if data is available */
+    (void)uart_id;
+    return false;
+}
+
+static inline error_t stm32_uart_set_rx_wake(uart_id_t uart_id, bool enable)
+{
+    /* The F4 USARTs cannot wake from Stop; the RX pin (left in its
+     * alternate function, its input stage still runs) is routed to its
+     * EXTI line instead, falling edge for the start bit. The EXTI
+     * handlers in hal_gpio.c clear PR, mask the line and call
+     * bsp_power_wake(POWER_WAKE_UART). */
+    if ((uint32_t)uart_id >= (uint32_t)UART_COUNT) {
+        return ERR_INVALID_PARAM;
+    }
+#if !defined(BOARD_HOST)
+    gpio_pin_t pin = stm32_uart_rx_pin(uart_id);
+    uint32_t line = GPIO_PIN_NUMBER(pin);
+    uint32_t bit = 1UL << line;
+    uint32_t shift = (line & 3U) * 4U;
+    uint32_t irq = STM32_EXTI_IRQ(line);
+
+    if (!enable) {
+        if ((stm32_exti_uart_wake_lines & bit) != 0U) {
+            STM32_EXTI_IMR &= ~bit;
+            STM32_EXTI_PR = bit;
+            stm32_exti_uart_wake_lines &= ~bit;
+        }
+        return ERR_OK;
+    }
+
+    /* Pin n of every port shares line n; one armed for a GPIO edge
+     * stays with its owner */
+    if ((STM32_EXTI_IMR & bit) != 0U && (stm32_exti_uart_wake_lines & bit) == 0U) {
+        return ERR_BUSY;
+    }
+
+    STM32_EXTI_IMR &= ~bit;
+    STM32_RCC_APB2ENR |= STM32_RCC_APB2ENR_SYSCFGEN;
+    STM32_SYSCFG_EXTICR(line >> 2) = (STM32_SYSCFG_EXTICR(line >> 2) & ~(0xFUL << shift)) |
+                                     ((uint32_t)GPIO_PIN_PORT(pin) << shift);
+    STM32_EXTI_RTSR &= ~bit;
+    STM32_EXTI_FTSR |= bit;
+    stm32_exti_uart_wake_lines |= bit;
+
+    /* Drop edges from traffic before the line was armed */
+    STM32_EXTI_PR = bit;
+    STM32_EXTI_IMR |= bit;
+    STM32_NVIC_ISER(irq >> 5) = 1UL << (irq & 31U);
+#else
+    (void)enable;
+#endif
+    return ERR_OK;
+}
+
+#endif /* HAL_UART_STM32_H */
@@ -0,0 +1,179 @@
+/*
+ * hal_wave.c - Waveform Engine HAL Implementation
+ *
+ * With HAL_STATIC_BINDING the engine API is resolved at compile time in
+ * hal_wave.h; the timer fitting and the DMA event dispatch stay here.
+ */
+
+#include "hal_wave.h"
+#include "../common/hot_path.h"
+
+#ifndef HAL_STATIC_BINDING
+
+#ifdef USE_POSIX_HAL
+#include "hal_wave_posix.h"
+#else
+#include "hal_wave_stm32.h"
+#endif
+
+static const wave_hal_t *wave_hal = NULL;
+
+#ifndef USE_POSIX_HAL
+
+static const wave_hal_t stm32_wave_hal = {
+    .start = stm32_wave_start,
+    .stop = stm32_wave_stop,
+    .set_timing = stm32_wave_set_timing,
+    .remaining = stm32_wave_remaining
+};
+
+#endif /* !USE_POSIX_HAL */
+
+/* ===== HAL Abstraction API ===== */
+
+void wave_hal_init(void)
+{
+#ifdef USE_STM32_HAL
+    wave_hal = &stm32_wave_hal;
+#elif defined(USE_STM32_LL)
+    /* wave_hal = &stm32_ll_wave_hal; */
+#elif defined(USE_OPENCM3)
+    /* wave_hal = &opencm3_wave_hal; */
+#elif defined(USE_POSIX_HAL)
+    wave_hal = &posix_wave_hal;
+#else
+    wave_hal = &stm32_wave_hal;
+#endif
+}
+
+error_t wave_start(gpio_port_t port, const wave_word_t *words, uint16_t count,
+                   const wave_timing_t *timing, bool circular)
+{
+    if (wave_hal == NULL || wave_hal->start == NULL) {
+        return ERR_NOT_INITIALIZED;
+    }
+    return wave_hal->start(port, words, count, timing, circular);
+}
+
+void wave_stop(void)
+{
+    if (wave_hal != NULL && wave_hal->stop != NULL) {
+        wave_hal->stop();
+    }
+}
+
+error_t wave_set_timing(const wave_timing_t *timing)
+{
+    if (wave_hal == NULL || wave_hal->set_timing == NULL) {
+        return ERR_NOT_INITIALIZED;
+    }
+    return wave_hal->set_timing(timing);
+}
+
+uint16_t wave_remaining(void)
+{
+    if (wave_hal == NULL || wave_hal->remaining == NULL) {
+        return 0;
+    }
+    return wave_hal->remaining();
+}
+
+#endif /* !HAL_STATIC_BINDING */
+
+/* ===== Timer Fitting ===== */
+
+error_t wave_compute_timing(uint32_t sample_rate_hz, wave_timing_t *timing)
+{
+    clock_config_t clocks;
+
+    (void)bsp_clock_get_config(&clocks);
+    return wave_compute_timing_for_clock(sample_rate_hz, &clocks, timing);
+}
+
+error_t wave_compute_timing_for_clock(uint32_t sample_rate_hz, const clock_config_t *clocks,
+                                      wave_timing_t *timing)
+{
+    uint32_t tim_clk;
+    uint32_t ticks;
+    uint32_t prescaler;
+    uint32_t reload;
+    uint64_t actual_uhz;
+    int64_t error;
+
+    if (sample_rate_hz == 0U || sample_rate_hz > WAVE_MAX_RATE_HZ || clocks == NULL ||
+        timing == NULL) {
+        return ERR_INVALID_PARAM;
+    }
+
+    /* Timers on a divided APB run at twice the bus clock */
+    tim_clk = clocks->apb2_clock_hz;
+    if (clocks->apb2_clock_hz != clocks->ahb_clock_hz) {
+        tim_clk *= 2U;
+    }
+
+    ticks = (uint32_t)(((uint64_t)tim_clk + (sample_rate_hz / 2U)) / sample_rate_hz);
+    if (ticks < 2U) {
+        return ERR_INVALID_PARAM;
+    }
+    prescaler = (ticks - 1U) / 0x10000U;
+    reload = (ticks + (prescaler + 1U) / 2U) / (prescaler + 1U) - 1U;
+
+    timing->timer_clock_hz = tim_clk;
+    timing->prescaler = (uint16_t)prescaler;
+    timing->reload = (uint16_t)reload;
+
+    /* Rate in uHz: the error of a 1 Hz rate is still exact to 1 ppm */
+    actual_uhz = (uint64_t)tim_clk * 1000000U / ((uint64_t)(prescaler + 1U) * (reload + 1U));
+    timing->actual_rate_hz = (uint32_t)((actual_uhz + 500000U) / 1000000U);
+    error = ((int64_t)actual_uhz - (int64_t)sample_rate_hz * 1000000) / (int64_t)sample_rate_hz;
+    timing->error_ppm = (int32_t)error;
+    if (error > WAVE_RATE_MAX_ERROR_PPM || error < -WAVE_RATE_MAX_ERROR_PPM) {
+        return ERR_INVALID_PARAM;
+    }
+    return ERR_OK;
+}
+
+/* ===== DMA Events ===== */
+
+static wave_event_callback_t wave_event_callback;
+
+void wave_hal_register_event_callback(wave_event_callback_t on_event)
+{
+    wave_event_callback = on_event;
+}
+
+HOT_FUNC void wave_hal_event_isr(wave_event_t event)
+{
+    if (wave_event_callback != NULL) {
+        wave_event_callback(event);
+    }
+}
+
+#if !defined(BOARD_HOST) && !defined(USE_POSIX_HAL)
+
+#include "hal_wave_stm32.h"
+
+HOT_FUNC void DMA2_Stream5_IRQHandler(void)
+{
+    uint32_t flags = STM32_DMA2_HISR & STM32_DMA_HISR_S5_ALL;
+
+    STM32_DMA2_HIFCR = flags;
+    if ((flags & STM32_DMA_HISR_TEIF5) != 0U) {
+        stm32_wave_stop();
+        wave_hal_event_isr(WAVE_EVENT_ERROR);
+        return;
+    }
+    if ((flags & STM32_DMA_HISR_HTIF5) != 0U) {
+        wave_hal_event_isr(WAVE_EVENT_HALF);
+    }
+    if ((flags & STM32_DMA_HISR_TCIF5) != 0U) {
+        /* A normal-mode stream has disabled itself; stop requesting */
+        if ((STM32_DMA2_S5CR & STM32_DMA_SxCR_CIRC) == 0U) {
+            STM32_TIM1_CR1 = 0;
+            STM32_TIM1_DIER = 0;
+        }
+        wave_hal_event_isr(WAVE_EVENT_FULL);
+    }
+}
+
+#endif /* !BOARD_HOST && !USE_POSIX_HAL */
@@ -0,0 +1,144 @@
+/*
+ * hal_wave.h - Waveform Engine Hardware Abstraction Layer (HAL)
+ *
+ * A hardware timer paces a DMA stream that copies one word per tick from
+ * memory to a GPIO port's bit set/reset register (BSRR on STM32): bits
+ * 0..15 drive pins high, bits 16..31 drive them low, set wins. Once
+ * started the CPU is not involved between samples, so edges land on the
+ * timer grid whatever the main loop is doing.
+ *
+ * STM32F4: TIM1 update requests DMA2 stream 5 / channel 6 (only DMA2
+ * reaches the AHB1 GPIO ports). There is one engine.
+ *
+ * Dispatch is through wave_hal_t unless HAL_STATIC_BINDING is defined,
+ * in which case calls resolve to the selected backend at compile time.
+ */
+
+#ifndef HAL_WAVE_H
+#define HAL_WAVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/error.h"
+#include "../bsp/bsp_clock.h"
+#include "hal_gpio.h"
+
+/* One sample: pins to set and pins to clear on the port */
+typedef uint32_t wave_word_t;
+
+#define WAVE_SET(mask)          ((wave_word_t)(uint16_t)(mask))
+#define WAVE_CLEAR(mask)        ((wave_word_t)(uint16_t)(mask) << 16)
+
+#define WAVE_MAX_WORDS          0xFFFFU     /* DMA transfer counter */
+#define WAVE_MAX_RATE_HZ        2000000U    /* DMA to AHB1 with bus contention */
+
+/* Largest accepted deviation of the generated rate (ppm) */
+#define WAVE_RATE_MAX_ERROR_PPM 1000
+
+/* Timer Setting
+ * rate = timer_clock / ((prescaler + 1) * (reload + 1)); the smallest
+ * prescaler that fits is used, for the finest reload step.
+ */
+typedef struct {
+    uint32_t timer_clock_hz;    /* TIM1 kernel clock (2 x APB2 if APB2 is divided) */
+    uint16_t prescaler;         /* TIMx_PSC */
+    uint16_t reload;            /* TIMx_ARR */
+    uint32_t actual_rate_hz;    /* Sample rate really generated (rounded) */
+    int32_t error_ppm;          /* (actual - requested) / requested */
+} wave_timing_t;
+
+/* DMA events, reported from interrupt context */
+typedef enum {
+    WAVE_EVENT_HALF = 0,        /* First half of the buffer has been output */
+    WAVE_EVENT_FULL,            /* Whole buffer output: wrapped, or stopped if not circular */
+    WAVE_EVENT_ERROR            /* Transfer error: the engine has stopped */
+} wave_event_t;
+
+typedef void (*wave_event_callback_t)(wave_event_t event);
+
+/* Waveform HAL Function Pointers */
+typedef struct {
+    error_t (*start)(gpio_port_t port, const wave_word_t *words, uint16_t count,
+                     const wave_timing_t *timing, bool circular);
+    void (*stop)(void);
+    error_t (*set_timing)(const wave_timing_t *timing);
+    uint16_t (*remaining)(void);
+} wave_hal_t;
+
+/* Fit sample_rate_hz to the timer clock of the current clock profile.
+ * ERR_INVALID_PARAM if out of range (0 or above WAVE_MAX_RATE_HZ) or off
+ * by more than WAVE_RATE_MAX_ERROR_PPM. */
+error_t wave_compute_timing(uint32_t sample_rate_hz, wave_timing_t *timing);
+
+/* As wave_compute_timing(), for the bus clocks in clocks */
+error_t wave_compute_timing_for_clock(uint32_t sample_rate_hz, const clock_config_t *clocks,
+                                      wave_timing_t *timing);
+
+#ifdef HAL_STATIC_BINDING
+
+/* ===== Static Binding ===== */
+#if defined(USE_POSIX_HAL)
+#include "hal_wave_posix.h"
+#define WAVE_HAL_OP(op)     posix_wave_##op
+#elif defined(USE_STM32_LL) || defined(USE_OPENCM3)
+#error "HAL_STATIC_BINDING: no static waveform backend for the selected HAL yet"
+#else
+#include "hal_wave_stm32.h"
+#define WAVE_HAL_OP(op)     stm32_wave_##op
+#endif
+
+static inline void wave_hal_init(void)
+{
+}
+
+static inline error_t wave_start(gpio_port_t port, const wave_word_t *words, uint16_t count,
+                                 const wave_timing_t *timing, bool circular)
+{
+    return WAVE_HAL_OP(start)(port, words, count, timing, circular);
+}
+
+static inline void wave_stop(void)
+{
+    WAVE_HAL_OP(stop)();
+}
+
+static inline error_t wave_set_timing(const wave_timing_t *timing)
+{
+    return WAVE_HAL_OP(set_timing)(timing);
+}
+
+static inline uint16_t wave_remaining(void)
+{
+    return WAVE_HAL_OP(remaining)();
+}
+
+#else
+
+/* Waveform HAL API */
+void wave_hal_init(void);
+
+/* Output words[0..count) to port, one per timer tick, the first right
+ * away. circular restarts at words[0] after the last word until
+ * wave_stop(); otherwise the engine stops after it and the pins keep
+ * their last state. words must stay valid while the engine runs. */
+error_t wave_start(gpio_port_t port, const wave_word_t *words, uint16_t count,
+                   const wave_timing_t *timing, bool circular);
+void wave_stop(void);
+
+/* Re-time a running engine (clock profile switch) */
+error_t wave_set_timing(const wave_timing_t *timing);
+
+/* Words still to be output in the current pass */
+uint16_t wave_remaining(void);
+
+#endif /* HAL_STATIC_BINDING */
+
+/* DMA events
+ * The driver registers one callback; the backend's DMA interrupt reports
+ * half-transfer and transfer-complete through wave_hal_event_isr().
+ */
+void wave_hal_register_event_callback(wave_event_callback_t on_event);
+void wave_hal_event_isr(wave_event_t event);
+
+#endif /* HAL_WAVE_H */
@@ -0,0 +1,241 @@
+/*
+ * hal_wave_posix.c - Waveform engine for the host (POSIX) backend
+ *
+ * The engine thread sleeps on a condition variable bound to
+ * CLOCK_MONOTONIC until the next sample is due, so wave_stop() and
+ * wave_start() take effect at once even at slow rates. Sample n of a
+ * segment is due at segment start + n periods; wave_set_timing() starts
+ * a new segment at the next sample, as TIM1's preloaded ARR does.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "hal_wave.h"
+#include "hal_wave_posix.h"
+#include "hal_gpio_posix.h"
+
+#include <pthread.h>
+#include <time.h>
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool running;
+    uint32_t generation;                /* Bumped by every start/stop */
+
+    gpio_port_t port;
+    const wave_word_t *words;
+    uint16_t count;
+    uint16_t index;                     /* Next word */
+    bool circular;
+
+    double period_ns;
+    uint64_t start_ns;                  /* Sample 0 */
+    uint64_t segment_ns;                /* Sample segment_sample, at the current period */
+    uint32_t segment_sample;
+    uint32_t sample;                    /* Next sample */
+
+    posix_wave_edge_t *capture;
+    uint32_t capacity;
+    uint32_t captured;
+} posix_wave_t;
+
+static posix_wave_t posix_wave = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+static pthread_once_t posix_wave_once = PTHREAD_ONCE_INIT;
+static bool posix_wave_thread_ok;
+
+const wave_hal_t posix_wave_hal = {
+    .start = posix_wave_start,
+    .stop = posix_wave_stop,
+    .set_timing = posix_wave_set_timing,
+    .remaining = posix_wave_remaining
+};
+
+static uint64_t posix_wave_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double posix_wave_timing_period_ns(const wave_timing_t *timing)
+{
+    return ((double)timing->prescaler + 1.0) * ((double)timing->reload + 1.0) * 1e9 /
+           (double)timing->timer_clock_hz;
+}
+
+/* Timer + DMA: one word per wake-up, events where the stream raises them */
+static void *posix_wave_engine(void *arg)
+{
+    posix_wave_t *wave = &posix_wave;
+
+    (void)arg;
+    pthread_mutex_lock(&wave->lock);
+    for (;;) {
+        uint64_t due;
+        uint32_t generation;
+        struct timespec ts;
+        posix_gpio_port_t *port;
+        wave_word_t word;
+        uint16_t before;
+        bool half;
+        bool full;
+
+        while (!wave->running) {
+            pthread_cond_wait(&wave->cond, &wave->lock);
+        }
+
+        generation = wave->generation;
+        due = wave->segment_ns +
+              (uint64_t)((double)(wave->sample - wave->segment_sample) * wave->period_ns);
+        ts.tv_sec = (time_t)(due / 1000000000ULL);
+        ts.tv_nsec = (long)(due % 1000000000ULL);
+        while (wave->running && wave->generation == generation && posix_wave_now_ns() < due) {
+            (void)pthread_cond_timedwait(&wave->cond, &wave->lock, &ts);
+        }
+        if (!wave->running || wave->generation != generation) {
+            continue;
+        }
+
+        port = &posix_gpio_ports[wave->port & 0x0FU];
+        word = wave->words[wave->index];
+        before = port->odr;
+        posix_gpio_port_set_clear(wave->port, (uint16_t)word, (uint16_t)(word >> 16));
+        if (wave->capture != NULL && port->odr != before && wave->captured < wave->capacity) {
+            posix_wave_edge_t *edge = &wave->capture[wave->captured++];
+
+            edge->sample = wave->sample;
+            edge->time_ns = posix_wave_now_ns() - wave->start_ns;
+            edge->before = before;
+            edge->after = port->odr;
+        }
+
+        wave->sample++;
+        wave->index++;
+        half = (wave->index == wave->count / 2U);
+        full = (wave->index == wave->count);
+        if (full) {
+            wave->index = 0;
+            if (!wave->circular) {
+                wave->running = false;
+            }
+        }
+
+        if (half || full) {
+            pthread_mutex_unlock(&wave->lock);
+            wave_hal_event_isr(half ? WAVE_EVENT_HALF : WAVE_EVENT_FULL);
+            pthread_mutex_lock(&wave->lock);
+        }
+    }
+    return NULL;
+}
+
+static void posix_wave_create(void)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&posix_wave.cond, &attr);
+    pthread_condattr_destroy(&attr);
+    posix_wave_thread_ok = pthread_create(&posix_wave.thread, NULL, posix_wave_engine, NULL) == 0;
+}
+
+error_t posix_wave_start(gpio_port_t port, const wave_word_t *words, uint16_t count,
+                         const wave_timing_t *timing, bool circular)
+{
+    posix_wave_t *wave = &posix_wave;
+
+    (void)pthread_once(&posix_wave_once, posix_wave_create);
+    if (!posix_wave_thread_ok) {
+        return ERR_HW_FAILURE;
+    }
+
+    pthread_mutex_lock(&wave->lock);
+    wave->port = port;
+    wave->words = words;
+    wave->count = count;
+    wave->index = 0;
+    wave->circular = circular;
+    wave->period_ns = posix_wave_timing_period_ns(timing);
+    wave->start_ns = posix_wave_now_ns();
+    wave->segment_ns = wave->start_ns;
+    wave->segment_sample = 0;
+    wave->sample = 0;
+    wave->captured = 0;
+    wave->generation++;
+    wave->running = true;
+    pthread_cond_signal(&wave->cond);
+    pthread_mutex_unlock(&wave->lock);
+    return ERR_OK;
+}
+
+void posix_wave_stop(void)
+{
+    pthread_mutex_lock(&posix_wave.lock);
+    posix_wave.running = false;
+    posix_wave.generation++;
+    pthread_cond_signal(&posix_wave.cond);
+    pthread_mutex_unlock(&posix_wave.lock);
+}
+
+error_t posix_wave_set_timing(const wave_timing_t *timing)
+{
+    posix_wave_t *wave = &posix_wave;
+
+    pthread_mutex_lock(&wave->lock);
+    /* The sample in progress keeps its period; the next one starts the
+     * new grid */
+    wave->segment_ns += (uint64_t)((double)(wave->sample - wave->segment_sample) * wave->period_ns);
+    wave->segment_sample = wave->sample;
+    wave->period_ns = posix_wave_timing_period_ns(timing);
+    wave->generation++;
+    pthread_cond_signal(&wave->cond);
+    pthread_mutex_unlock(&wave->lock);
+    return ERR_OK;
+}
+
+uint16_t posix_wave_remaining(void)
+{
+    uint16_t remaining;
+
+    pthread_mutex_lock(&posix_wave.lock);
+    remaining = posix_wave.running ? (uint16_t)(posix_wave.count - posix_wave.index) : 0U;
+    pthread_mutex_unlock(&posix_wave.lock);
+    return remaining;
+}
+
+/* ===== Host Harness Hooks ===== */
+
+void posix_wave_capture(posix_wave_edge_t *edges, uint32_t capacity)
+{
+    pthread_mutex_lock(&posix_wave.lock);
+    posix_wave.capture = edges;
+    posix_wave.capacity = (edges != NULL) ? capacity : 0U;
+    posix_wave.captured = 0;
+    pthread_mutex_unlock(&posix_wave.lock);
+}
+
+uint32_t posix_wave_captured(void)
+{
+    uint32_t captured;
+
+    pthread_mutex_lock(&posix_wave.lock);
+    captured = posix_wave.captured;
+    pthread_mutex_unlock(&posix_wave.lock);
+    return captured;
+}
+
+uint64_t posix_wave_period_ns(void)
+{
+    uint64_t period;
+
+    pthread_mutex_lock(&posix_wave.lock);
+    period = (uint64_t)(posix_wave.period_ns + 0.5);
+    pthread_mutex_unlock(&posix_wave.lock);
+    return period;
+}
@@ -0,0 +1,47 @@
+/*
+ * hal_wave_posix.h - Waveform engine backend for the host (POSIX) build
+ *
+ * A thread stands in for the timer and DMA: it wakes on the sample grid
+ * (absolute deadlines from the start, so lateness does not accumulate),
+ * applies the next word to the simulated GPIO port and raises the
+ * half/full events at the same points as the DMA stream. A host thread
+ * wakes late now and then; the word still goes out, late, and the
+ * capture below shows by how much.
+ */
+
+#ifndef HAL_WAVE_POSIX_H
+#define HAL_WAVE_POSIX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_wave.h"
+
+error_t posix_wave_start(gpio_port_t port, const wave_word_t *words, uint16_t count,
+                         const wave_timing_t *timing, bool circular);
+void posix_wave_stop(void);
+error_t posix_wave_set_timing(const wave_timing_t *timing);
+uint16_t posix_wave_remaining(void);
+
+/* HAL instance selected by wave_hal_init() */
+extern const wave_hal_t posix_wave_hal;
+
+/* ===== Host Harness Hooks ===== */
+
+/* One output change: the port pins before and after a sample that
+ * changed at least one of them */
+typedef struct {
+    uint32_t sample;            /* Samples since wave_start() (0 = first) */
+    uint64_t time_ns;           /* When it was applied, from the start */
+    uint16_t before;
+    uint16_t after;
+} posix_wave_edge_t;
+
+/* Record edges into edges[0..capacity) from the next wave_start() on;
+ * NULL stops recording. posix_wave_captured() is the count so far. */
+void posix_wave_capture(posix_wave_edge_t *edges, uint32_t capacity);
+uint32_t posix_wave_captured(void);
+
+/* Nominal sample period of the running (or last) waveform, ns */
+uint64_t posix_wave_period_ns(void);
+
+#endif /* HAL_WAVE_POSIX_H */
@@ -0,0 +1,133 @@
+/*
+ * hal_wave_stm32.h - STM32 waveform engine backend (TIM1 + DMA2 stream 5)
+ *
+ * Backend operations are static inline so they can be used both by the
+ * function-pointer table in hal_wave.c and, with HAL_STATIC_BINDING,
+ * directly by the API in hal_wave.h.
+ *
+ * Register level: the ST HAL has no timer-paced memory-to-GPIO helper,
+ * and the whole setup is a dozen stores. TIM1's update event raises a
+ * DMA request (UDE); DMA2 stream 5 on channel 6 moves one 32-bit word
+ * from memory to GPIOx_BSRR per request. UG right after enabling makes
+ * the first request, so word 0 goes out on start. The stream interrupt
+ * (DMA2_Stream5_IRQHandler in hal_wave.c) reports HT/TC and stops the
+ * timer when a non-circular transfer completes. BOARD=host builds
+ * (BOARD_HOST) compile the operations to no-ops.
+ */
+
+#ifndef HAL_WAVE_STM32_H
+#define HAL_WAVE_STM32_H
+
+#include "hal_wave.h"
+
+/* ===== STM32F4 TIM1 / DMA2 Registers ===== */
+#define STM32_RCC_AHB1ENR           (*(volatile uint32_t *)0x40023830UL)
+#define STM32_RCC_APB2ENR           (*(volatile uint32_t *)0x40023844UL)
+#define STM32_RCC_AHB1ENR_DMA2EN    (1UL << 22)
+#define STM32_RCC_APB2ENR_TIM1EN    (1UL << 0)
+
+#define STM32_TIM1_CR1              (*(volatile uint32_t *)0x40010000UL)
+#define STM32_TIM1_DIER             (*(volatile uint32_t *)0x4001000CUL)
+#define STM32_TIM1_EGR              (*(volatile uint32_t *)0x40010014UL)
+#define STM32_TIM1_CNT              (*(volatile uint32_t *)0x40010024UL)
+#define STM32_TIM1_PSC              (*(volatile uint32_t *)0x40010028UL)
+#define STM32_TIM1_ARR              (*(volatile uint32_t *)0x4001002CUL)
+#define STM32_TIM_CR1_CEN           (1UL << 0)
+#define STM32_TIM_CR1_ARPE          (1UL << 7)
+#define STM32_TIM_DIER_UDE          (1UL << 8)
+#define STM32_TIM_EGR_UG            (1UL << 0)
+
+#define STM32_DMA2_HISR             (*(volatile uint32_t *)0x40026404UL)
+#define STM32_DMA2_HIFCR            (*(volatile uint32_t *)0x4002640CUL)
+#define STM32_DMA2_S5CR             (*(volatile uint32_t *)0x40026488UL)
+#define STM32_DMA2_S5NDTR           (*(volatile uint32_t *)0x4002648CUL)
+#define STM32_DMA2_S5PAR            (*(volatile uint32_t *)0x40026490UL)
+#define STM32_DMA2_S5M0AR           (*(volatile uint32_t *)0x40026494UL)
+#define STM32_DMA_SxCR_EN           (1UL << 0)
+#define STM32_DMA_SxCR_TEIE         (1UL << 2)
+#define STM32_DMA_SxCR_HTIE         (1UL << 3)
+#define STM32_DMA_SxCR_TCIE         (1UL << 4)
+#define STM32_DMA_SxCR_DIR_M2P      (1UL << 6)
+#define STM32_DMA_SxCR_CIRC         (1UL << 8)
+#define STM32_DMA_SxCR_MINC         (1UL << 10)
+#define STM32_DMA_SxCR_PSIZE_32     (2UL << 11)
+#define STM32_DMA_SxCR_MSIZE_32     (2UL << 13)
+#define STM32_DMA_SxCR_CHSEL(n)     ((uint32_t)(n) << 25)
+#define STM32_DMA_HISR_FEIF5        (1UL << 6)
+#define STM32_DMA_HISR_DMEIF5       (1UL << 8)
+#define STM32_DMA_HISR_TEIF5        (1UL << 9)
+#define STM32_DMA_HISR_HTIF5        (1UL << 10)
+#define STM32_DMA_HISR_TCIF5        (1UL << 11)
+#define STM32_DMA_HISR_S5_ALL       (STM32_DMA_HISR_FEIF5 | STM32_DMA_HISR_DMEIF5 | \
+                                     STM32_DMA_HISR_TEIF5 | STM32_DMA_HISR_HTIF5 | \
+                                     STM32_DMA_HISR_TCIF5)
+
+#define STM32_WAVE_DMA_IRQ          68U     /* DMA2 stream 5 */
+#define STM32_WAVE_NVIC_ISER        (*(volatile uint32_t *)(0xE000E100UL + 4UL * (STM32_WAVE_DMA_IRQ >> 5)))
+#define STM32_GPIO_BSRR_ADDR(port)  (0x40020018UL + 0x400UL * (port))
+
+static inline void stm32_wave_stop(void)
+{
+#if !defined(BOARD_HOST)
+    STM32_TIM1_CR1 = 0;
+    STM32_TIM1_DIER = 0;
+    STM32_DMA2_S5CR &= ~STM32_DMA_SxCR_EN;
+    while ((STM32_DMA2_S5CR & STM32_DMA_SxCR_EN) != 0U) {
+    }
+    STM32_DMA2_HIFCR = STM32_DMA_HISR_S5_ALL;
+#endif
+}
+
+static inline error_t stm32_wave_set_timing(const wave_timing_t *timing)
+{
+#if !defined(BOARD_HOST)
+    /* ARPE: the new period starts at the next update, no runt sample */
+    STM32_TIM1_PSC = timing->prescaler;
+    STM32_TIM1_ARR = timing->reload;
+#else
+    (void)timing;
+#endif
+    return ERR_OK;
+}
+
+static inline error_t stm32_wave_start(gpio_port_t port, const wave_word_t *words, uint16_t count,
+                                       const wave_timing_t *timing, bool circular)
+{
+#if !defined(BOARD_HOST)
+    STM32_RCC_AHB1ENR |= STM32_RCC_AHB1ENR_DMA2EN;
+    STM32_RCC_APB2ENR |= STM32_RCC_APB2ENR_TIM1EN;
+    stm32_wave_stop();
+
+    STM32_DMA2_S5PAR = STM32_GPIO_BSRR_ADDR(port);
+    STM32_DMA2_S5M0AR = (uint32_t)(uintptr_t)words;
+    STM32_DMA2_S5NDTR = count;
+    STM32_DMA2_S5CR = STM32_DMA_SxCR_CHSEL(6) | STM32_DMA_SxCR_MSIZE_32 | STM32_DMA_SxCR_PSIZE_32 |
+                      STM32_DMA_SxCR_MINC | STM32_DMA_SxCR_DIR_M2P |
+                      (circular ? STM32_DMA_SxCR_CIRC : 0U) |
+                      STM32_DMA_SxCR_TCIE | STM32_DMA_SxCR_HTIE | STM32_DMA_SxCR_TEIE;
+    STM32_DMA2_S5CR |= STM32_DMA_SxCR_EN;
+    STM32_WAVE_NVIC_ISER = 1UL << (STM32_WAVE_DMA_IRQ & 31U);
+
+    STM32_TIM1_CR1 = STM32_TIM_CR1_ARPE;
+    STM32_TIM1_PSC = timing->prescaler;
+    STM32_TIM1_ARR = timing->reload;
+    STM32_TIM1_CNT = 0;
+    STM32_TIM1_DIER = STM32_TIM_DIER_UDE;
+    STM32_TIM1_EGR = STM32_TIM_EGR_UG;
+    STM32_TIM1_CR1 = STM32_TIM_CR1_ARPE | STM32_TIM_CR1_CEN;
+#else
+    (void)port; (void)words; (void)count; (void)timing; (void)circular;
+#endif
+    return ERR_OK;
+}
+
+static inline uint16_t stm32_wave_remaining(void)
+{
+#if !defined(BOARD_HOST)
+    return (uint16_t)STM32_DMA2_S5NDTR;
+#else
+    return 0;
+#endif
+}
+
+#endif /* HAL_WAVE_STM32_H */
@@ -6,15 +6,17 @@
  */
 
 #include "app/app.h"
+#include "bsp/bsp_power.h"
+#include "bsp/bsp_time.h"
+#include "bsp/bsp_watchdog.h"
 #include "common/error.h"
+#include "common/profile.h"
+#include "common/scheduler.h"
+#include <stddef.h>
 
-/* Busy-wait delay (in main loop iterations) */
-static void delay_ms(uint32_t ms)
-{
-    /* TODO: Replace with actual timer-based delay */
-    volatile uint32_t counter = ms * 1000;
-    while (counter--);
-}
+/* Halted: wake this often to keep the watchdog (app.c, 1000 ms, as
+ * little as 0.7x that on a fast LSI) from resetting the board */
+#define MAIN_HALT_KICK_US       250000U
 
 int main(void)
 {
@@ -25,7 +27,7 @@ int main(void)
     if (err != ERR_OK) {
         /* Fatal error during init - system should not proceed */
         while (1) {
-            delay_ms(1);
+            bsp_time_delay_ms(1);
         }
     }
 
@@ -36,21 +38,30 @@ int main(void)
         return (int)err;
     }
 
-    /* Main application loop */
+    /* Main application loop: run what is ready, then sleep (or stop,
+     * if it is far enough) until the next timer or periodic release, or
+     * until an interrupt posts an event */
     while (app_get_state() == APP_STATE_RUNNING) {
+        PROFILE_BEGIN(app_run);
         err = app_run();
+        PROFILE_END(app_run);
         if (err != ERR_OK) {
             /* Log error but continue running */
             error_log(err, SEVERITY_WARN, 0);
         }
-        delay_ms(1);
+        (void)bsp_power_idle_until(app_next_wakeup_us(), sched_events_pending, NULL);
     }
 
     /* Shutdown */
     app_stop();
 
-    /* System halted */
-    while (1);
+    /* System halted: stay in the deepest idle the watchdog allows. It
+     * cannot be stopped once started, so it is kicked here directly,
+     * without the liveness checks of the running loop */
+    while (1) {
+        bsp_watchdog_kick();
+        (void)bsp_power_idle_until(bsp_time_us() + MAIN_HALT_KICK_US, NULL, NULL);
+    }
 
     return 0;
 }
@@ -1,15 +1,233 @@
 /*
  * platform_startup.c - Platform startup implementation
+ *
+ * Vector table and reset sequence for the STM32F412. Handlers not
+ * defined elsewhere fall through to Default_Handler, which parks the
+ * core so the debugger shows where it stopped.
+ *
+ * With HOT_PLACEMENT (MODE=perf) the table is copied to the start of
+ * SRAM and VTOR pointed at it: exception entry then fetches the handler
+ * address without flash wait states or an ART miss, so entry latency no
+ * longer depends on what the flash accelerator last cached.
  */
 
+#include <stdint.h>
 #include "platform_startup.h"
+#include "../common/hot_path.h"
+
+#if !defined(BOARD_HOST)
+
+#define SCB_VTOR            (*(volatile uint32_t *)0xE000ED08UL)
+
+typedef void (*vector_t)(void);
+
+/* Linker script symbols (platform/linker.ld) */
+extern uint32_t _estack;
+extern uint32_t _sidata, _sdata, _edata;
+extern uint32_t _siramfunc, _sramfunc, _eramfunc;
+extern uint32_t _sihotdata, _shotdata, _ehotdata;
+extern uint32_t _sbss, _ebss;
+
+int main(void);
+
+void Reset_Handler(void);
+void Default_Handler(void);
+
+/* ===== Exception and Interrupt Handlers ===== */
+
+#define WEAK_HANDLER(name) void name(void) __attribute__((weak, alias("Default_Handler")))
+
+WEAK_HANDLER(NMI_Handler);
+WEAK_HANDLER(HardFault_Handler);
+WEAK_HANDLER(MemManage_Handler);
+WEAK_HANDLER(BusFault_Handler);
+WEAK_HANDLER(UsageFault_Handler);
+WEAK_HANDLER(SVC_Handler);
+WEAK_HANDLER(DebugMon_Handler);
+WEAK_HANDLER(PendSV_Handler);
+WEAK_HANDLER(SysTick_Handler);
+
+WEAK_HANDLER(RTC_WKUP_IRQHandler);
+WEAK_HANDLER(EXTI0_IRQHandler);
+WEAK_HANDLER(EXTI1_IRQHandler);
+WEAK_HANDLER(EXTI2_IRQHandler);
+WEAK_HANDLER(EXTI3_IRQHandler);
+WEAK_HANDLER(EXTI4_IRQHandler);
+WEAK_HANDLER(EXTI9_5_IRQHandler);
+WEAK_HANDLER(EXTI15_10_IRQHandler);
+WEAK_HANDLER(USART1_IRQHandler);
+WEAK_HANDLER(USART2_IRQHandler);
+WEAK_HANDLER(USART3_IRQHandler);
+WEAK_HANDLER(DMA2_Stream5_IRQHandler);
+WEAK_HANDLER(USART6_IRQHandler);
+
+/* ===== Vector Table ===== */
+
+__attribute__((section(".isr_vector"), used))
+static const vector_t flash_vectors[PLATFORM_VECTOR_COUNT] = {
+    (vector_t)(uintptr_t)&_estack,
+    Reset_Handler,
+    NMI_Handler,
+    HardFault_Handler,
+    MemManage_Handler,
+    BusFault_Handler,
+    UsageFault_Handler,
+    0, 0, 0, 0,
+    SVC_Handler,
+    DebugMon_Handler,
+    0,
+    PendSV_Handler,
+    SysTick_Handler,
+
+    Default_Handler,        /* IRQ  0 */
+    Default_Handler,        /* IRQ  1 */
+    Default_Handler,        /* IRQ  2 */
+    RTC_WKUP_IRQHandler,    /* IRQ  3 */
+    Default_Handler,        /* IRQ  4 */
+    Default_Handler,        /* IRQ  5 */
+    EXTI0_IRQHandler,       /* IRQ  6 */
+    EXTI1_IRQHandler,       /* IRQ  7 */
+    EXTI2_IRQHandler,       /* IRQ  8 */
+    EXTI3_IRQHandler,       /* IRQ  9 */
+    EXTI4_IRQHandler,       /* IRQ 10 */
+    Default_Handler,        /* IRQ 11 */
+    Default_Handler,        /* IRQ 12 */
+    Default_Handler,        /* IRQ 13 */
+    Default_Handler,        /* IRQ 14 */
+    Default_Handler,        /* IRQ 15 */
+    Default_Handler,        /* IRQ 16 */
+    Default_Handler,        /* IRQ 17 */
+    Default_Handler,        /* IRQ 18 */
+    Default_Handler,        /* IRQ 19 */
+    Default_Handler,        /* IRQ 20 */
+    Default_Handler,        /* IRQ 21 */
+    Default_Handler,        /* IRQ 22 */
+    EXTI9_5_IRQHandler,     /* IRQ 23 */
+    Default_Handler,        /* IRQ 24 */
+    Default_Handler,        /* IRQ 25 */
+    Default_Handler,        /* IRQ 26 */
+    Default_Handler,        /* IRQ 27 */
+    Default_Handler,        /* IRQ 28 */
+    Default_Handler,        /* IRQ 29 */
+    Default_Handler,        /* IRQ 30 */
+    Default_Handler,        /* IRQ 31 */
+    Default_Handler,        /* IRQ 32 */
+    Default_Handler,        /* IRQ 33 */
+    Default_Handler,        /* IRQ 34 */
+    Default_Handler,        /* IRQ 35 */
+    Default_Handler,        /* IRQ 36 */
+    USART1_IRQHandler,      /* IRQ 37 */
+    USART2_IRQHandler,      /* IRQ 38 */
+    USART3_IRQHandler,      /* IRQ 39 */
+    EXTI15_10_IRQHandler,   /* IRQ 40 */
+    Default_Handler,        /* IRQ 41 */
+    Default_Handler,        /* IRQ 42 */
+    Default_Handler,        /* IRQ 43 */
+    Default_Handler,        /* IRQ 44 */
+    Default_Handler,        /* IRQ 45 */
+    Default_Handler,        /* IRQ 46 */
+    Default_Handler,        /* IRQ 47 */
+    Default_Handler,        /* IRQ 48 */
+    Default_Handler,        /* IRQ 49 */
+    Default_Handler,        /* IRQ 50 */
+    Default_Handler,        /* IRQ 51 */
+    Default_Handler,        /* IRQ 52 */
+    Default_Handler,        /* IRQ 53 */
+    Default_Handler,        /* IRQ 54 */
+    Default_Handler,        /* IRQ 55 */
+    Default_Handler,        /* IRQ 56 */
+    Default_Handler,        /* IRQ 57 */
+    Default_Handler,        /* IRQ 58 */
+    Default_Handler,        /* IRQ 59 */
+    Default_Handler,        /* IRQ 60 */
+    Default_Handler,        /* IRQ 61 */
+    Default_Handler,        /* IRQ 62 */
+    Default_Handler,        /* IRQ 63 */
+    Default_Handler,        /* IRQ 64 */
+    Default_Handler,        /* IRQ 65 */
+    Default_Handler,        /* IRQ 66 */
+    Default_Handler,        /* IRQ 67 */
+    DMA2_Stream5_IRQHandler, /* IRQ 68 */
+    Default_Handler,        /* IRQ 69 */
+    Default_Handler,        /* IRQ 70 */
+    USART6_IRQHandler,      /* IRQ 71 */
+    Default_Handler,        /* IRQ 72 */
+    Default_Handler,        /* IRQ 73 */
+    Default_Handler,        /* IRQ 74 */
+    Default_Handler,        /* IRQ 75 */
+    Default_Handler,        /* IRQ 76 */
+    Default_Handler,        /* IRQ 77 */
+    Default_Handler,        /* IRQ 78 */
+    Default_Handler,        /* IRQ 79 */
+    Default_Handler,        /* IRQ 80 */
+    Default_Handler,        /* IRQ 81 */
+    Default_Handler,        /* IRQ 82 */
+    Default_Handler,        /* IRQ 83 */
+    Default_Handler,        /* IRQ 84 */
+    Default_Handler,        /* IRQ 85 */
+    Default_Handler,        /* IRQ 86 */
+    Default_Handler,        /* IRQ 87 */
+    Default_Handler,        /* IRQ 88 */
+    Default_Handler,        /* IRQ 89 */
+    Default_Handler,        /* IRQ 90 */
+    Default_Handler,        /* IRQ 91 */
+    Default_Handler,        /* IRQ 92 */
+    Default_Handler,        /* IRQ 93 */
+    Default_Handler,        /* IRQ 94 */
+    Default_Handler,        /* IRQ 95 */
+    Default_Handler         /* IRQ 96 */
+};
+
+#ifdef HOT_PLACEMENT
+/* VTOR needs the table aligned to its size rounded up to a power of two */
+__attribute__((section(".ram_vectors"), aligned(512)))
+static vector_t ram_vectors[PLATFORM_VECTOR_COUNT];
+#endif
+
+void Default_Handler(void)
+{
+    for (;;) {
+    }
+}
+
+/* ===== Reset ===== */
+
+static void platform_copy(uint32_t *dst, const uint32_t *src, const uint32_t *end)
+{
+    while (dst < end) {
+        *dst++ = *src++;
+    }
+}
+
+void Reset_Handler(void)
+{
+    platform_copy(&_sdata, &_sidata, &_edata);
+    platform_copy(&_sramfunc, &_siramfunc, &_eramfunc);
+    platform_copy(&_shotdata, &_sihotdata, &_ehotdata);
+    for (uint32_t *p = &_sbss; p < &_ebss; p++) {
+        *p = 0;
+    }
+
+#ifdef HOT_PLACEMENT
+    for (uint32_t i = 0; i < PLATFORM_VECTOR_COUNT; i++) {
+        ram_vectors[i] = flash_vectors[i];
+    }
+    SCB_VTOR = (uint32_t)(uintptr_t)ram_vectors;
+    __asm volatile ("dsb\n\tisb" ::: "memory");
+#endif
+
+    (void)platform_init();
+    (void)main();
+    for (;;) {
+    }
+}
+
+#endif /* !BOARD_HOST */
 
 error_t platform_init(void)
 {
     /* TODO: Implement platform-specific initialization:
-     * - Memory initialization (BSS, data sections)
-     * - Stack setup
-     * - Interrupt vector table
+     * - Enable the FPU (CPACR) before any floating point code
      * - Enable interrupts
      */
     return ERR_OK;
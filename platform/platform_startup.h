@@ -1,5 +1,10 @@
 /*
  * platform_startup.h - Platform-specific startup
+ *
+ * Reset_Handler (platform_startup.c) copies the initialized sections
+ * from flash (.data, and .ramfunc / .hotdata for common/hot_path.h),
+ * clears .bss, relocates the vector table to SRAM in perf builds, then
+ * runs platform_init() and main().
  */
 
 #ifndef PLATFORM_STARTUP_H
@@ -7,6 +12,11 @@
 
 #include "../common/error.h"
 
+/* STM32F412: 16 core exception entries + 97 peripheral interrupts */
+#define PLATFORM_CORE_VECTORS   16U
+#define PLATFORM_IRQ_COUNT      97U
+#define PLATFORM_VECTOR_COUNT   (PLATFORM_CORE_VECTORS + PLATFORM_IRQ_COUNT)
+
 /* Platform initialization (before main()) */
 error_t platform_init(void);
 
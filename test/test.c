@@ -0,0 +1,58 @@
+/*
+ * test.c - Host Test Support
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "test.h"
+
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Checks may run on several threads */
+static atomic_uint test_checks;
+static atomic_uint test_failures;
+
+bool test_check(bool cond, const char *text, const char *file, int line)
+{
+    atomic_fetch_add(&test_checks, 1U);
+    if (!cond) {
+        /* Only the first few, a failing loop would flood the log */
+        if (atomic_fetch_add(&test_failures, 1U) < 10U) {
+            printf("  FAIL %s:%d: %s\n", file, line, text);
+        }
+    }
+    return cond;
+}
+
+void test_note(const char *format, ...)
+{
+    va_list args;
+
+    printf("  ");
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+    fflush(stdout);
+}
+
+uint64_t test_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int test_report(const char *name)
+{
+    unsigned int failures = atomic_load(&test_failures);
+
+    printf("%s: %s (%u checks, %u failed)\n", name, (failures == 0U) ? "PASS" : "FAIL",
+           atomic_load(&test_checks), failures);
+    return (failures == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
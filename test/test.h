@@ -0,0 +1,33 @@
+/*
+ * test.h - Host Test Support
+ *
+ * Each test/test_*.c is its own program (make test builds and runs them
+ * all, BOARD=host), linked against the firmware objects, so a test owns
+ * the process: it may init modules, start threads and leave them
+ * running. TEST_CHECK records a failure and carries on; main() ends
+ * with return test_report(), which prints the verdict.
+ *
+ * Measurements that are not pass/fail (throughput, drop counts) go to
+ * stdout with test_note().
+ */
+
+#ifndef TEST_TEST_H
+#define TEST_TEST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TEST_CHECK(cond) test_check((cond), #cond, __FILE__, __LINE__)
+
+/* Record the outcome of one check; returns cond */
+bool test_check(bool cond, const char *text, const char *file, int line);
+
+void test_note(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/* Monotonic nanoseconds */
+uint64_t test_now_ns(void);
+
+/* Checks and failures so far, "PASS"/"FAIL"; the exit status */
+int test_report(const char *name);
+
+#endif /* TEST_TEST_H */
@@ -0,0 +1,180 @@
+/*
+ * test_error_stress.c - Error Log Concurrency Stress Test
+ *
+ * STRESS_WRITERS threads call error_log() without pause while a reader
+ * walks the ring with error_get_entry() and error_get_last(). Every
+ * entry describes itself: the context names the writer and its call,
+ * and the code, severity and timestamp are derived from it, so a torn
+ * entry (fields from two different calls) cannot pass the check.
+ *
+ *   no tear  every entry the reader is handed is self-consistent
+ *   no loss  per-code and per-severity totals match what was logged,
+ *            and every event was either queued or counted as a drop
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "test.h"
+#include "../common/error.h"
+#include "../common/event_bus.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define STRESS_WRITERS          8U
+#define STRESS_LOGS_PER_WRITER  200000U
+#define STRESS_LOG_SIZE         32U     /* ERROR_LOG_SIZE */
+
+#define STRESS_CONTEXT(writer, call)    (((uint32_t)(writer) << 24) | (uint32_t)(call))
+#define STRESS_WRITER(context)          ((context) >> 24)
+#define STRESS_CALL(context)            ((context) & 0x00FFFFFFU)
+
+/* Codes ERR_TIMEOUT..ERR_MEMORY and every severity, mixed per writer */
+static error_t stress_code(uint32_t context)
+{
+    return (error_t)(1U + (STRESS_WRITER(context) + STRESS_CALL(context)) % 6U);
+}
+
+static error_severity_t stress_severity(uint32_t context)
+{
+    return (error_severity_t)((STRESS_WRITER(context) * 3U + STRESS_CALL(context)) % 4U);
+}
+
+/* error_log() calls the clock on the writer's own thread */
+static _Thread_local uint32_t stress_stamp;
+
+static uint32_t stress_clock(void)
+{
+    return stress_stamp;
+}
+
+static bool stress_entry_valid(const error_entry_t *entry)
+{
+    return STRESS_WRITER(entry->context) < STRESS_WRITERS &&
+           STRESS_CALL(entry->context) < STRESS_LOGS_PER_WRITER &&
+           entry->error_code == stress_code(entry->context) &&
+           entry->severity == stress_severity(entry->context) &&
+           entry->timestamp == ~entry->context;
+}
+
+/* ===== Writers ===== */
+
+static atomic_uint writers_done;
+
+static void *stress_writer(void *arg)
+{
+    uint32_t writer = (uint32_t)(uintptr_t)arg;
+
+    for (uint32_t call = 0; call < STRESS_LOGS_PER_WRITER; call++) {
+        uint32_t context = STRESS_CONTEXT(writer, call);
+
+        stress_stamp = ~context;
+        error_log(stress_code(context), stress_severity(context), context);
+    }
+    atomic_fetch_add(&writers_done, 1U);
+    return NULL;
+}
+
+/* ===== Reader ===== */
+
+static uint32_t reader_entries;
+static uint32_t reader_busy;
+static uint32_t reader_torn;
+
+static void *stress_reader(void *arg)
+{
+    (void)arg;
+    while (atomic_load(&writers_done) < STRESS_WRITERS) {
+        error_t last;
+
+        for (uint32_t age = 0; age < STRESS_LOG_SIZE; age++) {
+            error_entry_t entry;
+            error_t result = error_get_entry(age, &entry);
+
+            if (result == ERR_OK) {
+                reader_entries++;
+                if (!stress_entry_valid(&entry)) {
+                    reader_torn++;
+                }
+            } else if (result == ERR_BUSY) {
+                reader_busy++;
+            }
+        }
+        /* ERR_OK only if the writers lapped every slot during the scan */
+        last = error_get_last();
+        TEST_CHECK(last <= ERR_MEMORY);
+        /* The only dispatcher: keeps the event queue moving */
+        (void)event_bus_dispatch();
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t writers[STRESS_WRITERS];
+    pthread_t reader;
+    uint32_t code_expected[ERR_MEMORY + 1] = { 0 };
+    uint32_t severity_expected[SEVERITY_FATAL + 1] = { 0 };
+    uint32_t total = STRESS_WRITERS * STRESS_LOGS_PER_WRITER;
+    event_topic_stats_t events;
+    uint64_t start;
+    uint64_t elapsed;
+
+    error_init();
+    error_set_clock(stress_clock);
+    event_bus_init(NULL, NULL);
+
+    /* Seed one entry so error_get_last() has something to find */
+    stress_stamp = ~STRESS_CONTEXT(0U, 0U);
+    error_log(stress_code(0U), stress_severity(0U), 0U);
+    total++;
+
+    start = test_now_ns();
+    TEST_CHECK(pthread_create(&reader, NULL, stress_reader, NULL) == 0);
+    for (uint32_t w = 0; w < STRESS_WRITERS; w++) {
+        TEST_CHECK(pthread_create(&writers[w], NULL, stress_writer, (void *)(uintptr_t)w) == 0);
+    }
+    for (uint32_t w = 0; w < STRESS_WRITERS; w++) {
+        (void)pthread_join(writers[w], NULL);
+    }
+    (void)pthread_join(reader, NULL);
+    elapsed = test_now_ns() - start;
+
+    /* No tear */
+    TEST_CHECK(reader_entries > 0U);
+    TEST_CHECK(reader_torn == 0U);
+
+    /* The writers are done: every slot holds a complete, valid entry */
+    TEST_CHECK(error_get_count() == STRESS_LOG_SIZE);
+    for (uint32_t age = 0; age < STRESS_LOG_SIZE; age++) {
+        error_entry_t entry;
+
+        TEST_CHECK(error_get_entry(age, &entry) == ERR_OK && stress_entry_valid(&entry));
+    }
+
+    /* No loss */
+    code_expected[stress_code(0U)]++;
+    severity_expected[stress_severity(0U)]++;
+    for (uint32_t w = 0; w < STRESS_WRITERS; w++) {
+        for (uint32_t call = 0; call < STRESS_LOGS_PER_WRITER; call++) {
+            code_expected[stress_code(STRESS_CONTEXT(w, call))]++;
+            severity_expected[stress_severity(STRESS_CONTEXT(w, call))]++;
+        }
+    }
+    for (uint32_t code = ERR_TIMEOUT; code <= ERR_MEMORY; code++) {
+        TEST_CHECK(error_get_code_count((error_t)code) == code_expected[code]);
+    }
+    for (uint32_t severity = SEVERITY_INFO; severity <= SEVERITY_FATAL; severity++) {
+        TEST_CHECK(error_get_severity_count((error_severity_t)severity) ==
+                   severity_expected[severity]);
+    }
+    TEST_CHECK(error_get_severity_mask() == 0x0FU);
+    TEST_CHECK(event_topic_get_stats(&error_topic, &events) == ERR_OK);
+    TEST_CHECK(events.posts + events.drops == total);
+
+    test_note("%u writers, %u entries in %.1f ms; reader saw %u entries, %u busy, %u torn",
+              STRESS_WRITERS, total, (double)elapsed / 1e6, reader_entries, reader_busy,
+              reader_torn);
+    test_note("events: %u queued, %u dropped", events.posts, events.drops);
+    return test_report("error_stress");
+}
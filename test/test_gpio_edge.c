@@ -0,0 +1,291 @@
+/*
+ * test_gpio_edge.c - GPIO Edge Event Test
+ *
+ * Plays edge trains on an input through the host EXTI model
+ * (posix_gpio_inject_edges()) and checks what gpio_driver reports:
+ *
+ *   irq       debounce_us = 0, both edges: one callback per interrupt,
+ *             all counted as accepted, none before its edge. Edges lost
+ *             to merging and the IRQ-entry latency are reported, at a
+ *             slow and at a fast train.
+ *   debounce  debounce_us > 0: transitions that bounce report exactly
+ *             once each, in the right direction, stamped with the time
+ *             of the burst's first edge; every other edge is filtered.
+ *   glitch    short pulses that settle back at the old level report
+ *             nothing and are all filtered.
+ *
+ * After each part every interrupt is either accepted or filtered.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "test.h"
+#include "../bsp/bsp_time.h"
+#include "../drivers/gpio_driver.h"
+#include "../hal/hal_gpio_posix.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define EDGE_PIN                GPIO_PIN(GPIO_PORT_E, 4)
+#define EDGE_MAX                2000U
+
+#define IRQ_SLOW_EDGES          400U
+#define IRQ_SLOW_US             1000U
+#define IRQ_FAST_EDGES          2000U
+#define IRQ_FAST_US             10U
+
+#define DEBOUNCE_US             5000U
+#define DEBOUNCE_TRANSITIONS    50U
+#define DEBOUNCE_BOUNCES        5U      /* Extra edge pairs per transition */
+#define DEBOUNCE_BOUNCE_US      20U
+#define DEBOUNCE_GAP_US         (3U * DEBOUNCE_US)
+#define DEBOUNCE_TOGGLES        (1U + 2U * DEBOUNCE_BOUNCES)
+
+#define GLITCH_PULSES           20U
+#define GLITCH_WIDTH_US         20U
+
+typedef struct {
+    gpio_edge_t edge;
+    uint64_t timestamp_us;
+} edge_report_t;
+
+static edge_report_t edge_reports[EDGE_MAX];
+static _Atomic uint32_t edge_report_count;
+static uint64_t edge_times[EDGE_MAX];
+static uint32_t edge_intervals[EDGE_MAX];
+static _Atomic bool edge_injecting;
+
+static void edge_record(gpio_pin_t pin, gpio_edge_t edge, uint64_t timestamp_us, void *context)
+{
+    uint32_t n = atomic_load_explicit(&edge_report_count, memory_order_relaxed);
+
+    (void)pin;
+    (void)context;
+    if (n < EDGE_MAX) {
+        edge_reports[n].edge = edge;
+        edge_reports[n].timestamp_us = timestamp_us;
+    }
+    atomic_store_explicit(&edge_report_count, n + 1U, memory_order_release);
+}
+
+static void edge_sleep_us(uint64_t us)
+{
+    struct timespec ts = { .tv_sec = (time_t)(us / 1000000U),
+                           .tv_nsec = (long)(us % 1000000U) * 1000L };
+
+    (void)nanosleep(&ts, NULL);
+}
+
+static int edge_compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Arm the pin afresh, starting low */
+static bool edge_enable(uint32_t debounce_us)
+{
+    (void)gpio_driver_disable_edge(EDGE_PIN);
+    posix_gpio_set_input(EDGE_PIN, false);
+    atomic_store(&edge_report_count, 0U);
+    return TEST_CHECK(gpio_driver_enable_edge(EDGE_PIN, GPIO_EDGE_BOTH, debounce_us,
+                                              edge_record, NULL) == ERR_OK);
+}
+
+static void edge_check_counts(const char *name)
+{
+    gpio_edge_stats_t stats;
+
+    TEST_CHECK(gpio_driver_get_edge_stats(EDGE_PIN, &stats) == ERR_OK);
+    TEST_CHECK(stats.accepted + stats.filtered == stats.edges);
+    test_note("%s: %u interrupts, %u accepted, %u filtered, %u missed", name,
+              stats.edges, stats.accepted, stats.filtered, stats.missed);
+}
+
+/* ===== Interrupt Context ===== */
+
+static void edge_irq_train(uint32_t count, uint32_t interval_us)
+{
+    static uint64_t latency[EDGE_MAX];
+    gpio_edge_stats_t stats;
+    uint32_t reports;
+    uint32_t early = 0;
+    uint32_t n = 0;
+    uint32_t next = 0;
+
+    if (!edge_enable(0U)) {
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        edge_intervals[i] = interval_us;
+    }
+    posix_gpio_inject_edges(EDGE_PIN, edge_intervals, count, edge_times);
+    edge_sleep_us(20000U);
+
+    reports = atomic_load_explicit(&edge_report_count, memory_order_acquire);
+    TEST_CHECK(gpio_driver_get_edge_stats(EDGE_PIN, &stats) == ERR_OK);
+    TEST_CHECK(stats.edges > 0U && stats.edges <= count);
+    TEST_CHECK(stats.accepted == stats.edges && stats.filtered == 0U);
+    TEST_CHECK(reports == stats.edges);
+
+    /* Latency from the latest edge at or before each interrupt */
+    for (uint32_t r = 0; r < reports && r < EDGE_MAX; r++) {
+        uint64_t at = edge_reports[r].timestamp_us;
+
+        if (at < edge_times[0]) {
+            early++;
+            continue;
+        }
+        while (next + 1U < count && edge_times[next + 1U] <= at) {
+            next++;
+        }
+        latency[n++] = at - edge_times[next];
+    }
+    TEST_CHECK(early == 0U);
+    if (n > 0U) {
+        qsort(latency, n, sizeof(latency[0]), edge_compare);
+        test_note("irq: %u edges every %u us, %.1f%% lost, latency p50 %llu us, p99 %llu us",
+                  count, interval_us, 100.0 * (double)(count - stats.edges) / count,
+                  (unsigned long long)latency[n / 2U],
+                  (unsigned long long)latency[(n * 99U) / 100U]);
+    }
+    edge_check_counts("irq");
+}
+
+static void edge_irq(void)
+{
+    edge_irq_train(IRQ_SLOW_EDGES, IRQ_SLOW_US);
+    edge_irq_train(IRQ_FAST_EDGES, IRQ_FAST_US);
+}
+
+/* ===== Debounced ===== */
+
+typedef struct {
+    uint32_t bursts;
+    uint32_t toggles;           /* Per burst */
+    uint32_t width_us;          /* Between the toggles of a burst */
+} edge_plan_t;
+
+/* Bursts one call apart, so a late injector only lengthens the gaps */
+static void *edge_injector(void *arg)
+{
+    const edge_plan_t *plan = (const edge_plan_t *)arg;
+    uint32_t intervals[DEBOUNCE_TOGGLES];
+
+    for (uint32_t b = 0; b < plan->bursts; b++) {
+        intervals[0] = DEBOUNCE_GAP_US;
+        for (uint32_t i = 1; i < plan->toggles; i++) {
+            intervals[i] = plan->width_us;
+        }
+        posix_gpio_inject_edges(EDGE_PIN, intervals, plan->toggles,
+                                &edge_times[b * plan->toggles]);
+    }
+    atomic_store(&edge_injecting, false);
+    return NULL;
+}
+
+/* Play the plan while serving gpio_driver_process() like the main loop */
+static void edge_play_debounced(const edge_plan_t *plan)
+{
+    pthread_t injector;
+    uint64_t settle;
+
+    atomic_store(&edge_injecting, true);
+    if (!TEST_CHECK(pthread_create(&injector, NULL, edge_injector, (void *)plan) == 0)) {
+        return;
+    }
+    while (atomic_load(&edge_injecting)) {
+        gpio_driver_process(bsp_time_us());
+        edge_sleep_us(100U);
+    }
+    (void)pthread_join(injector, NULL);
+    settle = bsp_time_us() + 2U * DEBOUNCE_US;
+    while (bsp_time_us() < settle) {
+        gpio_driver_process(bsp_time_us());
+        edge_sleep_us(100U);
+    }
+    TEST_CHECK(gpio_driver_next_deadline_us() == UINT64_MAX);
+}
+
+static void edge_debounce(void)
+{
+    static uint64_t late[DEBOUNCE_TRANSITIONS];
+    const edge_plan_t plan = { DEBOUNCE_TRANSITIONS, DEBOUNCE_TOGGLES, DEBOUNCE_BOUNCE_US };
+    gpio_edge_stats_t stats;
+    uint32_t reports;
+    uint32_t wrong = 0;
+    uint32_t early = 0;
+
+    if (!edge_enable(DEBOUNCE_US)) {
+        return;
+    }
+    edge_play_debounced(&plan);
+
+    reports = atomic_load_explicit(&edge_report_count, memory_order_acquire);
+    TEST_CHECK(reports == DEBOUNCE_TRANSITIONS);
+    for (uint32_t i = 0; i < reports && i < DEBOUNCE_TRANSITIONS; i++) {
+        uint64_t first = edge_times[i * DEBOUNCE_TOGGLES];
+        gpio_edge_t expected = ((i & 1U) == 0U) ? GPIO_EDGE_RISING : GPIO_EDGE_FALLING;
+
+        if (edge_reports[i].edge != expected) {
+            wrong++;
+        }
+        /* Stamped at the burst's first interrupt, not at the settle */
+        if (edge_reports[i].timestamp_us < first) {
+            early++;
+            late[i] = 0;
+        } else {
+            late[i] = edge_reports[i].timestamp_us - first;
+        }
+    }
+    TEST_CHECK(wrong == 0U);
+    TEST_CHECK(early == 0U);
+
+    TEST_CHECK(gpio_driver_get_edge_stats(EDGE_PIN, &stats) == ERR_OK);
+    TEST_CHECK(stats.accepted == DEBOUNCE_TRANSITIONS);
+    TEST_CHECK(stats.edges <= DEBOUNCE_TRANSITIONS * DEBOUNCE_TOGGLES);
+    if (reports == DEBOUNCE_TRANSITIONS) {
+        qsort(late, reports, sizeof(late[0]), edge_compare);
+        TEST_CHECK(late[reports / 2U] < DEBOUNCE_US);
+        test_note("debounce: %u transitions of %u edges, reported %llu us after the first "
+                  "edge (median), %llu us max", DEBOUNCE_TRANSITIONS, DEBOUNCE_TOGGLES,
+                  (unsigned long long)late[reports / 2U],
+                  (unsigned long long)late[reports - 1U]);
+    }
+    edge_check_counts("debounce");
+}
+
+static void edge_glitch(void)
+{
+    const edge_plan_t plan = { GLITCH_PULSES, 2U, GLITCH_WIDTH_US };
+    gpio_edge_stats_t stats;
+
+    if (!edge_enable(DEBOUNCE_US)) {
+        return;
+    }
+    edge_play_debounced(&plan);
+
+    TEST_CHECK(atomic_load(&edge_report_count) == 0U);
+    TEST_CHECK(gpio_driver_get_edge_stats(EDGE_PIN, &stats) == ERR_OK);
+    TEST_CHECK(stats.accepted == 0U);
+    TEST_CHECK(stats.filtered == stats.edges);
+    edge_check_counts("glitch");
+}
+
+int main(void)
+{
+    if (!TEST_CHECK(bsp_time_init() == ERR_OK) || !TEST_CHECK(gpio_driver_init() == ERR_OK)) {
+        return test_report("gpio_edge");
+    }
+    (void)gpio_driver_configure(EDGE_PIN, GPIO_MODE_INPUT);
+    edge_irq();
+    edge_debounce();
+    edge_glitch();
+    (void)gpio_driver_disable_edge(EDGE_PIN);
+    return test_report("gpio_edge");
+}
@@ -0,0 +1,294 @@
+/*
+ * test_mem_pool.c - Memory Pool Fragmentation and Concurrency Test
+ *
+ *   churn       random mem_alloc()/mem_free() of random sizes. An
+ *               allocation fails only when every class that fits is
+ *               full, however long the churn has run; no block overlaps
+ *               another.
+ *   refill      with everything freed, every block of every class can
+ *               be taken again: the pools never fragment.
+ *   threads     several threads allocate, fill, check and free at once;
+ *               nothing is lost or handed out twice.
+ *   cost        one block, and a burst of mixed sizes freed out of
+ *               order, through the pools and through malloc()/free(),
+ *               reported per allocate/free pair.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "test.h"
+#include "../common/mem_pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MEM_TEST_BLOCKS         (MEM_CLASS_0_BLOCKS + MEM_CLASS_1_BLOCKS + MEM_CLASS_2_BLOCKS)
+#define MEM_TEST_CHURN_STEPS    500000U
+#define MEM_TEST_THREADS        4U
+#define MEM_TEST_THREAD_HELD    4U          /* Threads x held <= class 2 blocks */
+#define MEM_TEST_THREAD_STEPS   200000U
+#define MEM_TEST_COST_SIZE      100U        /* Class 1 */
+#define MEM_TEST_COST_PAIRS     1000000U
+#define MEM_TEST_BURST          16U
+
+typedef struct {
+    uint8_t *block;
+    uint32_t size;
+    uint8_t fill;
+} mem_test_block_t;
+
+static const uint32_t class_sizes[MEM_CLASS_COUNT] = {
+    MEM_CLASS_0_SIZE, MEM_CLASS_1_SIZE, MEM_CLASS_2_SIZE
+};
+
+static uint32_t mem_test_random(uint32_t *seed)
+{
+    *seed = *seed * 1103515245U + 12345U;
+    return *seed >> 8;
+}
+
+static void mem_test_fill(mem_test_block_t *held, uint8_t fill)
+{
+    held->fill = fill;
+    memset(held->block, fill, held->size);
+}
+
+static bool mem_test_intact(const mem_test_block_t *held)
+{
+    for (uint32_t i = 0; i < held->size; i++) {
+        if (held->block[i] != held->fill) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* True if some class that fits size has a free block */
+static bool mem_test_fits(uint32_t size)
+{
+    for (uint32_t i = 0; i < MEM_CLASS_COUNT; i++) {
+        mem_pool_stats_t stats;
+
+        (void)mem_get_class_stats(i, &stats);
+        if (size <= class_sizes[i] && stats.in_use < stats.block_count) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool mem_test_all_free(void)
+{
+    for (uint32_t i = 0; i < MEM_CLASS_COUNT; i++) {
+        mem_pool_stats_t stats;
+
+        (void)mem_get_class_stats(i, &stats);
+        if (stats.in_use != 0U) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ===== Churn ===== */
+
+static void mem_test_churn(void)
+{
+    static mem_test_block_t held[MEM_TEST_BLOCKS];
+    uint32_t count = 0;
+    uint32_t refused = 0;
+    uint32_t seed = 1U;
+
+    for (uint32_t step = 0; step < MEM_TEST_CHURN_STEPS; step++) {
+        uint32_t r = mem_test_random(&seed);
+
+        /* Slightly more allocations than frees keeps the pools near full */
+        if (count == 0U || (r % 16U) < 9U) {
+            uint32_t size = 1U + mem_test_random(&seed) % MEM_CLASS_2_SIZE;
+            bool fits = mem_test_fits(size);
+            uint8_t *block = (uint8_t *)mem_alloc(size);
+
+            TEST_CHECK((block != NULL) == fits);
+            if (block == NULL) {
+                refused++;
+                continue;
+            }
+            TEST_CHECK(((uintptr_t)block % MEM_POOL_ALIGN) == 0U);
+            held[count].block = block;
+            held[count].size = size;
+            mem_test_fill(&held[count], (uint8_t)step);
+            count++;
+        } else {
+            uint32_t victim = mem_test_random(&seed) % count;
+
+            TEST_CHECK(mem_test_intact(&held[victim]));
+            TEST_CHECK(mem_free(held[victim].block) == ERR_OK);
+            held[victim] = held[--count];
+        }
+    }
+
+    /* A block freed twice is refused */
+    if (count > 0U) {
+        TEST_CHECK(mem_free(held[0].block) == ERR_OK);
+        TEST_CHECK(mem_free(held[0].block) == ERR_INVALID_PARAM);
+        held[0] = held[--count];
+    }
+    while (count > 0U) {
+        TEST_CHECK(mem_test_intact(&held[count - 1U]));
+        TEST_CHECK(mem_free(held[--count].block) == ERR_OK);
+    }
+    TEST_CHECK(mem_test_all_free());
+    test_note("churn: %u steps, %u allocations refused (all with the fitting classes full)",
+              MEM_TEST_CHURN_STEPS, refused);
+}
+
+/* ===== Refill ===== */
+
+static void mem_test_refill(void)
+{
+    static void *blocks[MEM_TEST_BLOCKS];
+    uint32_t count = 0;
+
+    /* Largest class first, so no request falls back into a bigger class */
+    for (uint32_t i = MEM_CLASS_COUNT; i-- > 0U;) {
+        mem_pool_stats_t stats;
+
+        (void)mem_get_class_stats(i, &stats);
+        for (uint32_t j = 0; j < stats.block_count; j++) {
+            blocks[count] = mem_alloc(class_sizes[i]);
+            TEST_CHECK(blocks[count] != NULL);
+            count++;
+        }
+        (void)mem_get_class_stats(i, &stats);
+        TEST_CHECK(stats.in_use == stats.block_count);
+    }
+    TEST_CHECK(count == MEM_TEST_BLOCKS);
+    TEST_CHECK(mem_alloc(1U) == NULL);
+
+    while (count > 0U) {
+        TEST_CHECK(mem_free(blocks[--count]) == ERR_OK);
+    }
+    TEST_CHECK(mem_test_all_free());
+}
+
+/* ===== Threads ===== */
+
+static void *mem_test_thread(void *arg)
+{
+    mem_test_block_t held[MEM_TEST_THREAD_HELD] = { { 0 } };
+    uint32_t seed = 1U + (uint32_t)(uintptr_t)arg;
+
+    for (uint32_t step = 0; step < MEM_TEST_THREAD_STEPS; step++) {
+        mem_test_block_t *slot = &held[step % MEM_TEST_THREAD_HELD];
+
+        if (slot->block != NULL) {
+            TEST_CHECK(mem_test_intact(slot));
+            TEST_CHECK(mem_free(slot->block) == ERR_OK);
+        }
+        slot->size = 1U + mem_test_random(&seed) % MEM_CLASS_2_SIZE;
+        slot->block = (uint8_t *)mem_alloc(slot->size);
+        if (TEST_CHECK(slot->block != NULL)) {
+            mem_test_fill(slot, (uint8_t)(seed ^ step));
+        }
+    }
+    for (uint32_t i = 0; i < MEM_TEST_THREAD_HELD; i++) {
+        if (held[i].block != NULL) {
+            TEST_CHECK(mem_test_intact(&held[i]));
+            TEST_CHECK(mem_free(held[i].block) == ERR_OK);
+        }
+    }
+    return NULL;
+}
+
+static void mem_test_threads(void)
+{
+    pthread_t threads[MEM_TEST_THREADS];
+    uint64_t start = test_now_ns();
+
+    for (uint32_t i = 0; i < MEM_TEST_THREADS; i++) {
+        TEST_CHECK(pthread_create(&threads[i], NULL, mem_test_thread, (void *)(uintptr_t)i) == 0);
+    }
+    for (uint32_t i = 0; i < MEM_TEST_THREADS; i++) {
+        (void)pthread_join(threads[i], NULL);
+    }
+    TEST_CHECK(mem_test_all_free());
+    test_note("threads: %u x %u alloc/free in %.1f ms", MEM_TEST_THREADS,
+              MEM_TEST_THREAD_STEPS, (double)(test_now_ns() - start) / 1e6);
+}
+
+/* ===== Cost ===== */
+
+/* The pointers go to a volatile sink so the compiler cannot pair a
+ * malloc() with its free() and drop both */
+static volatile uintptr_t mem_test_sink;
+
+static const uint32_t mem_test_burst_sizes[MEM_TEST_BURST] = {
+    24U, 100U, 400U, 8U, 128U, 32U, 60U, 512U, 16U, 90U, 300U, 32U, 120U, 4U, 200U, 64U
+};
+
+static double mem_test_time_single(bool pool)
+{
+    uint64_t start = test_now_ns();
+
+    for (uint32_t i = 0; i < MEM_TEST_COST_PAIRS; i++) {
+        void *block = pool ? mem_alloc(MEM_TEST_COST_SIZE) : malloc(MEM_TEST_COST_SIZE);
+
+        mem_test_sink = (uintptr_t)block;
+        if (pool) {
+            (void)mem_free(block);
+        } else {
+            free(block);
+        }
+    }
+    return (double)(test_now_ns() - start) / MEM_TEST_COST_PAIRS;
+}
+
+static double mem_test_time_burst(bool pool)
+{
+    void *blocks[MEM_TEST_BURST];
+    uint32_t rounds = MEM_TEST_COST_PAIRS / MEM_TEST_BURST;
+    uint64_t start = test_now_ns();
+
+    for (uint32_t i = 0; i < rounds; i++) {
+        for (uint32_t j = 0; j < MEM_TEST_BURST; j++) {
+            blocks[j] = pool ? mem_alloc(mem_test_burst_sizes[j]) : malloc(mem_test_burst_sizes[j]);
+            mem_test_sink = (uintptr_t)blocks[j];
+        }
+        for (uint32_t j = 0; j < MEM_TEST_BURST; j++) {
+            void *block = blocks[(j * 7U) % MEM_TEST_BURST];
+
+            if (pool) {
+                (void)mem_free(block);
+            } else {
+                free(block);
+            }
+        }
+    }
+    return (double)(test_now_ns() - start) / (rounds * MEM_TEST_BURST);
+}
+
+static void mem_test_cost(void)
+{
+    double pool_single = mem_test_time_single(true);
+    double heap_single = mem_test_time_single(false);
+    double pool_burst = mem_test_time_burst(true);
+    double heap_burst = mem_test_time_burst(false);
+
+    TEST_CHECK(mem_test_all_free());
+    test_note("cost: one %u-byte block %.1f ns (malloc %.1f ns), burst of %u %.1f ns (malloc %.1f ns) per pair",
+              MEM_TEST_COST_SIZE, pool_single, heap_single, MEM_TEST_BURST, pool_burst, heap_burst);
+}
+
+int main(void)
+{
+    if (!TEST_CHECK(mem_init() == ERR_OK)) {
+        return test_report("mem_pool");
+    }
+    mem_test_churn();
+    mem_test_refill();
+    mem_test_threads();
+    mem_test_refill();
+    mem_test_cost();
+    return test_report("mem_pool");
+}
@@ -0,0 +1,404 @@
+/*
+ * test_packet.c - COBS, CRC and Packet Framing Test
+ *
+ *   cobs     round trips of every length up to two full blocks, with and
+ *            without zeros; the edge cases by their exact encoding (a
+ *            254-byte run, a trailing zero); a frame fed in two spans at
+ *            every split point and a byte at a time; truncated, empty
+ *            and oversize frames.
+ *   crc      the catalogue check values of CRC-16/X-25 and CRC-32, and
+ *            the same result whatever the alignment and span split.
+ *   packet   packet_encode() into packet_decoder_feed(), whole and byte
+ *            by byte, for both CRCs; a flipped bit is counted, not
+ *            delivered.
+ *   speed    the CRC kernels over 4 KiB in bytes per cycle (TSC on x86
+ *            hosts), and full-size frames through the packet layer in
+ *            each direction in frames per second.
+ */
+
+#include "test.h"
+#include "../common/cobs.h"
+#include "../common/crc.h"
+#include "../common/profile.h"
+#include "../drivers/packet.h"
+
+#include <string.h>
+
+#define COBS_TEST_MAX           600U
+#define COBS_TEST_BUFFER        (COBS_ENCODED_MAX(COBS_TEST_MAX) + 1U)
+#define SPEED_CRC_LENGTH        4096U
+#define SPEED_CRC_ROUNDS        256U
+#define SPEED_FRAMES            20000U
+
+static uint32_t test_seed = 1U;
+
+static uint8_t test_random(void)
+{
+    test_seed = test_seed * 1103515245U + 12345U;
+    return (uint8_t)(test_seed >> 16);
+}
+
+/* ===== COBS ===== */
+
+static uint32_t cobs_encode(const uint8_t *data, uint32_t length, uint8_t *out,
+                            uint32_t capacity)
+{
+    cobs_encoder_t enc;
+
+    cobs_encode_begin(&enc, out, capacity);
+    cobs_encode_update(&enc, data, length);
+    return cobs_encode_end(&enc);
+}
+
+/* Feed encoded[] in spans of at most step bytes (the first split at
+ * first); true if exactly one frame came out, equal to expected */
+static bool cobs_decode_split(const uint8_t *encoded, uint32_t encoded_length, uint32_t first,
+                              uint32_t step, const uint8_t *expected, uint32_t expected_length)
+{
+    uint8_t buffer[COBS_TEST_MAX];
+    cobs_decoder_t dec;
+    uint32_t frames = 0;
+    bool match = false;
+    uint32_t pos = 0;
+
+    cobs_decoder_init(&dec, buffer, sizeof(buffer));
+    while (pos < encoded_length) {
+        uint32_t span = (pos == 0U && first > 0U) ? first : step;
+        bool complete;
+        cobs_frame_status_t status;
+
+        if (span > encoded_length - pos) {
+            span = encoded_length - pos;
+        }
+        pos += cobs_decoder_feed(&dec, &encoded[pos], span, &complete, &status);
+        if (complete) {
+            frames++;
+            match = status == COBS_FRAME_OK && dec.length == expected_length &&
+                    memcmp(buffer, expected, expected_length) == 0;
+        }
+    }
+    return frames == 1U && match;
+}
+
+static void cobs_round_trips(void)
+{
+    static uint8_t data[COBS_TEST_MAX];
+    static uint8_t encoded[COBS_TEST_BUFFER];
+
+    for (uint32_t zeros = 0; zeros < 3U; zeros++) {
+        for (uint32_t length = 1; length <= 2U * 254U + 2U; length++) {
+            uint32_t encoded_length;
+
+            for (uint32_t i = 0; i < length; i++) {
+                /* No zeros, a few, or mostly zeros */
+                uint8_t byte = test_random();
+
+                data[i] = (zeros == 0U) ? (uint8_t)(byte | 1U) :
+                          (zeros == 1U) ? (((byte & 0x0FU) == 0U) ? 0U : byte) :
+                                          (uint8_t)(byte & 0x01U);
+            }
+            encoded_length = cobs_encode(data, length, encoded, sizeof(encoded));
+            TEST_CHECK(encoded_length > length && encoded_length <= COBS_ENCODED_MAX(length) + 1U);
+            TEST_CHECK(memchr(encoded, 0, encoded_length - 1U) == NULL);
+            TEST_CHECK(encoded[encoded_length - 1U] == COBS_DELIMITER);
+            TEST_CHECK(cobs_decode_split(encoded, encoded_length, 0U, encoded_length,
+                                         data, length));
+        }
+    }
+}
+
+static void cobs_zero_cases(void)
+{
+    static const uint8_t trailing_zero[] = { 0x11, 0x22, 0x00 };
+    static const uint8_t trailing_zero_encoded[] = { 0x03, 0x11, 0x22, 0x01, 0x00 };
+    static const uint8_t only_zero[] = { 0x00 };
+    static const uint8_t only_zero_encoded[] = { 0x01, 0x01, 0x00 };
+    uint8_t encoded[16];
+    uint32_t length;
+
+    /* A trailing zero still gets its own (empty) block */
+    length = cobs_encode(trailing_zero, sizeof(trailing_zero), encoded, sizeof(encoded));
+    TEST_CHECK(length == sizeof(trailing_zero_encoded) &&
+               memcmp(encoded, trailing_zero_encoded, length) == 0);
+    TEST_CHECK(cobs_decode_split(encoded, length, 0U, length, trailing_zero,
+                                 sizeof(trailing_zero)));
+
+    length = cobs_encode(only_zero, sizeof(only_zero), encoded, sizeof(encoded));
+    TEST_CHECK(length == sizeof(only_zero_encoded) &&
+               memcmp(encoded, only_zero_encoded, length) == 0);
+    TEST_CHECK(cobs_decode_split(encoded, length, 0U, length, only_zero, sizeof(only_zero)));
+}
+
+static void cobs_run_cases(void)
+{
+    uint8_t run[255];
+    uint8_t encoded[COBS_TEST_BUFFER];
+    uint8_t split[COBS_TEST_BUFFER];
+    cobs_encoder_t enc;
+    uint32_t length;
+
+    for (uint32_t i = 0; i < sizeof(run); i++) {
+        run[i] = (uint8_t)(i + 1U);
+    }
+
+    /* 254 non-zero bytes fill one block exactly: code 0xFF, no zero
+     * implied after it */
+    length = cobs_encode(run, 254U, encoded, sizeof(encoded));
+    TEST_CHECK(encoded[0] == 0xFFU && memcmp(&encoded[1], run, 254U) == 0);
+    TEST_CHECK(length <= COBS_ENCODED_MAX(254U) + 1U);
+    TEST_CHECK(cobs_decode_split(encoded, length, 0U, length, run, 254U));
+
+    /* The same run followed by a zero: the zero opens a new block */
+    run[254] = 0U;
+    length = cobs_encode(run, 255U, encoded, sizeof(encoded));
+    TEST_CHECK(encoded[0] == 0xFFU);
+    TEST_CHECK(cobs_decode_split(encoded, length, 0U, length, run, 255U));
+
+    /* Encoding in two spans that meet inside the run changes nothing */
+    cobs_encode_begin(&enc, split, sizeof(split));
+    cobs_encode_update(&enc, run, 100U);
+    cobs_encode_update(&enc, &run[100], 254U - 100U);
+    length = cobs_encode(run, 254U, encoded, sizeof(encoded));
+    TEST_CHECK(cobs_encode_end(&enc) == length && memcmp(split, encoded, length) == 0);
+
+    /* Too small an output buffer: nothing usable */
+    TEST_CHECK(cobs_encode(run, 254U, encoded, 254U) == 0U);
+}
+
+static void cobs_split_feeds(void)
+{
+    uint8_t data[300];
+    uint8_t encoded[COBS_TEST_BUFFER];
+    uint32_t length;
+
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = ((i % 37U) == 5U) ? 0U : (uint8_t)(i | 1U);
+    }
+    length = cobs_encode(data, sizeof(data), encoded, sizeof(encoded));
+
+    /* Every split point, through code bytes and long runs alike */
+    for (uint32_t first = 1; first < length; first++) {
+        TEST_CHECK(cobs_decode_split(encoded, length, first, length, data, sizeof(data)));
+    }
+    TEST_CHECK(cobs_decode_split(encoded, length, 0U, 1U, data, sizeof(data)));
+    TEST_CHECK(cobs_decode_split(encoded, length, 0U, 7U, data, sizeof(data)));
+}
+
+static void cobs_bad_frames(void)
+{
+    static const uint8_t stream[] = {
+        0x00,                           /* Idle fill */
+        0x05, 0x11, 0x22, 0x00,         /* Cut short inside a block */
+        0x03, 0x33, 0x44, 0x00          /* Good frame: 33 44 */
+    };
+    static const cobs_frame_status_t expected[] = {
+        COBS_FRAME_EMPTY, COBS_FRAME_CORRUPT, COBS_FRAME_OK
+    };
+    uint8_t buffer[8];
+    uint8_t oversize[20];
+    uint8_t encoded[32];
+    uint32_t length;
+    cobs_decoder_t dec;
+    bool complete;
+    cobs_frame_status_t status;
+    uint32_t pos = 0;
+    uint32_t frames = 0;
+
+    cobs_decoder_init(&dec, buffer, sizeof(buffer));
+    while (pos < sizeof(stream)) {
+        pos += cobs_decoder_feed(&dec, &stream[pos], sizeof(stream) - pos, &complete, &status);
+        if (complete && TEST_CHECK(frames < 3U)) {
+            TEST_CHECK(status == expected[frames]);
+            frames++;
+        }
+    }
+    TEST_CHECK(frames == 3U);
+    TEST_CHECK(dec.length == 2U && buffer[0] == 0x33U && buffer[1] == 0x44U);
+
+    /* Longer than the buffer: reported, and the next frame is fine */
+    memset(oversize, 0x55, sizeof(oversize));
+    length = cobs_encode(oversize, sizeof(oversize), encoded, sizeof(encoded));
+    (void)cobs_decoder_feed(&dec, encoded, length, &complete, &status);
+    TEST_CHECK(complete && status == COBS_FRAME_OVERFLOW);
+    (void)cobs_decoder_feed(&dec, &stream[5], 4U, &complete, &status);
+    TEST_CHECK(complete && status == COBS_FRAME_OK && dec.length == 2U);
+}
+
+/* ===== CRC ===== */
+
+static void crc_check_values(void)
+{
+    static const uint8_t check[] = "123456789";
+    uint8_t data[64 + 8];
+
+    TEST_CHECK(crc16_update(0, check, 9U) == 0x906EU);
+    TEST_CHECK(crc32_update(0, check, 9U) == 0xCBF43926UL);
+
+    /* Slice kernels at every alignment and split agree with one pass */
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = test_random();
+    }
+    for (uint32_t offset = 0; offset < 8U; offset++) {
+        uint16_t crc16 = crc16_update(0, &data[offset], 64U);
+        uint32_t crc32 = crc32_update(0, &data[offset], 64U);
+
+        for (uint32_t split = 0; split <= 64U; split += 7U) {
+            TEST_CHECK(crc16_update(crc16_update(0, &data[offset], split),
+                                    &data[offset + split], 64U - split) == crc16);
+            TEST_CHECK(crc32_update(crc32_update(0, &data[offset], split),
+                                    &data[offset + split], 64U - split) == crc32);
+        }
+    }
+}
+
+/* ===== Packet ===== */
+
+static uint8_t received[PACKET_MAX_PAYLOAD];
+static uint16_t received_length;
+static uint32_t received_frames;
+
+static void packet_received(const uint8_t *payload, uint16_t length, void *context)
+{
+    (void)context;
+    memcpy(received, payload, length);
+    received_length = length;
+    received_frames++;
+}
+
+static void packet_round_trips(packet_crc_t crc)
+{
+    uint8_t payload[PACKET_MAX_PAYLOAD];
+    uint8_t frame[PACKET_FRAME_MAX];
+    packet_decoder_t dec;
+
+    TEST_CHECK(packet_decoder_init(&dec, crc, packet_received, NULL) == ERR_OK);
+    for (uint32_t length = 0; length <= PACKET_MAX_PAYLOAD; length += 17U) {
+        uint32_t frame_length;
+
+        for (uint32_t i = 0; i < length; i++) {
+            payload[i] = ((i % 11U) == 3U) ? 0U : test_random();
+        }
+        frame_length = packet_encode(crc, payload, (uint16_t)length, frame, sizeof(frame));
+        if (!TEST_CHECK(frame_length > 0U && frame_length <= PACKET_FRAME_MAX)) {
+            continue;
+        }
+
+        /* Whole, then a byte at a time */
+        received_frames = 0;
+        packet_decoder_feed(&dec, frame, frame_length);
+        for (uint32_t i = 0; i < frame_length; i++) {
+            packet_decoder_feed(&dec, &frame[i], 1U);
+        }
+        TEST_CHECK(received_frames == 2U && received_length == length &&
+                   memcmp(received, payload, length) == 0);
+
+        /* One flipped bit (kept non-zero so COBS framing survives) */
+        if (frame_length > 3U && frame[1] != 0x01U) {
+            frame[1] ^= 0x01U;
+            received_frames = 0;
+            packet_decoder_feed(&dec, frame, frame_length);
+            TEST_CHECK(received_frames == 0U);
+        }
+    }
+    TEST_CHECK(dec.stats.rx_crc_errors > 0U);
+    TEST_CHECK(packet_encode(crc, payload, PACKET_MAX_PAYLOAD + 1U, frame, sizeof(frame)) == 0U);
+}
+
+/* ===== Speed ===== */
+
+static volatile uint32_t speed_sink;
+
+static void speed_frame_received(const uint8_t *payload, uint16_t length, void *context)
+{
+    (void)context;
+    speed_sink = (uint32_t)payload[0] + length;
+}
+
+static void speed_crc(void)
+{
+    static uint8_t data[SPEED_CRC_LENGTH];
+    double total = (double)SPEED_CRC_LENGTH * SPEED_CRC_ROUNDS;
+    uint32_t cycles16;
+    uint32_t cycles32;
+    uint64_t ns16;
+    uint64_t ns32;
+    uint64_t t0;
+    uint32_t c0;
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < SPEED_CRC_LENGTH; i++) {
+        data[i] = test_random();
+    }
+    t0 = test_now_ns();
+    c0 = profile_cycles();
+    for (uint32_t i = 0; i < SPEED_CRC_ROUNDS; i++) {
+        sum += crc16_update(0, data, SPEED_CRC_LENGTH);
+    }
+    cycles16 = profile_cycles() - c0;
+    ns16 = test_now_ns() - t0;
+
+    t0 = test_now_ns();
+    c0 = profile_cycles();
+    for (uint32_t i = 0; i < SPEED_CRC_ROUNDS; i++) {
+        sum += crc32_update(0, data, SPEED_CRC_LENGTH);
+    }
+    cycles32 = profile_cycles() - c0;
+    ns32 = test_now_ns() - t0;
+    speed_sink = sum;
+
+    test_note("crc16: %.2f bytes/cycle, %.0f MB/s; crc32: %.2f bytes/cycle, %.0f MB/s",
+              total / cycles16, total * 1e3 / (double)ns16,
+              total / cycles32, total * 1e3 / (double)ns32);
+}
+
+static void speed_frames(void)
+{
+    static uint8_t payload[PACKET_MAX_PAYLOAD];
+    static uint8_t frame[PACKET_FRAME_MAX];
+    packet_decoder_t dec;
+    uint32_t frame_length = 0;
+    uint64_t encode_ns;
+    uint64_t decode_ns;
+    uint64_t t0;
+
+    /* A zero every few bytes, as sensor data has */
+    for (uint32_t i = 0; i < PACKET_MAX_PAYLOAD; i++) {
+        payload[i] = ((i % 5U) == 0U) ? 0U : (uint8_t)(test_random() | 1U);
+    }
+    t0 = test_now_ns();
+    for (uint32_t i = 0; i < SPEED_FRAMES; i++) {
+        frame_length = packet_encode(PACKET_CRC32, payload, PACKET_MAX_PAYLOAD, frame,
+                                     sizeof(frame));
+    }
+    encode_ns = test_now_ns() - t0;
+    if (!TEST_CHECK(frame_length != 0U) ||
+        !TEST_CHECK(packet_decoder_init(&dec, PACKET_CRC32, speed_frame_received, NULL) == ERR_OK)) {
+        return;
+    }
+    t0 = test_now_ns();
+    for (uint32_t i = 0; i < SPEED_FRAMES; i++) {
+        packet_decoder_feed(&dec, frame, frame_length);
+    }
+    decode_ns = test_now_ns() - t0;
+    TEST_CHECK(dec.stats.rx_frames == SPEED_FRAMES);
+
+    test_note("frames (%u-byte payload, CRC-32): encode %.0f k/s, decode %.0f k/s",
+              PACKET_MAX_PAYLOAD, SPEED_FRAMES * 1e6 / (double)encode_ns,
+              SPEED_FRAMES * 1e6 / (double)decode_ns);
+}
+
+int main(void)
+{
+    crc_init();
+    cobs_round_trips();
+    cobs_zero_cases();
+    cobs_run_cases();
+    cobs_split_feeds();
+    cobs_bad_frames();
+    crc_check_values();
+    packet_round_trips(PACKET_CRC16);
+    packet_round_trips(PACKET_CRC32);
+    speed_crc();
+    speed_frames();
+    return test_report("packet");
+}
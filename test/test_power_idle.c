@@ -0,0 +1,103 @@
+/*
+ * test_power_idle.c - Idle Application Power Test
+ *
+ * Runs the firmware's main loop (main.c) with nothing to do and checks
+ * that it spends the gaps in Stop, not in a Sleep held short by some
+ * periodic poll:
+ *
+ *   idle     the loop reaches POWER_MODE_STOP: no timer (such as a
+ *            UART timeout poll) keeps the next wakeup too close.
+ *   console  bytes sent to the console still end in an RX idle
+ *            timeout, after which the loop goes back to Stop.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "test.h"
+#include "../app/app.h"
+#include "../bsp/board_config.h"
+#include "../bsp/bsp_power.h"
+#include "../common/scheduler.h"
+#include "../drivers/uart_driver.h"
+#include "../hal/hal_uart_posix.h"
+
+#include <unistd.h>
+
+#define IDLE_RUN_NS             1000000000ULL
+#define CONSOLE_WAIT_NS         500000000ULL
+
+/* One pass of the main.c loop */
+static void idle_loop_once(void)
+{
+    (void)app_run();
+    (void)bsp_power_idle_until(app_next_wakeup_us(), sched_events_pending, NULL);
+}
+
+static void idle_loop_for(uint64_t duration_ns)
+{
+    uint64_t start = test_now_ns();
+
+    while (test_now_ns() - start < duration_ns) {
+        idle_loop_once();
+    }
+}
+
+/* ===== Idle ===== */
+
+static void power_idle(void)
+{
+    power_stats_t stats;
+
+    bsp_power_reset_stats();
+    idle_loop_for(IDLE_RUN_NS);
+    bsp_power_get_stats(&stats);
+
+    TEST_CHECK(stats.entries[POWER_MODE_STOP] > 0U);
+    test_note("idle: %u stops, %u sleeps in %.0f ms; %.1f ms in Stop",
+              stats.entries[POWER_MODE_STOP], stats.entries[POWER_MODE_SLEEP],
+              (double)IDLE_RUN_NS / 1e6, (double)stats.residency_us[POWER_MODE_STOP] / 1e3);
+}
+
+/* ===== Console ===== */
+
+static void power_console(void)
+{
+    static const uint8_t line[] = "health\r";
+    int fd = posix_uart_get_peer_fd(CONSOLE_UART);
+    uart_driver_stats_t before;
+    uart_driver_stats_t after;
+    power_stats_t stats;
+    uint64_t start;
+    uint64_t reported;
+
+    (void)uart_driver_get_stats(CONSOLE_UART, &before);
+    TEST_CHECK(write(fd, line, sizeof(line) - 1U) == (ssize_t)(sizeof(line) - 1U));
+
+    start = test_now_ns();
+    do {
+        idle_loop_once();
+        (void)uart_driver_get_stats(CONSOLE_UART, &after);
+    } while (after.rx_timeouts == before.rx_timeouts && test_now_ns() - start < CONSOLE_WAIT_NS);
+    reported = test_now_ns() - start;
+    TEST_CHECK(after.rx_bytes - before.rx_bytes == sizeof(line) - 1U);
+    TEST_CHECK(after.rx_timeouts == before.rx_timeouts + 1U);
+
+    /* The reply drains, the poll parks and the loop stops again */
+    bsp_power_reset_stats();
+    idle_loop_for(IDLE_RUN_NS / 2U);
+    bsp_power_get_stats(&stats);
+    TEST_CHECK(stats.entries[POWER_MODE_STOP] > 0U);
+    test_note("console: RX idle reported after %.1f ms; %u stops after it",
+              (double)reported / 1e6, stats.entries[POWER_MODE_STOP]);
+}
+
+int main(void)
+{
+    if (!TEST_CHECK(app_init() == ERR_OK) || !TEST_CHECK(app_start() == ERR_OK)) {
+        return test_report("power_idle");
+    }
+    power_idle();
+    power_console();
+    app_stop();
+    return test_report("power_idle");
+}
@@ -0,0 +1,249 @@
+/*
+ * test_sw_timer.c - Timing Wheel Test and Benchmark
+ *
+ * 10k timers on the wheel at once:
+ *
+ *   exact   random delays up to twice the directly placed range,
+ *           starting just before the 32-bit tick wrap, a quarter of
+ *           them cancelled; processed one tick at a time, every armed
+ *           timer fires once, on its expiry tick, and no cancelled one
+ *           fires.
+ *   skips   the same with ticks skipped as after tickless idle: each
+ *           timer fires on the first processed tick at or past its
+ *           expiry.
+ *   sleep   the same, each time sleeping exactly sw_timer_ticks_to_next()
+ *           ticks: that is always the earliest pending expiry, on any
+ *           wheel, and every timer fires on its expiry tick.
+ *   cost    arming and cancelling all 10k (random delays up to 1 h of
+ *           ms ticks, so all four wheels are used) and expiring them,
+ *           reported per timer as the median of several rounds.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "test.h"
+#include "../common/sw_timer.h"
+
+#include <stdlib.h>
+
+#define TIMER_COUNT             10000U
+#define TIMER_EXACT_RANGE       (1UL << 25)
+#define TIMER_SKIP_MAX          4096U
+#define TIMER_BENCH_RANGE       3600000U
+#define TIMER_EXPIRE_RANGE      4096U
+#define TIMER_ROUNDS            15U
+
+static sw_timer_t timers[TIMER_COUNT];
+static uint32_t timer_due[TIMER_COUNT];
+static uint32_t timer_fired_at[TIMER_COUNT];
+static uint32_t timer_fires[TIMER_COUNT];
+static uint32_t timer_now;
+static uint32_t timer_rng = 0x2545F491U;
+
+static uint32_t timer_random(void)
+{
+    timer_rng ^= timer_rng << 13;
+    timer_rng ^= timer_rng >> 17;
+    timer_rng ^= timer_rng << 5;
+    return timer_rng;
+}
+
+static void timer_record(sw_timer_t *timer, void *context)
+{
+    uint32_t index = (uint32_t)(uintptr_t)context;
+
+    (void)timer;
+    timer_fired_at[index] = timer_now;
+    timer_fires[index]++;
+}
+
+static void timer_count(sw_timer_t *timer, void *context)
+{
+    (void)timer;
+    (void)context;
+    timer_fires[0]++;
+}
+
+/* Arm every timer at a random delay from start, cancel every fourth */
+static void timer_arm_all(uint32_t start, uint32_t range)
+{
+    sw_timer_init(start);
+    timer_now = start;
+    for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+        uint32_t delay = timer_random() % range;
+
+        (void)sw_timer_setup(&timers[i], timer_record, (void *)(uintptr_t)i);
+        (void)sw_timer_start(&timers[i], delay, 0U);
+        timer_due[i] = start + ((delay == 0U) ? 1U : delay);
+        timer_fires[i] = 0;
+    }
+    for (uint32_t i = 0; i < TIMER_COUNT; i += 4U) {
+        (void)sw_timer_stop(&timers[i]);
+    }
+}
+
+/* ===== Exact ===== */
+
+static void timer_exact(void)
+{
+    uint32_t start = 0xFFFFFFFFU - (1UL << 24);
+    uint32_t wrong = 0;
+
+    timer_arm_all(start, TIMER_EXACT_RANGE);
+    while (timer_now - start <= TIMER_EXACT_RANGE) {
+        timer_now++;
+        sw_timer_process(timer_now);
+    }
+    for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+        bool cancelled = (i % 4U) == 0U;
+
+        if (cancelled ? (timer_fires[i] != 0U)
+                      : (timer_fires[i] != 1U || timer_fired_at[i] != timer_due[i])) {
+            wrong++;
+        }
+    }
+    TEST_CHECK(wrong == 0U);
+    TEST_CHECK(sw_timer_ticks_to_next() == UINT32_MAX);
+}
+
+/* ===== Skipped Ticks ===== */
+
+static void timer_skips(void)
+{
+    uint32_t start = 0xFFFFFFFFU - (1UL << 24);
+    uint32_t wrong = 0;
+    uint32_t steps = 0;
+
+    timer_arm_all(start, TIMER_EXACT_RANGE);
+    while (timer_now - start <= TIMER_EXACT_RANGE) {
+        timer_now += 1U + timer_random() % TIMER_SKIP_MAX;
+        sw_timer_process(timer_now);
+        steps++;
+    }
+    for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+        bool cancelled = (i % 4U) == 0U;
+        uint32_t late = timer_fired_at[i] - timer_due[i];
+
+        if (cancelled ? (timer_fires[i] != 0U)
+                      : (timer_fires[i] != 1U || late >= TIMER_SKIP_MAX)) {
+            wrong++;
+        }
+    }
+    TEST_CHECK(wrong == 0U);
+    test_note("skips: %u process calls over %lu ticks", steps, TIMER_EXACT_RANGE);
+}
+
+/* ===== Sleeping To The Next Expiry ===== */
+
+static uint32_t timer_earliest_pending(void)
+{
+    uint32_t earliest = UINT32_MAX;
+
+    for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+        if ((i % 4U) != 0U && timer_fires[i] == 0U && timer_due[i] - timer_now < earliest) {
+            earliest = timer_due[i] - timer_now;
+        }
+    }
+    return earliest;
+}
+
+static void timer_sleep(void)
+{
+    uint32_t start = 0xFFFFFFFFU - (1UL << 24);
+    uint32_t wrong = 0;
+    uint32_t wakes = 0;
+    uint32_t ticks;
+
+    timer_arm_all(start, TIMER_EXACT_RANGE);
+    while ((ticks = sw_timer_ticks_to_next()) != UINT32_MAX) {
+        if (ticks != timer_earliest_pending()) {
+            wrong++;
+            break;
+        }
+        timer_now += ticks;
+        sw_timer_process(timer_now);
+        wakes++;
+    }
+    for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+        bool cancelled = (i % 4U) == 0U;
+
+        if (cancelled ? (timer_fires[i] != 0U)
+                      : (timer_fires[i] != 1U || timer_fired_at[i] != timer_due[i])) {
+            wrong++;
+        }
+    }
+    TEST_CHECK(wrong == 0U);
+    test_note("sleep: %u wake-ups for %u timers", wakes, TIMER_COUNT - TIMER_COUNT / 4U);
+}
+
+/* ===== Cost ===== */
+
+static int timer_compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static double timer_median_per_timer(uint64_t *ns)
+{
+    qsort(ns, TIMER_ROUNDS, sizeof(ns[0]), timer_compare);
+    return (double)ns[TIMER_ROUNDS / 2U] / TIMER_COUNT;
+}
+
+static void timer_cost(void)
+{
+    static uint32_t delays[TIMER_COUNT];
+    uint64_t start_ns[TIMER_ROUNDS];
+    uint64_t stop_ns[TIMER_ROUNDS];
+    uint64_t expire_ns[TIMER_ROUNDS];
+
+    for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+        (void)sw_timer_setup(&timers[i], timer_count, NULL);
+    }
+    for (uint32_t round = 0; round < TIMER_ROUNDS; round++) {
+        uint64_t t0;
+
+        /* Fresh delays each round, so the slots are not all cached */
+        for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+            delays[i] = timer_random() % TIMER_BENCH_RANGE;
+        }
+        sw_timer_init(0U);
+        t0 = test_now_ns();
+        for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+            (void)sw_timer_start(&timers[i], delays[i], 0U);
+        }
+        start_ns[round] = test_now_ns() - t0;
+
+        t0 = test_now_ns();
+        for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+            (void)sw_timer_stop(&timers[i]);
+        }
+        stop_ns[round] = test_now_ns() - t0;
+
+        /* Expiry: all due within a few level-0 turns, processed tick by tick */
+        for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+            (void)sw_timer_start(&timers[i], timer_random() % TIMER_EXPIRE_RANGE, 0U);
+        }
+        timer_fires[0] = 0;
+        t0 = test_now_ns();
+        for (uint32_t tick = 1; tick <= TIMER_EXPIRE_RANGE; tick++) {
+            sw_timer_process(tick);
+        }
+        expire_ns[round] = test_now_ns() - t0;
+        TEST_CHECK(timer_fires[0] == TIMER_COUNT);
+    }
+    test_note("cost: start %.1f ns, stop %.1f ns, expire %.1f ns per timer (%u timers, median of %u)",
+              timer_median_per_timer(start_ns), timer_median_per_timer(stop_ns),
+              timer_median_per_timer(expire_ns), TIMER_COUNT, TIMER_ROUNDS);
+}
+
+int main(void)
+{
+    timer_exact();
+    timer_skips();
+    timer_sleep();
+    timer_cost();
+    return test_report("sw_timer");
+}
@@ -0,0 +1,366 @@
+/*
+ * test_uart_ports.c - Parallel UART Port Test
+ *
+ * All UART_COUNT ports at full rate at once, each with its own TX
+ * writer, RX reader and peer threads:
+ *
+ *   TX  every port's peer receives that port's stream complete and in
+ *       order; a byte from another port's stream is a mismatch.
+ *   RX  every byte a peer sends is either read from that port or
+ *       counted in its rx_dropped.
+ *
+ * Then two writers share one port. A call that finds the other writer
+ * transmitting gets ERR_BUSY with nothing queued, and the peer sees each
+ * call's bytes unbroken: the stream only switches writer where a call
+ * ended.
+ *
+ * Last, one port loses its peer. The transfer on the dead link still
+ * completes, so the driver is not left busy, and the next transmit is
+ * refused with ERR_HW_FAILURE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "test.h"
+#include "../drivers/uart_driver.h"
+#include "../hal/hal_uart_posix.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define PORTS_TX_BYTES          (2UL << 20)
+#define PORTS_RX_BYTES          (256UL << 10)
+#define PORTS_TIMEOUT_NS        60000000000ULL
+#define PORTS_IDLE_NS           100000000ULL
+
+#define SHARED_UART             UART_2
+#define SHARED_WRITERS          2U
+#define SHARED_BYTES            (256UL << 10)   /* Per writer */
+#define SHARED_CHUNK            48U
+
+#define DEAD_UART               UART_6
+#define DEAD_BYTES              64U
+
+static uint8_t port_byte(uart_id_t uart_id, uint32_t index)
+{
+    return (uint8_t)((index * 7U) ^ (index >> 8) ^ ((uint32_t)uart_id * 0x35U));
+}
+
+/* ===== TX ===== */
+
+typedef struct {
+    uart_id_t uart_id;
+    uint32_t sent;
+    uint32_t received;
+    uint32_t mismatches;
+} tx_port_t;
+
+static tx_port_t tx_ports[UART_COUNT];
+
+static void *tx_peer(void *arg)
+{
+    tx_port_t *port = (tx_port_t *)arg;
+    int fd = posix_uart_get_peer_fd(port->uart_id);
+    uint8_t buffer[4096];
+
+    while (port->received < PORTS_TX_BYTES) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+
+        if (n <= 0) {
+            break;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            if (buffer[i] != port_byte(port->uart_id, port->received)) {
+                port->mismatches++;
+            }
+            port->received++;
+        }
+    }
+    return NULL;
+}
+
+static void *tx_writer(void *arg)
+{
+    tx_port_t *port = (tx_port_t *)arg;
+    uint8_t chunk[200];
+    uint64_t start = test_now_ns();
+
+    while (port->sent < PORTS_TX_BYTES && test_now_ns() - start < PORTS_TIMEOUT_NS) {
+        uint16_t length = (uint16_t)((PORTS_TX_BYTES - port->sent < sizeof(chunk)) ?
+                                     PORTS_TX_BYTES - port->sent : sizeof(chunk));
+        uint16_t written = 0;
+
+        for (uint16_t i = 0; i < length; i++) {
+            chunk[i] = port_byte(port->uart_id, port->sent + i);
+        }
+        TEST_CHECK(uart_driver_write(port->uart_id, chunk, length, &written) == ERR_OK);
+        port->sent += written;
+        if (written < length) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/* ===== RX ===== */
+
+typedef struct {
+    uart_id_t uart_id;
+    uint32_t peer_sent;
+    uint32_t received;
+    uint32_t exact;
+    uint32_t dropped;
+} rx_port_t;
+
+static rx_port_t rx_ports[UART_COUNT];
+
+static void *rx_peer(void *arg)
+{
+    rx_port_t *port = (rx_port_t *)arg;
+    int fd = posix_uart_get_peer_fd(port->uart_id);
+    uint8_t buffer[512];
+
+    while (port->peer_sent < PORTS_RX_BYTES) {
+        ssize_t n;
+
+        for (uint32_t i = 0; i < sizeof(buffer); i++) {
+            buffer[i] = port_byte(port->uart_id, port->peer_sent + i);
+        }
+        n = write(fd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            break;
+        }
+        port->peer_sent += (uint32_t)n;
+    }
+    return NULL;
+}
+
+static void *rx_reader(void *arg)
+{
+    rx_port_t *port = (rx_port_t *)arg;
+    uart_driver_stats_t before;
+    uart_driver_stats_t after;
+    uint8_t buffer[128];
+    uint64_t start = test_now_ns();
+    uint64_t idle_since = 0;
+
+    (void)uart_driver_get_stats(port->uart_id, &before);
+    for (;;) {
+        uint16_t n = 0;
+
+        TEST_CHECK(uart_driver_read(port->uart_id, buffer, sizeof(buffer), &n) == ERR_OK);
+        (void)uart_driver_get_stats(port->uart_id, &after);
+        port->dropped = after.rx_dropped - before.rx_dropped;
+        for (uint16_t i = 0; i < n; i++) {
+            if (port->dropped == 0U &&
+                buffer[i] == port_byte(port->uart_id, port->received + i)) {
+                port->exact++;
+            }
+        }
+        port->received += n;
+        if (port->received + port->dropped >= PORTS_RX_BYTES ||
+            test_now_ns() - start > PORTS_TIMEOUT_NS) {
+            break;
+        }
+        if (n == 0U) {
+            if (idle_since == 0U) {
+                idle_since = test_now_ns();
+            } else if (test_now_ns() - idle_since > PORTS_IDLE_NS) {
+                break;
+            }
+            sched_yield();
+        } else {
+            idle_since = 0;
+        }
+    }
+    return NULL;
+}
+
+static void ports_parallel(void)
+{
+    pthread_t threads[UART_COUNT][4];
+    uint32_t tx_total = 0;
+    uint32_t rx_received = 0;
+    uint32_t rx_dropped = 0;
+    uint64_t start = test_now_ns();
+    uint64_t elapsed;
+
+    for (uint32_t id = 0; id < UART_COUNT; id++) {
+        tx_ports[id].uart_id = (uart_id_t)id;
+        rx_ports[id].uart_id = (uart_id_t)id;
+        TEST_CHECK(pthread_create(&threads[id][0], NULL, tx_peer, &tx_ports[id]) == 0);
+        TEST_CHECK(pthread_create(&threads[id][1], NULL, tx_writer, &tx_ports[id]) == 0);
+        TEST_CHECK(pthread_create(&threads[id][2], NULL, rx_reader, &rx_ports[id]) == 0);
+        TEST_CHECK(pthread_create(&threads[id][3], NULL, rx_peer, &rx_ports[id]) == 0);
+    }
+    for (uint32_t id = 0; id < UART_COUNT; id++) {
+        for (uint32_t t = 0; t < 4U; t++) {
+            (void)pthread_join(threads[id][t], NULL);
+        }
+    }
+    elapsed = test_now_ns() - start;
+
+    for (uint32_t id = 0; id < UART_COUNT; id++) {
+        tx_port_t *tx = &tx_ports[id];
+        rx_port_t *rx = &rx_ports[id];
+
+        TEST_CHECK(tx->sent == PORTS_TX_BYTES);
+        TEST_CHECK(tx->received == PORTS_TX_BYTES);
+        TEST_CHECK(tx->mismatches == 0U);
+        TEST_CHECK(rx->received > 0U);
+        TEST_CHECK(rx->received + rx->dropped == PORTS_RX_BYTES);
+        TEST_CHECK(rx->dropped != 0U || rx->exact == rx->received);
+        tx_total += tx->received;
+        rx_received += rx->received;
+        rx_dropped += rx->dropped;
+    }
+    test_note("%u ports: tx %u bytes, %.2f MB/s total; rx %u received, %u dropped, in %.1f ms",
+              (unsigned int)UART_COUNT, tx_total, (double)tx_total * 1e3 / (double)elapsed,
+              rx_received, rx_dropped, (double)elapsed / 1e6);
+}
+
+/* ===== Shared Port ===== */
+
+/* A byte carries its writer (top bit) and that writer's byte count
+ * modulo 128. Each writer marks where its calls ended, the peer where
+ * the stream left each writer; compared once all threads are done. */
+static uint8_t shared_call_end[SHARED_WRITERS][SHARED_BYTES / 8U + 1U];
+static uint8_t shared_switch[SHARED_WRITERS][SHARED_BYTES / 8U + 1U];
+static uint32_t shared_busy[SHARED_WRITERS];
+
+static uint8_t shared_byte(uint32_t writer, uint32_t index)
+{
+    return (uint8_t)((writer << 7) | (index & 0x7FU));
+}
+
+static void *shared_writer(void *arg)
+{
+    uint32_t writer = (uint32_t)(uintptr_t)arg;
+    uint8_t chunk[SHARED_CHUNK];
+    uint32_t sent = 0;
+    uint64_t start = test_now_ns();
+
+    while (sent < SHARED_BYTES && test_now_ns() - start < PORTS_TIMEOUT_NS) {
+        uint16_t length = (uint16_t)((SHARED_BYTES - sent < SHARED_CHUNK) ?
+                                     SHARED_BYTES - sent : SHARED_CHUNK);
+        uint16_t written = 0;
+        error_t err;
+
+        for (uint16_t i = 0; i < length; i++) {
+            chunk[i] = shared_byte(writer, sent + i);
+        }
+        err = uart_driver_write(SHARED_UART, chunk, length, &written);
+        if (err == ERR_BUSY) {
+            shared_busy[writer]++;
+            continue;
+        }
+        TEST_CHECK(err == ERR_OK);
+        if (written > 0U) {
+            sent += written;
+            shared_call_end[writer][sent / 8U] |= (uint8_t)(1U << (sent % 8U));
+        }
+        if (written < length) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void ports_shared(void)
+{
+    int fd = posix_uart_get_peer_fd(SHARED_UART);
+    pthread_t writers[SHARED_WRITERS];
+    uint32_t counts[SHARED_WRITERS] = { 0 };
+    uint32_t broken = 0;
+    uint32_t out_of_order = 0;
+    uint32_t switches = 0;
+    uint32_t total = 0;
+    uint32_t current = SHARED_WRITERS;
+    uint8_t buffer[4096];
+
+    for (uint32_t w = 0; w < SHARED_WRITERS; w++) {
+        TEST_CHECK(pthread_create(&writers[w], NULL, shared_writer, (void *)(uintptr_t)w) == 0);
+    }
+    while (total < SHARED_WRITERS * SHARED_BYTES) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+
+        if (n <= 0) {
+            break;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            uint32_t writer = buffer[i] >> 7;
+
+            if (writer != current) {
+                if (current < SHARED_WRITERS) {
+                    uint32_t end = counts[current];
+
+                    shared_switch[current][end / 8U] |= (uint8_t)(1U << (end % 8U));
+                    switches++;
+                }
+                current = writer;
+            }
+            if (buffer[i] != shared_byte(writer, counts[writer])) {
+                out_of_order++;
+            }
+            counts[writer]++;
+            total++;
+        }
+    }
+    for (uint32_t w = 0; w < SHARED_WRITERS; w++) {
+        (void)pthread_join(writers[w], NULL);
+        TEST_CHECK(counts[w] == SHARED_BYTES);
+        /* The stream only left a writer where one of its calls ended */
+        for (uint32_t i = 0; i < sizeof(shared_switch[w]); i++) {
+            broken += (uint32_t)__builtin_popcount(shared_switch[w][i] &
+                                                   (uint8_t)~shared_call_end[w][i]);
+        }
+    }
+
+    TEST_CHECK(out_of_order == 0U);
+    TEST_CHECK(broken == 0U);
+    test_note("shared port: %u bytes from %u writers, %u switches, %u broken calls, "
+              "%u + %u ERR_BUSY", total, SHARED_WRITERS, switches, broken,
+              shared_busy[0], shared_busy[1]);
+}
+
+/* ===== Dead Link ===== */
+
+static void ports_dead_link(void)
+{
+    uint8_t data[DEAD_BYTES] = { 0 };
+    uart_driver_stats_t stats = { 0 };
+    uint32_t before;
+    uint16_t written = 0;
+    uint64_t start;
+
+    (void)uart_driver_get_stats(DEAD_UART, &stats);
+    before = stats.tx_bytes;
+    TEST_CHECK(shutdown(posix_uart_get_peer_fd(DEAD_UART), SHUT_RDWR) == 0);
+    TEST_CHECK(uart_driver_write(DEAD_UART, data, DEAD_BYTES, &written) == ERR_OK);
+    TEST_CHECK(written == DEAD_BYTES);
+
+    start = test_now_ns();
+    while (stats.tx_bytes - before < DEAD_BYTES && test_now_ns() - start < PORTS_IDLE_NS * 10U) {
+        (void)uart_driver_get_stats(DEAD_UART, &stats);
+        sched_yield();
+    }
+    TEST_CHECK(stats.tx_bytes - before == DEAD_BYTES);
+    TEST_CHECK(uart_transmit_it(DEAD_UART, data, DEAD_BYTES) == ERR_HW_FAILURE);
+    test_note("dead link: transfer completed, next transmit refused");
+}
+
+int main(void)
+{
+    TEST_CHECK(uart_driver_init() == ERR_OK);
+    for (uint32_t id = 0; id < UART_COUNT; id++) {
+        if (!TEST_CHECK(uart_driver_open((uart_id_t)id, UART_BAUD_115200) == ERR_OK)) {
+            return test_report("uart_ports");
+        }
+    }
+    ports_parallel();
+    ports_shared();
+    ports_dead_link();
+    return test_report("uart_ports");
+}
@@ -0,0 +1,268 @@
+/*
+ * test_uart_stress.c - UART Ring Stress Test
+ *
+ * Continuous traffic through one port's rings, the simulated TX and RX
+ * interrupts running on the POSIX backend's threads:
+ *
+ *   TX  uart_driver_write() as fast as the ring takes it; the peer
+ *       checks every byte arrives, in order.
+ *   RX  the peer writes without pause; uart_driver_read() drains the
+ *       ring. Every byte is either received or counted in rx_dropped,
+ *       and nothing arrives that was not sent.
+ *
+ *   string  uart_driver_write_string() of a string longer than a
+ *           uint16_t length: with a wait, all of it arrives in order
+ *           as the ring drains; without one, the start of it is
+ *           queued and the rest reported cut off. The ring stays
+ *           consistent either way.
+ *
+ * Reports the sustained throughput and the drop count of each run.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "test.h"
+#include "../bsp/board_config.h"
+#include "../drivers/uart_driver.h"
+#include "../hal/hal_uart_posix.h"
+
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define STRESS_UART             UART_1
+#define STRESS_TX_BYTES         (4UL << 20)
+#define STRESS_RX_BYTES         (1UL << 20)
+#define STRESS_TIMEOUT_NS       30000000000ULL
+#define STRESS_STRING_LENGTH    (1UL << 16)     /* 0 as a uint16_t length */
+#define STRESS_STRING_WAIT_US   10000000U
+
+static uint8_t stress_byte(uint32_t index)
+{
+    return (uint8_t)((index * 7U) ^ (index >> 8));
+}
+
+/* ===== TX ===== */
+
+static uint32_t peer_received;
+static uint32_t peer_mismatches;
+
+static void *stress_tx_peer(void *arg)
+{
+    int fd = posix_uart_get_peer_fd(STRESS_UART);
+    uint8_t buffer[4096];
+
+    (void)arg;
+    while (peer_received < STRESS_TX_BYTES) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+
+        if (n <= 0) {
+            break;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            if (buffer[i] != stress_byte(peer_received)) {
+                peer_mismatches++;
+            }
+            peer_received++;
+        }
+    }
+    return NULL;
+}
+
+static void stress_tx(void)
+{
+    uint8_t chunk[200];
+    uint32_t sent = 0;
+    uint64_t start = test_now_ns();
+    uint64_t elapsed;
+    pthread_t peer;
+
+    TEST_CHECK(pthread_create(&peer, NULL, stress_tx_peer, NULL) == 0);
+    while (sent < STRESS_TX_BYTES && test_now_ns() - start < STRESS_TIMEOUT_NS) {
+        uint16_t length = (uint16_t)((STRESS_TX_BYTES - sent < sizeof(chunk)) ?
+                                     STRESS_TX_BYTES - sent : sizeof(chunk));
+        uint16_t written = 0;
+
+        for (uint16_t i = 0; i < length; i++) {
+            chunk[i] = stress_byte(sent + i);
+        }
+        TEST_CHECK(uart_driver_write(STRESS_UART, chunk, length, &written) == ERR_OK);
+        sent += written;
+        if (written < length) {
+            sched_yield();      /* Ring full: let the TX thread run */
+        }
+    }
+    (void)pthread_join(peer, NULL);
+    elapsed = test_now_ns() - start;
+
+    TEST_CHECK(sent == STRESS_TX_BYTES);
+    TEST_CHECK(peer_received == STRESS_TX_BYTES);
+    TEST_CHECK(peer_mismatches == 0U);
+    test_note("tx: %lu bytes in %.1f ms, %.2f MB/s, %u mismatches", (unsigned long)sent,
+              (double)elapsed / 1e6, (double)sent * 1e3 / (double)elapsed, peer_mismatches);
+}
+
+/* ===== RX ===== */
+
+static void *stress_rx_peer(void *arg)
+{
+    int fd = posix_uart_get_peer_fd(STRESS_UART);
+    uint8_t buffer[512];
+    uint32_t sent = 0;
+
+    (void)arg;
+    while (sent < STRESS_RX_BYTES) {
+        size_t length = sizeof(buffer);
+        ssize_t n;
+
+        for (size_t i = 0; i < length; i++) {
+            buffer[i] = stress_byte(sent + (uint32_t)i);
+        }
+        n = write(fd, buffer, length);
+        if (n <= 0) {
+            break;
+        }
+        sent += (uint32_t)n;
+    }
+    return NULL;
+}
+
+static void stress_rx(void)
+{
+    uart_driver_stats_t before;
+    uart_driver_stats_t after;
+    uint8_t buffer[128];
+    uint32_t received = 0;
+    uint32_t exact = 0;
+    uint32_t dropped;
+    uint64_t start = test_now_ns();
+    uint64_t idle_since = 0;
+    uint64_t elapsed;
+    pthread_t peer;
+
+    (void)uart_driver_get_stats(STRESS_UART, &before);
+    TEST_CHECK(pthread_create(&peer, NULL, stress_rx_peer, NULL) == 0);
+    for (;;) {
+        uint16_t n = 0;
+
+        TEST_CHECK(uart_driver_read(STRESS_UART, buffer, sizeof(buffer), &n) == ERR_OK);
+        (void)uart_driver_get_stats(STRESS_UART, &after);
+        dropped = after.rx_dropped - before.rx_dropped;
+        for (uint16_t i = 0; i < n; i++) {
+            /* Until the first drop the stream must match exactly */
+            if (dropped == 0U && buffer[i] == stress_byte(received + i)) {
+                exact++;
+            }
+        }
+        received += n;
+        if (received + dropped >= STRESS_RX_BYTES ||
+            test_now_ns() - start > STRESS_TIMEOUT_NS) {
+            break;
+        }
+        if (n == 0U) {
+            /* Quiet for 100 ms after the peer finished: nothing more */
+            if (idle_since == 0U) {
+                idle_since = test_now_ns();
+            } else if (test_now_ns() - idle_since > 100000000ULL) {
+                break;
+            }
+            sched_yield();
+        } else {
+            idle_since = 0;
+        }
+    }
+    (void)pthread_join(peer, NULL);
+    elapsed = test_now_ns() - start;
+
+    TEST_CHECK(received > 0U);
+    TEST_CHECK(received + dropped == STRESS_RX_BYTES);
+    TEST_CHECK(dropped != 0U || exact == received);
+    test_note("rx: %lu bytes in %.1f ms, %.2f MB/s, %u received, %u dropped",
+              (unsigned long)STRESS_RX_BYTES, (double)elapsed / 1e6,
+              (double)STRESS_RX_BYTES * 1e3 / (double)elapsed, received, dropped);
+}
+
+/* ===== Long String ===== */
+
+static char string_text[STRESS_STRING_LENGTH + 1U];
+
+/* Reads what the peer has until it stays quiet for 100 ms; returns the
+ * count and adds bytes that differ from string_text to *mismatches */
+static uint32_t stress_string_receive(uint32_t *mismatches)
+{
+    int fd = posix_uart_get_peer_fd(STRESS_UART);
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    uint8_t buffer[512];
+    uint32_t received = 0;
+
+    while (poll(&pfd, 1, 100) > 0) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+
+        if (n <= 0) {
+            break;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            if (buffer[i] != (uint8_t)string_text[received % STRESS_STRING_LENGTH]) {
+                (*mismatches)++;
+            }
+            received++;
+        }
+    }
+    return received;
+}
+
+static void *stress_string_peer(void *arg)
+{
+    uint32_t *mismatches = arg;
+
+    peer_received = stress_string_receive(mismatches);
+    return NULL;
+}
+
+static void stress_string(void)
+{
+    uint32_t received;
+    uint32_t mismatches = 0;
+    uint64_t start;
+    uint64_t elapsed;
+    pthread_t peer;
+
+    for (uint32_t i = 0; i < STRESS_STRING_LENGTH; i++) {
+        string_text[i] = (char)('a' + i % 26U);
+    }
+    string_text[STRESS_STRING_LENGTH] = '\0';
+
+    /* With a wait: the whole string, drained by the peer as it goes */
+    TEST_CHECK(pthread_create(&peer, NULL, stress_string_peer, &mismatches) == 0);
+    start = test_now_ns();
+    TEST_CHECK(uart_driver_write_string(STRESS_UART, STRESS_STRING_WAIT_US, string_text) ==
+               ERR_OK);
+    elapsed = test_now_ns() - start;
+    (void)pthread_join(peer, NULL);
+    TEST_CHECK(peer_received == STRESS_STRING_LENGTH);
+    TEST_CHECK(mismatches == 0U);
+    test_note("string: %lu characters in %.1f ms with a wait",
+              (unsigned long)STRESS_STRING_LENGTH, (double)elapsed / 1e6);
+
+    /* Without: cut short when the ring fills, never wrapped to a short write */
+    TEST_CHECK(uart_driver_write_string(STRESS_UART, 0U, string_text) == ERR_BUSY);
+    received = stress_string_receive(&mismatches);
+    TEST_CHECK(received >= UART1_TX_BUFFER_SIZE && received < STRESS_STRING_LENGTH);
+    TEST_CHECK(mismatches == 0U);
+    TEST_CHECK(uart_driver_tx_free(STRESS_UART) == UART1_TX_BUFFER_SIZE);
+    test_note("string: %lu characters, %u queued before the ring filled without a wait",
+              (unsigned long)STRESS_STRING_LENGTH, received);
+}
+
+int main(void)
+{
+    TEST_CHECK(uart_driver_init() == ERR_OK);
+    if (!TEST_CHECK(uart_driver_open(STRESS_UART, UART_BAUD_115200) == ERR_OK)) {
+        return test_report("uart_stress");
+    }
+    stress_tx();
+    stress_rx();
+    stress_string();
+    return test_report("uart_stress");
+}
@@ -0,0 +1,346 @@
+/*
+ * test_wave.c - Waveform Driver Test
+ *
+ * Plays waveforms on a spare port through wave_driver with the host
+ * engine's capture on, every word changing a pin so every sample leaves
+ * an edge:
+ *
+ *   ports    a port the board does not have, and the other malformed
+ *            starts, are refused before anything runs.
+ *   oneshot  each word goes out once, in order, the callback runs once
+ *            and the pins keep the last word.
+ *   repeat   the buffer loops until stopped, one callback per pass.
+ *   double   the callback gets the two halves in turn, and what it
+ *            writes into a half is what goes out on its next pass.
+ *   clock    a clock profile switch mid-waveform re-times the timer
+ *            for the new clock; the samples stay on the same rate.
+ *
+ * Each edge's timestamp is checked against its sample's slot, sample
+ * number x the sample period: never early, and late by less than a
+ * period at the median. A host thread wakes late now and then and the
+ * samples it owes then go out back to back, so an edge is late only
+ * from its slot or the edge before it, whichever is later.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "test.h"
+#include "../app/app.h"
+#include "../bsp/bsp_clock.h"
+#include "../drivers/gpio_driver.h"
+#include "../drivers/wave_driver.h"
+#include "../hal/hal_gpio_posix.h"
+#include "../hal/hal_wave_posix.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define WAVE_PORT               GPIO_PORT_G
+#define WAVE_RATE_HZ            1000U
+#define WAVE_WORDS              8U
+#define WAVE_ONESHOT_WORDS      63U     /* Odd; enough that one late wake-up is not the median */
+#define WAVE_RUN_NS             50000000ULL
+#define WAVE_TIMEOUT_NS         2000000000ULL
+#define WAVE_MAX_EDGES          1024U
+
+#define WAVE_PIN_A              (1U << 0)
+#define WAVE_PIN_B              (1U << 1)
+
+static wave_word_t wave_words[WAVE_ONESHOT_WORDS];
+static posix_wave_edge_t wave_edges[WAVE_MAX_EDGES];
+
+static _Atomic uint32_t wave_calls;
+static _Atomic uint32_t wave_bad_halves;
+static wave_word_t *wave_last_words;
+static uint16_t wave_last_count;
+
+static void wave_sleep_ns(uint64_t ns)
+{
+    struct timespec ts = { .tv_sec = (time_t)(ns / 1000000000ULL),
+                           .tv_nsec = (long)(ns % 1000000000ULL) };
+
+    (void)nanosleep(&ts, NULL);
+}
+
+/* Pin toggles: set and clear mask by turns, starting with a set */
+static void wave_fill(wave_word_t *words, uint16_t count, uint16_t mask)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        words[i] = ((i & 1U) == 0U) ? WAVE_SET(mask) : WAVE_CLEAR(mask);
+    }
+}
+
+/* Start from all pins low, so the first word is an edge */
+static void wave_reset(void)
+{
+    (void)gpio_driver_port_write_masked(WAVE_PORT, 0xFFFFU, 0U);
+    atomic_store(&wave_calls, 0U);
+    atomic_store(&wave_bad_halves, 0U);
+    wave_last_words = NULL;
+    wave_last_count = 0U;
+    posix_wave_capture(wave_edges, WAVE_MAX_EDGES);
+}
+
+static void wave_wait_stopped(void)
+{
+    uint64_t start = test_now_ns();
+
+    while (wave_driver_is_running() && test_now_ns() - start < WAVE_TIMEOUT_NS) {
+        wave_sleep_ns(1000000ULL);
+    }
+}
+
+static int wave_compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Edges first..count-1 against their slots, sample x period from the
+ * start, or the edge before when that came later */
+static void wave_check_timestamps(const char *name, uint32_t first, uint32_t count)
+{
+    static double late[WAVE_MAX_EDGES];
+    uint64_t period_ns = posix_wave_period_ns();
+    double period = (double)period_ns;
+    uint32_t early = 0;
+    uint32_t n = 0;
+    double median;
+
+    for (uint32_t i = first; i < count; i++) {
+        double due = (double)wave_edges[i].sample * period;
+        double from = due;
+
+        /* 1 us of slack for the rounding of the period */
+        if ((double)wave_edges[i].time_ns + 1000.0 < due) {
+            early++;
+        }
+        if (i > first && (double)wave_edges[i - 1U].time_ns > from) {
+            from = (double)wave_edges[i - 1U].time_ns;
+        }
+        late[n++] = (double)wave_edges[i].time_ns - from;
+    }
+    if (!TEST_CHECK(n > 0U)) {
+        return;
+    }
+    qsort(late, n, sizeof(late[0]), wave_compare_double);
+    median = late[n / 2U];
+    TEST_CHECK(early == 0U);
+    TEST_CHECK(median < period);
+    test_note("%s: %u edges, period %.0f us, late by %.1f us median, %.1f us max", name, n,
+              period / 1e3, median / 1e3, late[n - 1U] / 1e3);
+}
+
+static void wave_count_call(wave_word_t *words, uint16_t count, void *context)
+{
+    (void)context;
+    wave_last_words = words;
+    wave_last_count = count;
+    atomic_fetch_add(&wave_calls, 1U);
+}
+
+/* ===== Ports ===== */
+
+static void wave_ports(void)
+{
+    wave_fill(wave_words, WAVE_WORDS, WAVE_PIN_A);
+
+    TEST_CHECK(wave_driver_start(GPIO_BOARD_PORT_COUNT, wave_words, WAVE_WORDS, WAVE_RATE_HZ,
+                                 WAVE_MODE_ONESHOT, NULL, NULL) == ERR_INVALID_PARAM);
+    TEST_CHECK(wave_driver_start(GPIO_PORT_COUNT - 1U, wave_words, WAVE_WORDS, WAVE_RATE_HZ,
+                                 WAVE_MODE_ONESHOT, NULL, NULL) == ERR_INVALID_PARAM);
+    TEST_CHECK(wave_driver_start(WAVE_PORT, NULL, WAVE_WORDS, WAVE_RATE_HZ,
+                                 WAVE_MODE_ONESHOT, NULL, NULL) == ERR_INVALID_PARAM);
+    TEST_CHECK(wave_driver_start(WAVE_PORT, wave_words, 0U, WAVE_RATE_HZ,
+                                 WAVE_MODE_ONESHOT, NULL, NULL) == ERR_INVALID_PARAM);
+    TEST_CHECK(wave_driver_start(WAVE_PORT, wave_words, WAVE_WORDS, WAVE_RATE_HZ,
+                                 WAVE_MODE_DOUBLE, NULL, NULL) == ERR_INVALID_PARAM);
+    TEST_CHECK(wave_driver_start(WAVE_PORT, wave_words, WAVE_WORDS - 1U, WAVE_RATE_HZ,
+                                 WAVE_MODE_DOUBLE, wave_count_call, NULL) == ERR_INVALID_PARAM);
+    TEST_CHECK(wave_driver_start(WAVE_PORT, wave_words, WAVE_WORDS, WAVE_MAX_RATE_HZ * 2U,
+                                 WAVE_MODE_ONESHOT, NULL, NULL) != ERR_OK);
+    TEST_CHECK(!wave_driver_is_running());
+}
+
+/* ===== One-Shot ===== */
+
+static void wave_oneshot(void)
+{
+    wave_status_t status;
+    uint32_t captured;
+    uint32_t in_order = 0;
+
+    wave_reset();
+    /* Odd count: the last word is a set, which the pins keep */
+    wave_fill(wave_words, WAVE_ONESHOT_WORDS, WAVE_PIN_A);
+    if (!TEST_CHECK(wave_driver_start(WAVE_PORT, wave_words, WAVE_ONESHOT_WORDS, WAVE_RATE_HZ,
+                                      WAVE_MODE_ONESHOT, wave_count_call, NULL) == ERR_OK)) {
+        return;
+    }
+    TEST_CHECK(wave_driver_start(WAVE_PORT, wave_words, WAVE_WORDS, WAVE_RATE_HZ,
+                                 WAVE_MODE_ONESHOT, NULL, NULL) == ERR_BUSY);
+    wave_wait_stopped();
+    wave_sleep_ns(10000000ULL);         /* No word after the last */
+
+    captured = posix_wave_captured();
+    TEST_CHECK(captured == WAVE_ONESHOT_WORDS);
+    for (uint32_t i = 0; i < captured; i++) {
+        if (wave_edges[i].sample == i &&
+            wave_edges[i].after == (((i & 1U) == 0U) ? WAVE_PIN_A : 0U)) {
+            in_order++;
+        }
+    }
+    TEST_CHECK(in_order == captured);
+    TEST_CHECK(atomic_load(&wave_calls) == 1U);
+    TEST_CHECK(wave_last_words == wave_words && wave_last_count == WAVE_ONESHOT_WORDS);
+    TEST_CHECK(posix_gpio_ports[WAVE_PORT].odr == WAVE_PIN_A);
+    TEST_CHECK(wave_driver_get_status(&status) == ERR_OK);
+    TEST_CHECK(!status.running && status.mode == WAVE_MODE_ONESHOT && status.passes == 1U);
+    TEST_CHECK(status.timing.actual_rate_hz == WAVE_RATE_HZ);
+    wave_check_timestamps("oneshot", 0U, captured);
+}
+
+/* ===== Repeat ===== */
+
+static void wave_repeat(void)
+{
+    wave_status_t status;
+    uint32_t captured;
+    uint32_t gaps = 0;
+
+    wave_reset();
+    wave_fill(wave_words, WAVE_WORDS, WAVE_PIN_A);
+    if (!TEST_CHECK(wave_driver_start(WAVE_PORT, wave_words, WAVE_WORDS, WAVE_RATE_HZ,
+                                      WAVE_MODE_REPEAT, wave_count_call, NULL) == ERR_OK)) {
+        return;
+    }
+    wave_sleep_ns(WAVE_RUN_NS);
+    TEST_CHECK(wave_driver_is_running());
+    TEST_CHECK(wave_driver_stop() == ERR_OK);
+    TEST_CHECK(wave_driver_get_status(&status) == ERR_OK);
+
+    /* Every sample an edge, no sample skipped */
+    captured = posix_wave_captured();
+    for (uint32_t i = 0; i < captured; i++) {
+        if (wave_edges[i].sample != i) {
+            gaps++;
+        }
+    }
+    TEST_CHECK(gaps == 0U);
+    TEST_CHECK(captured >= 2U * WAVE_WORDS);
+    TEST_CHECK(status.passes >= captured / WAVE_WORDS - 1U && status.passes <= captured / WAVE_WORDS);
+    TEST_CHECK(atomic_load(&wave_calls) == status.passes);
+    TEST_CHECK(wave_last_words == wave_words && wave_last_count == WAVE_WORDS);
+    wave_check_timestamps("repeat", 0U, captured);
+}
+
+/* ===== Double Buffer ===== */
+
+/* Each half, once handed back, toggles pin B instead of pin A */
+static void wave_refill(wave_word_t *words, uint16_t count, void *context)
+{
+    uint32_t call = atomic_fetch_add(&wave_calls, 1U);
+    wave_word_t *expected = &wave_words[((call & 1U) == 0U) ? 0U : WAVE_WORDS / 2U];
+
+    (void)context;
+    if (words != expected || count != WAVE_WORDS / 2U) {
+        atomic_fetch_add(&wave_bad_halves, 1U);
+    }
+    wave_fill(words, count, WAVE_PIN_B);
+}
+
+static void wave_double(void)
+{
+    uint32_t captured;
+    uint32_t pin_a_late = 0;
+    uint32_t pin_b = 0;
+
+    wave_reset();
+    wave_fill(wave_words, WAVE_WORDS, WAVE_PIN_A);
+    if (!TEST_CHECK(wave_driver_start(WAVE_PORT, wave_words, WAVE_WORDS, WAVE_RATE_HZ,
+                                      WAVE_MODE_DOUBLE, wave_refill, NULL) == ERR_OK)) {
+        return;
+    }
+    wave_sleep_ns(WAVE_RUN_NS);
+    TEST_CHECK(wave_driver_stop() == ERR_OK);
+
+    /* The first pass plays pin A; every later one the refilled pin B */
+    captured = posix_wave_captured();
+    for (uint32_t i = 0; i < captured; i++) {
+        uint16_t changed = (uint16_t)(wave_edges[i].before ^ wave_edges[i].after);
+
+        if (wave_edges[i].sample >= WAVE_WORDS && changed != WAVE_PIN_B) {
+            pin_a_late++;
+        }
+        if (changed == WAVE_PIN_B) {
+            pin_b++;
+        }
+    }
+    TEST_CHECK(captured >= 2U * WAVE_WORDS);
+    TEST_CHECK(atomic_load(&wave_calls) >= 2U);
+    TEST_CHECK(atomic_load(&wave_bad_halves) == 0U);
+    TEST_CHECK(pin_a_late == 0U);
+    TEST_CHECK(pin_b > 0U);
+    test_note("double: %u refills, %u pin B edges", atomic_load(&wave_calls), pin_b);
+    wave_check_timestamps("double", 0U, captured);
+}
+
+/* ===== Clock Switch ===== */
+
+static void wave_clock(void)
+{
+    wave_status_t before;
+    wave_status_t after;
+    uint32_t switched;
+    uint32_t captured;
+
+    wave_reset();
+    wave_fill(wave_words, WAVE_WORDS, WAVE_PIN_A);
+    if (!TEST_CHECK(wave_driver_start(WAVE_PORT, wave_words, WAVE_WORDS, WAVE_RATE_HZ,
+                                      WAVE_MODE_REPEAT, NULL, NULL) == ERR_OK)) {
+        return;
+    }
+    wave_sleep_ns(WAVE_RUN_NS / 2U);
+    TEST_CHECK(wave_driver_get_status(&before) == ERR_OK);
+    TEST_CHECK(bsp_clock_set_profile(CLOCK_PROFILE_LOW_POWER, NULL) == ERR_OK);
+    switched = posix_wave_captured();
+    TEST_CHECK(wave_driver_get_status(&after) == ERR_OK);
+    wave_sleep_ns(WAVE_RUN_NS / 2U);
+    TEST_CHECK(wave_driver_is_running());
+    TEST_CHECK(wave_driver_stop() == ERR_OK);
+    TEST_CHECK(bsp_clock_set_profile(CLOCK_PROFILE_PERFORMANCE, NULL) == ERR_OK);
+
+    /* Re-timed for the slower timer clock, at the same rate */
+    TEST_CHECK(after.timing.timer_clock_hz < before.timing.timer_clock_hz);
+    TEST_CHECK(after.timing.actual_rate_hz == WAVE_RATE_HZ);
+    TEST_CHECK(posix_wave_period_ns() == 1000000000ULL / WAVE_RATE_HZ);
+    test_note("clock: timer %u -> %u Hz, PSC %u ARR %u -> PSC %u ARR %u",
+              before.timing.timer_clock_hz, after.timing.timer_clock_hz,
+              before.timing.prescaler, before.timing.reload,
+              after.timing.prescaler, after.timing.reload);
+
+    /* Samples after the switch still on the start's grid */
+    captured = posix_wave_captured();
+    TEST_CHECK(captured > switched + WAVE_WORDS);
+    wave_check_timestamps("clock", switched, captured);
+}
+
+int main(void)
+{
+    if (!TEST_CHECK(app_init() == ERR_OK)) {
+        return test_report("wave");
+    }
+    for (uint8_t n = 0; n < 2U; n++) {
+        (void)gpio_driver_configure(GPIO_PIN(WAVE_PORT, n), GPIO_MODE_OUTPUT);
+    }
+    wave_ports();
+    wave_oneshot();
+    wave_repeat();
+    wave_double();
+    wave_clock();
+    posix_wave_capture(NULL, 0U);
+    return test_report("wave");
+}
@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""
+bench_compare.py - Check host benchmark results against a baseline
+
+Usage:
+    bench_compare.py --merge OUT.json RUN.json [RUN.json ...]
+    bench_compare.py BASELINE.json RESULTS.json
+    bench_compare.py --update BASELINE.json RESULTS.json
+    bench_compare.py --versus A.json B.json
+
+Each RUN.json is the output of one run of the bench program (make bench
+runs it BENCH_RUNS times). --merge folds them into one RESULTS.json in
+which each of a benchmark's measurements (ns_per_op, ops_per_sec,
+bytes_per_sec, p50_ns, p90_ns, p99_ns) is its median over the runs,
+so one run disturbed by the rest of the machine moves neither the
+check nor a recorded baseline. The other modes also accept RUN.json
+files, merged the same way.
+
+Each benchmark's median is compared with the baseline's: it fails
+when it is slower by more than the tolerance, a fraction of the baseline
+median, and by more than FLOOR_NS, so that a nanosecond of noise on a
+few-nanosecond operation is not a regression. The tolerance is the
+case's own (bench_case_t.tolerance_pct, in the results), else the
+baseline's default; BENCH_TOLERANCE in the environment overrides both.
+A benchmark missing from either side (the baseline side only for an
+unfiltered run), or results from a different build configuration than
+the baseline, fail as well.
+
+Absolute times only compare on one machine: a baseline is recorded with
+--update (make bench-baseline) on the machine that runs the check, one
+per build configuration, and is not committed. A missing baseline fails
+with a hint to record one.
+
+--update writes the results as the new baseline; a filtered run only
+replaces the benchmarks it ran.
+
+--versus sets two results side by side, e.g. the same cases built with
+dynamic and static HAL binding (make bench-binding), and never fails.
+
+Exits 1 on any failure. Only the Python standard library is needed.
+"""
+
+import json
+import os
+import statistics
+import sys
+
+DEFAULT_TOLERANCE = 0.25
+FLOOR_NS = 5.0
+
+# Per-run measurements; --merge keeps the median of each over the runs
+MEASURED = ("ns_per_op", "ops_per_sec", "bytes_per_sec", "p50_ns", "p90_ns", "p99_ns")
+
+
+def load(path):
+    try:
+        with open(path) as f:
+            return json.load(f)
+    except (OSError, ValueError) as e:
+        sys.exit("%s: %s" % (path, e))
+
+
+def write(path, results):
+    with open(path, "w") as f:
+        json.dump(results, f, indent=2)
+        f.write("\n")
+    return 0
+
+
+def merge(runs):
+    """Fold several runs into one result: per benchmark, the median over
+    the runs of each measured field; the rest is taken from the first."""
+    first = runs[0]
+    if len(runs) == 1:
+        for bench in first["benchmarks"]:
+            bench.setdefault("runs", 1)
+        return first
+    for run in runs[1:]:
+        if run["config"] != first["config"] or run.get("filter") != first.get("filter"):
+            sys.exit("results: runs from different configurations or filters")
+    benches = {}
+    values = {}
+    for run in runs:
+        for bench in run["benchmarks"]:
+            benches.setdefault(bench["name"], dict(bench))
+            fields = values.setdefault(bench["name"], {})
+            for field in MEASURED:
+                if field in bench:
+                    fields.setdefault(field, []).append(bench[field])
+    merged = dict(first)
+    merged["benchmarks"] = []
+    for name, bench in benches.items():
+        for field, samples in values[name].items():
+            bench[field] = statistics.median(samples)
+        bench["runs"] = len(values[name]["p50_ns"])
+        merged["benchmarks"].append(bench)
+    return merged
+
+
+def update(baseline_path, results):
+    """Write results as the baseline, keeping its default tolerance."""
+    old = load(baseline_path) if os.path.exists(baseline_path) else {}
+    marks = dict(old.get("benchmarks", {})) if "filter" in results else {}
+    for bench in results["benchmarks"]:
+        marks[bench["name"]] = {"p50_ns": round(bench["p50_ns"], 1)}
+    baseline = {
+        "config": results["config"],
+        "tolerance": old.get("tolerance", DEFAULT_TOLERANCE),
+        "benchmarks": marks,
+    }
+    directory = os.path.dirname(baseline_path)
+    if directory:
+        os.makedirs(directory, exist_ok=True)
+    write(baseline_path, baseline)
+    print("Baseline: %s (%d benchmarks)" % (baseline_path, len(marks)))
+    return 0
+
+
+def compare(baseline, results):
+    failed = []
+    if baseline["config"] != results["config"]:
+        failed.append("config %s, baseline was recorded with %s"
+                      % (json.dumps(results["config"]), json.dumps(baseline["config"])))
+
+    env = os.environ.get("BENCH_TOLERANCE")
+    default = float(env) if env else baseline.get("tolerance", DEFAULT_TOLERANCE)
+    marks = baseline["benchmarks"]
+    seen = set()
+
+    print("%-32s %10s %10s %8s %6s %5s"
+          % ("benchmark", "base p50", "p50", "change", "limit", "runs"))
+    for bench in results["benchmarks"]:
+        name = bench["name"]
+        seen.add(name)
+        if name not in marks:
+            failed.append("%s: not in the baseline" % name)
+            continue
+        base = marks[name]["p50_ns"]
+        now = bench["p50_ns"]
+        tolerance = default if env else bench.get("tolerance", default)
+        change = (now - base) / base if base > 0 else 0.0
+        regressed = now > base * (1.0 + tolerance) and now - base > FLOOR_NS
+        print("%-32s %10.1f %10.1f %+7.1f%% %5.0f%% %5d%s"
+              % (name, base, now, change * 100.0, tolerance * 100.0, bench["runs"],
+                 "  REGRESSED" if regressed else ""))
+        if regressed:
+            failed.append("%s: p50 %.1f ns, baseline %.1f ns" % (name, now, base))
+
+    # A filtered run only checks what it ran
+    if "filter" not in results:
+        for name in marks:
+            if name not in seen:
+                failed.append("%s: in the baseline but not run" % name)
+
+    for line in failed:
+        print("FAIL: %s" % line)
+    if failed:
+        return 1
+    print("OK: %d benchmarks within tolerance" % len(seen))
+    return 0
+
+
+def versus(a, b):
+    print("A: %s" % json.dumps(a["config"]))
+    print("B: %s" % json.dumps(b["config"]))
+    print("%-32s %10s %10s %8s" % ("benchmark", "A p50", "B p50", "B/A"))
+    marks = {bench["name"]: bench["p50_ns"] for bench in a["benchmarks"]}
+    for bench in b["benchmarks"]:
+        if bench["name"] not in marks:
+            continue
+        base = marks[bench["name"]]
+        print("%-32s %10.1f %10.1f %8.2f"
+              % (bench["name"], base, bench["p50_ns"],
+                 bench["p50_ns"] / base if base > 0 else 0.0))
+    return 0
+
+
+def main(argv):
+    args = argv[1:]
+    mode = args.pop(0) if args and args[0].startswith("--") else None
+    if len(args) < 2 or mode not in (None, "--update", "--merge", "--versus"):
+        sys.exit(__doc__.strip())
+    if mode == "--versus":
+        if len(args) != 2:
+            sys.exit(__doc__.strip())
+        return versus(merge([load(args[0])]), merge([load(args[1])]))
+    results = merge([load(path) for path in args[1:]])
+    if mode == "--merge":
+        return write(args[0], results)
+    if mode == "--update":
+        return update(args[0], results)
+    if not os.path.exists(args[0]):
+        sys.exit("%s: no baseline for this configuration; record one on this "
+                 "machine with make bench-baseline (same options as make bench)" % args[0])
+    return compare(load(args[0]), results)
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""
+binlog_decode.py - Decode deferred binary log frames (common/binlog.h)
+
+Usage:
+    binlog_decode.py FIRMWARE.elf [CAPTURE]
+
+Reads frames from CAPTURE (a file, a serial device, or stdin when
+omitted or "-") and prints one line per record. The format strings are
+taken from the "binlog_fmt" section of the ELF the target was flashed
+with; a frame's message ID is the offset of its string in that section.
+
+Frame: [0xB1] [id:16 LE] [nargs:8] [dt_us:var] [arg:var]*nargs
+where var is an unsigned LEB128 and dt_us the time since the previous
+frame, a 32-bit difference read as signed (a record may be stamped a
+little earlier than the one before it). Timestamps are counted from the
+first frame seen, so they match the target's clock only when the
+capture starts at boot.
+
+Only the Python standard library is needed.
+"""
+
+import re
+import struct
+import sys
+
+FRAME_SYNC = 0xB1
+FRAME_HEADER = 4
+MAX_ARGS = 4
+ID_DROPPED = 0xFFFF
+SECTION = "binlog_fmt"
+
+CONVERSION = re.compile(
+    r"%([-+ #0]*)(\d+)?(?:\.(\d+))?(?:hh|h|ll|l|j|z|t|L)?([diuxXocp%])")
+
+
+def read_section(path, name):
+    """Return the contents of section name from an ELF32/ELF64 file."""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF":
+        sys.exit("%s: not an ELF file" % path)
+    is64 = elf[4] == 2
+    endian = "<" if elf[5] == 1 else ">"
+    if is64:
+        shoff, = struct.unpack_from(endian + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x3A)
+        entry = endian + "IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from(endian + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x2E)
+        entry = endian + "IIIIIIIIII"
+
+    sections = [struct.unpack_from(entry, elf, shoff + i * shentsize) for i in range(shnum)]
+    names = sections[shstrndx]
+    for section in sections:
+        sh_name, offset, size = section[0], section[4], section[5]
+        start = names[4] + sh_name
+        if elf[start:elf.index(b"\0", start)].decode() == name:
+            return elf[offset:offset + size]
+    sys.exit("%s: no %s section (no BINLOG calls linked in?)" % (path, name))
+
+
+def format_record(fmt, args):
+    """Apply a printf-style format to 32-bit argument words."""
+    words = iter(args)
+
+    def convert(match):
+        flags, width, precision, conv = match.groups()
+        if conv == "%":
+            return "%"
+        value = next(words, 0)
+        if conv in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+            conv = "d"
+        elif conv == "c":
+            value = chr(value & 0xFF)
+        elif conv == "p":
+            return "0x%08x" % value
+        elif conv == "u":
+            conv = "d"
+        spec = "%" + flags + (width or "") + ("." + precision if precision else "") + conv
+        return spec % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def message(strings, msg_id):
+    if msg_id >= len(strings):
+        return None
+    end = strings.find(b"\0", msg_id)
+    return strings[msg_id:end if end >= 0 else len(strings)].decode("utf-8", "replace")
+
+
+def read_var(buf, pos):
+    """Unsigned LEB128 at buf[pos:]; returns (value, next_pos), or None
+    if buf ends first. A sixth byte means this is not a frame."""
+    value = 0
+    for shift in range(0, 35, 7):
+        if pos >= len(buf):
+            return None
+        byte = buf[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value & 0xFFFFFFFF, pos
+    raise ValueError("varint too long")
+
+
+def parse_frame(strings, buf):
+    """Return (fmt, dt, args, length) for the frame at buf[0], None if
+    more bytes are needed; ValueError if buf[0] does not start a frame."""
+    if buf[0] != FRAME_SYNC:
+        raise ValueError("no sync")
+    msg_id, nargs = struct.unpack_from("<HB", buf, 1)
+    fmt = "records dropped: %u" if msg_id == ID_DROPPED else message(strings, msg_id)
+    if nargs > MAX_ARGS or fmt is None:
+        raise ValueError("bad header")
+    fields = []
+    pos = FRAME_HEADER
+    for _ in range(1 + nargs):
+        field = read_var(buf, pos)
+        if field is None:
+            return None
+        value, pos = field
+        fields.append(value)
+    return fmt, fields[0], fields[1:], pos
+
+
+def decode(strings, stream, out):
+    buf = b""
+    timestamp = 0
+    while True:
+        chunk = stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+        if not chunk:
+            break
+        buf += chunk
+        while len(buf) >= FRAME_HEADER:
+            try:
+                frame = parse_frame(strings, buf)
+            except ValueError:
+                buf = buf[1:]       # Not a frame boundary; resync
+                continue
+            if frame is None:
+                break
+            fmt, dt, args, length = frame
+            timestamp += dt - (1 << 32) if dt >= 1 << 31 else dt
+            out.write("[%6u.%06u] %s\n" % (timestamp // 1000000, timestamp % 1000000,
+                                           format_record(fmt, args)))
+            out.flush()
+            buf = buf[length:]
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.exit(__doc__.strip())
+    strings = read_section(argv[1], SECTION)
+    if len(argv) == 2 or argv[2] == "-":
+        decode(strings, sys.stdin.buffer, sys.stdout)
+    else:
+        with open(argv[2], "rb", buffering=0) as stream:
+            decode(strings, stream, sys.stdout)
+
+
+if __name__ == "__main__":
+    main(sys.argv)
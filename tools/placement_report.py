@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""
+placement_report.py - Report where hot code and data were linked
+
+Usage:
+    placement_report.py FIRMWARE.elf [SECTION ...]
+
+Prints every allocated section with its run address, load address
+(differs for sections copied from flash at reset) and size, then each
+symbol in the listed sections (default: .ramfunc .hotdata .ram_vectors,
+see common/hot_path.h) with its address and size.
+
+Only the Python standard library is needed.
+"""
+
+import struct
+import sys
+
+HOT_SECTIONS = (".ramfunc", ".hotdata", ".ram_vectors")
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+SHT_SYMTAB = 2
+PT_LOAD = 1
+EM_ARM = 40
+STT_OBJECT = 1
+STT_FUNC = 2
+
+
+def load_elf(path):
+    """Return (sections, symbols, segments) of an ELF32/ELF64 file."""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF":
+        sys.exit("%s: not an ELF file" % path)
+    is64 = elf[4] == 2
+    endian = "<" if elf[5] == 1 else ">"
+    thumb = struct.unpack_from(endian + "H", elf, 0x12)[0] == EM_ARM
+    if is64:
+        phoff, shoff = struct.unpack_from(endian + "QQ", elf, 0x20)
+        phentsize, phnum, shentsize, shnum, shstrndx = \
+            struct.unpack_from(endian + "HHHHH", elf, 0x36)
+        sh_entry = endian + "IIQQQQIIQQ"
+        ph_entry = endian + "IIQQQQQQ"
+        sym_entry = endian + "IBBHQQ"
+    else:
+        phoff, shoff = struct.unpack_from(endian + "II", elf, 0x1C)
+        phentsize, phnum, shentsize, shnum, shstrndx = \
+            struct.unpack_from(endian + "HHHHH", elf, 0x2A)
+        sh_entry = endian + "IIIIIIIIII"
+        ph_entry = endian + "IIIIIIII"
+        sym_entry = endian + "IIIBBH"
+
+    def cstr(offset):
+        return elf[offset:elf.index(b"\0", offset)].decode("utf-8", "replace")
+
+    raw = [struct.unpack_from(sh_entry, elf, shoff + i * shentsize) for i in range(shnum)]
+    names = raw[shstrndx][4]
+    sections = []
+    for sh in raw:
+        sh_name, sh_type, flags, addr, offset, size, link = sh[:7]
+        sections.append({"name": cstr(names + sh_name), "type": sh_type, "flags": flags,
+                         "addr": addr, "offset": offset, "size": size, "link": link})
+
+    segments = []
+    for i in range(phnum):
+        ph = struct.unpack_from(ph_entry, elf, phoff + i * phentsize)
+        if is64:
+            p_type, _, p_offset, p_vaddr, p_paddr, p_filesz = ph[:6]
+        else:
+            p_type, p_offset, p_vaddr, p_paddr, p_filesz = ph[:5]
+        if p_type == PT_LOAD:
+            segments.append((p_offset, p_filesz, p_vaddr, p_paddr))
+
+    symbols = []
+    for sh in sections:
+        if sh["type"] != SHT_SYMTAB:
+            continue
+        strtab = sections[sh["link"]]["offset"]
+        step = struct.calcsize(sym_entry)
+        for pos in range(sh["offset"] + step, sh["offset"] + sh["size"], step):
+            fields = struct.unpack_from(sym_entry, elf, pos)
+            if is64:
+                st_name, info, _, shndx, value, size = fields
+            else:
+                st_name, value, size, info, _, shndx = fields
+            if info & 0xF in (STT_OBJECT, STT_FUNC) and 0 < shndx < len(sections):
+                if thumb and info & 0xF == STT_FUNC:
+                    value &= ~1
+                symbols.append((cstr(strtab + st_name), shndx, value, size))
+    return sections, symbols, segments
+
+
+def load_address(section, segments):
+    """Flash address a section is copied from, or its own address."""
+    if section["type"] == SHT_NOBITS:
+        return section["addr"]
+    for offset, filesz, vaddr, paddr in segments:
+        if offset <= section["offset"] < offset + filesz:
+            return paddr + (section["offset"] - offset)
+    return section["addr"]
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.exit(__doc__.strip())
+    sections, symbols, segments = load_elf(argv[1])
+    wanted = argv[2:] or HOT_SECTIONS
+
+    print("%-16s %10s %10s %8s" % ("section", "address", "load", "size"))
+    for section in sections:
+        if section["flags"] & SHF_ALLOC and section["size"]:
+            print("%-16s 0x%08x 0x%08x %8d" % (section["name"], section["addr"],
+                                               load_address(section, segments), section["size"]))
+
+    for name in wanted:
+        index = next((i for i, s in enumerate(sections) if s["name"] == name), None)
+        print()
+        if index is None:
+            print("%s: not in this image" % name)
+            continue
+        placed = sorted((s for s in symbols if s[1] == index), key=lambda s: s[2])
+        print("%s: %d symbols, %d bytes" % (name, len(placed), sections[index]["size"]))
+        for sym_name, _, value, size in placed:
+            print("  0x%08x %6d  %s" % (value, size, sym_name))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))